@@ -95,6 +95,19 @@ class MMAPAllocation : public Allocation {
     return offset_of_buffer_in_file_;
   }
 
+  // Hints that the mapped bytes [data, data + bytes) will be read soon, so
+  // that the OS starts paging them in from the file. The range is widened to
+  // whole pages. Returns false if the range is outside of the mapping or the
+  // hint failed.
+  bool Prefetch(const void* data, size_t bytes) const;
+
+  // Drops the pages fully within the mapped bytes [data, data + bytes) from
+  // the resident memory of the process. The mapping is read-only and backed
+  // by the file, so the data stays valid and is paged in again if it is read
+  // later. Returns false if the range is outside of the mapping or the hint
+  // failed.
+  bool ReleasePages(const void* data, size_t bytes) const;
+
   static bool IsSupported();
 
  protected:
@@ -19,7 +19,9 @@ limitations under the License.
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/compiler/mlir/lite/allocation.h"
 #include "tensorflow/compiler/mlir/lite/core/api/error_reporter.h"
@@ -40,6 +42,42 @@ size_t GetFdSizeBytes(int fd) {
   return fd_stat.st_size;
 }
 
+size_t GetPageSize() {
+#ifdef __ANDROID__
+  static const size_t pagesize = getpagesize();
+#else
+  static const size_t pagesize = sysconf(_SC_PAGE_SIZE);
+#endif
+  return pagesize;
+}
+
+// Applies `advice` to the pages of [data, data + bytes) within the mapping at
+// [mapping, mapping + mapping_bytes). If `whole_pages_only`, the pages that
+// the range only covers partially are left alone.
+bool AdvisePages(const void* mapping, size_t mapping_bytes, const void* data,
+                 size_t bytes, bool whole_pages_only, int advice) {
+  const uintptr_t mapping_begin = reinterpret_cast<uintptr_t>(mapping);
+  const uintptr_t mapping_end = mapping_begin + mapping_bytes;
+  uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  uintptr_t end = begin + bytes;
+  if (begin < mapping_begin || end > mapping_end || end < begin) {
+    return false;
+  }
+  const size_t pagesize = GetPageSize();
+  if (whole_pages_only) {
+    begin = (begin + pagesize - 1) / pagesize * pagesize;
+    end = end / pagesize * pagesize;
+  } else {
+    begin = begin / pagesize * pagesize;
+    end = std::min<uintptr_t>((end + pagesize - 1) / pagesize * pagesize,
+                              mapping_end);
+  }
+  if (end <= begin) {
+    return true;
+  }
+  return madvise(reinterpret_cast<void*>(begin), end - begin, advice) == 0;
+}
+
 }  // namespace
 
 MMAPAllocation::MMAPAllocation(const char* filename,
@@ -81,12 +119,7 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
     return;
   }
 
-#ifdef __ANDROID__
-  static int pagesize = getpagesize();
-#else
-  static int pagesize = sysconf(_SC_PAGE_SIZE);
-#endif
-
+  const size_t pagesize = GetPageSize();
   offset_in_buffer_ = offset % pagesize;
   offset_of_buffer_in_file_ = offset - offset_in_buffer_;
 
@@ -129,6 +162,18 @@ size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
 bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
+bool MMAPAllocation::Prefetch(const void* data, size_t bytes) const {
+  return valid() &&
+         AdvisePages(mmapped_buffer_, mmapped_buffer_size(), data, bytes,
+                     /*whole_pages_only=*/false, MADV_WILLNEED);
+}
+
+bool MMAPAllocation::ReleasePages(const void* data, size_t bytes) const {
+  return valid() &&
+         AdvisePages(mmapped_buffer_, mmapped_buffer_size(), data, bytes,
+                     /*whole_pages_only=*/true, MADV_DONTNEED);
+}
+
 bool MMAPAllocation::IsSupported() { return true; }
 
 }  // namespace tflite
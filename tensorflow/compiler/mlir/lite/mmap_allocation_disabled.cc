@@ -45,6 +45,14 @@ size_t MMAPAllocation::bytes() const { return 0; }
 
 bool MMAPAllocation::valid() const { return false; }
 
+bool MMAPAllocation::Prefetch(const void* data, size_t bytes) const {
+  return false;
+}
+
+bool MMAPAllocation::ReleasePages(const void* data, size_t bytes) const {
+  return false;
+}
+
 bool MMAPAllocation::IsSupported() { return false; }
 
 }  // namespace tflite
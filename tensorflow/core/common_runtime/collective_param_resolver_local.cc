@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,13 +63,27 @@ void CollectiveParamResolverLocal::CompleteGroupAsync(
 }
 
 namespace {
+// Returns true if a reduction over CPU devices should reduce within each
+// locality group (devices sharing a task and a NUMA node) before reducing
+// across groups, so that less data crosses socket and host boundaries. This
+// is only done when requested with the "hierarchical_ring" communication
+// hint, and falls back to a single ring if the groups are not uniform.
+bool UseHierarchicalRingReduce(const CollectiveParams* cp) {
+  return cp->instance.impl_details.communication_hint == "hierarchical_ring" &&
+         cp->group.device_type == DEVICE_CPU &&
+         collective_util::IsUniformLocalityHierarchy(
+             collective_util::LocalityGroups(cp->group));
+}
+
 const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   switch (cp->instance.type) {
     case BROADCAST_COLLECTIVE:
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      return UseHierarchicalRingReduce(cp) ? "HierarchicalRingReduce"
+                                           : "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
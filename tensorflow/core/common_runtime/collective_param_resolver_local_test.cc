@@ -28,8 +28,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/public/session_options.h"
@@ -77,6 +79,29 @@ class CollectiveParamResolverLocalTest : public ::testing::Test {
     EXPECT_EQ(actual_device_order, expected_device_order);
   }
 
+  // Returns the implementation the resolver picks for a CPU reduction over
+  // `num_devices_per_task[t]` devices of each task t.
+  string GetReductionName(const std::vector<int>& num_devices_per_task,
+                          const string& communication_hint) {
+    auto cp = core::RefCountPtr<CollectiveParams>(new CollectiveParams());
+    cp->group.device_type = DeviceType("CPU");
+    cp->group.num_tasks = num_devices_per_task.size();
+    for (int t = 0; t < num_devices_per_task.size(); ++t) {
+      for (int d = 0; d < num_devices_per_task[t]; ++d) {
+        CollGroupMember member;
+        member.task = strings::StrCat("/job:worker/replica:0/task:", t);
+        member.device.set_name(
+            strings::StrCat(member.task, "/device:CPU:", d));
+        cp->group.members.push_back(member);
+      }
+    }
+    cp->group.group_size = cp->group.members.size();
+    cp->instance.type = REDUCTION_COLLECTIVE;
+    cp->instance.impl_details.communication_hint = communication_hint;
+    prl_->AssignCollectiveType(cp.get());
+    return cp->instance.impl_details.collective_name;
+  }
+
   DeviceAttributes GetDeviceAttributes(const string& device_name) {
     Device* device = nullptr;
     TF_CHECK_OK(device_mgr_->LookupDevice(device_name, &device));
@@ -208,6 +233,22 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   }
 }
 
+TEST_F(CollectiveParamResolverLocalTest, HierarchicalRingReduceIsOptIn) {
+  EXPECT_EQ(GetReductionName({2, 2}, ""), "RingReduce");
+  EXPECT_EQ(GetReductionName({2, 2}, "ring"), "RingReduce");
+  EXPECT_EQ(GetReductionName({2, 2}, "hierarchical_ring"),
+            "HierarchicalRingReduce");
+}
+
+TEST_F(CollectiveParamResolverLocalTest,
+       HierarchicalRingReduceFallsBackToRingReduce) {
+  // A single locality group, groups of one device, and groups of different
+  // sizes are reduced on a single ring.
+  EXPECT_EQ(GetReductionName({4}, "hierarchical_ring"), "RingReduce");
+  EXPECT_EQ(GetReductionName({1, 1, 1}, "hierarchical_ring"), "RingReduce");
+  EXPECT_EQ(GetReductionName({2, 3}, "hierarchical_ring"), "RingReduce");
+}
+
 void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
                                             bool is_source,
                                             CollectiveParams* cp) {
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/collective_util.h"
 
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -83,6 +86,37 @@ string SubdivPermDebugString(const CollectiveParams& col_params) {
   return buf;
 }
 
+std::vector<std::vector<int>> LocalityGroups(const CollGroupParams& group) {
+  // Groups keyed by (task index, NUMA node), so that std::map orders them.
+  std::unordered_map<string, int> task_indices;
+  std::map<std::pair<int, int>, std::vector<int>> groups;
+  for (int di = 0; di < group.members.size(); ++di) {
+    const CollGroupMember& member = group.members[di];
+    const int task_idx =
+        task_indices
+            .emplace(member.task, static_cast<int>(task_indices.size()))
+            .first->second;
+    groups[{task_idx, member.device.locality().numa_node()}].push_back(di);
+  }
+  std::vector<std::vector<int>> locality_groups;
+  locality_groups.reserve(groups.size());
+  for (auto& it : groups) {
+    locality_groups.push_back(std::move(it.second));
+  }
+  return locality_groups;
+}
+
+bool IsUniformLocalityHierarchy(
+    const std::vector<std::vector<int>>& locality_groups) {
+  if (locality_groups.size() < 2 || locality_groups[0].size() < 2) {
+    return false;
+  }
+  for (const std::vector<int>& devs : locality_groups) {
+    if (devs.size() != locality_groups[0].size()) return false;
+  }
+  return true;
+}
+
 SubContext::SubContext(OpKernelContext* ctx, OpKernelContext::Params* params,
                        OpKernel* op, Tensor* output, Tensor* input)
     : sub_params_(*params),
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_UTIL_H_
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -33,6 +34,18 @@ absl::Status InitializeDeviceAndLocality(const DeviceMgr* dev_mgr,
                                          DeviceLocality* device_locality);
 string SubdivPermDebugString(const CollectiveParams& col_params);
 
+// Partitions the members of `group` into sets of devices that share both a
+// task and a NUMA node, and returns them as indices into `group.members`.
+// The sets are ordered by task, in order of first appearance, then by NUMA
+// node.
+std::vector<std::vector<int>> LocalityGroups(const CollGroupParams& group);
+
+// Returns true if an all-reduce over `locality_groups` benefits from being
+// done in two levels: there are at least two groups and all of them hold the
+// same number, at least two, of devices.
+bool IsUniformLocalityHierarchy(
+    const std::vector<std::vector<int>>& locality_groups);
+
 // Used for executing a sub-operation, e.g. a merge_op instance, with
 // an OpKernelContext based on the one passed into this Op.
 class SubContext {
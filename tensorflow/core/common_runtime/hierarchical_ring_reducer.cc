@@ -0,0 +1,423 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  // TODO(b/113171733): change CHECKs to return errors.
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalRingReduce");
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  // The subdiv offsets chosen here are shared by the rings within every
+  // locality group, and the permutations are used as is if the reduction
+  // falls back to a single ring.
+  return RingAlg::InitializeCollectiveParams(col_params);
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  TF_RETURN_IF_ERROR(RingAlg::InitializeCollectiveContext(col_ctx));
+  group_ctx_ = col_ctx_;
+  const CollectiveParams& group_params = *group_ctx_->col_params;
+  const std::vector<std::vector<int>> groups =
+      collective_util::LocalityGroups(group_params.group);
+  if (!collective_util::IsUniformLocalityHierarchy(groups)) {
+    VLOG(1) << "HierarchicalRingReducer for device " << col_ctx_->device_name
+            << " reduces with a single ring over " << groups.size()
+            << " non-uniform locality groups";
+    return absl::OkStatus();
+  }
+
+  int position = -1;
+  for (int gi = 0; gi < groups.size() && position < 0; ++gi) {
+    for (int di = 0; di < groups[gi].size(); ++di) {
+      if (groups[gi][di] == group_params.default_rank) {
+        group_idx_ = gi;
+        position = di;
+        break;
+      }
+    }
+  }
+  if (position < 0) {
+    return errors::Internal("Device ", col_ctx_->device_name,
+                            " is not in any locality group of collective ",
+                            group_params.name);
+  }
+
+  // The ring within this device's locality group. Every group has the same
+  // size and uses the same subdiv offsets, so devices at the same position
+  // have the same rank in each subdiv and own the same chunks.
+  const std::vector<int>& local_devs = groups[group_idx_];
+  local_params_.reset(new CollectiveParams());
+  local_params_->name = group_params.name;
+  local_params_->group.group_key = group_params.group.group_key;
+  local_params_->group.device_type = group_params.group.device_type;
+  local_params_->group.group_size = static_cast<int32>(local_devs.size());
+  local_params_->group.num_tasks = 1;
+  local_params_->group.same_num_devices_per_task = true;
+  for (int di : local_devs) {
+    local_params_->group.members.push_back(group_params.group.members[di]);
+  }
+  local_params_->group
+      .num_devices_per_task[local_params_->group.members[0].task] =
+      local_params_->group.group_size;
+  local_params_->instance = group_params.instance;
+  local_params_->instance.impl_details.subdiv_permutations.clear();
+  local_params_->default_rank = position;
+  local_params_->merge_op = group_params.merge_op;
+  local_params_->final_op = group_params.final_op;
+  TF_RETURN_IF_ERROR(RingAlg::InitializeCollectiveParams(local_params_.get()));
+
+  for (const std::vector<int>& devs : groups) {
+    cross_group_members_.push_back(group_params.group.members[devs[position]]);
+  }
+
+  // Buffers of the local rings are keyed by group, since the rings of
+  // several groups may share a task.
+  col_ctx_ = std::make_shared<CollectiveContext>(
+      group_ctx_->col_exec, group_ctx_->nccl_communicator, group_ctx_->dev_mgr,
+      group_ctx_->op_ctx, group_ctx_->op_params, local_params_.get(),
+      strings::StrCat(group_ctx_->exec_key, ":local", group_idx_),
+      group_ctx_->step_id, group_ctx_->input, group_ctx_->output);
+  col_ctx_->device = group_ctx_->device;
+  col_ctx_->device_locality = group_ctx_->device_locality;
+  col_params_ = local_params_.get();
+  return absl::OkStatus();
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalRingReducer` doesn't require non-overlapping
+  // collectives, unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*group_ctx_->col_params);
+
+  done_ = std::move(done);
+  group_size_ = col_params_->group.group_size;
+  num_subdivs_ = static_cast<int>(
+      col_params_->instance.impl_details.subdiv_permutations.size());
+  CHECK_GT(num_subdivs_, 0);
+
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " locality group " << group_idx_
+          << " of size " << group_size_ << ", "
+          << cross_group_members_.size() << " locality groups\n"
+          << collective_util::SubdivPermDebugString(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    // We are running in a blockable thread and the callback can't block so
+    // just wait here on the copy.
+    Notification note;
+    Status status;
+    tsl::profiler::TraceMe activity("MemCpyAsync",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done_(status);
+      return;
+    }
+  }
+  ContinueAfterInputCopy();
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+void HierarchicalRingReducer::ContinueAfterInputCopy() {
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, group_size_ * num_subdivs_,
+                                  col_ctx_->device->GetAllocator(attr)));
+  if (col_params_->final_op) {
+    // The final op divides by the size of the whole group, not of the ring
+    // within the locality group. Only CPU devices are supported, so the
+    // scalar can be used as is.
+    group_size_tensor_ = ca_->Scalar(group_ctx_->col_params->group.group_size);
+  }
+  Finish(RunAsyncParts());
+}
+
+void HierarchicalRingReducer::InitRingField(RingField* rf, int chunk_idx,
+                                            int subdiv_idx, int field_idx) {
+  RingAlg::InitRingField(rf, chunk_idx, subdiv_idx, field_idx);
+  if (rf->do_recv) {
+    rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
+  }
+}
+
+void HierarchicalRingReducer::DispatchCrossGroupReduce(
+    RingField* rf, const StatusCallback& done) {
+  if (cross_group_members_.empty() || ca_->ChunkBytes(rf->sc_idx) == 0) {
+    done(absl::OkStatus());
+    return;
+  }
+  const CollectiveParams& group_params = *group_ctx_->col_params;
+  core::RefCountPtr<CollectiveParams> cross_params(new CollectiveParams());
+  cross_params->name = group_params.name;
+  cross_params->group.group_key = group_params.group.group_key;
+  cross_params->group.device_type = group_params.group.device_type;
+  cross_params->group.group_size =
+      static_cast<int32>(cross_group_members_.size());
+  cross_params->group.members = cross_group_members_;
+  for (const CollGroupMember& member : cross_group_members_) {
+    ++cross_params->group.num_devices_per_task[member.task];
+  }
+  cross_params->group.num_tasks =
+      static_cast<int32>(cross_params->group.num_devices_per_task.size());
+  cross_params->instance = group_params.instance;
+  cross_params->instance.shape = rf->chunk.shape();
+  cross_params->instance.impl_details.collective_name = "RingReduce";
+  cross_params->instance.impl_details.subdiv_offsets.clear();
+  cross_params->instance.impl_details.subdiv_permutations.clear();
+  cross_params->default_rank = group_idx_;
+  // The final op is applied by the caller once the chunk holds the sum over
+  // the whole group.
+  cross_params->merge_op = group_params.merge_op;
+
+  core::RefCountPtr<RingReducer> reducer(new RingReducer());
+  Status s = reducer->InitializeCollectiveParams(cross_params.get());
+  if (s.ok()) {
+    // Each chunk is reduced by a ring of its own, so its buffers are keyed by
+    // the chunk.
+    auto cross_ctx = std::make_shared<CollectiveContext>(
+        group_ctx_->col_exec, group_ctx_->nccl_communicator,
+        group_ctx_->dev_mgr, group_ctx_->op_ctx, group_ctx_->op_params,
+        cross_params.get(),
+        strings::StrCat(group_ctx_->exec_key, ":cross", rf->sc_idx),
+        group_ctx_->step_id, &rf->chunk, &rf->chunk);
+    s = reducer->InitializeCollectiveContext(cross_ctx);
+  }
+  if (!s.ok()) {
+    reducer->group_size_tensor_ready_.Notify();  // To unblock destructor.
+    done(s);
+    return;
+  }
+  // The reduction blocks until the chunk has been through the whole ring, so
+  // it runs on its own thread.
+  RingReducer* cross_reducer = reducer.release();
+  group_ctx_->col_exec->RunClosure([cross_reducer, done] {
+    cross_reducer->RunReduction(done);
+    cross_reducer->Unref();
+  });
+}
+
+bool HierarchicalRingReducer::RunAsyncParts() {
+  // This function orchestrates the reduction on behalf of a single device, as
+  // in RingReducer::RunAsyncParts. The first pass of the local ring is a
+  // reduce-scatter, whose final fields are reduced across locality groups
+  // before they start the second pass, the local all-gather.
+  rfv_.clear();
+  rfv_.resize(group_size_ * num_subdivs_);
+  PCQueue ready_queue;
+  for (int chunk_idx = 0; chunk_idx < group_size_; ++chunk_idx) {
+    for (int subdiv_idx = 0; subdiv_idx < num_subdivs_; ++subdiv_idx) {
+      int rf_index = (chunk_idx * num_subdivs_) + subdiv_idx;
+      InitRingField(&rfv_[rf_index], chunk_idx, subdiv_idx, rf_index);
+      ready_queue.Enqueue(&rfv_[rf_index]);
+    }
+  }
+
+  int field_done_count = 0;
+  int send_pending_count = 0;
+  int recv_pending_count = 0;
+  int cross_pending_count = 0;
+  std::atomic<bool> aborted(false);
+  auto requeue = [this, &ready_queue, &aborted](RingField* rf) {
+    return [this, rf, &ready_queue, &aborted](Status s) {
+      if (!s.ok()) {
+        aborted = true;
+        StartAbort(s);
+      }
+      ready_queue.Enqueue(rf);
+    };
+  };
+
+  {
+    tsl::profiler::TraceMe activity("Loop", tsl::profiler::TraceMeLevel::kInfo);
+    // Loop until all RingFields have advanced to completion.
+    while (field_done_count < rfv_.size()) {
+      VLOG(4) << FieldState();
+      // Wait for a RingField to appear in the ready_queue.
+      RingField* rf = ready_queue.Dequeue();
+      // Advance the RingField to its next action and execute, repeating
+      // until either an async action has been started or the RingField
+      // is done.
+      bool dispatched = false;  // true if async action was initiated
+      do {
+        if (aborted) {
+          // Requeue this RingField to be counted off below.
+          ready_queue.Enqueue(rf);
+          break;
+        }
+        switch (rf->action) {
+          case RF_INIT:
+            if (rf->do_recv) {
+              rf->action = RF_RECV;
+              DispatchRecv(rf, requeue(rf));
+              dispatched = true;
+              ++recv_pending_count;
+            } else {
+              rf->action = rf->second_pass ? RF_SEND_READY : RF_REDUCE;
+            }
+            break;
+          case RF_RECV:
+            CHECK_GT(recv_pending_count, 0);
+            --recv_pending_count;
+            if (!rf->second_pass) {
+              rf->action = RF_REDUCE;
+              Status s = collective_util::ComputeBinOp(
+                  col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+                  col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
+              if (!s.ok()) {
+                aborted = true;
+                StartAbort(s);
+              }
+            } else {
+              rf->action = RF_SEND_READY;
+            }
+            break;
+          case RF_REDUCE:
+            // The local reduction is done. The final field of the first pass
+            // now holds the sum over this locality group.
+            if (!rf->second_pass && rf->is_final) {
+              rf->action = RF_FINALIZE;
+              DispatchCrossGroupReduce(rf, requeue(rf));
+              dispatched = true;
+              ++cross_pending_count;
+            } else {
+              rf->action = RF_SEND_READY;
+            }
+            break;
+          case RF_FINALIZE:
+            CHECK_GT(cross_pending_count, 0);
+            --cross_pending_count;
+            rf->action = RF_DONE;
+            if (col_params_->final_op && ca_->ChunkBytes(rf->sc_idx) > 0) {
+              Status s = collective_util::ComputeBinOp(
+                  col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+                  col_params_->final_op, &rf->chunk, &group_size_tensor_);
+              if (!s.ok()) {
+                aborted = true;
+                StartAbort(s);
+              }
+            }
+            break;
+          case RF_SEND_READY:
+            if (rf->do_send) {
+              rf->action = RF_SEND;
+              DispatchSend(rf, requeue(rf));
+              dispatched = true;
+              ++send_pending_count;
+            } else {
+              rf->action = RF_DONE;
+            }
+            break;
+          case RF_SEND:
+            CHECK_GT(send_pending_count, 0);
+            --send_pending_count;
+            rf->action = RF_DONE;
+            break;
+          case RF_DONE:
+            break;
+        }
+        if (rf->action == RF_DONE) {
+          if (rf->second_pass) {
+            ++field_done_count;
+            break;  // from do while(!dispatched)
+          } else {
+            AdvanceToSecondPass(rf);
+          }
+        }
+      } while (!dispatched);
+      if (aborted) break;
+    }  // while (field_done_count < number of fields)
+
+    if (aborted) {
+      // All of the pending data actions should be aborted; field the
+      // callbacks and clear the queue before quitting.
+      while ((send_pending_count > 0) || (recv_pending_count > 0) ||
+             (cross_pending_count > 0)) {
+        RingField* rf = ready_queue.Dequeue();
+        switch (rf->action) {
+          case RF_RECV:
+            --recv_pending_count;
+            break;
+          case RF_SEND:
+            --send_pending_count;
+            break;
+          case RF_FINALIZE:
+            --cross_pending_count;
+            break;
+          default: {
+          }  // Ignore any other actions
+        }
+      }
+    }
+  }
+
+  CHECK_EQ(send_pending_count, 0);
+  CHECK_EQ(recv_pending_count, 0);
+  CHECK_EQ(cross_pending_count, 0);
+
+  VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
+          << " final value " << TensorDebugString(ca_->Value());
+  return !aborted;
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/ring_alg.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/platform/refcount.h"
+
+namespace tensorflow {
+
+// Two-level ring implementation of collective all-reduce for CPU devices.
+//
+// The group is partitioned into locality groups, the devices which share a
+// task and a NUMA node (see collective_util::LocalityGroups). The reduction
+// runs as:
+//   1. a reduce-scatter on a ring within each locality group, after which
+//      every device holds the group-local sum of its own chunks;
+//   2. for each of those chunks, an all-reduce on a ring over the devices at
+//      the same position in every locality group, i.e. across sockets and
+//      hosts;
+//   3. an all-gather on the ring within each locality group.
+// Each chunk moves on to the cross-group ring as soon as its local reduction
+// completes, and on to the local all-gather as soon as its cross-group
+// reduction completes, so the phases are pipelined chunk by chunk.
+//
+// Only 1/L of the tensor crosses a socket or host boundary from each device,
+// where L is the size of a locality group. If the locality groups are not all
+// the same size, or there is a single one, the reduction falls back to a
+// single ring over the whole group.
+//
+// The param resolver only picks this implementation for reductions whose
+// communication hint is "hierarchical_ring"; all others use RingReducer.
+class HierarchicalRingReducer : public RingAlg {
+ public:
+  HierarchicalRingReducer()
+      : RingAlg(REDUCTION_COLLECTIVE, "HierarchicalReduce") {}
+  ~HierarchicalRingReducer() override {}
+
+  // Begins async execution of the hierarchical ring reduce algorithm.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Also sets up the ring within this device's locality group, and the
+  // devices of the ring across locality groups.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+ protected:
+  void InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
+                     int field_idx) override;
+
+ private:
+  void ContinueAfterInputCopy();
+  bool RunAsyncParts();
+
+  // Starts an all-reduce of `rf->chunk` with the devices at the same position
+  // in the other locality groups, and calls `done` when it completes.
+  void DispatchCrossGroupReduce(RingField* rf, const StatusCallback& done);
+
+  // The context of the whole group. When the reduction is hierarchical,
+  // `col_ctx_` and `col_params_` describe the ring within this device's
+  // locality group instead.
+  std::shared_ptr<CollectiveContext> group_ctx_;
+  core::RefCountPtr<CollectiveParams> local_params_;
+  // The devices at this device's position in every locality group, in group
+  // order. Empty if the reduction is not hierarchical.
+  std::vector<CollGroupMember> cross_group_members_;
+  // Index of this device's locality group.
+  int group_idx_ = 0;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -0,0 +1,248 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    const DeviceType& device_type,
+                                    DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  // Places the devices of each worker on `num_numa_nodes` NUMA nodes, in
+  // contiguous blocks.
+  void Init(int num_workers, int num_devices, int num_numa_nodes,
+            DataType dtype, const TensorShape& shape, int num_subdivs,
+            int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    for (int wi = 0; wi < num_workers; ++wi) {
+      for (int di = 0; di < num_devices; ++di) {
+        int rank = wi * num_devices + di;
+        instances_.push_back(std::make_unique<DeviceInstance>(
+            rank, num_numa_nodes, num_subdivs, dtype, shape, test_env_.get()));
+      }
+    }
+  }
+
+  void Reduce(int fail_after) {
+    std::atomic<int> done(0);
+    for (auto& di : instances_) {
+      SchedClosure([&di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+      if (fail_after > 0) {
+        // Stagger the op execution starts.
+        Env::Default()->SleepForMicroseconds(100);
+      }
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int num_numa_nodes, int num_subdivs, int tensor_len,
+               int fail_after) {
+    Init(num_workers, num_devices, num_numa_nodes, dtype,
+         TensorShape({tensor_len}), num_subdivs, fail_after);
+    std::vector<T> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (size_t i = 0; i < t->NumElements(); ++i) {
+          T value = static_cast<T>(di * 10 + i);
+          t->flat<T>()(i) = value;
+          expected[i] += value;
+        }
+      });
+    }
+    Reduce(fail_after);
+    if (fail_after > 0) {
+      // Confirm that every device terminated with the expected error status.
+      for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+        EXPECT_NE(instances_[di]->status_.message().find("Deliberate failure"),
+                  string::npos);
+      }
+    } else {
+      // Confirm that every device computed the same correct reduction value.
+      for (int i = 0; i < tensor_len; ++i) {
+        expected[i] /= static_cast<T>(num_workers * num_devices);
+      }
+      for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+        TF_EXPECT_OK(instances_[di]->status_);
+        test::ExpectTensorEqual<T>(test::AsTensor<T>(expected),
+                                   instances_[di]->tensor());
+      }
+    }
+  }
+
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, int num_numa_nodes, int num_subdivs,
+                   DataType dtype, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalRingReduce",
+                                 REDUCTION_COLLECTIVE, dtype, shape);
+      const int num_devices = test_env_->num_devices_per_worker;
+      for (int mi = 0; mi < col_params_->group.members.size(); ++mi) {
+        col_params_->group.members[mi].device.mutable_locality()->set_numa_node(
+            (mi % num_devices) * num_numa_nodes / num_devices);
+      }
+      if (num_subdivs > 0) {
+        col_params_->instance.impl_details.subdiv_offsets =
+            GenerateEvenSubdivOffsets(num_devices, num_subdivs);
+      }
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_))
+          << "Couldn't find device " << dev_name
+          << " existing devices: " << test_env_->device_mgr->DebugString();
+      merge_op_ = GetKernel("Add", dtype, DEVICE_CPU, device_);
+      final_op_ = GetKernel("Div", dtype, DEVICE_CPU, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void InitTensor(const std::function<void(Tensor*)>& init_f) {
+      init_f(&tensor_);
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    const Tensor& tensor() { return tensor_; }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST(LocalityGroupsTest, GroupsByTaskAndNumaNode) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/2,
+                                          /*num_devices_per_worker=*/4,
+                                          DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+  EXPECT_EQ(collective_util::LocalityGroups(cp->group),
+            (std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}}));
+  EXPECT_TRUE(collective_util::IsUniformLocalityHierarchy(
+      collective_util::LocalityGroups(cp->group)));
+
+  // Interleave the devices of each worker over two NUMA nodes.
+  for (int mi = 0; mi < cp->group.members.size(); ++mi) {
+    cp->group.members[mi].device.mutable_locality()->set_numa_node(1 - mi % 2);
+  }
+  EXPECT_EQ(
+      collective_util::LocalityGroups(cp->group),
+      (std::vector<std::vector<int>>{{1, 3}, {0, 2}, {5, 7}, {4, 6}}));
+
+  // Groups of different sizes are not reduced hierarchically.
+  cp->group.members[0].device.mutable_locality()->set_numa_node(0);
+  EXPECT_FALSE(collective_util::IsUniformLocalityHierarchy(
+      collective_util::LocalityGroups(cp->group)));
+}
+
+#define DEF_TEST(B, T, W, D, N, S, L, A)                                     \
+  TEST_F(HierarchicalRingReducerTest,                                        \
+         DaTy##B##_Wkr##W##_Dev##D##_Numa##N##_Sdiv##S##_Len##L##_Abrt##A) { \
+    DataType dtype = DT_##B;                                                 \
+    RunTest<T>(dtype, W, D, N, S, L, A);                                     \
+  }
+
+// Test all-reduce on CPU only.
+// B = data element type
+// T = C++ type of data elements
+// W = number of workers
+// D = number of devices per worker
+// N = number of NUMA nodes per worker
+// S = number of subdivisions, 0 for the default
+// L = tensor length
+// A = abort after count
+// Two hosts with one socket each.
+DEF_TEST(FLOAT, float, 2, 4, 1, 1, 1, 0)
+DEF_TEST(FLOAT, float, 2, 4, 1, 1, 1001, 0)
+DEF_TEST(FLOAT, float, 2, 4, 1, 2, 1001, 0)
+DEF_TEST(INT32, int32, 2, 4, 1, 2, 4096, 0)
+DEF_TEST(INT64, int64_t, 3, 2, 1, 1, 127, 0)
+// One host with two sockets.
+DEF_TEST(FLOAT, float, 1, 4, 2, 1, 1001, 0)
+DEF_TEST(INT32, int32, 1, 8, 2, 2, 1001, 0)
+// Two hosts with two sockets each.
+DEF_TEST(FLOAT, float, 2, 4, 2, 1, 1001, 0)
+DEF_TEST(DOUBLE, double, 2, 8, 2, 2, 8192, 0)
+// Locality groups of a single device fall back to a single ring.
+DEF_TEST(FLOAT, float, 4, 1, 1, 1, 1001, 0)
+DEF_TEST(FLOAT, float, 1, 4, 4, 1, 1001, 0)
+// Locality groups of different sizes fall back to a single ring.
+DEF_TEST(FLOAT, float, 1, 3, 2, 1, 1001, 0)
+// Failure cases.
+DEF_TEST(FLOAT, float, 2, 4, 1, 1, 1001, 5)
+DEF_TEST(FLOAT, float, 2, 4, 2, 2, 1001, 30)
+
+}  // namespace
+}  // namespace tensorflow
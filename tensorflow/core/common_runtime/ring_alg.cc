@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <utility>
@@ -186,23 +187,31 @@ Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
   // depend on that being the case so we'll compute something that
   // works in any case.
 
-  // Start by counting the devices in each task.
+  // Start by collecting the devices in each task.
   // Precondition: device_names must be sorted so that all devices in
   // the same task are adjacent.
-  std::vector<int> dev_per_task;
+  std::vector<std::vector<int>> task_devs(1);
   const string* prior_task_name = &col_params->group.members[0].task;
-  int dev_count = 1;
+  task_devs.back().push_back(0);
   for (int di = 1; di < col_params->group.group_size; ++di) {
     if (col_params->group.members[di].task != *prior_task_name) {
-      dev_per_task.push_back(dev_count);
-      dev_count = 1;
+      task_devs.emplace_back();
       prior_task_name = &col_params->group.members[di].task;
-    } else {
-      ++dev_count;
     }
+    task_devs.back().push_back(di);
+  }
+  DCHECK_EQ(col_params->group.num_tasks, task_devs.size());
+
+  // Within a task, keep the devices of the same NUMA node adjacent so that
+  // the ring crosses each socket boundary of a host as few times as possible.
+  // Devices without locality information all compare equal and keep their
+  // original order.
+  for (std::vector<int>& devs : task_devs) {
+    std::stable_sort(devs.begin(), devs.end(), [col_params](int a, int b) {
+      return col_params->group.members[a].device.locality().numa_node() <
+             col_params->group.members[b].device.locality().numa_node();
+    });
   }
-  dev_per_task.push_back(dev_count);
-  DCHECK_EQ(col_params->group.num_tasks, dev_per_task.size());
 
   if (col_params->instance.impl_details.subdiv_offsets.empty()) {
     TF_RETURN_IF_ERROR(GenerateSubdivsInCollectiveParams(col_params));
@@ -230,14 +239,13 @@ Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
       offset = abs(offset);
       reverse = true;
     }
-    int prior_dev_count = 0;  // sum over prior worker device counts
     for (int ti = 0; ti < col_params->group.num_tasks; ++ti) {
-      for (int di = 0; di < dev_per_task[ti]; ++di) {
-        int di_offset = (di + offset) % dev_per_task[ti];
-        int offset_di =
-            reverse ? (dev_per_task[ti] - (di_offset + 1)) : di_offset;
+      const int num_task_devs = static_cast<int>(task_devs[ti].size());
+      for (int di = 0; di < num_task_devs; ++di) {
+        int di_offset = (di + offset) % num_task_devs;
+        int offset_di = reverse ? (num_task_devs - (di_offset + 1)) : di_offset;
         // Device index in global subdivision permutation.
-        int permuted_di = prior_dev_count + offset_di;
+        int permuted_di = task_devs[ti][offset_di];
         int rank = static_cast<int>(perm.size());
         perm.push_back(permuted_di);
         if (col_params->group.members[permuted_di].device.name() ==
@@ -246,7 +254,6 @@ Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
           col_params->subdiv_rank[sdi] = rank;
         }
       }
-      prior_dev_count += dev_per_task[ti];
     }
     DCHECK_EQ(col_params->group.group_size, perm.size());
   }
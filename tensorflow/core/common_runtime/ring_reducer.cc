@@ -58,7 +58,10 @@ void RingReducer::Run(StatusCallback done) {
   // Since `RingReducer` doesn't require non-overlapping collectives, unblock
   // any collective that is blocked on this instance.
   col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  RunReduction(std::move(done));
+}
 
+void RingReducer::RunReduction(StatusCallback done) {
   done_ = std::move(done);
   group_size_ = col_params_->group.group_size;
   num_subdivs_ = static_cast<int>(
@@ -46,12 +46,18 @@ class RingReducer : public RingAlg {
                      int field_idx) override;
 
  private:
+  // Runs the all-reduce without unblocking the collectives that depend on
+  // this instance. Used by HierarchicalRingReducer, which runs a RingReducer
+  // for each chunk it reduces across locality groups. Must be called in a
+  // blockable thread.
+  void RunReduction(StatusCallback done);
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
 
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
 
+  friend class HierarchicalRingReducer;
   friend class RingReducerTest;
   friend class RingReducerInitParamsTest;
 };
@@ -257,6 +257,26 @@ TEST_F(RingReducerInitParamsTest, SpecifiedSubdivs) {
                      {0, 1});
 }
 
+TEST_F(RingReducerInitParamsTest, NumaAwareSubdivs) {
+  const int kNumDevsPerWorker = 4;
+  const int kNumWorkers = 2;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+  // Alternate the devices of each worker between two NUMA nodes.
+  for (int di = 0; di < cp->group.members.size(); ++di) {
+    cp->group.members[di].device.mutable_locality()->set_numa_node(di % 2);
+  }
+
+  cp->default_rank = 0;
+  cp->instance.impl_details.subdiv_offsets = {0, -1};
+  RunSubdivPermsTest(cp.get(),
+                     {{0, 2, 1, 3, 4, 6, 5, 7}, {1, 2, 0, 3, 5, 6, 4, 7}},
+                     {0, 2});
+}
+
 TEST_F(RingReducerInitParamsTest, AutomaticSubdivs) {
   const int kNumDevsPerWorker = 8;
   const int kNumWorkers = 3;
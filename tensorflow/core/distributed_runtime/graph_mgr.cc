@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 
+#include <atomic>
 #include <chrono>  // NOLINT(build/c++11)
+#include <map>
 #include <memory>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/common_runtime/build_graph_options.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -117,6 +120,124 @@ static Status ValidateGraphDefForDevices(const GraphDef& gdef) {
   return absl::OkStatus();
 }
 
+// Assigns every Send/Recv pair whose two ends are both in "partition_graphs"
+// a fixed slot in the step rendezvous, so that the pair can be matched
+// without hashing its rendezvous key. Pairs with a remote or client end keep
+// using the hashed rendezvous table.
+void AssignStaticRendezvousSlots(
+    std::unordered_map<string, std::unique_ptr<Graph>>* partition_graphs) {
+  // Table ids only need to be unique within the process, because that is
+  // the scope in which a step rendezvous can be shared between graphs.
+  static std::atomic<int64_t> next_table_id{1};
+
+  struct PairEnds {
+    Node* send = nullptr;
+    Node* recv = nullptr;
+    bool ambiguous = false;
+  };
+  // Ordered so that slot numbers are deterministic.
+  std::map<string, PairEnds> pairs;
+  for (auto& p : *partition_graphs) {
+    for (Node* n : p.second->op_nodes()) {
+      if (!n->IsSend() && !n->IsRecv()) continue;
+      bool flag = false;
+      if ((TryGetNodeAttr(n->attrs(), "client_terminated", &flag) && flag) ||
+          (TryGetNodeAttr(n->attrs(), "_hostmem_sendrecv", &flag) && flag)) {
+        continue;
+      }
+      string send_device;
+      string recv_device;
+      string tensor_name;
+      int64_t send_device_incarnation;
+      if (!TryGetNodeAttr(n->attrs(), "send_device", &send_device) ||
+          !TryGetNodeAttr(n->attrs(), "recv_device", &recv_device) ||
+          !TryGetNodeAttr(n->attrs(), "tensor_name", &tensor_name) ||
+          !TryGetNodeAttr(n->attrs(), "send_device_incarnation",
+                          &send_device_incarnation)) {
+        continue;
+      }
+      PairEnds& ends = pairs[strings::StrCat(send_device, ";",
+                                             send_device_incarnation, ";",
+                                             recv_device, ";", tensor_name)];
+      Node*& end = n->IsSend() ? ends.send : ends.recv;
+      if (end != nullptr) ends.ambiguous = true;
+      end = n;
+    }
+  }
+
+  int64_t num_slots = 0;
+  for (const auto& p : pairs) {
+    const PairEnds& ends = p.second;
+    if (ends.send != nullptr && ends.recv != nullptr && !ends.ambiguous) {
+      ++num_slots;
+    }
+  }
+  if (num_slots == 0) return;
+
+  const int64_t table_id = next_table_id.fetch_add(1);
+  int64_t slot = 0;
+  for (const auto& p : pairs) {
+    const PairEnds& ends = p.second;
+    if (ends.send == nullptr || ends.recv == nullptr || ends.ambiguous) {
+      continue;
+    }
+    for (Node* n : {ends.send, ends.recv}) {
+      n->AddAttr(kStaticRendezvousTableAttr, table_id);
+      n->AddAttr(kStaticRendezvousNumSlotsAttr, num_slots);
+      n->AddAttr(kStaticRendezvousSlotAttr, slot);
+    }
+    ++slot;
+  }
+  VLOG(1) << "Assigned " << num_slots << " static rendezvous slots (table "
+          << table_id << ")";
+}
+
+// Returns the name of the node that produces the tensor of a Send/Recv pair
+// added by graph partitioning, whose tensor name is "edge_<id>_<node name>".
+static StringPiece ProducerOfEdge(StringPiece tensor_name) {
+  if (!absl::ConsumePrefix(&tensor_name, "edge_")) return StringPiece();
+  const size_t pos = tensor_name.find('_');
+  if (pos == StringPiece::npos) return StringPiece();
+  return tensor_name.substr(pos + 1);
+}
+
+// Records on each _Recv node whose sender lives in another task the wire
+// codec that "compression" selects for its edge, so that the RPC rendezvous
+// requests it from the sending worker.
+static void AssignRecvWireCodecs(
+    const TensorTransferCompression& compression,
+    std::unordered_map<string, std::unique_ptr<Graph>>* partition_graphs) {
+  int num_assigned = 0;
+  for (auto& p : *partition_graphs) {
+    for (Node* n : p.second->op_nodes()) {
+      if (n->type_string() != "_Recv") continue;
+      bool client_terminated = false;
+      string send_device;
+      string recv_device;
+      string tensor_name;
+      if ((TryGetNodeAttr(n->attrs(), "client_terminated",
+                          &client_terminated) &&
+           client_terminated) ||
+          !TryGetNodeAttr(n->attrs(), "send_device", &send_device) ||
+          !TryGetNodeAttr(n->attrs(), "recv_device", &recv_device) ||
+          !TryGetNodeAttr(n->attrs(), "tensor_name", &tensor_name) ||
+          DeviceNameUtils::IsSameAddressSpace(send_device, recv_device)) {
+        continue;
+      }
+      TensorTransferCompression::Codec codec = compression.default_codec();
+      const auto it = compression.edge_codecs().find(
+          string(ProducerOfEdge(tensor_name)));
+      if (it != compression.edge_codecs().end()) {
+        codec = static_cast<TensorTransferCompression::Codec>(it->second);
+      }
+      if (codec == TensorTransferCompression::NONE) continue;
+      n->AddAttr(kRecvWireCodecAttr, static_cast<int64_t>(codec));
+      ++num_assigned;
+    }
+  }
+  VLOG(1) << "Assigned wire codecs to " << num_assigned << " _Recv nodes";
+}
+
 Status GraphMgr::DecorateAndPublishGraphForDebug(
     const DebugOptions& debug_options, Graph* graph, Device* device) {
   std::unique_ptr<DebugGraphDecoratorInterface> decorator;
@@ -221,6 +342,15 @@ Status GraphMgr::InitItem(const string& handle, const GraphDef& gdef,
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
 
+  if (config_proto.experimental().enable_static_rendezvous_slots()) {
+    AssignStaticRendezvousSlots(&partition_graphs);
+  }
+  if (config_proto.experimental().has_tensor_transfer_compression()) {
+    AssignRecvWireCodecs(
+        config_proto.experimental().tensor_transfer_compression(),
+        &partition_graphs);
+  }
+
   LocalExecutorParams params;
 
   item->units.reserve(partitions.size());
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -46,6 +47,7 @@ class CoordinationServiceAgent;
 namespace tensorflow {
 
 class ExecutorOpts;
+class Graph;
 class StepStatsCollector;
 class RendezvousMgrInterface;
 class DeviceMgr;
@@ -203,6 +205,11 @@ class GraphMgr {
   void operator=(const GraphMgr&) = delete;
 };
 
+// Assigns every Send/Recv pair whose two ends are both in "partition_graphs"
+// a fixed slot in the step rendezvous. Exposed for testing.
+void AssignStaticRendezvousSlots(
+    std::unordered_map<string, std::unique_ptr<Graph>>* partition_graphs);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_mgr.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpu0[] = "/job:a/replica:0/task:0/device:CPU:0";
+constexpr char kCpu1[] = "/job:a/replica:0/task:0/device:CPU:1";
+
+class AssignStaticRendezvousSlotsTest : public ::testing::Test {
+ protected:
+  Graph* AddGraph(const string& device) {
+    auto graph = std::make_unique<Graph>(OpRegistry::Global());
+    Graph* g = graph.get();
+    graphs_[device] = std::move(graph);
+    return g;
+  }
+
+  Node* AddSend(Graph* g, const string& tensor, const string& receiver) {
+    Node* input = test::graph::Constant(g, Tensor(1.0f));
+    return test::graph::Send(g, input, tensor, kCpu0, 1, receiver);
+  }
+
+  Node* AddRecv(Graph* g, const string& tensor) {
+    return test::graph::Recv(g, tensor, "float", kCpu0, 1, kCpu1);
+  }
+
+  std::unordered_map<string, std::unique_ptr<Graph>> graphs_;
+};
+
+// Returns the static slot of "n", or -1 if it has none.
+int64_t SlotOf(const Node* n) {
+  int64_t slot = -1;
+  TryGetNodeAttr(n->attrs(), kStaticRendezvousSlotAttr, &slot);
+  return slot;
+}
+
+TEST_F(AssignStaticRendezvousSlotsTest, AssignsSlotsToLocalPairs) {
+  Graph* g0 = AddGraph(kCpu0);
+  Graph* g1 = AddGraph(kCpu1);
+  Node* send_a = AddSend(g0, "a", kCpu1);
+  Node* send_b = AddSend(g0, "b", kCpu1);
+  Node* recv_a = AddRecv(g1, "a");
+  Node* recv_b = AddRecv(g1, "b");
+
+  AssignStaticRendezvousSlots(&graphs_);
+
+  // Slots are assigned in key order, and both ends of a pair agree.
+  EXPECT_EQ(SlotOf(send_a), 0);
+  EXPECT_EQ(SlotOf(recv_a), 0);
+  EXPECT_EQ(SlotOf(send_b), 1);
+  EXPECT_EQ(SlotOf(recv_b), 1);
+
+  int64_t send_table_id = 0;
+  int64_t recv_table_id = 0;
+  int64_t num_slots = 0;
+  TF_ASSERT_OK(
+      GetNodeAttr(send_a->attrs(), kStaticRendezvousTableAttr, &send_table_id));
+  TF_ASSERT_OK(
+      GetNodeAttr(recv_b->attrs(), kStaticRendezvousTableAttr, &recv_table_id));
+  TF_ASSERT_OK(
+      GetNodeAttr(send_b->attrs(), kStaticRendezvousNumSlotsAttr, &num_slots));
+  EXPECT_GT(send_table_id, 0);
+  EXPECT_EQ(send_table_id, recv_table_id);
+  EXPECT_EQ(num_slots, 2);
+}
+
+TEST_F(AssignStaticRendezvousSlotsTest, UsesNewTableForEachRegistration) {
+  Node* send = AddSend(AddGraph(kCpu0), "a", kCpu1);
+  AddRecv(AddGraph(kCpu1), "a");
+  AssignStaticRendezvousSlots(&graphs_);
+
+  std::unordered_map<string, std::unique_ptr<Graph>> other_graphs;
+  other_graphs.swap(graphs_);
+  Node* other_send = AddSend(AddGraph(kCpu0), "a", kCpu1);
+  AddRecv(AddGraph(kCpu1), "a");
+  AssignStaticRendezvousSlots(&graphs_);
+
+  int64_t table_id = 0;
+  int64_t other_table_id = 0;
+  TF_ASSERT_OK(
+      GetNodeAttr(send->attrs(), kStaticRendezvousTableAttr, &table_id));
+  TF_ASSERT_OK(GetNodeAttr(other_send->attrs(), kStaticRendezvousTableAttr,
+                           &other_table_id));
+  EXPECT_NE(table_id, other_table_id);
+}
+
+TEST_F(AssignStaticRendezvousSlotsTest, SkipsUnmatchedEnds) {
+  Graph* g0 = AddGraph(kCpu0);
+  Graph* g1 = AddGraph(kCpu1);
+  // The receiver of "remote" is in another worker.
+  Node* remote_send = AddSend(g0, "remote", "/job:b/replica:0/task:0/cpu:0");
+  // The sender of "orphan" is in another worker.
+  Node* orphan_recv = AddRecv(g1, "orphan");
+
+  AssignStaticRendezvousSlots(&graphs_);
+
+  EXPECT_EQ(SlotOf(remote_send), -1);
+  EXPECT_EQ(SlotOf(orphan_recv), -1);
+}
+
+TEST_F(AssignStaticRendezvousSlotsTest, SkipsAmbiguousPairs) {
+  Graph* g0 = AddGraph(kCpu0);
+  Graph* g1 = AddGraph(kCpu1);
+  Node* send = AddSend(g0, "a", kCpu1);
+  Node* recv = AddRecv(g1, "a");
+  Node* other_recv = AddRecv(g1, "a");
+
+  AssignStaticRendezvousSlots(&graphs_);
+
+  EXPECT_EQ(SlotOf(send), -1);
+  EXPECT_EQ(SlotOf(recv), -1);
+  EXPECT_EQ(SlotOf(other_recv), -1);
+}
+
+TEST_F(AssignStaticRendezvousSlotsTest, SkipsClientTerminatedAndHostMemory) {
+  Graph* g0 = AddGraph(kCpu0);
+  Graph* g1 = AddGraph(kCpu1);
+  Node* client_send = AddSend(g0, "client", kCpu1);
+  client_send->AddAttr("client_terminated", true);
+  Node* client_recv = AddRecv(g1, "client");
+  Node* host_send = AddSend(g0, "host", kCpu1);
+  Node* host_recv = AddRecv(g1, "host");
+  host_recv->AddAttr("_hostmem_sendrecv", true);
+
+  AssignStaticRendezvousSlots(&graphs_);
+
+  EXPECT_EQ(SlotOf(client_send), -1);
+  EXPECT_EQ(SlotOf(client_recv), -1);
+  EXPECT_EQ(SlotOf(host_send), -1);
+  EXPECT_EQ(SlotOf(host_recv), -1);
+}
+
+}  // namespace
+}  // namespace tensorflow
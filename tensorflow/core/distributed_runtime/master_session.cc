@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
+#include "tensorflow/core/distributed_runtime/partition_balancer.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -2011,8 +2012,112 @@ Status MasterSession::DoRunWithLocalExecution(
                                 &cancellation_manager_, false);
 
   cleanup.release();  // MarkRunCompletion called in PostRunCleanup().
-  return PostRunCleanup(rcg, step_id, req.options(), &pss, ph, s,
-                        resp->mutable_metadata());
+  s = PostRunCleanup(rcg, step_id, req.options(), &pss, ph, s,
+                     resp->mutable_metadata());
+  if (s.ok() && session_opts_.config.experimental()
+                    .enable_cost_based_partition_balancing()) {
+    MaybeBalancePartitions(rcg, count, pss,
+                           resp->mutable_metadata()->cost_graph());
+  }
+  return s;
+}
+
+namespace {
+// Number of steps of a rebalanced graph after which the achieved step time
+// is reported.
+constexpr int64_t kPartitionBalancingReportSteps = 10;
+}  // namespace
+
+void MasterSession::MaybeBalancePartitions(ReffedClientGraph* rcg,
+                                           int64_t count,
+                                           const PerStepState& pss,
+                                           const CostGraphDef& cost_graph) {
+  const uint64 hash = HashBuildGraphOptions(rcg->build_graph_options());
+  const int64_t step_micros = pss.end_micros - pss.start_micros;
+  std::unique_ptr<ClientGraph> client_graph;
+  {
+    mutex_lock l(mu_);
+    auto iter = run_graphs_.find(hash);
+    if (closed_ || iter == run_graphs_.end() || iter->second != rcg) return;
+    PartitionBalancingStats& stats = partition_balancing_[hash];
+    if (stats.reported) return;
+    // The first step of each graph also registers its partitions, so its
+    // time is not representative.
+    if (stats.balanced) {
+      if (count == 0) return;
+      ++stats.num_steps_after;
+      stats.total_micros_after += step_micros;
+      if (stats.num_steps_after < kPartitionBalancingReportSteps) return;
+      stats.reported = true;
+      const int64_t achieved_after =
+          stats.total_micros_after / stats.num_steps_after;
+      if (stats.num_steps_before > 0) {
+        const int64_t achieved_before =
+            stats.total_micros_before / stats.num_steps_before;
+        LOG(INFO) << "Partition balancing for graph " << hash
+                  << ": predicted step time " << stats.predicted_before_micros
+                  << "us -> " << stats.predicted_after_micros
+                  << "us, achieved " << achieved_before << "us -> "
+                  << achieved_after << "us";
+      } else {
+        LOG(INFO) << "Partition balancing for graph " << hash
+                  << ": predicted step time " << stats.predicted_before_micros
+                  << "us -> " << stats.predicted_after_micros
+                  << "us, achieved " << achieved_after << "us";
+      }
+      return;
+    }
+    if (count > 0) {
+      ++stats.num_steps_before;
+      stats.total_micros_before += step_micros;
+    }
+    if (!pss.collect_costs || cost_graph.node_size() == 0) return;
+    // Only one refinement is attempted per graph.
+    stats.balanced = true;
+    Status s =
+        execution_state_->BuildGraph(rcg->build_graph_options(), &client_graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Skipping partition balancing: " << s;
+      stats.reported = true;
+      return;
+    }
+  }
+
+  PartitionBalancerResult result;
+  Status s = BalancePartitions(client_graph->graph, cost_graph,
+                               PartitionBalancerOptions(), &result);
+  if (!s.ok() || result.assignments.empty()) {
+    if (!s.ok()) LOG(WARNING) << "Skipping partition balancing: " << s;
+    VLOG(1) << "Partition balancing found no improving moves for graph "
+            << hash;
+    mutex_lock l(mu_);
+    partition_balancing_[hash].reported = true;
+    return;
+  }
+  VLOG(1) << "Partition balancing moves " << result.assignments.size()
+          << " nodes of graph " << hash << "; predicted step time "
+          << result.predicted_before_micros << "us -> "
+          << result.predicted_after_micros << "us";
+  ApplyPartitionAssignments(result.assignments, &client_graph->graph);
+
+  ReffedClientGraph* to_unref = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto iter = run_graphs_.find(hash);
+    // The cached graph may have been discarded while we were balancing.
+    if (closed_ || iter == run_graphs_.end() || iter->second != rcg) return;
+    PartitionBalancingStats& stats = partition_balancing_[hash];
+    stats.predicted_before_micros = result.predicted_before_micros;
+    stats.predicted_after_micros = result.predicted_after_micros;
+    // Steps that are still running hold their own reference to the old
+    // graph; new steps pick up the rebalanced one from StartStep().
+    to_unref = iter->second;
+    iter->second = new ReffedClientGraph(
+        handle_, rcg->build_graph_options(), std::move(client_graph),
+        session_opts_, stats_publisher_factory_, false /* is_partial */,
+        get_worker_cache(), !should_delete_worker_sessions_);
+  }
+  to_unref->Unref();
 }
 
 Status MasterSession::MakeCallable(const MakeCallableRequest& req,
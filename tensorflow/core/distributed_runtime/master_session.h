@@ -192,6 +192,23 @@ class MasterSession : public core::RefCounted {
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       TF_GUARDED_BY(mu_);
 
+  // Progress of the optional cost-based partition balancing of one entry in
+  // `run_graphs_`, keyed by the same hash. See
+  // ConfigProto.Experimental.enable_cost_based_partition_balancing.
+  struct PartitionBalancingStats {
+    bool balanced = false;
+    bool reported = false;
+    int64_t predicted_before_micros = 0;
+    int64_t predicted_after_micros = 0;
+    // Measured step times, excluding the first step of each graph.
+    int64_t num_steps_before = 0;
+    int64_t total_micros_before = 0;
+    int64_t num_steps_after = 0;
+    int64_t total_micros_after = 0;
+  };
+  std::unordered_map<uint64, PartitionBalancingStats> partition_balancing_
+      TF_GUARDED_BY(mu_);
+
   // Active RunStep calls.
   condition_variable num_running_is_zero_;
   int32 num_running_ TF_GUARDED_BY(mu_) = 0;
@@ -244,6 +261,13 @@ class MasterSession : public core::RefCounted {
                         const Status& run_status,
                         RunMetadata* out_run_metadata);
 
+  // Records the step time of `rcg` and, after the first step of `rcg` that
+  // collected `cost_graph`, replaces the cached graph by one whose placement
+  // has been refined by BalancePartitions().
+  void MaybeBalancePartitions(ReffedClientGraph* rcg, int64_t count,
+                              const PerStepState& pss,
+                              const CostGraphDef& cost_graph);
+
   void MarkRunCompletion();
   void UpdateLastAccessTime();
 
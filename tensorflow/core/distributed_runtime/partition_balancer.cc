@@ -0,0 +1,272 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/partition_balancer.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+// Flattened view of the placed graph used to evaluate candidate moves
+// without touching the Graph itself.
+class PlacementModel {
+ public:
+  PlacementModel(const Graph& g, const CostGraphDef& costs,
+                 const PartitionBalancerOptions& opts)
+      : g_(g), opts_(opts) {
+    GetReversePostOrder(g, &order_);
+
+    std::unordered_map<string, const CostGraphDef::Node*> cost_by_name;
+    for (const CostGraphDef::Node& cn : costs.node()) {
+      cost_by_name.emplace(cn.name(), &cn);
+    }
+
+    const int num_ids = g.num_node_ids();
+    placement_.assign(num_ids, -1);
+    compute_micros_.assign(num_ids, 0);
+    output_bytes_.resize(num_ids);
+    for (const Node* n : g.nodes()) {
+      placement_[n->id()] = DeviceIndex(n->assigned_device_name());
+      auto it = cost_by_name.find(n->name());
+      if (it == cost_by_name.end()) continue;
+      const CostGraphDef::Node& cn = *it->second;
+      compute_micros_[n->id()] = std::max<int64_t>(cn.compute_cost(), 0);
+      for (const auto& out : cn.output_info()) {
+        output_bytes_[n->id()].push_back(std::max<int64_t>(out.size(), 0));
+      }
+    }
+  }
+
+  const std::vector<int>& placement() const { return placement_; }
+  const string& device_name(int d) const { return device_names_[d]; }
+  int task(int d) const { return d < 0 ? -1 : device_task_[d]; }
+  const string& device_type(int d) const { return device_types_[d]; }
+  int64_t EdgeBytes(const Edge* e) const {
+    if (e->IsControlEdge()) return 0;
+    const std::vector<int64_t>& out = output_bytes_[e->src()->id()];
+    const size_t port = e->src_output();
+    return port < out.size() ? out[port] : 0;
+  }
+
+  bool CrossesTask(const Edge* e, const std::vector<int>& placement) const {
+    const int src_task = task(placement[e->src()->id()]);
+    const int dst_task = task(placement[e->dst()->id()]);
+    return src_task >= 0 && dst_task >= 0 && src_task != dst_task;
+  }
+
+  // Returns the predicted step time of "placement", which maps each node id
+  // to a device index.
+  int64_t Predict(const std::vector<int>& placement) const {
+    std::vector<int64_t> finish(g_.num_node_ids(), 0);
+    std::vector<int64_t> load(device_names_.size(), 0);
+    int64_t critical_path = 0;
+    for (const Node* n : order_) {
+      int64_t start = 0;
+      for (const Edge* e : n->in_edges()) {
+        // Back edges of while loops are not part of the DAG.
+        if (e->src()->IsNextIteration()) continue;
+        int64_t ready = finish[e->src()->id()];
+        if (CrossesTask(e, placement)) {
+          ready += opts_.cross_task_latency_micros +
+                   static_cast<int64_t>(EdgeBytes(e) /
+                                        opts_.cross_task_bytes_per_micro);
+        }
+        start = std::max(start, ready);
+      }
+      const int64_t cost = compute_micros_[n->id()];
+      finish[n->id()] = start + cost;
+      critical_path = std::max(critical_path, finish[n->id()]);
+      if (placement[n->id()] >= 0) load[placement[n->id()]] += cost;
+    }
+    int64_t busiest = 0;
+    for (int64_t l : load) busiest = std::max(busiest, l);
+    return std::max(critical_path, busiest);
+  }
+
+ private:
+  int DeviceIndex(const string& name) {
+    if (name.empty()) return -1;
+    auto it = device_index_.find(name);
+    if (it != device_index_.end()) return it->second;
+
+    string task_name;
+    string unused;
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::SplitDeviceName(name, &task_name, &unused) ||
+        !DeviceNameUtils::ParseFullName(name, &parsed)) {
+      return -1;
+    }
+    auto task_it = task_index_.emplace(task_name, task_index_.size()).first;
+    const int index = device_names_.size();
+    device_names_.push_back(name);
+    device_types_.push_back(parsed.type);
+    device_task_.push_back(task_it->second);
+    device_index_.emplace(name, index);
+    return index;
+  }
+
+  const Graph& g_;
+  const PartitionBalancerOptions& opts_;
+  std::vector<Node*> order_;
+
+  std::vector<int> placement_;                      // Indexed by node id.
+  std::vector<int64_t> compute_micros_;             // Indexed by node id.
+  std::vector<std::vector<int64_t>> output_bytes_;  // Indexed by node id.
+
+  std::unordered_map<string, int> device_index_;
+  std::unordered_map<string, int> task_index_;
+  std::vector<string> device_names_;
+  std::vector<string> device_types_;
+  std::vector<int> device_task_;
+};
+
+// Returns true if "n" may be assigned to any other device of the same type
+// without changing the semantics of the graph.
+bool IsMovable(const Node* n) {
+  if (!n->IsOp() || n->assigned_device_name().empty()) return false;
+  if (n->IsSend() || n->IsRecv() || n->IsControlFlow()) return false;
+  if (n->IsArg() || n->IsRetval() || n->IsFunctionCall()) return false;
+  if (n->op_def().is_stateful()) return false;
+  if (n->attrs().Find(kColocationAttrName) != nullptr) return false;
+  for (DataType dt : n->input_types()) {
+    if (IsRefType(dt) || dt == DT_RESOURCE) return false;
+  }
+  for (DataType dt : n->output_types()) {
+    if (IsRefType(dt) || dt == DT_RESOURCE) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+Status BalancePartitions(const Graph& g, const CostGraphDef& costs,
+                         const PartitionBalancerOptions& opts,
+                         PartitionBalancerResult* result) {
+  if (opts.cross_task_bytes_per_micro <= 0) {
+    return errors::InvalidArgument(
+        "cross_task_bytes_per_micro must be positive, got ",
+        opts.cross_task_bytes_per_micro);
+  }
+  result->assignments.clear();
+
+  PlacementModel model(g, costs, opts);
+  std::vector<int> device = model.placement();
+  int64_t current = model.Predict(device);
+  result->predicted_before_micros = current;
+
+  std::vector<bool> moved(g.num_node_ids(), false);
+  for (int round = 0; round < opts.max_moves; ++round) {
+    // Candidates are movable nodes on a task boundary, ordered by the
+    // number of bytes they currently send or receive across tasks.
+    std::vector<std::pair<int64_t, const Node*>> candidates;
+    for (const Node* n : g.op_nodes()) {
+      if (moved[n->id()] || !IsMovable(n)) continue;
+      int64_t cross_bytes = 0;
+      bool on_boundary = false;
+      for (const Edge* e : n->in_edges()) {
+        if (model.CrossesTask(e, device)) {
+          on_boundary = true;
+          cross_bytes += model.EdgeBytes(e);
+        }
+      }
+      for (const Edge* e : n->out_edges()) {
+        if (model.CrossesTask(e, device)) {
+          on_boundary = true;
+          cross_bytes += model.EdgeBytes(e);
+        }
+      }
+      if (on_boundary) candidates.emplace_back(cross_bytes, n);
+    }
+    if (candidates.empty()) break;
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const std::pair<int64_t, const Node*>& a,
+                        const std::pair<int64_t, const Node*>& b) {
+                       return a.first > b.first;
+                     });
+    if (candidates.size() > static_cast<size_t>(opts.max_candidates)) {
+      candidates.resize(opts.max_candidates);
+    }
+
+    const Node* best_node = nullptr;
+    int best_device = -1;
+    int64_t best = current;
+    for (const auto& candidate : candidates) {
+      const Node* n = candidate.second;
+      const int from = device[n->id()];
+      // Only devices of the same type that already host a neighbour on
+      // another task are considered, which keeps the search local.
+      std::set<int> targets;
+      for (const Edge* e : n->in_edges()) {
+        const int d = device[e->src()->id()];
+        if (d >= 0 && model.task(d) != model.task(from)) targets.insert(d);
+      }
+      for (const Edge* e : n->out_edges()) {
+        const int d = device[e->dst()->id()];
+        if (d >= 0 && model.task(d) != model.task(from)) targets.insert(d);
+      }
+      for (int to : targets) {
+        if (model.device_type(to) != model.device_type(from)) continue;
+        device[n->id()] = to;
+        const int64_t predicted = model.Predict(device);
+        device[n->id()] = from;
+        if (predicted < best) {
+          best = predicted;
+          best_node = n;
+          best_device = to;
+        }
+      }
+    }
+    if (best_node == nullptr ||
+        current - best < opts.min_relative_improvement * current) {
+      break;
+    }
+    VLOG(2) << "Moving " << best_node->name() << " from "
+            << best_node->assigned_device_name() << " to "
+            << model.device_name(best_device) << ": predicted step time "
+            << current << "us -> " << best << "us";
+    device[best_node->id()] = best_device;
+    moved[best_node->id()] = true;
+    result->assignments[best_node->name()] = model.device_name(best_device);
+    current = best;
+  }
+  result->predicted_after_micros = current;
+  return absl::OkStatus();
+}
+
+void ApplyPartitionAssignments(
+    const std::unordered_map<string, string>& assignments, Graph* g) {
+  if (assignments.empty()) return;
+  for (Node* n : g->op_nodes()) {
+    auto it = assignments.find(n->name());
+    if (it != assignments.end()) {
+      n->set_assigned_device_name(it->second);
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_PARTITION_BALANCER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_PARTITION_BALANCER_H_
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+struct PartitionBalancerOptions {
+  // Modeled bandwidth of a transfer between two tasks, in bytes per
+  // microsecond (1000 ~= 1 GB/s).
+  double cross_task_bytes_per_micro = 1000.0;
+
+  // Modeled fixed overhead of each cross-task transfer, in microseconds.
+  int64_t cross_task_latency_micros = 50;
+
+  // Maximum number of nodes moved by one call to BalancePartitions().
+  int max_moves = 16;
+
+  // Maximum number of candidate nodes evaluated in each round. Candidates
+  // are the nodes with the largest cross-task input/output volume.
+  int max_candidates = 64;
+
+  // A move is only accepted if it shortens the predicted step time by at
+  // least this fraction of the current prediction.
+  double min_relative_improvement = 0.01;
+};
+
+struct PartitionBalancerResult {
+  // Node name -> new assigned device, for each node that was moved.
+  std::unordered_map<string, string> assignments;
+
+  // Predicted step time before and after applying "assignments".
+  int64_t predicted_before_micros = 0;
+  int64_t predicted_after_micros = 0;
+};
+
+// Refines the device assignment of the placed graph "g" using per-node
+// measurements from "costs" (as produced by the CostModelManager on the
+// workers and returned in RunMetadata.cost_graph).
+//
+// The predicted step time of a placement is the maximum of (a) the
+// critical path through "g", where every edge that crosses a task
+// boundary is charged the modeled transfer time of the bytes it carries,
+// and (b) the total compute time assigned to the busiest device. Nodes are
+// greedily moved to a device of the same type on another task that
+// already hosts one of their neighbours, as long as each move shortens
+// the prediction.
+//
+// Only stateless nodes without colocation constraints, reference-typed
+// edges or control-flow semantics are considered, so that moving them
+// cannot change the program's meaning. "g" is not modified.
+Status BalancePartitions(const Graph& g, const CostGraphDef& costs,
+                         const PartitionBalancerOptions& opts,
+                         PartitionBalancerResult* result);
+
+// Applies "assignments" computed by BalancePartitions() to "g". Names
+// that do not exist in "g" are ignored.
+void ApplyPartitionAssignments(
+    const std::unordered_map<string, string>& assignments, Graph* g);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_PARTITION_BALANCER_H_
@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/partition_balancer.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const char* const kTask0 = "/job:worker/replica:0/task:0/device:CPU:0";
+const char* const kTask1 = "/job:worker/replica:0/task:1/device:CPU:0";
+
+class PartitionBalancerTest : public ::testing::Test {
+ protected:
+  PartitionBalancerTest() : graph_(OpRegistry::Global()) {}
+
+  Node* Place(Node* n, const string& device) {
+    n->set_assigned_device_name(device);
+    return n;
+  }
+
+  void AddCost(const Node* n, int64_t compute_micros, int64_t output_bytes) {
+    CostGraphDef::Node* cn = costs_.add_node();
+    cn->set_name(n->name());
+    cn->set_compute_cost(compute_micros);
+    cn->add_output_info()->set_size(output_bytes);
+  }
+
+  Node* FloatConstant() {
+    return test::graph::Constant(&graph_, Tensor(DT_FLOAT, TensorShape({})));
+  }
+
+  Graph graph_;
+  CostGraphDef costs_;
+};
+
+TEST_F(PartitionBalancerTest, PullsLightNodeAcrossExpensiveTransfers) {
+  Node* a = Place(FloatConstant(), kTask0);
+  Node* b = Place(test::graph::Unary(&graph_, "Square", a), kTask1);
+  Node* c = Place(test::graph::Unary(&graph_, "Square", b), kTask0);
+  AddCost(a, 10, 1000000);
+  AddCost(b, 10, 1000000);
+  AddCost(c, 10, 1000000);
+
+  PartitionBalancerResult result;
+  TF_ASSERT_OK(BalancePartitions(graph_, costs_, PartitionBalancerOptions(),
+                                 &result));
+  // a -> b and b -> c each transfer 1MB at 1000 bytes/us plus 50us latency.
+  EXPECT_EQ(2130, result.predicted_before_micros);
+  EXPECT_EQ(30, result.predicted_after_micros);
+  ASSERT_EQ(1, result.assignments.size());
+  EXPECT_EQ(kTask0, result.assignments[b->name()]);
+
+  ApplyPartitionAssignments(result.assignments, &graph_);
+  EXPECT_EQ(kTask0, b->assigned_device_name());
+  EXPECT_EQ(kTask0, c->assigned_device_name());
+}
+
+TEST_F(PartitionBalancerTest, SpreadsLoadToIdleTask) {
+  Node* a = Place(FloatConstant(), kTask0);
+  Node* x1 = Place(test::graph::Unary(&graph_, "Square", a), kTask0);
+  Node* x2 = Place(test::graph::Unary(&graph_, "Square", a), kTask0);
+  Node* y = Place(test::graph::Add(&graph_, x1, x2), kTask1);
+  AddCost(a, 10, 100);
+  AddCost(x1, 1000, 100);
+  AddCost(x2, 1000, 100);
+  AddCost(y, 10, 100);
+
+  PartitionBalancerResult result;
+  TF_ASSERT_OK(BalancePartitions(graph_, costs_, PartitionBalancerOptions(),
+                                 &result));
+  // Before, task 0 runs 2010us of work; after, one Square runs on task 1.
+  EXPECT_EQ(2010, result.predicted_before_micros);
+  EXPECT_EQ(1070, result.predicted_after_micros);
+  ASSERT_EQ(1, result.assignments.size());
+  EXPECT_EQ(kTask1, result.assignments.begin()->second);
+  EXPECT_EQ(0, result.assignments.count(y->name()));
+}
+
+TEST_F(PartitionBalancerTest, DoesNotMoveStatefulNodes) {
+  Node* shape = Place(
+      test::graph::Constant(&graph_, Tensor(DT_INT32, TensorShape({0}))),
+      kTask0);
+  Node* random = Place(
+      test::graph::RandomUniform(&graph_, shape, DT_FLOAT), kTask1);
+  Node* c = Place(test::graph::Unary(&graph_, "Square", random), kTask0);
+  AddCost(shape, 10, 1000000);
+  AddCost(random, 10, 1000000);
+  AddCost(c, 10, 1000000);
+
+  PartitionBalancerResult result;
+  TF_ASSERT_OK(BalancePartitions(graph_, costs_, PartitionBalancerOptions(),
+                                 &result));
+  EXPECT_EQ(0, result.assignments.count(random->name()));
+  EXPECT_LT(result.predicted_after_micros, result.predicted_before_micros);
+}
+
+TEST_F(PartitionBalancerTest, NoMovesWithinOneTask) {
+  Node* a = Place(FloatConstant(), kTask0);
+  Node* b = Place(test::graph::Unary(&graph_, "Square", a), kTask0);
+  AddCost(a, 10, 1000000);
+  AddCost(b, 10, 1000000);
+
+  PartitionBalancerResult result;
+  TF_ASSERT_OK(BalancePartitions(graph_, costs_, PartitionBalancerOptions(),
+                                 &result));
+  EXPECT_TRUE(result.assignments.empty());
+  EXPECT_EQ(20, result.predicted_before_micros);
+  EXPECT_EQ(20, result.predicted_after_micros);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 namespace tensorflow {
 class Tensor;
 class RecvTensorResponse;
+class TensorWireEncoding;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -45,9 +46,14 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 //
 // "val" holds the tensor value to be encoded.
 //
+// If "wire_encoding" is non-null, "val" holds the output of
+// EncodeTensorForWire() and "*wire_encoding" is sent in
+// "RecvTensorResponse::transport_options" so that the receiver can decode it.
+//
 // Discards original contents of *result.
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result);
+                              ::grpc::ByteBuffer* result,
+                              const TensorWireEncoding* wire_encoding = nullptr);
 
 }  // namespace grpc
 }  // namespace tensorflow
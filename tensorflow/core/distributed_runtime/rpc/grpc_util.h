@@ -50,6 +50,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares "data" if it lies within a single slice of the ByteBuffer, by
+  // holding a reference to that slice.
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
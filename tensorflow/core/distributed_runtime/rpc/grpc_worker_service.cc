@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -454,12 +455,22 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64_t step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+  const TensorTransferCompression::Codec wire_codec = request->wire_codec();
 
-  auto do_response = [response, done, cache_enabled](
+  auto do_response = [response, done, cache_enabled, wire_codec](
                          const Tensor& tensor, bool is_dead,
                          const absl::Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      Tensor encoded;
+      TensorWireEncoding encoding;
+      if (!is_dead &&
+          EncodeTensorForWire(wire_codec, tensor, &encoded, &encoding)) {
+        grpc::EncodeTensorToByteBuffer(is_dead, encoded, cache_enabled,
+                                       response, &encoding);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -31,11 +32,25 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Whether received tensors may be backed directly by the transport's receive
+// buffers instead of being copied into the destination allocator. Enabled by
+// setting TF_RPC_ZERO_COPY_RECV_TENSOR=1.
+bool ShareReceivedTensorBuffers() {
+  static const bool share = [] {
+    bool value;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_RPC_ZERO_COPY_RECV_TENSOR", false, &value));
+    return value;
+  }();
+  return share;
+}
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
@@ -69,6 +84,13 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // Encoded tensors are decoded on the host, so a codec is only requested
+    // for tensors that are received into host memory.
+    if (alloc_attrs.on_host() ||
+        dst_device->attributes().device_type() == DEVICE_CPU) {
+      req_.set_wire_codec(
+          static_cast<TensorTransferCompression::Codec>(recv_args.wire_codec));
+    }
   }
 
   void Reset() {
@@ -83,6 +105,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     // opts_ appropriately.
     req_.Clear();
     resp_.Clear();
+    decoded_tensor_ = Tensor();
+    has_decoded_tensor_ = false;
     {
       mutex_lock l(mu_);
       status_ = absl::OkStatus();
@@ -122,7 +146,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_ = nullptr;
   }
 
-  const Tensor& tensor() const { return resp_.tensor(); }
+  const Tensor& tensor() const {
+    return has_decoded_tensor_ ? decoded_tensor_ : resp_.tensor();
+  }
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
@@ -136,15 +162,20 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
     resp_.InitAlloc(dst_device_, alloc_attrs_);
+    resp_.set_share_received_buffers(ShareReceivedTensorBuffers());
     auto abort_checked = std::make_shared<Notification>();
     auto cb = [this, abort_checked,
                recv_done = std::move(recv_done)](const absl::Status& s) {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
-      if (!s.ok()) {
+      absl::Status status = s;
+      if (status.ok()) {
+        status = MaybeDecodeTensor();
+      }
+      if (!status.ok()) {
         mutex_lock l(mu_);
-        status_.Update(s);
+        status_.Update(status);
       }
       recv_done();
     };
@@ -167,6 +198,26 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Decodes the received tensor if the sender encoded it with the wire codec
+  // that was requested in `req_`.
+  absl::Status MaybeDecodeTensor() {
+    const RecvTensorResponse& meta = resp_.metadata();
+    if (meta.is_dead() || !meta.has_transport_options() ||
+        !meta.transport_options().Is<TensorWireEncoding>()) {
+      return absl::OkStatus();
+    }
+    TensorWireEncoding encoding;
+    if (!meta.transport_options().UnpackTo(&encoding)) {
+      return errors::DataLoss("Cannot parse TensorWireEncoding for ",
+                              req_.rendezvous_key());
+    }
+    TF_RETURN_IF_ERROR(DecodeTensorFromWire(
+        encoding, resp_.tensor(), dst_device_->GetAllocator(alloc_attrs_),
+        &decoded_tensor_));
+    has_decoded_tensor_ = true;
+    return absl::OkStatus();
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -175,6 +226,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   CallOptions opts_;
   RecvTensorRequest req_;
   TensorResponse resp_;
+  Tensor decoded_tensor_;
+  bool has_decoded_tensor_ = false;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
 
@@ -45,6 +45,17 @@ class TensorResponse {
   // Initialize memory allocation related members.
   void InitAlloc(DeviceBase* d, const AllocatorAttributes& aa);
 
+  // If true, a host tensor whose contents arrive suitably aligned in a single
+  // contiguous block of the Source is backed directly by that block (see
+  // Source::ShareBytes) instead of being copied into a buffer from the
+  // allocator. Only honored when the tensor does not need GPU- or
+  // NIC-compatible memory. Must be called after InitAlloc().
+  void set_share_received_buffers(bool share) {
+    share_received_buffers_ =
+        share && on_host_ && !alloc_attrs_.gpu_compatible() &&
+        !alloc_attrs_.nic_compatible();
+  }
+
   // Source provides a way for a particular RPC implementation to provide
   // received data to ParseFrom.
   class Source {
@@ -63,6 +74,17 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer that aliases the "num_bytes" bytes at "data", which
+    // point into the stream most recently returned by contents(), and keeps
+    // them alive independently of this Source. The caller owns the single
+    // reference on the returned buffer.
+    //
+    // Returns nullptr if the data can't be shared, in which case the caller
+    // copies it. TensorResponse checks that "data" is EIGEN_MAX_ALIGN_BYTES
+    // aligned before asking to share it. The default implementation never
+    // shares.
+    virtual TensorBuffer* ShareBytes(const char* data, size_t num_bytes);
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -92,7 +114,10 @@ class TensorResponse {
 
  private:
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
+                             TensorProto* tensor_meta, Source* source);
+  bool ShareTensorContent(protobuf::io::CodedInputStream* input,
+                          Source* source, DataType dtype,
+                          const TensorShape& shape, int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -101,6 +126,7 @@ class TensorResponse {
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
   bool already_used_ = false;
+  bool share_received_buffers_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
@@ -15,13 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <memory>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -156,6 +161,124 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A Source over a single aligned block that shares the tensor contents
+// instead of letting TensorResponse copy them.
+class SharingSource : public TensorResponse::Source {
+ public:
+  // Places "encoded" so that the bytes of "content" inside it start
+  // "misalignment" bytes past an aligned address.
+  SharingSource(const string& encoded, StringPiece content,
+                size_t misalignment = 0) {
+    const size_t pos = encoded.find(content.data(), 0, content.size());
+    CHECK_NE(pos, string::npos);
+    offset_ = (EIGEN_MAX_ALIGN_BYTES - pos % EIGEN_MAX_ALIGN_BYTES) %
+                  EIGEN_MAX_ALIGN_BYTES +
+              misalignment;
+    size_ = encoded.size();
+    storage_ = std::shared_ptr<char>(
+        static_cast<char*>(port::AlignedMalloc(offset_ + size_,
+                                               EIGEN_MAX_ALIGN_BYTES)),
+        port::AlignedFree);
+    memcpy(storage_.get() + offset_, encoded.data(), size_);
+  }
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_ = std::make_unique<protobuf::io::ArrayInputStream>(
+        storage_.get() + offset_, size_);
+    return stream_.get();
+  }
+
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override {
+    ++num_shared_;
+    return new Buffer(storage_, data, num_bytes);
+  }
+
+  bool Contains(const char* p) const {
+    return p >= storage_.get() && p < storage_.get() + offset_ + size_;
+  }
+  int num_shared() const { return num_shared_; }
+
+ private:
+  class Buffer : public TensorBuffer {
+   public:
+    Buffer(std::shared_ptr<char> storage, const char* data, size_t size)
+        : TensorBuffer(const_cast<char*>(data)),
+          storage_(std::move(storage)),
+          size_(size) {}
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {}
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    std::shared_ptr<char> storage_;
+    size_t size_;
+  };
+
+  std::shared_ptr<char> storage_;
+  size_t offset_;
+  size_t size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+  int num_shared_ = 0;
+};
+
+TEST_F(TensorResponseTest, ShareReceivedBuffers) {
+  Tensor src(DT_FLOAT, TensorShape({4, 64}));
+  test::FillIota<float>(&src, 1.0f);
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  SharingSource source(encoded, src.tensor_data());
+  DummyDevice cpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+
+  // Without opting in, the contents are copied.
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(source.num_shared(), 0);
+  EXPECT_FALSE(source.Contains(response.tensor().tensor_data().data()));
+  test::ExpectTensorEqual<float>(src, response.tensor());
+
+  response.set_share_received_buffers(true);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(source.num_shared(), 1);
+  EXPECT_TRUE(source.Contains(response.tensor().tensor_data().data()));
+  EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+  test::ExpectTensorEqual<float>(src, response.tensor());
+
+  // GPU-compatible host memory is never shared.
+  AllocatorAttributes gpu_compatible;
+  gpu_compatible.set_gpu_compatible(true);
+  response.InitAlloc(&cpu_device, gpu_compatible);
+  response.set_share_received_buffers(true);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(source.num_shared(), 1);
+  test::ExpectTensorEqual<float>(src, response.tensor());
+}
+
+TEST_F(TensorResponseTest, ShareReceivedBuffersCopiesUnalignedContents) {
+  Tensor src(DT_FLOAT, TensorShape({4, 64}));
+  test::FillIota<float>(&src, 1.0f);
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  SharingSource source(encoded, src.tensor_data(), /*misalignment=*/4);
+  DummyDevice cpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  response.set_share_received_buffers(true);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(source.num_shared(), 0);
+  EXPECT_FALSE(source.Contains(response.tensor().tensor_data().data()));
+  test::ExpectTensorEqual<float>(src, response.tensor());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -0,0 +1,215 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
+
+#include <cstring>
+#include <string>
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* wire_codec_uncompressed_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_wire_codec/uncompressed_bytes",
+    "Total size of the tensors sent with a wire codec, before encoding.",
+    "codec");
+
+auto* wire_codec_encoded_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_wire_codec/encoded_bytes",
+    "Total size of the tensors sent with a wire codec, after encoding. The "
+    "achieved compression ratio is uncompressed_bytes / encoded_bytes.",
+    "codec");
+
+Tensor MakeWireTensor(int64_t num_bytes) {
+  return Tensor(cpu_allocator(), DT_UINT8, TensorShape({num_bytes}));
+}
+
+char* MutableData(Tensor* t) {
+  return const_cast<char*>(t->tensor_data().data());
+}
+
+bool IsZeroElement(const char* p, size_t element_size) {
+  for (size_t i = 0; i < element_size; ++i) {
+    if (p[i] != 0) return false;
+  }
+  return true;
+}
+
+// Encodes "data" as a sequence of (number of zero elements, number of literal
+// elements, literal bytes) runs. Gives up and returns false as soon as the
+// encoding is not smaller than "data".
+bool EncodeZeroRuns(StringPiece data, size_t element_size, string* out) {
+  const size_t n = data.size() / element_size;
+  const char* base = data.data();
+  size_t i = 0;
+  while (i < n) {
+    size_t zeros = 0;
+    while (i + zeros < n &&
+           IsZeroElement(base + (i + zeros) * element_size, element_size)) {
+      ++zeros;
+    }
+    i += zeros;
+    size_t literals = 0;
+    while (i + literals < n &&
+           !IsZeroElement(base + (i + literals) * element_size, element_size)) {
+      ++literals;
+    }
+    core::PutVarint64(out, zeros);
+    core::PutVarint64(out, literals);
+    out->append(base + i * element_size, literals * element_size);
+    i += literals;
+    if (out->size() >= data.size()) return false;
+  }
+  return true;
+}
+
+bool DecodeZeroRuns(StringPiece in, size_t element_size, char* out,
+                    size_t out_size) {
+  size_t pos = 0;
+  while (!in.empty()) {
+    uint64 zeros;
+    uint64 literals;
+    if (!core::GetVarint64(&in, &zeros) ||
+        !core::GetVarint64(&in, &literals)) {
+      return false;
+    }
+    if (zeros > (out_size - pos) / element_size) return false;
+    memset(out + pos, 0, zeros * element_size);
+    pos += zeros * element_size;
+    if (literals > (out_size - pos) / element_size) return false;
+    const size_t literal_bytes = literals * element_size;
+    if (in.size() < literal_bytes) return false;
+    memcpy(out + pos, in.data(), literal_bytes);
+    pos += literal_bytes;
+    in.remove_prefix(literal_bytes);
+  }
+  return pos == out_size;
+}
+
+}  // namespace
+
+bool EncodeTensorForWire(TensorTransferCompression::Codec codec,
+                         const Tensor& in, Tensor* encoded,
+                         TensorWireEncoding* encoding) {
+  if (codec == TensorTransferCompression::NONE ||
+      !DataTypeCanUseMemcpy(in.dtype()) ||
+      in.TotalBytes() < static_cast<size_t>(kMinWireCodecBytes)) {
+    return false;
+  }
+  const StringPiece data = in.tensor_data();
+  switch (codec) {
+    case TensorTransferCompression::SNAPPY: {
+      string compressed;
+      if (!port::Snappy_Compress(data.data(), data.size(), &compressed) ||
+          compressed.size() >= data.size()) {
+        return false;
+      }
+      *encoded = MakeWireTensor(compressed.size());
+      memcpy(MutableData(encoded), compressed.data(), compressed.size());
+      break;
+    }
+    case TensorTransferCompression::BFLOAT16: {
+      if (in.dtype() != DT_FLOAT) return false;
+      const int64_t n = in.NumElements();
+      *encoded = MakeWireTensor(n * sizeof(bfloat16));
+      FloatToBFloat16(in.flat<float>().data(),
+                      reinterpret_cast<bfloat16*>(MutableData(encoded)), n);
+      break;
+    }
+    case TensorTransferCompression::ZERO_RUN_LENGTH: {
+      string runs;
+      if (!EncodeZeroRuns(data, DataTypeSize(in.dtype()), &runs)) {
+        return false;
+      }
+      *encoded = MakeWireTensor(runs.size());
+      memcpy(MutableData(encoded), runs.data(), runs.size());
+      break;
+    }
+    default:
+      return false;
+  }
+  encoding->set_codec(codec);
+  encoding->set_dtype(in.dtype());
+  in.shape().AsProto(encoding->mutable_shape());
+
+  const string& label = TensorTransferCompression::Codec_Name(codec);
+  wire_codec_uncompressed_bytes->GetCell(label)->IncrementBy(data.size());
+  wire_codec_encoded_bytes->GetCell(label)->IncrementBy(encoded->TotalBytes());
+  return true;
+}
+
+Status DecodeTensorFromWire(const TensorWireEncoding& encoding,
+                            const Tensor& encoded, Allocator* allocator,
+                            Tensor* out) {
+  if (encoded.dtype() != DT_UINT8 || encoded.dims() != 1) {
+    return errors::InvalidArgument(
+        "Wire-encoded tensor must be a uint8 vector, got ",
+        encoded.DebugString());
+  }
+  if (!DataTypeCanUseMemcpy(encoding.dtype())) {
+    return errors::InvalidArgument("Cannot decode wire-encoded tensor of type ",
+                                   DataTypeString(encoding.dtype()));
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(encoding.shape(), &shape));
+  Tensor decoded(allocator, encoding.dtype(), shape);
+  const StringPiece in = encoded.tensor_data();
+  char* dst = MutableData(&decoded);
+  const size_t dst_size = decoded.TotalBytes();
+
+  bool ok = false;
+  switch (encoding.codec()) {
+    case TensorTransferCompression::SNAPPY: {
+      size_t length;
+      ok = port::Snappy_GetUncompressedLength(in.data(), in.size(), &length) &&
+           length == dst_size &&
+           port::Snappy_Uncompress(in.data(), in.size(), dst);
+      break;
+    }
+    case TensorTransferCompression::BFLOAT16: {
+      const size_t n = decoded.NumElements();
+      ok = encoding.dtype() == DT_FLOAT && in.size() == n * sizeof(bfloat16);
+      if (ok) {
+        BFloat16ToFloat(reinterpret_cast<const bfloat16*>(in.data()),
+                        reinterpret_cast<float*>(dst), n);
+      }
+      break;
+    }
+    case TensorTransferCompression::ZERO_RUN_LENGTH:
+      ok = DecodeZeroRuns(in, DataTypeSize(encoding.dtype()), dst, dst_size);
+      break;
+    default:
+      break;
+  }
+  if (!ok) {
+    return errors::DataLoss("Corrupt ",
+                            TensorTransferCompression::Codec_Name(
+                                encoding.codec()),
+                            "-encoded tensor of shape ", shape.DebugString());
+  }
+  *out = std::move(decoded);
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_WIRE_CODEC_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_WIRE_CODEC_H_
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Tensors smaller than this are never encoded, since the saving would not
+// pay for the encoding work.
+constexpr int64_t kMinWireCodecBytes = 1024;
+
+// Encodes the host tensor "in" with "codec" for a RecvTensor response.
+//
+// Returns true and fills "*encoded" (a DT_UINT8 vector) and "*encoding" if
+// the codec applies to "in" and, for the lossless codecs, makes it smaller.
+// Returns false if "in" should be sent unencoded.
+bool EncodeTensorForWire(TensorTransferCompression::Codec codec,
+                         const Tensor& in, Tensor* encoded,
+                         TensorWireEncoding* encoding);
+
+// Decodes "encoded", which was produced by EncodeTensorForWire() with
+// "encoding", into "*out", whose buffer is allocated from "allocator".
+Status DecodeTensorFromWire(const TensorWireEncoding& encoding,
+                            const Tensor& encoded, Allocator* allocator,
+                            Tensor* out);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_WIRE_CODEC_H_
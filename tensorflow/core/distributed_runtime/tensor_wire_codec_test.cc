@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns a float tensor of "n" elements in which every "stride"-th element
+// is non-zero.
+Tensor SparseFloats(int64_t n, int64_t stride) {
+  Tensor t(DT_FLOAT, TensorShape({n}));
+  auto flat = t.flat<float>();
+  for (int64_t i = 0; i < n; ++i) {
+    flat(i) = (i % stride == 0) ? static_cast<float>(i) + 0.5f : 0.0f;
+  }
+  return t;
+}
+
+void ExpectRoundTrip(TensorTransferCompression::Codec codec, const Tensor& in,
+                     Tensor* decoded) {
+  Tensor encoded;
+  TensorWireEncoding encoding;
+  ASSERT_TRUE(EncodeTensorForWire(codec, in, &encoded, &encoding));
+  EXPECT_EQ(DT_UINT8, encoded.dtype());
+  EXPECT_LT(encoded.TotalBytes(), in.TotalBytes());
+  EXPECT_EQ(codec, encoding.codec());
+  TF_ASSERT_OK(
+      DecodeTensorFromWire(encoding, encoded, cpu_allocator(), decoded));
+  EXPECT_EQ(in.dtype(), decoded->dtype());
+  EXPECT_EQ(in.shape(), decoded->shape());
+}
+
+TEST(TensorWireCodecTest, Snappy) {
+  string probe;
+  if (!port::Snappy_Compress("x", 1, &probe)) {
+    GTEST_SKIP() << "Snappy is not available in this build";
+  }
+  Tensor in = SparseFloats(4096, 7);
+  Tensor decoded;
+  ExpectRoundTrip(TensorTransferCompression::SNAPPY, in, &decoded);
+  test::ExpectTensorEqual<float>(in, decoded);
+}
+
+TEST(TensorWireCodecTest, ZeroRunLength) {
+  Tensor in = SparseFloats(4096, 100);
+  Tensor decoded;
+  ExpectRoundTrip(TensorTransferCompression::ZERO_RUN_LENGTH, in, &decoded);
+  test::ExpectTensorEqual<float>(in, decoded);
+}
+
+TEST(TensorWireCodecTest, ZeroRunLengthInt64) {
+  Tensor in(DT_INT64, TensorShape({64, 32}));
+  in.flat<int64_t>().setZero();
+  in.matrix<int64_t>()(3, 5) = -1;
+  in.matrix<int64_t>()(63, 31) = 42;
+  Tensor decoded;
+  ExpectRoundTrip(TensorTransferCompression::ZERO_RUN_LENGTH, in, &decoded);
+  test::ExpectTensorEqual<int64_t>(in, decoded);
+}
+
+TEST(TensorWireCodecTest, ZeroRunLengthDeclinesDenseTensors) {
+  Tensor in = SparseFloats(4096, 1);
+  Tensor encoded;
+  TensorWireEncoding encoding;
+  EXPECT_FALSE(EncodeTensorForWire(TensorTransferCompression::ZERO_RUN_LENGTH,
+                                   in, &encoded, &encoding));
+}
+
+TEST(TensorWireCodecTest, BFloat16) {
+  // Values with at most 8 significant bits survive the truncation exactly.
+  Tensor in(DT_FLOAT, TensorShape({32, 32}));
+  auto flat = in.flat<float>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = static_cast<float>(i % 64) * 0.25f - 8.0f;
+  }
+  Tensor decoded;
+  ExpectRoundTrip(TensorTransferCompression::BFLOAT16, in, &decoded);
+  test::ExpectTensorEqual<float>(in, decoded);
+}
+
+TEST(TensorWireCodecTest, BFloat16OnlyAppliesToFloat) {
+  Tensor in(DT_INT32, TensorShape({1024}));
+  in.flat<int32>().setConstant(3);
+  Tensor encoded;
+  TensorWireEncoding encoding;
+  EXPECT_FALSE(EncodeTensorForWire(TensorTransferCompression::BFLOAT16, in,
+                                   &encoded, &encoding));
+}
+
+TEST(TensorWireCodecTest, SmallTensorsAreNotEncoded) {
+  Tensor in = SparseFloats(16, 100);
+  Tensor encoded;
+  TensorWireEncoding encoding;
+  EXPECT_FALSE(EncodeTensorForWire(TensorTransferCompression::ZERO_RUN_LENGTH,
+                                   in, &encoded, &encoding));
+  EXPECT_FALSE(EncodeTensorForWire(TensorTransferCompression::NONE,
+                                   SparseFloats(4096, 100), &encoded,
+                                   &encoding));
+}
+
+TEST(TensorWireCodecTest, CorruptInput) {
+  Tensor in = SparseFloats(4096, 100);
+  Tensor encoded;
+  TensorWireEncoding encoding;
+  ASSERT_TRUE(EncodeTensorForWire(TensorTransferCompression::ZERO_RUN_LENGTH,
+                                  in, &encoded, &encoding));
+  Tensor truncated = encoded.Slice(0, encoded.NumElements() - 1);
+  Tensor decoded;
+  EXPECT_TRUE(errors::IsDataLoss(
+      DecodeTensorFromWire(encoding, truncated, cpu_allocator(), &decoded)));
+
+  encoding.mutable_shape()->mutable_dim(0)->set_size(8192);
+  EXPECT_TRUE(errors::IsDataLoss(
+      DecodeTensorFromWire(encoding, encoded, cpu_allocator(), &decoded)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -113,7 +113,7 @@ struct CollImplDetails {
   std::vector<int32>
       dependencies;           // collective instances on which this node depends
   string communication_hint;  // user-supplied hint for implementation choice,
-                              // e.g. ring or nccl
+                              // e.g. ring, nccl or hierarchical_ring
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
 };
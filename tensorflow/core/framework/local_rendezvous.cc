@@ -106,6 +106,45 @@ struct LocalRendezvous::Item {
   }
 };
 
+// A preallocated meeting point for one statically matched Send/Recv pair.
+//
+// The first Send and the first Recv for the key each claim one side of the
+// slot, fill in their half of the payload, and then publish their arrival in
+// `state`. Whichever side arrives second observes the other side's bit and
+// invokes the receiver's callback, so the handoff never takes a lock. Any
+// further Send or Recv for the same key finds its side already claimed and
+// falls back to the hashed table, which preserves FIFO matching.
+struct LocalRendezvous::StaticSlot {
+  enum : uint8 { kSendArrived = 1, kRecvArrived = 2 };
+
+  std::atomic<bool> send_claimed{false};
+  std::atomic<bool> recv_claimed{false};
+  std::atomic<uint8> state{0};
+
+  // Written by the sending side before it sets `kSendArrived`. A non-OK
+  // `send_status` means the slot was cancelled or aborted instead.
+  Status send_status;
+  Rendezvous::Args send_args;
+  Tensor value;
+  bool is_dead = false;
+  tsl::core::RefCountPtr<Rendezvous> send_owner;
+
+  // Written by the receiving side before it sets `kRecvArrived`. `waiter` is
+  // empty if the slot was drained by an abort.
+  Rendezvous::Args recv_args;
+  Rendezvous::DoneCallback waiter;
+  tsl::core::RefCountPtr<Rendezvous> recv_owner;
+};
+
+struct LocalRendezvous::StaticSlotTable {
+  StaticSlotTable(int64_t id, int size)
+      : id(id), size(size), slots(std::make_unique<StaticSlot[]>(size)) {}
+
+  const int64_t id;
+  const int size;
+  const std::unique_ptr<StaticSlot[]> slots;
+};
+
 void LocalRendezvous::ItemQueue::push_back(Item* item) {
   if (TF_PREDICT_TRUE(head == nullptr)) {
     // The queue is empty.
@@ -138,18 +177,167 @@ LocalRendezvous::~LocalRendezvous() {
   if (table_not_empty) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
+  // Static slots are only used with a refcounted owner, and a parked sender
+  // or receiver, as well as a pending cancellation callback, holds a reference
+  // to it, so no slot is in use here.
+  delete static_slots_.load(std::memory_order_acquire);
 }
 
 namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+LocalRendezvous::StaticSlot* LocalRendezvous::FindStaticSlot(
+    const Rendezvous::ParsedKey& key) {
+  // A parked sender or receiver keeps the owner alive through its reference,
+  // which is what makes it safe to complete the handoff without a lock.
+  if (key.static_table_id == 0 || rc_owner_ == nullptr) {
+    return nullptr;
+  }
+  StaticSlotTable* table = static_slots_.load(std::memory_order_acquire);
+  if (TF_PREDICT_FALSE(table == nullptr)) {
+    auto* new_table =
+        new StaticSlotTable(key.static_table_id, key.static_table_size);
+    if (static_slots_.compare_exchange_strong(table, new_table,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+      table = new_table;
+    } else {
+      delete new_table;
+    }
+  }
+  if (table->id != key.static_table_id || key.static_slot < 0 ||
+      key.static_slot >= table->size) {
+    return nullptr;
+  }
+  return &table->slots[key.static_slot];
+}
+
+bool LocalRendezvous::SendToStaticSlot(StaticSlot* slot,
+                                       const Rendezvous::Args& send_args,
+                                       const Tensor& val, bool is_dead) {
+  if (slot->send_claimed.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+  slot->send_args = send_args;
+  if (send_args.device_context) {
+    send_args.device_context->Ref();
+  }
+  slot->value = val;
+  slot->is_dead = is_dead;
+  slot->send_owner = tsl::core::GetNewRef(rc_owner_);
+  const uint8 prev = slot->state.fetch_or(StaticSlot::kSendArrived,
+                                          std::memory_order_acq_rel);
+  if (prev & StaticSlot::kRecvArrived) {
+    DeliverStaticSlot(slot);
+  }
+  return true;
+}
+
+bool LocalRendezvous::RecvFromStaticSlot(StaticSlot* slot,
+                                         const Rendezvous::Args& recv_args,
+                                         Rendezvous::DoneCallback* done) {
+  if (slot->recv_claimed.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+  slot->recv_args = recv_args;
+  if (recv_args.device_context) {
+    recv_args.device_context->Ref();
+  }
+  slot->recv_owner = tsl::core::GetNewRef(rc_owner_);
+  CancellationManager* cm = recv_args.cancellation_manager;
+  // Reference to the owner held on behalf of a cancellation callback that was
+  // never registered, released once the slot is no longer accessed here.
+  Rendezvous* unregistered_callback_owner = nullptr;
+  if (cm == nullptr) {
+    slot->waiter = std::move(*done);
+  } else {
+    CancellationToken token = cm->get_cancellation_token();
+    // TryDeregisterCallback doesn't wait for a cancellation callback that is
+    // already running, so the callback may still access the slot after the
+    // waiter has run and released `recv_owner`. The callback holds its own
+    // reference to the owner, which keeps this rendezvous and its slots
+    // alive. The waiter releases it if the callback will never run, and the
+    // callback releases it when it is done otherwise.
+    Rendezvous* owner = rc_owner_;
+    owner->Ref();
+    // As in the hashed path, the cancellation callback must be deregistered
+    // before `done` runs, because `cm` may be gone afterwards.
+    slot->waiter = [cm, token, owner, done = std::move(*done)](
+                       const Status& s, const Rendezvous::Args& send_args,
+                       const Rendezvous::Args& recv_args, const Tensor& v,
+                       bool dead) {
+      if (cm->TryDeregisterCallback(token)) {
+        owner->Unref();
+      }
+      done(s, send_args, recv_args, v, dead);
+    };
+    const bool already_cancelled =
+        !cm->RegisterCallback(token, [this, slot, owner] {
+          CancelStaticSlot(slot, StatusGroup::MakeDerived(errors::Cancelled(
+                                     "RecvAsync is cancelled.")));
+          owner->Unref();
+        });
+    if (already_cancelled) {
+      unregistered_callback_owner = owner;
+      CancelStaticSlot(slot, StatusGroup::MakeDerived(errors::Cancelled(
+                                 "RecvAsync is cancelled.")));
+    }
+  }
+  const uint8 prev = slot->state.fetch_or(StaticSlot::kRecvArrived,
+                                          std::memory_order_acq_rel);
+  if (prev & StaticSlot::kSendArrived) {
+    DeliverStaticSlot(slot);
+  }
+  if (unregistered_callback_owner != nullptr) {
+    unregistered_callback_owner->Unref();
+  }
+  return true;
+}
+
+void LocalRendezvous::CancelStaticSlot(StaticSlot* slot,
+                                       const Status& status) {
+  // Take the place of the sender. If the real Send has already claimed the
+  // slot, the value it carries wins and the cancellation is a no-op.
+  if (slot->send_claimed.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  slot->send_status = status;
+  const uint8 prev = slot->state.fetch_or(StaticSlot::kSendArrived,
+                                          std::memory_order_acq_rel);
+  if (prev & StaticSlot::kRecvArrived) {
+    DeliverStaticSlot(slot);
+  }
+}
+
+void LocalRendezvous::DeliverStaticSlot(StaticSlot* slot) {
+  // Move everything out of the slot first: releasing the owner references
+  // may destroy this rendezvous, and with it the slot.
+  Rendezvous::DoneCallback waiter = std::move(slot->waiter);
+  Tensor value = std::move(slot->value);
+  tsl::core::RefCountPtr<Rendezvous> send_owner = std::move(slot->send_owner);
+  tsl::core::RefCountPtr<Rendezvous> recv_owner = std::move(slot->recv_owner);
+  const Rendezvous::Args send_args = slot->send_args;
+  const Rendezvous::Args recv_args = slot->recv_args;
+  if (waiter) {
+    if (slot->send_status.ok()) {
+      waiter(absl::OkStatus(), send_args, recv_args, value, slot->is_dead);
+    } else {
+      waiter(slot->send_status, Rendezvous::Args(), recv_args, Tensor(),
+             /*is_dead=*/false);
+    }
+  }
+  if (send_args.device_context) {
+    send_args.device_context->Unref();
+  }
+  if (recv_args.device_context) {
+    recv_args.device_context->Unref();
+  }
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
-  uint64 key_hash = KeyHash(key.FullKey());
-  DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
-
   if (is_dead) {
     static auto* rendezvous_dead_values_sent = monitoring::Counter<2>::New(
         "/tensorflow/core/rendezvous_dead_values_sent",
@@ -162,6 +350,16 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   TF_RETURN_IF_ERROR(status());
 
+  StaticSlot* slot = FindStaticSlot(key);
+  if (slot != nullptr && SendToStaticSlot(slot, send_args, val, is_dead)) {
+    DVLOG(2) << "Send " << this << " slot " << key.static_slot << " "
+             << key.FullKey();
+    return absl::OkStatus();
+  }
+
+  uint64 key_hash = KeyHash(key.FullKey());
+  DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -227,10 +425,6 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 const Rendezvous::Args& recv_args,
                                 Rendezvous::DoneCallback done) {
-  uint64 key_hash = KeyHash(key.FullKey());
-  DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
-  tsl::core::RefCountPtr<Rendezvous> rc_keep_alive;
-
   auto s = status();
   if (!s.ok()) {
     // Rendezvous has been aborted.
@@ -238,6 +432,16 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     return;
   }
 
+  StaticSlot* slot = FindStaticSlot(key);
+  if (slot != nullptr && RecvFromStaticSlot(slot, recv_args, &done)) {
+    DVLOG(2) << "Recv " << this << " slot " << key.static_slot << " "
+             << key.FullKey();
+    return;
+  }
+
+  uint64 key_hash = KeyHash(key.FullKey());
+  DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -389,6 +593,7 @@ std::vector<tsl::core::RefCountPtr<Rendezvous> >&
 
 void LocalRendezvous::StartAbort(const Status& status) {
   DoAbort(status);
+  AbortStaticSlots(status);
 
   if (rc_owner_) {
     mutex_lock l(aborted_rendezs_mu_);
@@ -436,6 +641,27 @@ void LocalRendezvous::DoAbort(const Status& status) {
   }
 }
 
+void LocalRendezvous::AbortStaticSlots(const Status& status) {
+  StaticSlotTable* slots = static_slots_.load(std::memory_order_acquire);
+  if (slots == nullptr) return;
+  // The table only exists with a refcounted owner. Keep it alive while the
+  // references held by parked senders and receivers are released.
+  auto keep_alive = tsl::core::GetNewRef(rc_owner_);
+  for (int i = 0; i < slots->size; ++i) {
+    StaticSlot* slot = &slots->slots[i];
+    // Completes a parked receiver, then drains a parked sender by taking the
+    // place of the receiver.
+    CancelStaticSlot(slot, status);
+    if (!slot->recv_claimed.exchange(true, std::memory_order_acq_rel)) {
+      const uint8 prev = slot->state.fetch_or(StaticSlot::kRecvArrived,
+                                              std::memory_order_acq_rel);
+      if (prev & StaticSlot::kSendArrived) {
+        DeliverStaticSlot(slot);
+      }
+    }
+  }
+}
+
 Status LocalRendezvous::status() {
   tf_shared_lock ml(mu_);
   return status_;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -37,6 +38,12 @@ namespace tensorflow {
 // IntraProcessRendezvous or RemoteRendezvous. This class does not implement
 // RendezvousInterface because virtual dispatch to LocalRendezvous methods
 // is not expected to be needed.
+//
+// Keys with a static slot assignment (see ParsedKey::static_slot) are matched
+// through a flat array of preallocated slots instead of the hashed table. The
+// array is created for the first static table seen by this rendezvous; keys
+// of any other table, and keys seen while the owner is not refcounted, use
+// the hashed table.
 class LocalRendezvous {
  public:
   // If the class wrapping LocalRendezvous is refcounted (i.e., extending
@@ -70,6 +77,25 @@ class LocalRendezvous {
   tsl::core::RefCountPtr<Rendezvous> GetOwnerRefCountPtr();
 
   struct Item;
+  struct StaticSlot;
+  struct StaticSlotTable;
+
+  // Returns the preallocated slot for `key`, or nullptr if `key` has to be
+  // matched through the hashed table.
+  StaticSlot* FindStaticSlot(const Rendezvous::ParsedKey& key);
+  // Each of the following returns false if the corresponding side of `slot`
+  // has already been claimed, in which case the caller falls back to the
+  // hashed table.
+  bool SendToStaticSlot(StaticSlot* slot, const Rendezvous::Args& send_args,
+                        const Tensor& val, bool is_dead);
+  bool RecvFromStaticSlot(StaticSlot* slot, const Rendezvous::Args& recv_args,
+                          Rendezvous::DoneCallback* done);
+  // Completes a parked Recv on `slot` (or any later one) with `status`.
+  void CancelStaticSlot(StaticSlot* slot, const Status& status);
+  // Invokes the receiver's callback once both sides of `slot` have arrived.
+  void DeliverStaticSlot(StaticSlot* slot);
+  // Completes or drops everything parked in the static slots.
+  void AbortStaticSlots(const Status& status);
 
   // By invariant, the item queue under each key is of the form
   //   [item.type == kSend]* meaning each item is a sent message.
@@ -100,6 +126,9 @@ class LocalRendezvous {
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
+
+  // Lazily created on the first key with a static slot assignment.
+  std::atomic<StaticSlotTable*> static_slots_{nullptr};
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
 
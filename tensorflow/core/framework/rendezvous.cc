@@ -47,6 +47,9 @@ Rendezvous::ParsedKey& Rendezvous::ParsedKey::operator=(const ParsedKey& b) {
   dst = b.dst;
   edge_name = StringPiece(buf_.data() + (b.edge_name.data() - b_base),
                           b.edge_name.size());
+  static_table_id = b.static_table_id;
+  static_table_size = b.static_table_size;
+  static_slot = b.static_slot;
   return *this;
 }
 
@@ -53,6 +53,9 @@ class RendezvousInterface {
     DeviceContext* device_context = nullptr;
     AllocatorAttributes alloc_attrs;
     CancellationManager* cancellation_manager = nullptr;  // not owned.
+    // TensorTransferCompression::Codec requested by the receiver when the
+    // tensor is transferred from another task. Ignored by local transfers.
+    int32 wire_codec = 0;
   };
 
   // Parses the key constructed by CreateKey and parse src/dst device
@@ -68,6 +71,14 @@ class RendezvousInterface {
     ParsedKey() {}
     ParsedKey(const ParsedKey& b) { *this = b; }
 
+    // If non-zero, the key belongs to a pair of Send/Recv nodes that were
+    // matched statically when their graph was registered, and `static_slot`
+    // is the fixed index of the pair among the `static_table_size` pairs of
+    // that graph. See LocalRendezvous for how the slot is used.
+    int64_t static_table_id = 0;
+    int32 static_table_size = 0;
+    int32 static_slot = -1;
+
     ParsedKey& operator=(const ParsedKey& b);
     StringPiece FullKey() const { return buf_; }
 
@@ -166,6 +177,17 @@ class Rendezvous : public RendezvousInterface, public core::WeakRefCounted {
   static Status ParseKey(StringPiece key, ParsedKey* out);
 };
 
+// Names of the node attributes that record the static slot assignment of a
+// Send/Recv node (see ParsedKey::static_slot).
+inline constexpr char kStaticRendezvousTableAttr[] = "_static_rendezvous_table";
+inline constexpr char kStaticRendezvousNumSlotsAttr[] =
+    "_static_rendezvous_num_slots";
+inline constexpr char kStaticRendezvousSlotAttr[] = "_static_rendezvous_slot";
+
+// Name of the int attribute of a _Recv node that records the wire codec to
+// request for its cross-task transfer (see Args::wire_codec).
+inline constexpr char kRecvWireCodecAttr[] = "_recv_wire_codec";
+
 // Returns a Rendezvous instance that is limited to use only by
 // producers and consumers in the local process.  The caller assumes
 // ownership of one Ref() on the returned object.
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
@@ -434,6 +435,151 @@ TEST_F(LocalRendezvousTest, TransferDummyDeviceContext) {
   args1.device_context->Unref();
 }
 
+Rendezvous::ParsedKey MakeStaticKey(const string& name, int64_t table_id,
+                                    int32 num_slots, int32 slot) {
+  Rendezvous::ParsedKey k = MakeKey(name);
+  k.static_table_id = table_id;
+  k.static_table_size = num_slots;
+  k.static_slot = slot;
+  return k;
+}
+
+TEST_F(LocalRendezvousTest, StaticSlotSendRecv) {
+  const auto key = MakeStaticKey("foo", 1, 2, 0);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(key, args, V("hello"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(key, args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, StaticSlotRecvSend) {
+  const auto key = MakeStaticKey("foo", 1, 2, 1);
+  SchedClosure([this, key]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(key, args, V("hello"), false));
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Recv(key, args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+// Only the first Send/Recv pair goes through the slot. The remaining ones
+// fall back to the hashed table and must still be received in order.
+TEST_F(LocalRendezvousTest, StaticSlotMultiSends) {
+  static const int N = 10;
+  const auto key = MakeStaticKey("foo", 1, 1, 0);
+  Rendezvous::Args args;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Send(key, args, V(strings::StrCat(i)), false));
+  }
+  Tensor val;
+  bool val_dead;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Recv(key, args, &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+  }
+}
+
+// The rendezvous binds to the first static table it sees. Keys of another
+// table are matched through the hashed table.
+TEST_F(LocalRendezvousTest, StaticSlotOtherTable) {
+  const auto key_foo = MakeStaticKey("foo", 1, 1, 0);
+  const auto key_bar = MakeStaticKey("bar", 2, 1, 0);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(key_foo, args, V("foo"), false));
+  TF_ASSERT_OK(rendez_->Send(key_bar, args, V("bar"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(key_bar, args, &val, &is_dead));
+  EXPECT_EQ("bar", V(val));
+  TF_ASSERT_OK(rendez_->Recv(key_foo, args, &val, &is_dead));
+  EXPECT_EQ("foo", V(val));
+}
+
+TEST_F(LocalRendezvousTest, StaticSlotCancelAfterRecv) {
+  const auto key = MakeStaticKey("foo", 1, 1, 0);
+  auto* cm = new CancellationManager();
+  Notification n;
+  SchedClosure([cm, &n]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    cm->StartCancel();
+    n.Notify();
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  args.cancellation_manager = cm;
+  auto s = rendez_->Recv(key, args, &val, &is_dead);
+  EXPECT_TRUE(absl::IsCancelled(s));
+  EXPECT_EQ("RecvAsync is cancelled.", s.message());
+  n.WaitForNotification();
+  delete cm;
+}
+
+// The cancellation callback may still run after a racing Send has completed
+// the Recv and the last reference to the rendezvous is gone. It must keep the
+// rendezvous, and the slot it accesses, alive.
+TEST_F(LocalRendezvousTest, StaticSlotCancelRacesWithSend) {
+  const auto key = MakeStaticKey("foo", 1, 1, 0);
+  for (int i = 0; i < 100; ++i) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    CancellationManager cm;
+    Rendezvous::Args args;
+    args.cancellation_manager = &cm;
+    Notification recv_done;
+    rendez->RecvAsync(key, args,
+                      [&recv_done](const Status&, const Rendezvous::Args&,
+                                   const Rendezvous::Args&, const Tensor&,
+                                   bool) { recv_done.Notify(); });
+
+    // The rendezvous is released by the sender, so observe it weakly.
+    const core::WeakPtr<Rendezvous> weak_rendez(rendez);
+    Notification send_done;
+    Notification cancel_done;
+    SchedClosure([rendez, &key, &send_done]() {
+      TF_EXPECT_OK(rendez->Send(key, Rendezvous::Args(), V("hello"), false));
+      rendez->Unref();
+      send_done.Notify();
+    });
+    SchedClosure([&cm, &cancel_done]() {
+      cm.StartCancel();
+      cancel_done.Notify();
+    });
+    recv_done.WaitForNotification();
+    send_done.WaitForNotification();
+    cancel_done.WaitForNotification();
+
+    // If the cancellation won, the value was parked in the hashed table, and
+    // keeps the rendezvous alive until it is received.
+    if (auto parked = weak_rendez.GetNewRef()) {
+      Tensor val(DT_STRING);
+      bool is_dead = false;
+      TF_ASSERT_OK(parked->Recv(key, Rendezvous::Args(), &val, &is_dead));
+      EXPECT_EQ("hello", V(val));
+    }
+  }
+}
+
+TEST_F(LocalRendezvousTest, StaticSlotRecvAbort) {
+  const auto key = MakeStaticKey("foo", 1, 1, 0);
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    rendez_->StartAbort(errors::Aborted(""));  // abort
+    rendez_->Unref();
+  });
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  Rendezvous::Args args;
+  Status status = rendez_->Recv(key, args, &val, &val_dead);
+  EXPECT_TRUE(absl::IsAborted(status));
+}
+
 void BM_SendRecv(::testing::benchmark::State& state) {
   Rendezvous* rendez = NewLocalRendezvous();
   Tensor orig = V("val");
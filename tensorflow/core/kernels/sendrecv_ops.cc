@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -44,6 +45,22 @@ static void GetRendezvousKey(const string& key_prefix,
                      frame_iter.iter_id);
 }
 
+// Copies the static slot assignment made by GraphMgr, if any, onto the cached
+// top-level rendezvous key.
+static void GetStaticRendezvousSlot(OpKernelConstruction* ctx,
+                                    Rendezvous::ParsedKey* parsed_key) {
+  int64_t table_id;
+  int64_t num_slots;
+  int64_t slot;
+  if (ctx->GetAttr(kStaticRendezvousTableAttr, &table_id).ok() &&
+      ctx->GetAttr(kStaticRendezvousNumSlotsAttr, &num_slots).ok() &&
+      ctx->GetAttr(kStaticRendezvousSlotAttr, &slot).ok()) {
+    parsed_key->static_table_id = table_id;
+    parsed_key->static_table_size = static_cast<int32>(num_slots);
+    parsed_key->static_slot = static_cast<int32>(slot);
+  }
+}
+
 static FrameAndIter GetFrameAndIter(OpKernelContext* ctx,
                                     bool hostmem_sendrecv) {
   if (hostmem_sendrecv && ctx->call_frame() != nullptr) {
@@ -74,6 +91,7 @@ SendOp::SendOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
   // proactively cache the rendezvous key for the top-level.
   GetRendezvousKey(key_prefix_, {0, 0}, &parsed_key_.buf_);
   OP_REQUIRES_OK(ctx, Rendezvous::ParseKey(parsed_key_.buf_, &parsed_key_));
+  GetStaticRendezvousSlot(ctx, &parsed_key_);
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
@@ -155,9 +173,13 @@ RecvOp::RecvOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
   // proactively cache the rendezvous key for the top-level.
   GetRendezvousKey(key_prefix_, {0, 0}, &parsed_key_.buf_);
   OP_REQUIRES_OK(ctx, Rendezvous::ParseKey(parsed_key_.buf_, &parsed_key_));
+  GetStaticRendezvousSlot(ctx, &parsed_key_);
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  if (!ctx->GetAttr(kRecvWireCodecAttr, &wire_codec_).ok()) {
+    wire_codec_ = 0;
+  }
 }
 
 string RecvOp::TraceString(const OpKernelContext& ctx, bool verbose) const {
@@ -203,6 +225,7 @@ void RecvOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   args.device_context = ctx->op_device_context();
   args.alloc_attrs = ctx->output_alloc_attr(0);
   args.cancellation_manager = ctx->cancellation_manager();
+  args.wire_codec = wire_codec_;
 
   FrameAndIter frame_iter = GetFrameAndIter(ctx, hostmem_sendrecv_);
   if (frame_iter == FrameAndIter(0, 0)) {
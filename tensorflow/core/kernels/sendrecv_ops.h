@@ -48,6 +48,7 @@ class RecvOp : public AsyncOpKernel {
   string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
   bool hostmem_sendrecv_;
+  int32 wire_codec_ = 0;
 
   RecvOp(const RecvOp&) = delete;
   void operator=(const RecvOp&) = delete;
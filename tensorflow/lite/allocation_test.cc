@@ -16,11 +16,15 @@ limitations under the License.
 
 #if defined(__linux__)
 #include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include <sys/stat.h>
 
+#include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "tensorflow/lite/testing/util.h"
@@ -140,6 +144,43 @@ TEST(MMAPAllocation, TestValidFileDescriptorWithOffset) {
 
   close(fd);
 }
+
+TEST(MMAPAllocation, TestPrefetchAndReleasePages) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  const size_t page_size = sysconf(_SC_PAGE_SIZE);
+  std::vector<char> contents(3 * page_size + 10);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = static_cast<char>(i % 251);
+  }
+  const std::string path = ::testing::TempDir() + "/mmap_allocation_pages.bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(fwrite(contents.data(), contents.size(), 1, file), 1);
+  ASSERT_EQ(fclose(file), 0);
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation(path.c_str(), &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+  const char* data = static_cast<const char*>(allocation.base());
+
+  EXPECT_TRUE(allocation.Prefetch(data + 1, page_size));
+  EXPECT_TRUE(allocation.Prefetch(data, allocation.bytes()));
+  // Covers one whole page only.
+  EXPECT_TRUE(allocation.ReleasePages(data + 1, 2 * page_size));
+  // Covers no whole page.
+  EXPECT_TRUE(allocation.ReleasePages(data + 1, 1));
+  EXPECT_TRUE(allocation.ReleasePages(data, allocation.bytes()));
+
+  // Ranges outside of the mapping.
+  EXPECT_FALSE(allocation.Prefetch(data, allocation.bytes() + 1));
+  EXPECT_FALSE(allocation.ReleasePages(contents.data(), 1));
+
+  // Released pages are read from the file again.
+  EXPECT_EQ(memcmp(data, contents.data(), contents.size()), 0);
+}
 #endif  // defined(__linux__)
 
 }  // namespace tflite
@@ -37,7 +37,8 @@ constexpr int32_t kScalarTensorBytes = 4;
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
-                           int subgraph_index)
+                           int subgraph_index, int plan_cache_size,
+                           bool bucket_plan_sizes)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment, subgraph_index),
@@ -45,7 +46,11 @@ ArenaPlanner::ArenaPlanner(TfLiteContext* context,
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
-      last_active_node_(kLastActiveNodeUndefined) {}
+      last_active_node_(kLastActiveNodeUndefined),
+      plan_cache_size_(plan_cache_size),
+      bucket_plan_sizes_(bucket_plan_sizes),
+      plan_is_fresh_(true),
+      num_plan_cache_hits_(0) {}
 
 ArenaPlanner::~ArenaPlanner() {
   arena_.ReleaseBuffer();
@@ -71,6 +76,7 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
   // all allocs to be cleared. if this is not set, the slow path is taken
   // (Purge) which inspects each alloc. Both paths give the exact same result.
   last_active_node_ = kLastActiveNodeUndefined;
+  plan_is_fresh_ = true;
   return kTfLiteOk;
 }
 
@@ -205,6 +211,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  // Cached plans depend on the tensor lifetimes computed below.
+  plan_cache_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -221,7 +229,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    alloc_node_[tensor] = node;
+    alloc_node_[tensor] = StageFirstNode(node);
     return kTfLiteOk;
   };
 
@@ -232,7 +240,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    dealloc_node_[tensor] = node;
+    dealloc_node_[tensor] = StageLastNode(node);
     return kTfLiteOk;
   };
 
@@ -352,10 +360,10 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = StageFirstNode(i);
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = StageLastNode(i);
       }
     }
   }
@@ -416,6 +424,27 @@ bool ArenaPlanner::HasNonPersistentMemory() {
   return has_nonpersistent_memory_;
 }
 
+void ArenaPlanner::SetConcurrentStages(const std::vector<int>& stage_begin) {
+  stage_begin_ = stage_begin;
+}
+
+int ArenaPlanner::StageFirstNode(int node) const {
+  auto next_stage =
+      std::upper_bound(stage_begin_.begin(), stage_begin_.end(), node);
+  if (next_stage == stage_begin_.begin()) return node;
+  return *(next_stage - 1);
+}
+
+int ArenaPlanner::StageLastNode(int node) const {
+  auto next_stage =
+      std::upper_bound(stage_begin_.begin(), stage_begin_.end(), node);
+  if (next_stage == stage_begin_.begin()) return node;
+  if (next_stage == stage_begin_.end()) {
+    return std::max<int>(node, graph_info_->num_execution_nodes() - 1);
+  }
+  return *next_stage - 1;
+}
+
 void ArenaPlanner::DumpDebugInfo(const std::vector<int>& execution_plan) const {
   arena_.DumpDebugInfo("kTfLiteArenaRw Dump:", execution_plan);
   persistent_arena_.DumpDebugInfo("kTfLiteArenaRwPersistent Dump:",
@@ -505,11 +534,24 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     }
   }
 
+  // Only plans started from scratch are cached, since they do not depend on
+  // allocations made by earlier calls.
+  const bool cacheable = plan_cache_size_ > 0 && plan_is_fresh_ &&
+                         first_node == 0 && !tensors_allocated->empty();
+  plan_is_fresh_ = false;
   if (tensors_allocated->empty()) {
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
-  if (first_node < last_active_node_) {
+  std::vector<PlannedTensor> planned_tensors;
+  bool restored = false;
+  if (cacheable) {
+    planned_tensors = GetPlannedTensors(*tensors_allocated);
+    restored = RestoreCachedPlan(last_node, planned_tensors);
+  }
+  if (restored) {
+    ++num_plan_cache_hits_;
+  } else if (first_node < last_active_node_) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
   } else {
@@ -517,10 +559,16 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     // exection faster.
     arena_.PurgeActiveAllocs(first_node);
   }
-  CreateTensorAllocationVector(tensors_allocated);
+  if (!restored) CreateTensorAllocationVector(tensors_allocated);
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
+    if (restored) {
+      // The cached plan already placed all ArenaRw tensors and decided which
+      // of them share a buffer.
+      if (actual_tensor_id_.count(tensor_index) != 0) continue;
+      if (tensor.allocation_type == kTfLiteArenaRw) continue;
+    }
     // Only allocate ArenaRw tensors which own their buffer.
     auto it = actual_tensor_id_.find(tensor_index);
     if (it != actual_tensor_id_.end()) {
@@ -541,10 +589,11 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(
+          context_, tensor_alignment_,
+          cacheable ? PlannedBytes(tensor) : tensor.bytes, tensor_index,
+          alloc_node_[tensor_index], dealloc_node_[tensor_index],
+          &allocs_[tensor_index]));
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -559,10 +608,81 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  if (cacheable && !restored) {
+    CachePlan(last_node, std::move(planned_tensors));
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+size_t ArenaPlanner::PlannedBytes(const TfLiteTensor& tensor) const {
+  if (!bucket_plan_sizes_ || tensor.bytes == 0) return tensor.bytes;
+  size_t bytes = 1;
+  while (bytes < tensor.bytes) bytes <<= 1;
+  return bytes;
+}
+
+std::vector<ArenaPlanner::PlannedTensor> ArenaPlanner::GetPlannedTensors(
+    const std::vector<int32_t>& tensors_allocated) const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<PlannedTensor> planned;
+  planned.reserve(tensors_allocated.size());
+  for (int32_t tensor_index : tensors_allocated) {
+    const TfLiteTensor& tensor = tensors[tensor_index];
+    if (tensor.allocation_type != kTfLiteArenaRw) continue;
+    planned.push_back({tensor_index, PlannedBytes(tensor),
+                       alloc_node_[tensor_index], dealloc_node_[tensor_index]});
+  }
+  std::sort(planned.begin(), planned.end(),
+            [](const PlannedTensor& a, const PlannedTensor& b) {
+              return a.tensor < b.tensor;
+            });
+  return planned;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(
+    int last_node, const std::vector<PlannedTensor>& tensors) {
+  const TfLiteTensor* graph_tensors = graph_info_->tensors();
+  for (auto it = plan_cache_.begin(); it != plan_cache_.end(); ++it) {
+    if (it->last_node != last_node || it->tensors != tensors) continue;
+    // Buffer sharing requires equal sizes, which bucketed sizes do not
+    // guarantee.
+    for (const auto& shared : it->actual_tensor_id) {
+      if (graph_tensors[shared.first].bytes !=
+              graph_tensors[shared.second].bytes ||
+          graph_tensors[shared.second].allocation_type != kTfLiteArenaRw) {
+        plan_cache_.erase(it);
+        return false;
+      }
+    }
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      allocs_[tensors[i].tensor] = it->allocs[i];
+    }
+    actual_tensor_id_ = it->actual_tensor_id;
+    arena_.RestorePlan(it->allocs, it->arena_size);
+    plan_cache_.splice(plan_cache_.begin(), plan_cache_, it);
+    return true;
+  }
+  return false;
+}
+
+void ArenaPlanner::CachePlan(int last_node,
+                             std::vector<PlannedTensor> tensors) {
+  CachedPlan plan;
+  plan.last_node = last_node;
+  plan.allocs.reserve(tensors.size());
+  for (const PlannedTensor& planned : tensors) {
+    plan.allocs.push_back(allocs_[planned.tensor]);
+  }
+  plan.tensors = std::move(tensors);
+  plan.actual_tensor_id = actual_tensor_id_;
+  plan.arena_size = arena_.GetPlannedSize();
+  plan_cache_.push_front(std::move(plan));
+  if (plan_cache_.size() > static_cast<size_t>(plan_cache_size_)) {
+    plan_cache_.pop_back();
+  }
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -51,9 +52,18 @@ class ArenaPlanner : public MemoryPlanner {
   // ArenaPlanner is destroyed. The inputs to the graph will not share
   // memory with any other tensor, effectively preserving them until the end
   // of inference.
+  //
+  // If 'plan_cache_size' is positive, the planner remembers that many arena
+  // plans, keyed by the sizes and lifetimes of the tensors they place, and
+  // restores a remembered plan instead of replanning when the same sizes come
+  // back after ResetAllocations(). With 'bucket_plan_sizes', cached plans
+  // reserve the next power of two bytes for every tensor so that nearby
+  // sizes share a plan. The cache only saves the placement of tensors in the
+  // arena; the caller still prepares the nodes that compute their sizes.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_all_tensors, int tensor_alignment,
-               int subgraph_index = 0);
+               int subgraph_index = 0, int plan_cache_size = 0,
+               bool bucket_plan_sizes = false);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -68,11 +78,62 @@ class ArenaPlanner : public MemoryPlanner {
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
+  void SetConcurrentStages(const std::vector<int>& stage_begin) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Returns the number of arena plans restored from the plan cache.
+  int64_t num_plan_cache_hits() const { return num_plan_cache_hits_; }
+
  private:
+  // Size and lifetime of a kTfLiteArenaRw tensor placed by a cached plan.
+  struct PlannedTensor {
+    int32_t tensor;
+    size_t bytes;
+    int32_t first_node;
+    int32_t last_node;
+
+    bool operator==(const PlannedTensor& other) const {
+      return tensor == other.tensor && bytes == other.bytes &&
+             first_node == other.first_node && last_node == other.last_node;
+    }
+  };
+
+  // An arena plan for the tensors of nodes [0, last_node].
+  struct CachedPlan {
+    int32_t last_node;
+    // Sorted by tensor index.
+    std::vector<PlannedTensor> tensors;
+    // allocs_ entry of each of `tensors`.
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+    size_t arena_size;
+  };
+
+  // Returns the number of bytes reserved for 'tensor' in the arena.
+  size_t PlannedBytes(const TfLiteTensor& tensor) const;
+
+  // Returns the kTfLiteArenaRw tensors of 'tensors_allocated', sorted by
+  // index, as they would be placed by a plan.
+  std::vector<PlannedTensor> GetPlannedTensors(
+      const std::vector<int32_t>& tensors_allocated) const;
+
+  // Restores the cached plan for 'tensors' and 'last_node', if any, and moves
+  // it to the front of the cache. Returns false if there is no usable plan.
+  bool RestoreCachedPlan(int last_node,
+                         const std::vector<PlannedTensor>& tensors);
+
+  // Adds the plan just computed for 'tensors' to the front of the cache,
+  // evicting the least recently used plan if the cache is full.
+  void CachePlan(int last_node, std::vector<PlannedTensor> tensors);
+
+  // Returns the first and last execution-plan index of the concurrent stage
+  // containing 'node'. Without stages every node is a stage of its own.
+  int StageFirstNode(int node) const;
+  int StageLastNode(int node) const;
+
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
   // example, `Reshape` doesn't modify data but Add does.
@@ -166,6 +227,26 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Start of each stage of nodes that may execute concurrently. Tensors are
+  // allocated at the start of the stage of their first use and deallocated at
+  // the end of the stage of their last use.
+  std::vector<int> stage_begin_;
+
+  // Maximum number of entries in plan_cache_.
+  int plan_cache_size_;
+
+  // If true, cached plans round tensor sizes up to powers of two.
+  bool bucket_plan_sizes_;
+
+  // True between ResetAllocations() and the next CalculateAllocations(), i.e.
+  // while the next allocation starts a plan from scratch.
+  bool plan_is_fresh_;
+
+  // Recently used plans, most recently used first.
+  std::list<CachedPlan> plan_cache_;
+
+  int64_t num_plan_cache_hits_;
 };
 
 }  // namespace tflite
@@ -208,12 +208,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false) {
+  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false,
+                int plan_cache_size = 0, bool bucket_plan_sizes = false) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_ = std::make_unique<ArenaPlanner>(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_all_tensors, kTensorAlignment);
+        preserve_all_tensors, kTensorAlignment, /*subgraph_index=*/0,
+        plan_cache_size, bucket_plan_sizes);
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -1101,6 +1103,113 @@ TEST_F(ArenaPlannerTest, DebugTensorsInputReuse) {
   EXPECT_NE(GetOffset(4), GetOffset(5));
 }
 
+TEST_F(ArenaPlannerTest, PlanCacheRestoresOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_all_tensors=*/false, /*plan_cache_size=*/2);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i <= 5; ++i) offsets.push_back(GetOffset(i));
+
+  // A new size for an intermediate tensor needs a new plan.
+  (*graph.tensors())[2].bytes = 100;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(planner_->num_plan_cache_hits(), 0);
+
+  // Going back to the original size reuses the first plan.
+  (*graph.tensors())[2].bytes = 9;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(planner_->num_plan_cache_hits(), 1);
+  for (int i = 0; i <= 5; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheEvictsLeastRecentlyUsed) {
+  TestGraph graph({0, 1}, {{{0, 1}, {2}, {}}, {{2}, {3}, {}}}, {3});
+  SetGraph(&graph, /*preserve_all_tensors=*/false, /*plan_cache_size=*/1);
+  Execute(0, graph.nodes().size() - 1);
+
+  (*graph.tensors())[2].bytes = 100;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+
+  // The plan for the original sizes was evicted by the second one.
+  (*graph.tensors())[2].bytes = 9;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(planner_->num_plan_cache_hits(), 0);
+
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(planner_->num_plan_cache_hits(), 1);
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheBucketsSizes) {
+  TestGraph graph({0, 1}, {{{0, 1}, {2}, {}}, {{2}, {3}, {}}}, {3});
+  (*graph.tensors())[2].bytes = 40;
+  SetGraph(&graph, /*preserve_all_tensors=*/false, /*plan_cache_size=*/1,
+           /*bucket_plan_sizes=*/true);
+  Execute(0, graph.nodes().size() - 1);
+  const std::ptrdiff_t offset = GetOffset(2);
+  size_t arena_size = 0;
+  size_t persistent_size = 0;
+  planner_->GetAllocInfo(&arena_size, &persistent_size);
+
+  // 40 and 60 bytes are both planned as 64 bytes.
+  (*graph.tensors())[2].bytes = 60;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(planner_->num_plan_cache_hits(), 1);
+  EXPECT_EQ(GetOffset(2), offset);
+  size_t new_arena_size = 0;
+  planner_->GetAllocInfo(&new_arena_size, &persistent_size);
+  EXPECT_EQ(new_arena_size, arena_size);
+
+  (*graph.tensors())[2].bytes = 65;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(planner_->num_plan_cache_hits(), 1);
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentStagesDoNotShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {5}},   // First op
+                      {{0}, {3}, {6}},   // Second op, independent of the first
+                      {{1}, {2}, {}},    // Third op
+                      {{2, 3}, {4}, {}}  // Fourth op
+                  },
+                  {4});
+  (*graph.tensors())[6].bytes = (*graph.tensors())[5].bytes;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // Run one at a time, the first two ops use the same temporary buffer.
+  EXPECT_EQ(GetOffset(5), GetOffset(6));
+
+  // Run concurrently, they must not.
+  planner_->SetConcurrentStages({0, 2, 3});
+  ASSERT_EQ(planner_->PlanAllocations(), kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_TRUE(GetOffsetAfter(5) <= GetOffset(6) ||
+              GetOffsetAfter(6) <= GetOffset(5));
+
+  // Going back to sequential execution shares the buffer again.
+  planner_->SetConcurrentStages({});
+  ASSERT_EQ(planner_->PlanAllocations(), kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(5), GetOffset(6));
+}
+
 TEST_F(ArenaPlannerTest, SimpleProfilerTest) {
   gNumAlloc = 0;
   gNumDealloc = 0;
@@ -0,0 +1,298 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/batching_signature_runner.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace impl {
+
+BatchingSignatureRunner::BatchingSignatureRunner(
+    std::vector<SignatureRunner*> runners, const Options& options)
+    : runners_(std::move(runners)),
+      options_(options),
+      runner_batch_sizes_(runners_.size(), 0) {}
+
+std::unique_ptr<BatchingSignatureRunner> BatchingSignatureRunner::Create(
+    SignatureRunner* runner, const Options& options) {
+  if (runner == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Invalid BatchingSignatureRunner options.");
+    return nullptr;
+  }
+  return CreateImpl({runner}, options);
+}
+
+std::unique_ptr<BatchingSignatureRunner> BatchingSignatureRunner::Create(
+    const std::vector<SignatureRunner*>& runners, const Options& options) {
+  if (runners.size() != options.allowed_batch_sizes.size() ||
+      std::count(runners.begin(), runners.end(), nullptr) != 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "BatchingSignatureRunner needs one runner per allowed "
+                    "batch size.");
+    return nullptr;
+  }
+  return CreateImpl(runners, options);
+}
+
+std::unique_ptr<BatchingSignatureRunner> BatchingSignatureRunner::CreateImpl(
+    std::vector<SignatureRunner*> runners, const Options& options) {
+  if (runners.empty() || options.max_batch_size < 1 ||
+      options.max_enqueued_batches < 1 || options.batch_timeout_micros < 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Invalid BatchingSignatureRunner options.");
+    return nullptr;
+  }
+  const std::vector<int>& allowed = options.allowed_batch_sizes;
+  if (!allowed.empty() &&
+      (allowed.front() < 1 || allowed.back() != options.max_batch_size ||
+       !std::is_sorted(allowed.begin(), allowed.end()))) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "allowed_batch_sizes must be increasing, positive and end "
+                    "with max_batch_size (%d).",
+                    options.max_batch_size);
+    return nullptr;
+  }
+  std::unique_ptr<BatchingSignatureRunner> batching_runner(
+      new BatchingSignatureRunner(std::move(runners), options));
+  if (batching_runner->Initialize() != kTfLiteOk) return nullptr;
+  batching_runner->batch_thread_ =
+      std::thread([r = batching_runner.get()] { r->BatchLoop(); });
+  return batching_runner;
+}
+
+BatchingSignatureRunner::~BatchingSignatureRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queue_changed_.notify_all();
+  if (batch_thread_.joinable()) batch_thread_.join();
+}
+
+TfLiteStatus BatchingSignatureRunner::Initialize() {
+  SignatureRunner* runner = runners_.front();
+  for (const char* name : runner->input_names()) {
+    const TfLiteTensor* tensor = runner->input_tensor(name);
+    if (tensor == nullptr || tensor->dims == nullptr ||
+        tensor->dims->size < 1 || tensor->type == kTfLiteString ||
+        tensor->type == kTfLiteResource || tensor->type == kTfLiteVariant) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Signature input '%s' cannot be batched.", name);
+      return kTfLiteError;
+    }
+    input_dims_.emplace_back(tensor->dims->data,
+                             tensor->dims->data + tensor->dims->size);
+  }
+  // Sizes of a single example are read off the tensors allocated for a
+  // batch of one.
+  TF_LITE_ENSURE_STATUS(ResizeBatch(0, 1));
+  for (const char* name : runner->input_names()) {
+    input_example_bytes_.push_back(runner->input_tensor(name)->bytes);
+  }
+  for (const char* name : runner->output_names()) {
+    const TfLiteTensor* tensor = runner->output_tensor(name);
+    if (tensor == nullptr || tensor->dims == nullptr ||
+        tensor->dims->size < 1 || tensor->dims->data[0] != 1 ||
+        tensor->type == kTfLiteString) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Signature output '%s' is not batched along its first "
+                      "dimension.",
+                      name);
+      return kTfLiteError;
+    }
+    output_example_bytes_.push_back(tensor->bytes);
+  }
+  if (runners_.size() == 1) return kTfLiteOk;
+
+  // Each runner is allocated for its batch size once and for all.
+  for (size_t i = 0; i < runners_.size(); ++i) {
+    const int batch_size = options_.allowed_batch_sizes[i];
+    bool matches =
+        runners_[i]->input_names().size() == input_dims_.size() &&
+        runners_[i]->output_names().size() == output_example_bytes_.size() &&
+        ResizeBatch(i, batch_size) == kTfLiteOk &&
+        HasBatchedOutputs(runners_[i], batch_size);
+    for (size_t j = 0; matches && j < input_dims_.size(); ++j) {
+      matches = runners_[i]->input_tensor(runners_[i]->input_names()[j])
+                    ->bytes == batch_size * input_example_bytes_[j];
+    }
+    if (!matches) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Runner %zu does not match the signature of runner 0.",
+                      i);
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
+int BatchingSignatureRunner::PaddedBatchSize(int num_requests) const {
+  for (int size : options_.allowed_batch_sizes) {
+    if (size >= num_requests) return size;
+  }
+  return num_requests;
+}
+
+TfLiteStatus BatchingSignatureRunner::ResizeBatch(int runner_index,
+                                                  int batch_size) {
+  if (batch_size == runner_batch_sizes_[runner_index]) return kTfLiteOk;
+  SignatureRunner* runner = runners_[runner_index];
+  const std::vector<const char*>& names = runner->input_names();
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::vector<int> dims = input_dims_[i];
+    dims[0] = batch_size;
+    TF_LITE_ENSURE_STATUS(runner->ResizeInputTensor(names[i], dims));
+  }
+  // Forget the current size first, so that a failed allocation is retried.
+  runner_batch_sizes_[runner_index] = 0;
+  TF_LITE_ENSURE_STATUS(runner->AllocateTensors());
+  runner_batch_sizes_[runner_index] = batch_size;
+  return kTfLiteOk;
+}
+
+bool BatchingSignatureRunner::HasBatchedOutputs(SignatureRunner* runner,
+                                                int batch_size) const {
+  const std::vector<const char*>& names = runner->output_names();
+  for (size_t i = 0; i < names.size(); ++i) {
+    const TfLiteTensor* tensor = runner->output_tensor(names[i]);
+    if (tensor == nullptr || tensor->data.raw == nullptr ||
+        tensor->dims == nullptr || tensor->dims->size < 1 ||
+        tensor->dims->data[0] != batch_size ||
+        tensor->bytes != batch_size * output_example_bytes_[i]) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Signature output '%s' does not hold %d examples.",
+                      names[i], batch_size);
+      return false;
+    }
+  }
+  return true;
+}
+
+TfLiteStatus BatchingSignatureRunner::Run(
+    const std::vector<const void*>& inputs,
+    const std::vector<void*>& outputs) {
+  if (inputs.size() != input_example_bytes_.size() ||
+      outputs.size() != output_example_bytes_.size()) {
+    return kTfLiteError;
+  }
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = &outputs;
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (stopping_ ||
+      queue_.size() >= static_cast<size_t>(options_.max_enqueued_batches) *
+                           options_.max_batch_size) {
+    return kTfLiteError;
+  }
+  request.enqueue_time = std::chrono::steady_clock::now();
+  queue_.push_back(&request);
+  queue_changed_.notify_one();
+  request_done_.wait(lock, [&request] { return request.done; });
+  return request.status;
+}
+
+TfLiteStatus BatchingSignatureRunner::RunBatch(
+    const std::vector<Request*>& batch) {
+  const int num_requests = batch.size();
+  const int batch_size = PaddedBatchSize(num_requests);
+  int runner_index = 0;
+  if (runners_.size() > 1) {
+    runner_index = std::lower_bound(options_.allowed_batch_sizes.begin(),
+                                    options_.allowed_batch_sizes.end(),
+                                    batch_size) -
+                   options_.allowed_batch_sizes.begin();
+  }
+  TF_LITE_ENSURE_STATUS(ResizeBatch(runner_index, batch_size));
+  SignatureRunner* runner = runners_[runner_index];
+
+  const std::vector<const char*>& input_names = runner->input_names();
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    char* data = runner->input_tensor(input_names[i])->data.raw;
+    const size_t example_bytes = input_example_bytes_[i];
+    for (int r = 0; r < num_requests; ++r) {
+      std::memcpy(data + r * example_bytes, (*batch[r]->inputs)[i],
+                  example_bytes);
+    }
+    // Padding rows are zeroed so that they cannot trip numerical checks.
+    std::memset(data + num_requests * example_bytes, 0,
+                (batch_size - num_requests) * example_bytes);
+  }
+
+  TF_LITE_ENSURE_STATUS(runner->Invoke());
+  // Dynamic outputs may have been resized by Invoke().
+  if (!HasBatchedOutputs(runner, batch_size)) return kTfLiteError;
+
+  const std::vector<const char*>& output_names = runner->output_names();
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    const char* data = runner->output_tensor(output_names[i])->data.raw;
+    const size_t example_bytes = output_example_bytes_[i];
+    for (int r = 0; r < num_requests; ++r) {
+      std::memcpy((*batch[r]->outputs)[i], data + r * example_bytes,
+                  example_bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+void BatchingSignatureRunner::BatchLoop() {
+  const auto timeout =
+      std::chrono::microseconds(options_.batch_timeout_micros);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_changed_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) return;  // Stopping with nothing left to run.
+
+    // Wait for a full batch until the oldest request times out. Queued
+    // requests are always drained, even when stopping.
+    const auto deadline = queue_.front()->enqueue_time + timeout;
+    queue_changed_.wait_until(lock, deadline, [this] {
+      return stopping_ ||
+             queue_.size() >= static_cast<size_t>(options_.max_batch_size);
+    });
+
+    const size_t num_requests =
+        std::min(queue_.size(), static_cast<size_t>(options_.max_batch_size));
+    std::vector<Request*> batch(queue_.begin(), queue_.begin() + num_requests);
+    queue_.erase(queue_.begin(), queue_.begin() + num_requests);
+
+    lock.unlock();
+    const TfLiteStatus status = RunBatch(batch);
+    lock.lock();
+
+    ++num_batches_;
+    for (Request* request : batch) {
+      request->status = status;
+      request->done = true;
+    }
+    request_done_.notify_all();
+  }
+}
+
+int64_t BatchingSignatureRunner::num_batches() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_batches_;
+}
+
+}  // namespace impl
+}  // namespace tflite
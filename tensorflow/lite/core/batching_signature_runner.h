@@ -0,0 +1,174 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_BATCHING_SIGNATURE_RUNNER_H_
+#define TENSORFLOW_LITE_CORE_BATCHING_SIGNATURE_RUNNER_H_
+/// \file
+///
+/// Dynamic batching of single-example requests on top of a SignatureRunner.
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/signature_runner.h"
+
+namespace tflite {
+namespace impl {
+
+/// \warning This is an experimental API and subject to change. \n
+/// BatchingSignatureRunner queues single-example requests from any number of
+/// threads, runs them as one batched Invoke() on a SignatureRunner, and copies
+/// each example's outputs back to its caller.
+///
+/// The queueing options follow the semantics of the TensorFlow
+/// SharedBatchScheduler: a batch is formed as soon as `max_batch_size`
+/// requests are queued, or when the oldest queued request has waited
+/// `batch_timeout_micros`. Batches are padded up to the next entry of
+/// `allowed_batch_sizes`, so the runner only ever sees a handful of input
+/// shapes.
+///
+/// Given one runner per allowed batch size, each runner is allocated for its
+/// batch size once, and batches of different sizes never resize a runner.
+/// Given a single runner, a batch of a different padded size than the last
+/// one resizes the inputs and calls AllocateTensors(), which prepares every
+/// node again. Enable InterpreterOptions::SetArenaPlanCacheSize() on its
+/// interpreter so that the arena plans of the allowed sizes are restored
+/// rather than recomputed.
+///
+/// Every input and output of the signature must have the batch as its first
+/// dimension and a fixed-size element type. A batch fails if an output does
+/// not come out with exactly one row of the static example size per padded
+/// example. The batching runner takes over the runners: nothing else may use
+/// them, or their interpreters, while the batching runner exists.
+class BatchingSignatureRunner {
+ public:
+  struct Options {
+    /// Largest batch run in one Invoke().
+    int max_batch_size = 8;
+    /// How long the oldest queued request may wait for more requests to
+    /// arrive before a partial batch is run. 0 runs whatever is queued as
+    /// soon as the batch thread is free.
+    int64_t batch_timeout_micros = 0;
+    /// Batch sizes the runner is resized to, in increasing order. A batch of
+    /// n requests is padded to the smallest allowed size that is >= n. If
+    /// empty, every size up to `max_batch_size` is allowed. Otherwise the
+    /// last entry must equal `max_batch_size`. Required when creating the
+    /// batching runner with one runner per batch size.
+    std::vector<int> allowed_batch_sizes;
+    /// Requests beyond `max_enqueued_batches * max_batch_size` queued
+    /// requests are rejected.
+    int max_enqueued_batches = 16;
+  };
+
+  /// Creates a batching runner for `runner`, which must outlive it. Returns
+  /// nullptr if the options are invalid or the signature cannot be batched.
+  static std::unique_ptr<BatchingSignatureRunner> Create(
+      SignatureRunner* runner, const Options& options);
+
+  /// Creates a batching runner that runs batches padded to
+  /// `options.allowed_batch_sizes[i]` on `runners[i]`. The runners must run
+  /// the same signature of the same model in distinct interpreters, and
+  /// outlive the batching runner. Returns nullptr if the options are invalid,
+  /// the signature cannot be batched or the runners don't match.
+  static std::unique_ptr<BatchingSignatureRunner> Create(
+      const std::vector<SignatureRunner*>& runners, const Options& options);
+
+  BatchingSignatureRunner(const BatchingSignatureRunner&) = delete;
+  BatchingSignatureRunner& operator=(const BatchingSignatureRunner&) = delete;
+
+  /// Waits for queued requests to finish, then stops the batch thread.
+  ~BatchingSignatureRunner();
+
+  /// Runs one example and blocks until its outputs are ready.
+  ///
+  /// `inputs[i]` points to `input_example_bytes()[i]` bytes holding the
+  /// example's value of the i-th signature input, in `input_names()` order,
+  /// and `outputs[i]` to `output_example_bytes()[i]` bytes receiving the
+  /// i-th output. Returns kTfLiteError if the queue is full or the batch
+  /// failed. Safe to call from multiple threads.
+  TfLiteStatus Run(const std::vector<const void*>& inputs,
+                   const std::vector<void*>& outputs);
+
+  const std::vector<size_t>& input_example_bytes() const {
+    return input_example_bytes_;
+  }
+  const std::vector<size_t>& output_example_bytes() const {
+    return output_example_bytes_;
+  }
+
+  /// Number of batched Invoke() calls run so far.
+  int64_t num_batches() const;
+
+ private:
+  struct Request {
+    const std::vector<const void*>* inputs;
+    const std::vector<void*>* outputs;
+    std::chrono::steady_clock::time_point enqueue_time;
+    TfLiteStatus status = kTfLiteOk;
+    bool done = false;
+  };
+
+  BatchingSignatureRunner(std::vector<SignatureRunner*> runners,
+                          const Options& options);
+
+  static std::unique_ptr<BatchingSignatureRunner> CreateImpl(
+      std::vector<SignatureRunner*> runners, const Options& options);
+
+  TfLiteStatus Initialize();
+  // Returns the size `num_requests` requests are padded to.
+  int PaddedBatchSize(int num_requests) const;
+  // Allocates the tensors of `runners_[runner_index]` for `batch_size`
+  // examples, unless they already are.
+  TfLiteStatus ResizeBatch(int runner_index, int batch_size);
+  // Returns true if every output of `runner` holds `batch_size` examples of
+  // `output_example_bytes_` bytes each.
+  bool HasBatchedOutputs(SignatureRunner* runner, int batch_size) const;
+  TfLiteStatus RunBatch(const std::vector<Request*>& batch);
+  void BatchLoop();
+
+  // A single runner that is resized for each batch, or one runner per entry
+  // of `options_.allowed_batch_sizes`.
+  const std::vector<SignatureRunner*> runners_;
+  const Options options_;
+
+  // Shape of each input with the batch dimension left unset.
+  std::vector<std::vector<int>> input_dims_;
+  std::vector<size_t> input_example_bytes_;
+  std::vector<size_t> output_example_bytes_;
+  // Batch size the tensors of each of `runners_` are currently allocated
+  // for. Only touched by the batch thread after initialization.
+  std::vector<int> runner_batch_sizes_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable queue_changed_;
+  std::condition_variable request_done_;
+  std::deque<Request*> queue_;
+  int64_t num_batches_ = 0;
+  bool stopping_ = false;
+
+  std::thread batch_thread_;
+};
+
+}  // namespace impl
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_BATCHING_SIGNATURE_RUNNER_H_
@@ -0,0 +1,169 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/batching_signature_runner.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/core/signature_runner.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace impl {
+namespace {
+
+// The "add" signature of multi_signatures.bin computes x + 2 on a float
+// vector.
+class BatchingSignatureRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/multi_signatures.bin", &reporter_);
+    ASSERT_NE(model_, nullptr);
+    InterpreterBuilder builder(*model_, resolver_);
+    ASSERT_EQ(builder(&interpreter_), kTfLiteOk);
+    runner_ = interpreter_->GetSignatureRunner("add");
+    ASSERT_NE(runner_, nullptr);
+  }
+
+  TestErrorReporter reporter_;
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolver resolver_;
+  std::unique_ptr<Interpreter> interpreter_;
+  SignatureRunner* runner_ = nullptr;
+};
+
+TEST_F(BatchingSignatureRunnerTest, RejectsInvalidOptions) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 4;
+  options.allowed_batch_sizes = {1, 2};
+  EXPECT_EQ(BatchingSignatureRunner::Create(runner_, options), nullptr);
+  options.allowed_batch_sizes = {2, 1, 4};
+  EXPECT_EQ(BatchingSignatureRunner::Create(runner_, options), nullptr);
+  options.allowed_batch_sizes = {};
+  options.max_batch_size = 0;
+  EXPECT_EQ(BatchingSignatureRunner::Create(runner_, options), nullptr);
+}
+
+TEST_F(BatchingSignatureRunnerTest, PadsToAllowedBatchSize) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 4;
+  options.allowed_batch_sizes = {2, 4};
+  auto batching_runner = BatchingSignatureRunner::Create(runner_, options);
+  ASSERT_NE(batching_runner, nullptr);
+  ASSERT_EQ(batching_runner->input_example_bytes(),
+            std::vector<size_t>{sizeof(float)});
+  ASSERT_EQ(batching_runner->output_example_bytes(),
+            std::vector<size_t>{sizeof(float)});
+
+  float x = 5;
+  float y = 0;
+  ASSERT_EQ(batching_runner->Run({&x}, {&y}), kTfLiteOk);
+  EXPECT_EQ(y, 7);
+  EXPECT_EQ(batching_runner->num_batches(), 1);
+  EXPECT_EQ(runner_->input_tensor("x")->dims->data[0], 2);
+}
+
+TEST_F(BatchingSignatureRunnerTest, BatchesConcurrentRequests) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 4;
+  // Long enough that batches are only formed once they are full.
+  options.batch_timeout_micros = 10 * 1000 * 1000;
+  auto batching_runner = BatchingSignatureRunner::Create(runner_, options);
+  ASSERT_NE(batching_runner, nullptr);
+
+  constexpr int kNumRequests = 8;
+  std::vector<float> outputs(kNumRequests, 0);
+  std::vector<TfLiteStatus> statuses(kNumRequests, kTfLiteError);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i] {
+      const float x = i;
+      statuses[i] = batching_runner->Run({&x}, {&outputs[i]});
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  for (int i = 0; i < kNumRequests; ++i) {
+    EXPECT_EQ(statuses[i], kTfLiteOk);
+    EXPECT_EQ(outputs[i], i + 2);
+  }
+  EXPECT_EQ(batching_runner->num_batches(), kNumRequests / 4);
+}
+
+TEST_F(BatchingSignatureRunnerTest, UsesOneRunnerPerBatchSize) {
+  std::unique_ptr<Interpreter> other_interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model_, resolver_)(&other_interpreter),
+            kTfLiteOk);
+  SignatureRunner* other_runner = other_interpreter->GetSignatureRunner("add");
+  ASSERT_NE(other_runner, nullptr);
+
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 4;
+  options.allowed_batch_sizes = {2, 4};
+  EXPECT_EQ(BatchingSignatureRunner::Create(
+                std::vector<SignatureRunner*>{runner_}, options),
+            nullptr);
+  auto batching_runner = BatchingSignatureRunner::Create(
+      std::vector<SignatureRunner*>{runner_, other_runner}, options);
+  ASSERT_NE(batching_runner, nullptr);
+  EXPECT_EQ(runner_->input_tensor("x")->dims->data[0], 2);
+  EXPECT_EQ(other_runner->input_tensor("x")->dims->data[0], 4);
+
+  // Whatever batches the requests form, each runs on the runner allocated
+  // for its padded size, and neither runner is resized.
+  constexpr int kNumRequests = 3;
+  std::vector<float> outputs(kNumRequests, 0);
+  std::vector<TfLiteStatus> statuses(kNumRequests, kTfLiteError);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i] {
+      const float x = i;
+      statuses[i] = batching_runner->Run({&x}, {&outputs[i]});
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int i = 0; i < kNumRequests; ++i) {
+    EXPECT_EQ(statuses[i], kTfLiteOk);
+    EXPECT_EQ(outputs[i], i + 2);
+  }
+
+  float x = 5;
+  float y = 0;
+  ASSERT_EQ(batching_runner->Run({&x}, {&y}), kTfLiteOk);
+  EXPECT_EQ(y, 7);
+  EXPECT_EQ(runner_->input_tensor("x")->dims->data[0], 2);
+  EXPECT_EQ(other_runner->input_tensor("x")->dims->data[0], 4);
+}
+
+TEST_F(BatchingSignatureRunnerTest, RejectsMismatchedArguments) {
+  auto batching_runner = BatchingSignatureRunner::Create(
+      runner_, BatchingSignatureRunner::Options());
+  ASSERT_NE(batching_runner, nullptr);
+  float x = 1;
+  float y = 0;
+  EXPECT_EQ(batching_runner->Run({&x, &x}, {&y}), kTfLiteError);
+  EXPECT_EQ(batching_runner->num_batches(), 0);
+}
+
+}  // namespace
+}  // namespace impl
+}  // namespace tflite
@@ -251,6 +251,11 @@ InterpreterBuilder::~InterpreterBuilder() = default;
 
 TfLiteStatus InterpreterBuilder::BuildLocalIndexToRegistrationMapping() {
   TfLiteStatus status = kTfLiteOk;
+  // The mapping only depends on the model and the op resolver, so a builder
+  // that builds several interpreters resolves it once.
+  if (registrations_resolved_) {
+    return status;
+  }
   // Reset state.
   flatbuffer_op_index_to_registration_.clear();
   unresolved_custom_ops_.clear();
@@ -290,6 +295,7 @@ TfLiteStatus InterpreterBuilder::BuildLocalIndexToRegistrationMapping() {
     }
     flatbuffer_op_index_to_registration_.push_back(registration);
   }
+  registrations_resolved_ = true;
   return status;
 }
 
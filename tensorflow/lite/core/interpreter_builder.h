@@ -98,6 +98,8 @@ class InterpreterBuilder {
   /// On success, returns kTfLiteOk and sets `*interpreter` to a valid
   /// Interpreter.
   /// On failure, returns an error status and sets `*interpreter` to nullptr.
+  /// A builder may build several interpreters; the model's operators are
+  /// looked up in the op resolver on the first successful call only.
   TfLiteStatus operator()(std::unique_ptr<Interpreter>* interpreter);
 
   /// Same as above, but also sets the number of CPU threads to use
@@ -161,6 +163,8 @@ class InterpreterBuilder {
   std::vector<const TfLiteRegistration*> flatbuffer_op_index_to_registration_;
   std::vector<TfLiteRegistration> unresolved_custom_ops_;
   std::vector<BuiltinOperator> flatbuffer_op_index_to_registration_types_;
+  // True once flatbuffer_op_index_to_registration_ has been built.
+  bool registrations_resolved_ = false;
   const Allocation* allocation_ = nullptr;
 
   bool has_flex_op_ = false;
@@ -0,0 +1,244 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/interpreter_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace impl {
+
+InterpreterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), interpreter_(other.interpreter_) {
+  other.interpreter_ = nullptr;
+}
+
+InterpreterPool::Lease::~Lease() {
+  if (interpreter_ != nullptr) pool_->Release(interpreter_);
+}
+
+InterpreterPool::InterpreterPool(const FlatBufferModel& model,
+                                 const OpResolver& resolver,
+                                 const Options& options)
+    : options_(options), builder_(model, resolver) {}
+
+InterpreterPool::~InterpreterPool() {
+  // Leases hold a raw pointer to the pool, so every instance must be back on
+  // the free list by now.
+  std::lock_guard<std::mutex> lock(mutex_);
+  TFLITE_DCHECK_EQ(num_building_, 0);
+  TFLITE_DCHECK_EQ(idle_.size(), instances_.size());
+}
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& resolver,
+    const Options& options) {
+  if (options.num_instances < 1) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool needs at least one instance, got %d.",
+                    options.num_instances);
+    return nullptr;
+  }
+  std::unique_ptr<InterpreterPool> pool(
+      new InterpreterPool(model, resolver, options));
+  if (pool->builder_.SetNumThreads(options.num_threads_per_instance) !=
+      kTfLiteOk) {
+    return nullptr;
+  }
+  // Building the first instance eagerly surfaces model and delegate errors
+  // at creation time and, with a weight cache, packs the weights once
+  // before any other instance tries to map them.
+  std::unique_ptr<Instance> first = pool->BuildInstance();
+  if (first == nullptr) return nullptr;
+  pool->idle_.push_back(first.get());
+  pool->instances_.push_back(std::move(first));
+  return pool;
+}
+
+std::unique_ptr<InterpreterPool::Instance> InterpreterPool::BuildInstance() {
+  auto instance = std::make_unique<Instance>();
+  TfLiteStatus status;
+  {
+    std::lock_guard<std::mutex> lock(builder_mutex_);
+    status = builder_(&instance->interpreter);
+  }
+  if (status != kTfLiteOk || instance->interpreter == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool failed to build an interpreter.");
+    return nullptr;
+  }
+  if (!options_.xnnpack_weight_cache_file_path.empty()) {
+    TfLiteXNNPackDelegateOptions xnnpack_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    xnnpack_options.num_threads = options_.num_threads_per_instance;
+    xnnpack_options.weight_cache_file_path =
+        options_.xnnpack_weight_cache_file_path.c_str();
+    Interpreter::TfLiteDelegatePtr delegate(
+        TfLiteXNNPackDelegateCreate(&xnnpack_options),
+        TfLiteXNNPackDelegateDelete);
+    if (delegate == nullptr ||
+        instance->interpreter->ModifyGraphWithDelegate(std::move(delegate)) !=
+            kTfLiteOk) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "InterpreterPool failed to apply the XNNPACK delegate.");
+      return nullptr;
+    }
+  }
+  if (instance->interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool failed to allocate tensors.");
+    return nullptr;
+  }
+  return instance;
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire() {
+  Instance* instance = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    instance_released_.wait(lock, [this] {
+      return !idle_.empty() ||
+             instances_.size() + num_building_ <
+                 static_cast<size_t>(options_.num_instances);
+    });
+    if (!idle_.empty()) {
+      instance = idle_.back();
+      idle_.pop_back();
+    } else {
+      ++num_building_;
+    }
+  }
+
+  if (instance == nullptr) {
+    std::unique_ptr<Instance> built = BuildInstance();
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_building_;
+    if (built == nullptr) {
+      // Let another waiter retry instead of blocking it on a slot that was
+      // never filled.
+      instance_released_.notify_one();
+      return Lease(this, nullptr);
+    }
+    instance = built.get();
+    instances_.push_back(std::move(built));
+  }
+
+  if (instance->arena_released) {
+    if (instance->interpreter->AllocateTensors() != kTfLiteOk) {
+      Release(instance->interpreter.get());
+      return Lease(this, nullptr);
+    }
+    instance->arena_released = false;
+  }
+  return Lease(this, instance->interpreter.get());
+}
+
+void InterpreterPool::Release(Interpreter* interpreter) {
+  // Arenas beyond `max_idle_arenas` are picked under the lock but released
+  // outside of it, so that other callers don't wait on arena teardown.
+  std::vector<Instance*> to_release;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Instance* instance = nullptr;
+    for (const auto& candidate : instances_) {
+      if (candidate->interpreter.get() == interpreter) {
+        instance = candidate.get();
+        break;
+      }
+    }
+    if (instance == nullptr) return;
+    idle_.push_back(instance);
+
+    // Idle instances at the front of the free list are the least recently
+    // used; release their arenas first.
+    if (options_.max_idle_arenas >= 0) {
+      int resident = 0;
+      for (auto it = idle_.rbegin(); it != idle_.rend(); ++it) {
+        if ((*it)->arena_released) continue;
+        if (resident < options_.max_idle_arenas) {
+          ++resident;
+          continue;
+        }
+        to_release.push_back(*it);
+      }
+      // Take them off the free list so they are not leased meanwhile.
+      idle_.erase(std::remove_if(idle_.begin(), idle_.end(),
+                                 [&to_release](Instance* idle) {
+                                   return std::find(to_release.begin(),
+                                                    to_release.end(),
+                                                    idle) != to_release.end();
+                                 }),
+                  idle_.end());
+    }
+  }
+  instance_released_.notify_one();
+  if (to_release.empty()) return;
+
+  std::vector<bool> released;
+  released.reserve(to_release.size());
+  for (Instance* instance : to_release) {
+    released.push_back(instance->interpreter->ReleaseNonPersistentMemory() ==
+                       kTfLiteOk);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < to_release.size(); ++i) {
+      to_release[i]->arena_released = released[i];
+    }
+    // They are still the least recently used idle instances.
+    idle_.insert(idle_.begin(), to_release.rbegin(), to_release.rend());
+  }
+  instance_released_.notify_all();
+}
+
+TfLiteStatus InterpreterPool::Invoke(
+    const std::function<TfLiteStatus(Interpreter*)>& fill_inputs,
+    const std::function<TfLiteStatus(Interpreter*)>& read_outputs) {
+  Lease lease = Acquire();
+  if (!lease) return kTfLiteError;
+  if (fill_inputs && fill_inputs(lease.get()) != kTfLiteOk) {
+    return kTfLiteError;
+  }
+  if (lease->Invoke() != kTfLiteOk) return kTfLiteError;
+  if (read_outputs && read_outputs(lease.get()) != kTfLiteOk) {
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+int InterpreterPool::num_created() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return instances_.size();
+}
+
+int InterpreterPool::num_resident_idle() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int resident = 0;
+  for (const Instance* instance : idle_) {
+    if (!instance->arena_released) ++resident;
+  }
+  return resident;
+}
+
+}  // namespace impl
+}  // namespace tflite
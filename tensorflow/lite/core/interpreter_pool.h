@@ -0,0 +1,187 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_CORE_INTERPRETER_POOL_H_
+/// \file
+///
+/// A pool of interpreters built from one model, for serving concurrent
+/// requests from multiple threads.
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/model_builder.h"
+
+namespace tflite {
+namespace impl {
+
+/// \warning This is an experimental API and subject to change. \n
+/// InterpreterPool owns up to `num_instances` interpreters for one model and
+/// hands them out to callers one at a time, so that several threads can run
+/// the same model concurrently without sharing an interpreter.
+///
+/// All instances read constant tensors directly from the model's buffer.
+/// When `xnnpack_weight_cache_file_path` is set, each instance is delegated to
+/// XNNPACK with that weight cache file: the first instance packs the weights
+/// into the file, and the others map the same packed weights instead of
+/// packing their own copy.
+///
+/// Each instance still has its own arena for activations. To bound the
+/// memory held by idle instances, at most `max_idle_arenas` idle instances
+/// keep their arena resident; the others release it and reallocate it the
+/// next time they are leased.
+///
+/// Usage:
+///
+/// <pre><code>
+/// auto model = tflite::FlatBufferModel::BuildFromFile(...);
+/// tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+/// InterpreterPool::Options options;
+/// options.num_instances = 4;
+/// auto pool = InterpreterPool::Create(*model, resolver, options);
+///
+/// // From any thread:
+/// pool->Invoke(
+///     [&](Interpreter* interpreter) {
+///       // Fill interpreter->typed_input_tensor<float>(0).
+///       return kTfLiteOk;
+///     },
+///     [&](Interpreter* interpreter) {
+///       // Read interpreter->typed_output_tensor<float>(0).
+///       return kTfLiteOk;
+///     });
+/// </code></pre>
+///
+/// All instances are built by the same InterpreterBuilder, so the model's op
+/// registrations and metadata are resolved once for the whole pool. The model
+/// and the op resolver must outlive the pool.
+class InterpreterPool {
+ public:
+  struct Options {
+    /// Maximum number of interpreters. Instances are created on demand, so
+    /// the pool only grows as large as the peak number of concurrent users.
+    int num_instances = 1;
+    /// Number of threads given to each interpreter (and to its XNNPACK
+    /// delegate, if any). -1 lets the interpreter decide.
+    int num_threads_per_instance = 1;
+    /// Maximum number of idle instances whose arena stays allocated.
+    /// -1 keeps every arena resident.
+    int max_idle_arenas = -1;
+    /// If non-empty, every instance is delegated to XNNPACK using this file
+    /// as a shared packed-weight cache. Use an op resolver without default
+    /// delegates in that case, so that XNNPACK is not applied twice.
+    std::string xnnpack_weight_cache_file_path;
+  };
+
+  /// A leased interpreter. The interpreter is returned to the pool when the
+  /// lease is destroyed, which must happen before the pool is destroyed.
+  class Lease {
+   public:
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&&) = delete;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    /// Returns nullptr if no interpreter could be leased.
+    Interpreter* get() const { return interpreter_; }
+    Interpreter* operator->() const { return interpreter_; }
+    explicit operator bool() const { return interpreter_ != nullptr; }
+
+   private:
+    friend class InterpreterPool;
+    Lease(InterpreterPool* pool, Interpreter* interpreter)
+        : pool_(pool), interpreter_(interpreter) {}
+
+    InterpreterPool* pool_;
+    Interpreter* interpreter_;
+  };
+
+  /// Builds a pool and its first interpreter, on which AllocateTensors() has
+  /// been called. Returns nullptr on failure.
+  static std::unique_ptr<InterpreterPool> Create(const FlatBufferModel& model,
+                                                 const OpResolver& resolver,
+                                                 const Options& options);
+
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+  /// All leases must have been destroyed.
+  ~InterpreterPool();
+
+  /// Leases an interpreter whose tensors are allocated, blocking while all
+  /// `num_instances` interpreters are in use. The returned lease is empty if
+  /// a new interpreter had to be built and that failed.
+  Lease Acquire();
+
+  /// Leases an interpreter, calls `fill_inputs`, invokes the interpreter and
+  /// calls `read_outputs`, then returns the interpreter to the pool. Safe to
+  /// call from multiple threads. `fill_inputs` may resize inputs, in which
+  /// case it must call AllocateTensors() itself.
+  TfLiteStatus Invoke(
+      const std::function<TfLiteStatus(Interpreter*)>& fill_inputs,
+      const std::function<TfLiteStatus(Interpreter*)>& read_outputs);
+
+  /// Number of interpreters built so far.
+  int num_created() const;
+  /// Number of idle interpreters whose arena is currently allocated.
+  int num_resident_idle() const;
+
+ private:
+  struct Instance {
+    std::unique_ptr<Interpreter> interpreter;
+    // True while the instance's non-persistent arena has been released.
+    bool arena_released = false;
+  };
+
+  InterpreterPool(const FlatBufferModel& model, const OpResolver& resolver,
+                  const Options& options);
+
+  std::unique_ptr<Instance> BuildInstance();
+  void Release(Interpreter* interpreter);
+
+  const Options options_;
+
+  // Builds every instance. The builder is not thread-safe, so it is guarded
+  // by its own mutex, which is not held while delegates are applied and
+  // tensors are allocated.
+  std::mutex builder_mutex_;
+  InterpreterBuilder builder_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable instance_released_;
+  // Every instance built so far, in creation order.
+  std::vector<std::unique_ptr<Instance>> instances_;
+  // Idle instances. The most recently released instance is at the back and
+  // is leased first, since its arena is most likely to still be resident.
+  // Instances whose arena is being released are not on this list until the
+  // release is done.
+  std::vector<Instance*> idle_;
+  // Number of instances currently being built outside of `mutex_`.
+  int num_building_ = 0;
+};
+
+}  // namespace impl
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTERPRETER_POOL_H_
@@ -0,0 +1,211 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/interpreter_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace impl {
+namespace {
+
+constexpr int kNumElements = 1 * 8 * 8 * 3;
+
+// Counts the op lookups made through it.
+class CountingOpResolver : public OpResolver {
+ public:
+  explicit CountingOpResolver(const OpResolver& resolver)
+      : resolver_(resolver) {}
+
+  const TfLiteRegistration* FindOp(BuiltinOperator op,
+                                   int version) const override {
+    ++num_lookups_;
+    return resolver_.FindOp(op, version);
+  }
+  const TfLiteRegistration* FindOp(const char* op,
+                                   int version) const override {
+    ++num_lookups_;
+    return resolver_.FindOp(op, version);
+  }
+
+  int num_lookups() const { return num_lookups_; }
+
+ private:
+  const OpResolver& resolver_;
+  mutable int num_lookups_ = 0;
+};
+
+class InterpreterPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/add.bin", &reporter_);
+    ASSERT_NE(model_, nullptr);
+  }
+
+  // Runs the model on `value` with a standalone interpreter.
+  std::vector<float> Reference(float value) {
+    std::unique_ptr<Interpreter> interpreter;
+    InterpreterBuilder builder(*model_, resolver_);
+    EXPECT_EQ(builder(&interpreter), kTfLiteOk);
+    EXPECT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+    float* input = interpreter->typed_input_tensor<float>(0);
+    std::fill(input, input + kNumElements, value);
+    EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+    const float* output = interpreter->typed_output_tensor<float>(0);
+    return std::vector<float>(output, output + kNumElements);
+  }
+
+  // Runs the model on `value` through `pool`.
+  std::vector<float> Run(InterpreterPool* pool, float value) {
+    std::vector<float> result;
+    EXPECT_EQ(pool->Invoke(
+                  [value](Interpreter* interpreter) {
+                    float* input = interpreter->typed_input_tensor<float>(0);
+                    std::fill(input, input + kNumElements, value);
+                    return kTfLiteOk;
+                  },
+                  [&result](Interpreter* interpreter) {
+                    const float* output =
+                        interpreter->typed_output_tensor<float>(0);
+                    result.assign(output, output + kNumElements);
+                    return kTfLiteOk;
+                  }),
+              kTfLiteOk);
+    return result;
+  }
+
+  TestErrorReporter reporter_;
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver_;
+};
+
+TEST_F(InterpreterPoolTest, RejectsEmptyPool) {
+  InterpreterPool::Options options;
+  options.num_instances = 0;
+  EXPECT_EQ(InterpreterPool::Create(*model_, resolver_, options), nullptr);
+}
+
+TEST_F(InterpreterPoolTest, ReusesIdleInstance) {
+  InterpreterPool::Options options;
+  options.num_instances = 4;
+  auto pool = InterpreterPool::Create(*model_, resolver_, options);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->num_created(), 1);
+
+  EXPECT_EQ(Run(pool.get(), 1.0f), Reference(1.0f));
+  EXPECT_EQ(Run(pool.get(), 2.0f), Reference(2.0f));
+  // Sequential callers never need more than one instance.
+  EXPECT_EQ(pool->num_created(), 1);
+}
+
+TEST_F(InterpreterPoolTest, GrowsUpToNumInstances) {
+  InterpreterPool::Options options;
+  options.num_instances = 2;
+  auto pool = InterpreterPool::Create(*model_, resolver_, options);
+  ASSERT_NE(pool, nullptr);
+
+  InterpreterPool::Lease first = pool->Acquire();
+  InterpreterPool::Lease second = pool->Acquire();
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(pool->num_created(), 2);
+}
+
+TEST_F(InterpreterPoolTest, ResolvesOpsOnce) {
+  CountingOpResolver resolver(resolver_);
+  InterpreterPool::Options options;
+  options.num_instances = 3;
+  auto pool = InterpreterPool::Create(*model_, resolver, options);
+  ASSERT_NE(pool, nullptr);
+  const int num_lookups = resolver.num_lookups();
+  EXPECT_GT(num_lookups, 0);
+
+  InterpreterPool::Lease a = pool->Acquire();
+  InterpreterPool::Lease b = pool->Acquire();
+  InterpreterPool::Lease c = pool->Acquire();
+  ASSERT_TRUE(a && b && c);
+  EXPECT_EQ(pool->num_created(), 3);
+  // Later instances reuse the registrations resolved for the first one.
+  EXPECT_EQ(resolver.num_lookups(), num_lookups);
+}
+
+TEST_F(InterpreterPoolTest, ReleasesIdleArenas) {
+  InterpreterPool::Options options;
+  options.num_instances = 3;
+  options.max_idle_arenas = 1;
+  auto pool = InterpreterPool::Create(*model_, resolver_, options);
+  ASSERT_NE(pool, nullptr);
+  {
+    InterpreterPool::Lease a = pool->Acquire();
+    InterpreterPool::Lease b = pool->Acquire();
+    InterpreterPool::Lease c = pool->Acquire();
+    ASSERT_TRUE(a && b && c);
+  }
+  EXPECT_EQ(pool->num_created(), 3);
+  EXPECT_EQ(pool->num_resident_idle(), 1);
+
+  // Instances whose arena was released are reallocated on demand.
+  InterpreterPool::Lease a = pool->Acquire();
+  InterpreterPool::Lease b = pool->Acquire();
+  InterpreterPool::Lease c = pool->Acquire();
+  for (Interpreter* interpreter : {a.get(), b.get(), c.get()}) {
+    ASSERT_NE(interpreter, nullptr);
+    float* input = interpreter->typed_input_tensor<float>(0);
+    std::fill(input, input + kNumElements, 3.0f);
+    ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  }
+}
+
+TEST_F(InterpreterPoolTest, ConcurrentInvoke) {
+  InterpreterPool::Options options;
+  options.num_instances = 3;
+  auto pool = InterpreterPool::Create(*model_, resolver_, options);
+  ASSERT_NE(pool, nullptr);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumRuns = 20;
+  std::vector<std::vector<float>> expected;
+  for (int t = 0; t < kNumThreads; ++t) expected.push_back(Reference(t));
+
+  std::vector<int> mismatches(kNumThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kNumRuns; ++i) {
+        if (Run(pool.get(), t) != expected[t]) ++mismatches[t];
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int t = 0; t < kNumThreads; ++t) EXPECT_EQ(mismatches[t], 0);
+  EXPECT_LE(pool->num_created(), 3);
+}
+
+}  // namespace
+}  // namespace impl
+}  // namespace tflite
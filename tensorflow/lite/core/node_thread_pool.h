@@ -0,0 +1,71 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_NODE_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_NODE_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of threads that runs the nodes of one stage of a subgraph
+// concurrently. The thread calling Run() takes part in the work, so a pool of
+// `num_threads` threads starts `num_threads - 1` workers.
+class NodeThreadPool {
+ public:
+  explicit NodeThreadPool(int num_threads);
+  ~NodeThreadPool();
+
+  NodeThreadPool(const NodeThreadPool&) = delete;
+  NodeThreadPool& operator=(const NodeThreadPool&) = delete;
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Calls `task(task_index, thread_index)` for every task_index in
+  // [0, num_tasks) and returns once all calls have returned. `thread_index`
+  // is in [0, num_threads()) and identifies the thread running the task; the
+  // calling thread is 0. Two tasks never run on the same thread at once.
+  // Must not be called concurrently.
+  void Run(int num_tasks, const std::function<void(int, int)>& task);
+
+ private:
+  // Runs tasks of the current generation until none are left.
+  void RunTasks(int thread_index);
+  void WorkerLoop(int thread_index);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented by every Run() call that hands out work to the workers.
+  int64_t generation_ = 0;
+  // Number of workers that have not finished the current generation.
+  int num_busy_workers_ = 0;
+  bool stopping_ = false;
+
+  // The work of the current generation, only changed while no worker is busy.
+  const std::function<void(int, int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_NODE_THREAD_POOL_H_
@@ -0,0 +1,63 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/node_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(NodeThreadPoolTest, RunsEveryTaskOnce) {
+  NodeThreadPool pool(4);
+  ASSERT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 4, 17}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    pool.Run(num_tasks, [&](int task, int thread) {
+      EXPECT_GE(thread, 0);
+      EXPECT_LT(thread, 4);
+      ++runs[task];
+    });
+    for (int task = 0; task < num_tasks; ++task) {
+      EXPECT_EQ(runs[task], 1) << "task " << task << " of " << num_tasks;
+    }
+  }
+}
+
+TEST(NodeThreadPoolTest, NeverRunsTwoTasksOnOneThread) {
+  NodeThreadPool pool(3);
+  std::vector<std::atomic<int>> running(pool.num_threads());
+  std::atomic<bool> overlapped(false);
+  pool.Run(64, [&](int task, int thread) {
+    if (++running[thread] != 1) overlapped = true;
+    --running[thread];
+  });
+  EXPECT_FALSE(overlapped);
+}
+
+TEST(NodeThreadPoolTest, SingleThreadRunsOnCaller) {
+  NodeThreadPool pool(1);
+  std::vector<int> order;
+  pool.Run(3, [&](int task, int thread) {
+    EXPECT_EQ(thread, 0);
+    order.push_back(task);
+  });
+  EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -497,6 +497,18 @@ const char* GetDelegateKernalName(const TfLiteRegistration& registration) {
 TfLiteStatus Subgraph::PartitionGraph(const TfLiteIntArray* nodes_to_replace,
                                       std::vector<NodeSubset>* node_subsets) {
   const InterpreterInfo info(this);
+  IntArrayUniquePtr delegated_nodes;
+  if (!nodes_excluded_from_delegation_.empty()) {
+    std::vector<int> nodes;
+    nodes.reserve(nodes_to_replace->size);
+    for (int node_index : TfLiteIntArrayView(nodes_to_replace)) {
+      if (!nodes_excluded_from_delegation_.count(node_index)) {
+        nodes.push_back(node_index);
+      }
+    }
+    delegated_nodes = BuildTfLiteArray(nodes);
+    nodes_to_replace = delegated_nodes.get();
+  }
   return PartitionGraphIntoIndependentNodeSubsets(
       &info, nodes_to_replace, node_subsets,
       /*greedily=*/!DisableDelegateClustering(), control_edges_);
@@ -567,6 +579,7 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
                   GetDelegateKernalName(registration), node_subsets.size());
 
   execution_plan_.clear();
+  can_run_stages_concurrently_ = false;
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -616,8 +629,19 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
   return kTfLiteOk;
 }
 
+namespace {
+// CPU backend context of the NodeThreadPool worker running on this thread, if
+// any. Kernels invoked on a worker get it instead of the subgraph's shared
+// context, which must not be used by two threads at once.
+thread_local TfLiteExternalContext* worker_cpu_backend_context = nullptr;
+}  // namespace
+
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      worker_cpu_backend_context != nullptr) {
+    return worker_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -971,6 +995,7 @@ TfLiteStatus Subgraph::AllocateTensors() {
     ReportError("AllocateTensors() called on inconsistent model.");
     return kTfLiteError;
   }
+  prefetch_weights_ = ShouldLazilyMaterializeWeights();
 
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
@@ -1009,10 +1034,14 @@ TfLiteStatus Subgraph::AllocateTensors() {
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
+  TF_LITE_ENSURE_STATUS(ScheduleStages());
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
   state_ = kStateInvokable;
+  can_run_stages_concurrently_ =
+      !stage_begin_.empty() && !has_dynamic_tensors_ &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size();
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
   // Developers shouldn't rely on the side effect of this function to reset
@@ -1563,8 +1592,10 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #else
     memory_planner_ = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
-        kDefaultTensorAlignment, subgraph_index_);
+        kDefaultTensorAlignment, subgraph_index_, ArenaPlanCacheSize(),
+        ShouldBucketArenaPlanSizes());
 #endif
+    memory_planner_->SetConcurrentStages(stage_begin_);
     memory_planner_->PlanAllocations();
   }
 
@@ -1642,10 +1673,27 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  // The stages of a static graph may run concurrently. With a profiler
+  // attached, the nodes run one at a time so that their events don't overlap.
+  if (can_run_stages_concurrently_ && profiler_ == nullptr) {
+    if (prefetch_weights_) {
+      for (int node_index : execution_plan_) PrefetchWeights(node_index);
+      prefetch_weights_ = false;
+    }
+    status = InvokeStages();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
+  if (prefetch_weights_ && !execution_plan_.empty()) {
+    PrefetchWeights(execution_plan_[0]);
+  }
   for (int execution_plan_index = 0;
        execution_plan_index < execution_plan_.size(); execution_plan_index++) {
     if (execution_plan_index == next_execution_plan_index_to_prepare_) {
@@ -1676,37 +1724,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -1723,6 +1741,12 @@ TfLiteStatus Subgraph::InvokeImpl() {
       return kTfLiteCancelled;
     }
 
+    // Page in the weights of the next node while this one runs.
+    if (prefetch_weights_ &&
+        execution_plan_index + 1 < execution_plan_.size()) {
+      PrefetchWeights(execution_plan_[execution_plan_index + 1]);
+    }
+
     EnsureTensorsVectorCapacity();
     tensor_resized_since_op_invoke_ = false;
     if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
@@ -1757,12 +1781,150 @@ TfLiteStatus Subgraph::InvokeImpl() {
     tflite::OnTfLiteOpInvokeEnd(trace_op);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
   }
+  prefetch_weights_ = false;
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
   return status;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::ScheduleStages() {
+  std::vector<int> stage_begin;
+  std::vector<int> execution_plan = execution_plan_;
+  // Delegate partitioning reads the model's control edges as execution plan
+  // indices, so the plan of such models is never reordered.
+  if (NumParallelBranchThreads() > 1 && control_edges_ == nullptr) {
+    InterpreterInfo info(this);
+    std::vector<std::vector<int>> stages;
+    TF_LITE_ENSURE_STATUS(GroupIndependentNodesIntoStages(
+        &info, /*control_edges=*/nullptr, &stages));
+    execution_plan.clear();
+    for (const std::vector<int>& stage : stages) {
+      stage_begin.push_back(execution_plan.size());
+      for (int execution_plan_index : stage) {
+        execution_plan.push_back(execution_plan_[execution_plan_index]);
+      }
+    }
+    // Without two nodes in the same stage there is nothing to run
+    // concurrently.
+    if (stage_begin.size() == execution_plan.size()) {
+      stage_begin.clear();
+      execution_plan = execution_plan_;
+    }
+  }
+  if (stage_begin == stage_begin_ && execution_plan == execution_plan_) {
+    return kTfLiteOk;
+  }
+  stage_begin_ = std::move(stage_begin);
+  execution_plan_ = std::move(execution_plan);
+  if (memory_planner_) {
+    memory_planner_->SetConcurrentStages(stage_begin_);
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::InvokeStages() {
+  const int num_threads = NumParallelBranchThreads();
+  if (node_thread_pool_ == nullptr ||
+      node_thread_pool_->num_threads() != num_threads) {
+    node_thread_pool_ = std::make_unique<NodeThreadPool>(num_threads);
+    worker_cpu_backend_contexts_.clear();
+    // The workers already share the cores, so their backend contexts are
+    // single-threaded from the first kernel on.
+    for (int i = 1; i < num_threads; ++i) {
+      auto cpu_backend_context = std::make_unique<ExternalCpuBackendContext>();
+      cpu_backend_context->set_max_num_threads(1);
+      worker_cpu_backend_contexts_.push_back(std::move(cpu_backend_context));
+    }
+  }
+  std::vector<TfLiteStatus> statuses;
+  for (int stage = 0; stage < stage_begin_.size(); ++stage) {
+    const int first = stage_begin_[stage];
+    const int end = stage + 1 < stage_begin_.size() ? stage_begin_[stage + 1]
+                                                    : execution_plan_.size();
+    for (int i = first; i < end; ++i) {
+      const auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[i]];
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    EnsureTensorsVectorCapacity();
+    tensor_resized_since_op_invoke_ = false;
+    statuses.assign(end - first, kTfLiteOk);
+    node_thread_pool_->Run(end - first, [&](int task, int thread) {
+      auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[first + task]];
+      if (thread == 0) {
+        statuses[task] = OpInvoke(registration, &node);
+        return;
+      }
+      worker_cpu_backend_context =
+          worker_cpu_backend_contexts_[thread - 1].get();
+      statuses[task] = OpInvoke(registration, &node);
+      worker_cpu_backend_context = nullptr;
+    });
+
+    for (int task = 0; task < end - first; ++task) {
+      if (statuses[task] == kTfLiteOk) continue;
+      const int node_index = execution_plan_[first + task];
+      const auto& [node, registration] = nodes_and_registration_[node_index];
+      auto err = ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+      return statuses[task] == kTfLiteCancelled ? statuses[task] : err;
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1999,6 +2161,7 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  can_run_stages_concurrently_ = false;
   return kTfLiteOk;
 }
 
@@ -2137,6 +2300,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  can_run_stages_concurrently_ = false;
 
   // Handling FP16 delegation (if applies).
   //
@@ -2374,6 +2538,9 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
         reset_delegation_if_not_ok(EnsureMemoryAllocations()));
   }
   delegates_applied_.push_back(delegate);
+  if (ShouldLazilyMaterializeWeights()) {
+    ReleaseDelegatedWeights();
+  }
 
   return status;
 }
@@ -2464,6 +2631,59 @@ void Subgraph::InitializeTensorReleaseMap() {
   }
 }
 
+namespace {
+
+// Returns the mapping of the model file that `tensor` points into, or nullptr
+// if `tensor` is not a constant mapped from the model file.
+const MMAPAllocation* GetMappedWeights(const TfLiteTensor& tensor) {
+  if (tensor.allocation_type != kTfLiteMmapRo || tensor.allocation == nullptr ||
+      tensor.data.raw == nullptr) {
+    return nullptr;
+  }
+  const auto* allocation = static_cast<const Allocation*>(tensor.allocation);
+  if (allocation->type() != Allocation::Type::kMMap) return nullptr;
+  return static_cast<const MMAPAllocation*>(allocation);
+}
+
+}  // namespace
+
+void Subgraph::PrefetchWeights(int node_index) {
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  if (node.delegate != nullptr) return;
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    if (const MMAPAllocation* weights = GetMappedWeights(tensor)) {
+      weights->Prefetch(tensor.data.raw, tensor.bytes);
+    }
+  }
+}
+
+void Subgraph::ReleaseDelegatedWeights() {
+  std::vector<bool> read_by_kernels(tensors_.size(), false);
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (node.delegate != nullptr) continue;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        read_by_kernels[tensor_index] = true;
+      }
+    }
+  }
+  for (int tensor_index : outputs_) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      read_by_kernels[tensor_index] = true;
+    }
+  }
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    if (read_by_kernels[i]) continue;
+    const TfLiteTensor& tensor = tensors_[i];
+    if (const MMAPAllocation* weights = GetMappedWeights(tensor)) {
+      weights->ReleasePages(tensor.data.raw, tensor.bytes);
+    }
+  }
+}
+
 void Subgraph::MaybeReleaseDynamicTensors(const TfLiteNode& node,
                                           size_t node_index) {
   if (!ShouldReleaseDynamicTensors()) return;
@@ -37,8 +37,10 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/node_thread_pool.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -466,6 +468,31 @@ class Subgraph {
     return (options_ && options_->GetEnsureDynamicTensorsAreReleased());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of arena plans the memory planner caches for recently seen tensor
+  // sizes.
+  int ArenaPlanCacheSize() const {
+    return options_ ? options_->GetArenaPlanCacheSize() : 0;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if cached arena plans round tensor sizes up to powers of two.
+  bool ShouldBucketArenaPlanSizes() const {
+    return (options_ && options_->GetBucketArenaPlanSizes());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads used to run independent nodes concurrently.
+  int NumParallelBranchThreads() const {
+    return options_ ? options_->GetNumParallelBranchThreads() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if constant tensors mapped from the model file are paged in lazily.
+  bool ShouldLazilyMaterializeWeights() const {
+    return (options_ && options_->GetLazyWeightMaterialization());
+  }
+
   /// WARNING: This is an experimental API and subject to change.
   /// Use dynamic tensor allocation and deallocation method for large tensors
   /// instead of static memory planner. Dynamic tensors are allocated just
@@ -556,6 +583,16 @@ class Subgraph {
   // more details.
   bool IsDelegationSkippable() const { return is_delegation_skippable_; }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Keeps the nodes with the given indices on the TF Lite kernels: delegates
+  // applied afterwards see them as unsupported when previewing partitions and
+  // don't replace them, even if they asked to. Used to apply the partitions
+  // picked by `delegates::TuneDelegatePartitions`.
+  void SetNodesExcludedFromDelegation(const std::vector<int>& node_indices) {
+    nodes_excluded_from_delegation_ = std::unordered_set<int>(
+        node_indices.begin(), node_indices.end());
+  }
+
   // Marks this subgraph as delegation-skippable.
   // See the documentation on the private is_delegation_skippable_ field for
   // more details.
@@ -689,6 +726,20 @@ class Subgraph {
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node);
 
+  // Makes sure that the input tensors of 'node' can be read, copying data
+  // back from delegate buffers if needed.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // If NumParallelBranchThreads() > 1, groups the execution plan into stages
+  // of independent nodes, reorders it stage by stage and hands the stages to
+  // the memory planner. Otherwise clears the stages.
+  TfLiteStatus ScheduleStages();
+
+  // Invokes the execution plan stage by stage, running the nodes of each
+  // stage concurrently on node_thread_pool_.
+  TfLiteStatus InvokeStages();
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -948,6 +999,15 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Hints the OS to page in the constant inputs of the node at `node_index`
+  // that are mapped from the model file. Delegate kernels are skipped, since
+  // they read their own copy of the weights.
+  void PrefetchWeights(int node_index);
+
+  // Drops the pages of the constant tensors mapped from the model file that
+  // only delegate kernels read. Used with `ShouldLazilyMaterializeWeights`.
+  void ReleaseDelegatedWeights();
+
   // Set the buffer handle to a tensor.
   // The method is used to implement Interpreter::SetBufferHandle and
   // SignatureRunner::SetInputBufferHandle/SetOutputBufferHandle APIs.
@@ -1088,9 +1148,32 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Start of each stage of the execution plan whose nodes may run
+  // concurrently. Empty unless NumParallelBranchThreads() > 1 and the graph
+  // has independent nodes.
+  std::vector<int> stage_begin_;
+
+  // True if the last AllocateTensors() prepared every node without finding
+  // dynamic tensors, so that Invoke() can run the stages concurrently.
+  bool can_run_stages_concurrently_ = false;
+
+  // Threads running the nodes of a stage, created by the first concurrent
+  // Invoke().
+  std::unique_ptr<NodeThreadPool> node_thread_pool_;
+
+  // CPU backend contexts of the node_thread_pool_ workers, indexed by worker
+  // thread index - 1. The calling thread uses the subgraph's shared context.
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
+  // True until the first Invoke() after AllocateTensors() completes, which
+  // prefetches the weights of the nodes in execution order. Only set if
+  // ShouldLazilyMaterializeWeights().
+  bool prefetch_weights_ = false;
+
   // Tracking bit for whether a tensor was resized in the course of an op
   // invocation. This is a useful hint to ensure that dynamic tensor outputs
   // trigger downstream reallocation after op invocation.
@@ -1171,6 +1254,10 @@ class Subgraph {
   // this subgraph.
   bool is_delegation_skippable_ = false;
 
+  // Nodes that delegates may not replace. See
+  // `SetNodesExcludedFromDelegation`.
+  std::unordered_set<int> nodes_excluded_from_delegation_;
+
   // Count how many times the context has been switched to the delegate context.
   // Incremented during Acquire(), and decremented during Release().
   // Initialized to 1 initially because SwitchToKernelContext() is called once
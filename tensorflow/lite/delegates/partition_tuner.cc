@@ -0,0 +1,395 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/partition_tuner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common_internal.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace delegates {
+namespace {
+
+// An interpreter and the delegate applied to it, if any. The interpreter is
+// destroyed first.
+struct TunedModel {
+  Interpreter::TfLiteDelegatePtr delegate{nullptr, [](TfLiteDelegate*) {}};
+  std::unique_ptr<Interpreter> interpreter;
+};
+
+// Mean latencies of a model.
+struct Measurement {
+  double latency_us = 0;
+  // Indexed by node of the primary subgraph.
+  std::unordered_map<int, double> node_latency_us;
+};
+
+TfLiteStatus PrepareModel(const InterpreterFactory& make_interpreter,
+                          const DelegateFactory* make_delegate,
+                          const std::vector<int>& excluded_nodes,
+                          TunedModel* model) {
+  model->interpreter = make_interpreter();
+  if (model->interpreter == nullptr) return kTfLiteError;
+  if (make_delegate != nullptr) {
+    model->delegate = (*make_delegate)();
+    if (model->delegate == nullptr) return kTfLiteError;
+    model->interpreter->primary_subgraph().SetNodesExcludedFromDelegation(
+        excluded_nodes);
+    TF_LITE_ENSURE_STATUS(
+        model->interpreter->ModifyGraphWithDelegate(model->delegate.get()));
+  }
+  TF_LITE_ENSURE_STATUS(model->interpreter->AllocateTensors());
+  for (int tensor_index : model->interpreter->inputs()) {
+    TfLiteTensor* tensor = model->interpreter->tensor(tensor_index);
+    if (tensor->type != kTfLiteString && tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Measures the whole model first, then each node with a profiler attached.
+// The profiler stays attached to the interpreter. `delegate` is the delegate
+// applied to `interpreter`, if any.
+TfLiteStatus Measure(Interpreter* interpreter, TfLiteDelegate* delegate,
+                     const PartitionTuningOptions& options,
+                     Measurement* measurement) {
+  const int num_runs = std::max(options.num_runs, 1);
+  for (int i = 0; i < options.num_warmup_runs; ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+  }
+  const uint64_t start_us = profiling::time::NowMicros();
+  for (int i = 0; i < num_runs; ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+  }
+  measurement->latency_us =
+      static_cast<double>(profiling::time::NowMicros() - start_us) / num_runs;
+
+  auto owned_profiler = std::make_unique<profiling::BufferedProfiler>(
+      /*max_num_initial_entries=*/1024,
+      /*allow_dynamic_buffer_increase=*/true);
+  profiling::BufferedProfiler* profiler = owned_profiler.get();
+  interpreter->SetProfiler(std::move(owned_profiler));
+  // The interpreter doesn't time the kernels of delegates that profile their
+  // own operators, such as XNNPack, and their operator events can't be mapped
+  // back to the nodes they replaced. Clears the flag while profiling, so that
+  // every delegate kernel gets an operator event of its own.
+  const int64_t delegate_flags = delegate != nullptr ? delegate->flags : 0;
+  if (delegate != nullptr) {
+    delegate->flags &= ~kTfLiteDelegateFlagsPerOperatorProfiling;
+  }
+  profiler->StartProfiling();
+  TfLiteStatus status = kTfLiteOk;
+  for (int i = 0; i < num_runs && status == kTfLiteOk; ++i) {
+    status = interpreter->Invoke();
+  }
+  profiler->StopProfiling();
+  if (delegate != nullptr) delegate->flags = delegate_flags;
+  TF_LITE_ENSURE_STATUS(status);
+  measurement->node_latency_us.clear();
+  for (const profiling::ProfileEvent* event : profiler->GetProfileEvents()) {
+    if (event->event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+        event->extra_event_metadata == 0) {
+      measurement->node_latency_us[event->event_metadata] +=
+          static_cast<double>(event->elapsed_time) / num_runs;
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Returns the nodes replaced by a delegate kernel, or nullptr if `node` isn't
+// one.
+const TfLiteIntArray* GetDelegatedNodes(const TfLiteNode& node) {
+  if (node.delegate == nullptr || node.builtin_data == nullptr) return nullptr;
+  if (TfLiteDelegateHasValidOpaqueDelegateBuilder(node.delegate)) {
+    return static_cast<const TfLiteOpaqueDelegateParams*>(node.builtin_data)
+        ->nodes_to_replace;
+  }
+  return static_cast<const TfLiteDelegateParams*>(node.builtin_data)
+      ->nodes_to_replace;
+}
+
+// Returns the latencies of the delegate partitions of `interpreter`.
+std::vector<PartitionLatency> GetPartitionLatencies(
+    const Interpreter& interpreter, const Measurement& delegated,
+    const Measurement& cpu) {
+  std::vector<PartitionLatency> partitions;
+  for (int node_index : interpreter.execution_plan()) {
+    const auto* node_and_registration =
+        interpreter.node_and_registration(node_index);
+    const TfLiteIntArray* delegated_nodes =
+        GetDelegatedNodes(node_and_registration->first);
+    if (delegated_nodes == nullptr) continue;
+    const auto delegated_latency = delegated.node_latency_us.find(node_index);
+    // The delegate kernel didn't run, e.g. because of a control flow op.
+    if (delegated_latency == delegated.node_latency_us.end()) continue;
+    PartitionLatency partition;
+    partition.nodes.assign(delegated_nodes->data,
+                           delegated_nodes->data + delegated_nodes->size);
+    partition.delegated_latency_us = delegated_latency->second;
+    for (int delegated_node : partition.nodes) {
+      const auto it = cpu.node_latency_us.find(delegated_node);
+      if (it != cpu.node_latency_us.end()) {
+        partition.cpu_latency_us += it->second;
+      }
+    }
+    partitions.push_back(std::move(partition));
+  }
+  return partitions;
+}
+
+// Returns the nodes of the partitions that were slower than the same nodes on
+// the TF Lite kernels.
+std::vector<int> GetSlowDelegatedNodes(
+    const std::vector<PartitionLatency>& partitions) {
+  std::vector<int> slow_nodes;
+  for (const PartitionLatency& partition : partitions) {
+    if (partition.delegated_latency_us >= partition.cpu_latency_us) {
+      slow_nodes.insert(slow_nodes.end(), partition.nodes.begin(),
+                        partition.nodes.end());
+    }
+  }
+  return slow_nodes;
+}
+
+bool HasDelegateKernels(const Interpreter& interpreter) {
+  for (int node_index : interpreter.execution_plan()) {
+    if (interpreter.node_and_registration(node_index)->first.delegate !=
+        nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 64-bit FNV-1a, which is stable across platforms and builds unlike
+// std::hash.
+uint64_t Fingerprint(const void* data, size_t size,
+                     uint64_t hash = 0xcbf29ce484222325ULL) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Describes the CPU, which is what the TF Lite kernels and CPU delegates run
+// on.
+std::string GetDeviceDescription() {
+  std::string description =
+      "cores=" + std::to_string(std::thread::hardware_concurrency());
+#if defined(__linux__) || defined(__ANDROID__)
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::set<std::string> seen_keys;
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string key = line.substr(0, colon);
+    key.erase(key.find_last_not_of(" \t") + 1);
+    if (key != "model name" && key != "Hardware" && key != "CPU implementer" &&
+        key != "CPU part") {
+      continue;
+    }
+    // Keeps the first core only. The cores of big.LITTLE systems differ, but
+    // the first one is enough to tell devices apart.
+    if (seen_keys.insert(key).second) description += ";" + line;
+  }
+#endif
+  return description;
+}
+
+std::string ToHex(uint64_t value) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016" PRIx64, value);
+  return buffer;
+}
+
+}  // namespace
+
+TfLiteStatus TuneDelegatePartitions(const InterpreterFactory& make_interpreter,
+                                    const DelegateFactory& make_delegate,
+                                    const PartitionTuningOptions& options,
+                                    PartitionTuningResult* result) {
+  TunedModel cpu_model;
+  Measurement cpu;
+  TF_LITE_ENSURE_STATUS(PrepareModel(make_interpreter,
+                                     /*make_delegate=*/nullptr,
+                                     /*excluded_nodes=*/{}, &cpu_model));
+  TF_LITE_ENSURE_STATUS(Measure(cpu_model.interpreter.get(),
+                                /*delegate=*/nullptr, options, &cpu));
+  const int num_nodes = cpu_model.interpreter->nodes_size();
+  cpu_model = TunedModel();
+
+  auto best_model = std::make_unique<TunedModel>();
+  Measurement best;
+  std::vector<int> excluded_nodes;
+  TF_LITE_ENSURE_STATUS(PrepareModel(make_interpreter, &make_delegate,
+                                     excluded_nodes, best_model.get()));
+  TF_LITE_ENSURE_STATUS(Measure(best_model->interpreter.get(),
+                                best_model->delegate.get(), options, &best));
+  result->cpu_latency_us = cpu.latency_us;
+  result->delegated_latency_us = best.latency_us;
+  result->partitions = GetPartitionLatencies(*best_model->interpreter, best,
+                                             cpu);
+
+  for (int round = 0; round < options.max_rounds; ++round) {
+    const std::vector<int> slow_nodes = GetSlowDelegatedNodes(
+        GetPartitionLatencies(*best_model->interpreter, best, cpu));
+    if (slow_nodes.empty()) break;
+    std::vector<int> candidate_nodes = excluded_nodes;
+    candidate_nodes.insert(candidate_nodes.end(), slow_nodes.begin(),
+                           slow_nodes.end());
+    std::sort(candidate_nodes.begin(), candidate_nodes.end());
+
+    auto candidate_model = std::make_unique<TunedModel>();
+    Measurement candidate;
+    TF_LITE_ENSURE_STATUS(PrepareModel(make_interpreter, &make_delegate,
+                                       candidate_nodes,
+                                       candidate_model.get()));
+    TF_LITE_ENSURE_STATUS(Measure(candidate_model->interpreter.get(),
+                                  candidate_model->delegate.get(), options,
+                                  &candidate));
+    TFLITE_LOG_PROD(TFLITE_LOG_INFO,
+                    "Partition tuning round %d: %zu nodes on TF Lite kernels, "
+                    "%.1f us (was %.1f us).",
+                    round, candidate_nodes.size(), candidate.latency_us,
+                    best.latency_us);
+    // The boundaries of the remaining partitions moved, which may cost more
+    // than the delegate partitions saved.
+    if (candidate.latency_us >= best.latency_us) break;
+    excluded_nodes = std::move(candidate_nodes);
+    best = std::move(candidate);
+    best_model = std::move(candidate_model);
+  }
+
+  // Excluding all delegated nodes is the same as not applying the delegate.
+  if (cpu.latency_us <= best.latency_us ||
+      !HasDelegateKernels(*best_model->interpreter)) {
+    excluded_nodes.resize(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) excluded_nodes[i] = i;
+    best.latency_us = cpu.latency_us;
+  }
+  result->excluded_nodes = std::move(excluded_nodes);
+  result->tuned_latency_us = best.latency_us;
+  return kTfLiteOk;
+}
+
+std::string GetPartitionTuningKey(const void* model_data, size_t model_size,
+                                  const std::string& delegate_name) {
+  const std::string device = GetDeviceDescription();
+  return ToHex(Fingerprint(model_data, model_size)) + "-" +
+         ToHex(Fingerprint(device.data(), device.size())) + "-" +
+         delegate_name;
+}
+
+bool LoadTunedPartitions(const std::string& cache_path, const std::string& key,
+                         std::vector<int>* excluded_nodes) {
+  std::ifstream cache(cache_path);
+  std::string line;
+  // Each line holds a key and the comma-separated excluded nodes.
+  while (std::getline(cache, line)) {
+    const size_t space = line.find(' ');
+    if (space == std::string::npos || line.compare(0, space, key) != 0) {
+      continue;
+    }
+    std::vector<int> nodes;
+    std::istringstream node_list(line.substr(space + 1));
+    std::string node;
+    while (std::getline(node_list, node, ',')) {
+      char* end = nullptr;
+      const long node_index = std::strtol(node.c_str(), &end, 10);  // NOLINT
+      if (node.empty() || *end != '\0' || node_index < 0) {
+        TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                        "Ignoring a corrupted entry of the partition cache %s.",
+                        cache_path.c_str());
+        return false;
+      }
+      nodes.push_back(static_cast<int>(node_index));
+    }
+    *excluded_nodes = std::move(nodes);
+    return true;
+  }
+  return false;
+}
+
+TfLiteStatus SaveTunedPartitions(const std::string& cache_path,
+                                 const std::string& key,
+                                 const std::vector<int>& excluded_nodes) {
+  std::vector<std::string> lines;
+  {
+    std::ifstream cache(cache_path);
+    std::string line;
+    while (std::getline(cache, line)) {
+      if (line.compare(0, key.size() + 1, key + " ") != 0) {
+        lines.push_back(line);
+      }
+    }
+  }
+  std::string entry = key + " ";
+  for (size_t i = 0; i < excluded_nodes.size(); ++i) {
+    if (i > 0) entry += ",";
+    entry += std::to_string(excluded_nodes[i]);
+  }
+  lines.push_back(std::move(entry));
+
+  // Writes a new file and renames it into place, so that concurrent readers
+  // see either the old or the new cache.
+  const std::string temp_path = cache_path + ".tmp";
+  {
+    std::ofstream cache(temp_path, std::ios::trunc);
+    for (const std::string& line : lines) cache << line << "\n";
+    if (!cache) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Failed to write the partition cache to %s.",
+                      temp_path.c_str());
+      return kTfLiteError;
+    }
+  }
+  if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Failed to move the partition cache to %s: %s.",
+                    cache_path.c_str(), std::strerror(errno));
+    std::remove(temp_path.c_str());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace delegates
+}  // namespace tflite
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_PARTITION_TUNER_H_
+#define TENSORFLOW_LITE_DELEGATES_PARTITION_TUNER_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+
+// Picks which partitions of a model a delegate should run from measured
+// latencies, instead of delegating every supported node.
+//
+// Delegating a small partition can be slower than running its nodes on the
+// TF Lite kernels, e.g. when the delegate kernel has a fixed dispatch cost or
+// has to copy its inputs and outputs. The tuner profiles the model on the
+// TF Lite kernels and with the delegate, moves the partitions that are slower
+// than their nodes on the TF Lite kernels back to them, and keeps the new
+// assignment only if the whole model got faster.
+//
+// Tuning is meant to run once per model and device, e.g. the first time an app
+// loads a model, with the result kept in a partition cache:
+//
+//   const std::string key = GetPartitionTuningKey(model_data, model_size,
+//                                                 "xnnpack");
+//   std::vector<int> excluded_nodes;
+//   if (!LoadTunedPartitions(cache_path, key, &excluded_nodes)) {
+//     PartitionTuningResult result;
+//     if (TuneDelegatePartitions(make_interpreter, make_delegate, {},
+//                                &result) == kTfLiteOk) {
+//       excluded_nodes = result.excluded_nodes;
+//       SaveTunedPartitions(cache_path, key, excluded_nodes);
+//     }
+//   }
+//   interpreter->primary_subgraph().SetNodesExcludedFromDelegation(
+//       excluded_nodes);
+//   interpreter->ModifyGraphWithDelegate(delegate.get());
+
+namespace tflite {
+namespace delegates {
+
+// Returns an interpreter for the model to tune, with its tensors not allocated
+// and no delegate applied.
+using InterpreterFactory = std::function<std::unique_ptr<Interpreter>()>;
+// Returns a new instance of the delegate to tune.
+using DelegateFactory = std::function<Interpreter::TfLiteDelegatePtr()>;
+
+struct PartitionTuningOptions {
+  // Invocations before measuring each assignment of nodes.
+  int num_warmup_runs = 1;
+  // Invocations measured for each assignment of nodes.
+  int num_runs = 10;
+  // Maximum number of times partitions are moved back to the TF Lite kernels.
+  int max_rounds = 8;
+};
+
+// Latencies of one delegate partition.
+struct PartitionLatency {
+  // Nodes of the primary subgraph replaced by the delegate kernel.
+  std::vector<int> nodes;
+  // Mean latency of the delegate kernel.
+  double delegated_latency_us = 0;
+  // Mean latency of `nodes` on the TF Lite kernels.
+  double cpu_latency_us = 0;
+};
+
+struct PartitionTuningResult {
+  // Nodes of the primary subgraph that the delegate should not run, to be
+  // passed to `Subgraph::SetNodesExcludedFromDelegation`. Holds all nodes when
+  // the model is fastest without the delegate.
+  std::vector<int> excluded_nodes;
+  // Mean latency of the model on the TF Lite kernels only.
+  double cpu_latency_us = 0;
+  // Mean latency of the model with all supported nodes delegated.
+  double delegated_latency_us = 0;
+  // Mean latency of the model with `excluded_nodes` on the TF Lite kernels.
+  double tuned_latency_us = 0;
+  // Partitions of the model with all supported nodes delegated.
+  std::vector<PartitionLatency> partitions;
+};
+
+// Profiles the primary subgraph of the interpreters returned by
+// `make_interpreter` with and without the delegates returned by
+// `make_delegate`, and returns the fastest assignment of its nodes in
+// `result`. Inputs are filled with zeros. Delegate kernels are timed as a
+// whole, also for delegates that profile their own operators
+// (`kTfLiteDelegateFlagsPerOperatorProfiling`), whose flag is cleared while
+// profiling.
+TfLiteStatus TuneDelegatePartitions(const InterpreterFactory& make_interpreter,
+                                    const DelegateFactory& make_delegate,
+                                    const PartitionTuningOptions& options,
+                                    PartitionTuningResult* result);
+
+// Returns the key of a model tuned for `delegate_name` on this device in the
+// partition cache. It combines a fingerprint of the model with one of the
+// device (CPU model and number of cores).
+std::string GetPartitionTuningKey(const void* model_data, size_t model_size,
+                                  const std::string& delegate_name);
+
+// Looks up `key` in the partition cache file at `cache_path`. Returns false if
+// the file or the key doesn't exist.
+bool LoadTunedPartitions(const std::string& cache_path, const std::string& key,
+                         std::vector<int>* excluded_nodes);
+
+// Adds or replaces the entry for `key` in the partition cache file at
+// `cache_path`.
+TfLiteStatus SaveTunedPartitions(const std::string& cache_path,
+                                 const std::string& key,
+                                 const std::vector<int>& excluded_nodes);
+
+}  // namespace delegates
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_PARTITION_TUNER_H_
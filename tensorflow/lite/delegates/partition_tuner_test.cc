@@ -0,0 +1,330 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/partition_tuner.h"
+
+#include <stdlib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/context_util.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/delegates/utils/simple_delegate.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace delegates {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr char kSlowOp[] = "SLOW";
+constexpr int kSlowOpLatencyUs = 5000;
+
+// A custom op that copies its input after sleeping, standing in for an op that
+// is slow on the TF Lite kernels.
+TfLiteRegistration* RegisterSlowOp() {
+  static TfLiteRegistration registration = [] {
+    TfLiteRegistration r = {};
+    r.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    r.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      profiling::time::SleepForMicros(kSlowOpLatencyUs);
+      const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      std::memcpy(output->data.raw, input->data.raw, input->bytes);
+      return kTfLiteOk;
+    };
+    r.builtin_code = kTfLiteBuiltinCustom;
+    r.custom_name = kSlowOp;
+    return r;
+  }();
+  return &registration;
+}
+
+// Runs SLOW and ADD nodes in a fixed time per partition, standing in for the
+// dispatch and copies of a real delegate.
+class FixedLatencyDelegateKernel : public SimpleDelegateKernelInterface {
+ public:
+  explicit FixedLatencyDelegateKernel(int latency_us)
+      : latency_us_(latency_us) {}
+
+  TfLiteStatus Init(TfLiteContext* context,
+                    const TfLiteDelegateParams* params) override {
+    for (int node_index : TfLiteIntArrayView(params->nodes_to_replace)) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, node_index, &node, &registration));
+      nodes_.push_back({registration->builtin_code == kTfLiteBuiltinAdd,
+                        node->inputs->data[0], node->outputs->data[0]});
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) override {
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) override {
+    profiling::time::SleepForMicros(latency_us_);
+    for (const Node& n : nodes_) {
+      const TfLiteTensor& input = context->tensors[n.input];
+      TfLiteTensor& output = context->tensors[n.output];
+      for (int i = 0; i < NumElements(&input); ++i) {
+        output.data.f[i] = n.is_add ? 2 * input.data.f[i] : input.data.f[i];
+      }
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  static int NumElements(const TfLiteTensor* tensor) {
+    return tensor->bytes / sizeof(float);
+  }
+
+  struct Node {
+    bool is_add;
+    int input;
+    int output;
+  };
+  const int latency_us_;
+  std::vector<Node> nodes_;
+};
+
+class FixedLatencyDelegate : public SimpleDelegateInterface {
+ public:
+  explicit FixedLatencyDelegate(int latency_us) : latency_us_(latency_us) {}
+
+  bool IsNodeSupportedByDelegate(const TfLiteRegistration* registration,
+                                 const TfLiteNode* node,
+                                 TfLiteContext* context) const override {
+    return registration->builtin_code == kTfLiteBuiltinAdd ||
+           (registration->custom_name != nullptr &&
+            std::strcmp(registration->custom_name, kSlowOp) == 0);
+  }
+
+  TfLiteStatus Initialize(TfLiteContext* context) override {
+    return kTfLiteOk;
+  }
+
+  const char* Name() const override { return "FixedLatencyDelegate"; }
+
+  std::unique_ptr<SimpleDelegateKernelInterface> CreateDelegateKernelInterface()
+      override {
+    return std::make_unique<FixedLatencyDelegateKernel>(latency_us_);
+  }
+
+  SimpleDelegateInterface::Options DelegateOptions() const override {
+    return SimpleDelegateInterface::Options();
+  }
+
+ private:
+  const int latency_us_;
+};
+
+// input -> SLOW -> MUL(x, x) -> ADD(x, x) -> output, on tensors of `size`
+// floats. The delegate supports nodes 0 and 2, which makes two partitions
+// around the MUL node.
+std::unique_ptr<Interpreter> BuildInterpreterOfSize(int size) {
+  auto interpreter = std::make_unique<Interpreter>();
+  interpreter->AddTensors(4);
+  interpreter->SetInputs({0});
+  interpreter->SetOutputs({3});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 4; ++i) {
+    interpreter->SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {size},
+                                              quant);
+  }
+  interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                     RegisterSlowOp());
+  auto* mul_params =
+      static_cast<TfLiteMulParams*>(malloc(sizeof(TfLiteMulParams)));
+  mul_params->activation = kTfLiteActNone;
+  interpreter->AddNodeWithParameters({1, 1}, {2}, nullptr, 0, mul_params,
+                                     ops::builtin::Register_MUL());
+  auto* add_params =
+      static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  add_params->activation = kTfLiteActNone;
+  add_params->pot_scale_int16 = false;
+  interpreter->AddNodeWithParameters({2, 2}, {3}, nullptr, 0, add_params,
+                                     ops::builtin::Register_ADD());
+  return interpreter;
+}
+
+std::unique_ptr<Interpreter> BuildInterpreter() {
+  return BuildInterpreterOfSize(4);
+}
+
+DelegateFactory FixedLatencyDelegateFactory(
+    int latency_us, int64_t flags = kTfLiteDelegateFlagsNone) {
+  return [latency_us, flags]() -> Interpreter::TfLiteDelegatePtr {
+    return Interpreter::TfLiteDelegatePtr(
+        TfLiteDelegateFactory::CreateSimpleDelegate(
+            std::make_unique<FixedLatencyDelegate>(latency_us), flags),
+        TfLiteDelegateFactory::DeleteSimpleDelegate);
+  };
+}
+
+Interpreter::TfLiteDelegatePtr CreateXNNPackDelegate() {
+  TfLiteXNNPackDelegateOptions options = TfLiteXNNPackDelegateOptionsDefault();
+  options.num_threads = 1;
+  return Interpreter::TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&options),
+                                        TfLiteXNNPackDelegateDelete);
+}
+
+PartitionTuningOptions TestOptions() {
+  PartitionTuningOptions options;
+  options.num_runs = 3;
+  return options;
+}
+
+TEST(PartitionTunerTest, MovesSlowPartitionsToTfLiteKernels) {
+  // Faster than SLOW, slower than ADD.
+  PartitionTuningResult result;
+  ASSERT_EQ(TuneDelegatePartitions(BuildInterpreter,
+                                   FixedLatencyDelegateFactory(1000),
+                                   TestOptions(), &result),
+            kTfLiteOk);
+  EXPECT_THAT(result.excluded_nodes, ElementsAre(2));
+  EXPECT_LT(result.tuned_latency_us, result.delegated_latency_us);
+  EXPECT_LT(result.tuned_latency_us, result.cpu_latency_us);
+}
+
+TEST(PartitionTunerTest, TunesDelegatesThatProfileTheirOwnOperators) {
+  PartitionTuningResult result;
+  ASSERT_EQ(TuneDelegatePartitions(
+                BuildInterpreter,
+                FixedLatencyDelegateFactory(
+                    1000, kTfLiteDelegateFlagsPerOperatorProfiling),
+                TestOptions(), &result),
+            kTfLiteOk);
+  EXPECT_THAT(result.excluded_nodes, ElementsAre(2));
+  ASSERT_EQ(result.partitions.size(), 2);
+  EXPECT_THAT(result.partitions[0].nodes, ElementsAre(0));
+  EXPECT_THAT(result.partitions[1].nodes, ElementsAre(2));
+}
+
+TEST(PartitionTunerTest, TunesXNNPackPartitions) {
+  PartitionTuningResult result;
+  // Large enough for MUL and ADD to take measurable time.
+  const InterpreterFactory make_interpreter = [] {
+    return BuildInterpreterOfSize(1 << 16);
+  };
+  ASSERT_EQ(TuneDelegatePartitions(make_interpreter, CreateXNNPackDelegate,
+                                   TestOptions(), &result),
+            kTfLiteOk);
+  // XNNPack supports MUL and ADD, which make a single partition after the
+  // SLOW node. Whether it beats the TF Lite kernels depends on the device,
+  // but it must have been measured against them.
+  ASSERT_EQ(result.partitions.size(), 1);
+  EXPECT_THAT(result.partitions[0].nodes, ElementsAre(1, 2));
+  EXPECT_GT(result.partitions[0].delegated_latency_us, 0);
+  EXPECT_GT(result.partitions[0].cpu_latency_us, 0);
+  EXPECT_LE(result.tuned_latency_us, result.delegated_latency_us);
+}
+
+TEST(PartitionTunerTest, KeepsFastPartitions) {
+  PartitionTuningResult result;
+  ASSERT_EQ(TuneDelegatePartitions(BuildInterpreter,
+                                   FixedLatencyDelegateFactory(0),
+                                   TestOptions(), &result),
+            kTfLiteOk);
+  // The delegated ADD is not measurably slower than the TF Lite one, so it may
+  // go either way, but the SLOW node must stay delegated.
+  EXPECT_THAT(result.excluded_nodes, ::testing::Not(::testing::Contains(0)));
+}
+
+TEST(PartitionTunerTest, FallsBackToTfLiteKernels) {
+  PartitionTuningResult result;
+  ASSERT_EQ(TuneDelegatePartitions(BuildInterpreter,
+                                   FixedLatencyDelegateFactory(20000),
+                                   TestOptions(), &result),
+            kTfLiteOk);
+  EXPECT_THAT(result.excluded_nodes, ElementsAre(0, 1, 2));
+  EXPECT_EQ(result.tuned_latency_us, result.cpu_latency_us);
+}
+
+TEST(PartitionTunerTest, ExcludedNodesAreNotDelegated) {
+  std::unique_ptr<Interpreter> interpreter = BuildInterpreter();
+  Interpreter::TfLiteDelegatePtr delegate = FixedLatencyDelegateFactory(0)();
+  interpreter->primary_subgraph().SetNodesExcludedFromDelegation({2});
+  ASSERT_EQ(interpreter->ModifyGraphWithDelegate(delegate.get()), kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+
+  // The delegate kernel of node 0, then MUL and ADD.
+  ASSERT_EQ(interpreter->execution_plan().size(), 3);
+  EXPECT_EQ(interpreter->execution_plan()[1], 1);
+  EXPECT_EQ(interpreter->execution_plan()[2], 2);
+
+  float* input = interpreter->typed_input_tensor<float>(0);
+  for (int i = 0; i < 4; ++i) input[i] = i;
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  EXPECT_THAT(std::vector<float>(output, output + 4),
+              ElementsAre(0, 2, 8, 18));
+}
+
+TEST(PartitionTunerTest, CachesTunedPartitions) {
+  const std::string cache_path =
+      ::testing::TempDir() + "/partition_tuner_test.cache";
+  std::remove(cache_path.c_str());
+  const char model_a[] = "model a";
+  const char model_b[] = "model b";
+  const std::string key_a =
+      GetPartitionTuningKey(model_a, sizeof(model_a), "xnnpack");
+  const std::string key_b =
+      GetPartitionTuningKey(model_b, sizeof(model_b), "xnnpack");
+  EXPECT_NE(key_a, key_b);
+  EXPECT_EQ(key_a, GetPartitionTuningKey(model_a, sizeof(model_a), "xnnpack"));
+  EXPECT_NE(key_a, GetPartitionTuningKey(model_a, sizeof(model_a), "gpu"));
+
+  std::vector<int> excluded_nodes;
+  EXPECT_FALSE(LoadTunedPartitions(cache_path, key_a, &excluded_nodes));
+
+  ASSERT_EQ(SaveTunedPartitions(cache_path, key_a, {3, 4}), kTfLiteOk);
+  ASSERT_EQ(SaveTunedPartitions(cache_path, key_b, {}), kTfLiteOk);
+  ASSERT_TRUE(LoadTunedPartitions(cache_path, key_a, &excluded_nodes));
+  EXPECT_THAT(excluded_nodes, ElementsAre(3, 4));
+  ASSERT_TRUE(LoadTunedPartitions(cache_path, key_b, &excluded_nodes));
+  EXPECT_THAT(excluded_nodes, IsEmpty());
+
+  // Replaces the previous entry.
+  ASSERT_EQ(SaveTunedPartitions(cache_path, key_a, {7}), kTfLiteOk);
+  ASSERT_TRUE(LoadTunedPartitions(cache_path, key_a, &excluded_nodes));
+  EXPECT_THAT(excluded_nodes, ElementsAre(7));
+  ASSERT_TRUE(LoadTunedPartitions(cache_path, key_b, &excluded_nodes));
+  EXPECT_THAT(excluded_nodes, IsEmpty());
+}
+
+}  // namespace
+}  // namespace delegates
+}  // namespace tflite
@@ -36,6 +36,7 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "xnnpack.h"  // from @XNNPACK
 #include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
@@ -127,8 +128,94 @@ bool FileExists(const char* path) {
   return access(path, F_OK) != -1;
 }
 
+uint64_t RotateLeft(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// MurmurHash3 64 bit finalizer.
+uint64_t FinalizeHash(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// Mixes `value` into the running hash `h`, following MurmurHash3's block
+// mixing.
+uint64_t HashCombine(uint64_t h, uint64_t value) {
+  value *= 0x87c37b91114253d5ull;
+  value = RotateLeft(value, 31);
+  value *= 0x4cf5ad432745937full;
+  h ^= value;
+  return RotateLeft(h, 27) * 5 + 0x52dce729;
+}
+
+uint64_t HashBytes(uint64_t h, const uint8_t* data, size_t size) {
+  const uint8_t* const end = data + size;
+  for (; data + sizeof(uint64_t) <= end; data += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    h = HashCombine(h, word);
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data, end - data);
+  return HashCombine(h, tail ^ size);
+}
+
 }  // namespace
 
+uint64_t ComputeCacheChecksum(const XNNPackCacheHeader& header,
+                              const uint8_t* buffer_list_data) {
+  XNNPackCacheHeader unchecked_header = header;
+  unchecked_header.checksum = 0;
+  uint64_t h =
+      HashBytes(/*h=*/0, reinterpret_cast<const uint8_t*>(&unchecked_header),
+                sizeof(unchecked_header));
+  h = HashBytes(h, buffer_list_data, header.buffer_list_size);
+  return FinalizeHash(h);
+}
+
+uint64_t ComputeModelFingerprint(
+    const TfLiteTensor* tensors, const size_t size,
+    const std::unordered_map<size_t, size_t>& tensor_index_to_identifier) {
+  // Number and size of the data samples taken from each buffer.
+  constexpr size_t kNumSamples = 4;
+  constexpr size_t kSampleSize = 64;
+
+  // Hash buffers in a deterministic order.
+  std::vector<std::pair<size_t, size_t>> identifier_to_index;
+  identifier_to_index.reserve(tensor_index_to_identifier.size());
+  for (const auto [index, identifier] : tensor_index_to_identifier) {
+    if (index < size) {
+      identifier_to_index.emplace_back(identifier, index);
+    }
+  }
+  std::sort(identifier_to_index.begin(), identifier_to_index.end());
+
+  uint64_t h = HashCombine(/*h=*/0, identifier_to_index.size());
+  for (const auto& [identifier, index] : identifier_to_index) {
+    const TfLiteTensor& tensor = tensors[index];
+    h = HashCombine(h, identifier);
+    h = HashCombine(h, tensor.type);
+    h = HashCombine(h, tensor.bytes);
+    const uint8_t* const data = static_cast<const uint8_t*>(tensor.data.data);
+    if (data == nullptr || tensor.bytes == 0) {
+      continue;
+    }
+    if (tensor.bytes <= kNumSamples * kSampleSize) {
+      h = HashBytes(h, data, tensor.bytes);
+      continue;
+    }
+    // Samples are spread evenly, the last one ends with the buffer.
+    const size_t stride = (tensor.bytes - kSampleSize) / (kNumSamples - 1);
+    for (size_t i = 0; i < kNumSamples; ++i) {
+      h = HashBytes(h, data + i * stride, kSampleSize);
+    }
+  }
+  h = FinalizeHash(h);
+  return h ? h : 1;
+}
+
 void swap(MMapHandle& a, MMapHandle& b) {
   using std::swap;
   swap(a.size_, b.size_);
@@ -227,10 +314,20 @@ WeightCacheBuilder::WeightCacheBuilder(WeightCacheBuilder&& other)
       XNN_MOVE_CONSTRUCT_MEMBER(build_segment_start_),
       XNN_MOVE_CONSTRUCT_MEMBER(first_write_done_),
       XNN_MOVE_CONSTRUCT_MEMBER(fd_),
-      XNN_MOVE_CONSTRUCT_MEMBER(file_path_) {}
+      XNN_MOVE_CONSTRUCT_MEMBER(file_path_),
+      XNN_MOVE_CONSTRUCT_MEMBER(temporary_file_path_),
+      XNN_MOVE_CONSTRUCT_MEMBER(model_fingerprint_),
+      XNN_MOVE_CONSTRUCT_MEMBER(is_complete_),
+      XNN_MOVE_CONSTRUCT_MEMBER(is_published_),
+      XNN_MOVE_CONSTRUCT_MEMBER(is_build_step_) {
+  other.temporary_file_path_.clear();
+}
 #undef XNN_MOVE_CONSTRUCT_MEMBER
 
+WeightCacheBuilder::~WeightCacheBuilder() { PublishOrRemoveTemporaryFile(); }
+
 WeightCacheBuilder& WeightCacheBuilder::operator=(WeightCacheBuilder&& other) {
+  PublishOrRemoveTemporaryFile();
 #define XNN_MOVE_MEMBER(x) x = std::move(other.x)
   XNN_MOVE_MEMBER(data_);
   XNN_MOVE_MEMBER(schema_);
@@ -240,19 +337,63 @@ WeightCacheBuilder& WeightCacheBuilder::operator=(WeightCacheBuilder&& other) {
   XNN_MOVE_MEMBER(first_write_done_);
   XNN_MOVE_MEMBER(fd_);
   XNN_MOVE_MEMBER(file_path_);
+  XNN_MOVE_MEMBER(temporary_file_path_);
+  XNN_MOVE_MEMBER(model_fingerprint_);
+  XNN_MOVE_MEMBER(is_complete_);
+  XNN_MOVE_MEMBER(is_published_);
+  XNN_MOVE_MEMBER(is_build_step_);
 #undef XNN_MOVE_MEMBER
+  other.temporary_file_path_.clear();
   return *this;
 }
 
+bool WeightCacheBuilder::Publish() {
+  if (temporary_file_path_.empty()) {
+    return true;
+  }
+  XNNPACK_RETURN_CHECK(is_complete_ && !is_build_step_,
+                       "cannot publish an incomplete cache file.");
+  XNNPACK_RETURN_CHECK(
+      rename(temporary_file_path_.c_str(), file_path_.c_str()) == 0,
+      "could not move '%s' to '%s': %s.", temporary_file_path_.c_str(),
+      file_path_.c_str(), strerror(errno));
+  temporary_file_path_.clear();
+  is_published_ = true;
+  TFLITE_LOG_PROD(tflite::TFLITE_LOG_VERBOSE,
+                  "XNNPack weight cache: published to '%s'.",
+                  file_path_.c_str());
+  return true;
+}
+
+void WeightCacheBuilder::PublishOrRemoveTemporaryFile() {
+  if (temporary_file_path_.empty()) {
+    return;
+  }
+  if (!is_complete_ || is_build_step_ || !Publish()) {
+    unlink(temporary_file_path_.c_str());
+    temporary_file_path_.clear();
+  }
+}
+
 bool WeightCacheBuilder::Start(const char* path) {
   XNNPACK_RETURN_CHECK(!IsStarted());
+  XNNPACK_RETURN_CHECK(path && path[0], "a cache file path is required.");
   file_path_ = path;
 
   if (IsInMemoryCachePath(file_path_)) {
     fd_ = CreateInMemoryFileDescriptor("XNNPack in-memory weight cache");
   } else {
+#if defined(_MSC_VER)
+    // Open files cannot be renamed, the cache is written in place.
     fd_ = FileDescriptor::Open(file_path_.c_str(), O_CREAT | O_TRUNC | O_RDWR,
                                0644);
+#else
+    // Other processes may have mapped an existing file at this path. It is
+    // only replaced once all the build steps are written, in `Publish`.
+    temporary_file_path_ = file_path_ + ".tmp" + std::to_string(getpid());
+    fd_ = FileDescriptor::Open(temporary_file_path_.c_str(),
+                               O_CREAT | O_TRUNC | O_RDWR, 0644);
+#endif
   }
   XNNPACK_RETURN_CHECK(fd_.IsValid(), "could not open file ('%s'): %s.",
                        file_path_.c_str(), strerror(errno));
@@ -273,6 +414,9 @@ bool WeightCacheBuilder::Start(const char* path) {
 
 bool WeightCacheBuilder::StartBuildStep() {
   XNNPACK_RETURN_CHECK(IsStarted());
+  XNNPACK_RETURN_CHECK(
+      !is_published_,
+      "cannot add data to a cache file that was already published.");
 
   // Reload flatbuffer data.
   XNNPackCacheHeader header;
@@ -291,6 +435,8 @@ bool WeightCacheBuilder::StartBuildStep() {
   build_segment_start_ = fd_.SetPos(header.buffer_list_offset);
   XNNPACK_RETURN_CHECK(build_segment_start_ != -1);
 
+  // New buffers overwrite the buffer list that the header points to.
+  is_complete_ = false;
   is_build_step_ = true;
   return true;
 }
@@ -345,6 +491,7 @@ bool WeightCacheBuilder::StopBuildStep() {
   is_build_step_ = false;
   if (fd_.GetPos() == build_segment_start_ && first_write_done_) {
     // Nothing was written to the file, we can exit early.
+    is_complete_ = true;
     return true;
   }
 
@@ -372,11 +519,14 @@ bool WeightCacheBuilder::StopBuildStep() {
          xnn_experimental_get_build_identifier_size());
   header.buffer_list_offset = fd_.GetPos();
   header.buffer_list_size = builder.GetSize();
+  header.model_fingerprint = model_fingerprint_;
 
   // Write the flatbuffer which serves as a header to index the buffer data.
   XNNPACK_RETURN_CHECK(fd_.Write(builder.GetBufferPointer(), builder.GetSize()),
                        "cannot write buffer list to '%s'.", file_path_.c_str());
 
+  header.checksum = ComputeCacheChecksum(header, builder.GetBufferPointer());
+
   // Save the segment size for that it can be individually mapped.
   build_segment_size_ = fd_.GetPos() - build_segment_start_;
 
@@ -390,6 +540,7 @@ bool WeightCacheBuilder::StopBuildStep() {
   TFLITE_LOG_PROD(tflite::TFLITE_LOG_VERBOSE,
                   "XNNPack weight cache: written to '%s'.", file_path_.c_str());
   first_write_done_ = true;
+  is_complete_ = true;
   return true;
 }
 
@@ -411,6 +562,8 @@ MMapWeightCacheProvider& MMapWeightCacheProvider::operator=(
   swap(mmap_handles_, other.mmap_handles_);
   swap(mmap_buffer_base_offset_, other.mmap_buffer_base_offset_);
   swap(builder_, other.builder_);
+  swap(model_fingerprint_, other.model_fingerprint_);
+  swap(loaded_model_fingerprint_, other.loaded_model_fingerprint_);
   return *this;
 }
 
@@ -441,9 +594,10 @@ bool MMapWeightCacheProvider::LoadOrStartBuild(const char* path) {
 bool MMapWeightCacheProvider::StartBuild(const char* path) {
   SetFilePath(path);
   building_run_ = builder_.Start(path);
-  if (IsInMemoryCachePath(file_path_)) {
+  if (building_run_) {
     // Duplicate the file descriptor to avoid loosing the temporary file when
-    // the builder is reset.
+    // the builder is reset. The cache is also mapped through it because the
+    // file is only moved to `path` once it is complete.
     temporary_file_descriptor_ = builder_.GetFileDescriptor().Duplicate();
   }
   return building_run_;
@@ -456,6 +610,7 @@ bool MMapWeightCacheProvider::Load(const std::string& path) {
 
 bool MMapWeightCacheProvider::Load() {
   mmap_buffer_base_offset_ = 0;
+  loaded_model_fingerprint_ = 0;
   cache_key_to_offset_.clear();
   mmap_handles_.resize(1);
   MMapHandle& mmap_handle = mmap_handles_.front();
@@ -503,6 +658,20 @@ bool MMapWeightCacheProvider::Load() {
       header.buffer_list_size == mmap_handle.size() - header.buffer_list_offset,
       "invalid size for buffer list descriptor.");
 
+  // Only the header and the buffer list are checked: reading the packed
+  // buffers would fault in the whole file, which may be several GB.
+  XNNPACK_RETURN_CHECK(
+      header.checksum ==
+          ComputeCacheChecksum(header,
+                               mmap_handle.data() + header.buffer_list_offset),
+      "checksum mismatch, the cache file is corrupted. Cache needs to be built "
+      "again.");
+
+  XNNPACK_RETURN_CHECK(
+      model_fingerprint_ == 0 || header.model_fingerprint == 0 ||
+          header.model_fingerprint == model_fingerprint_,
+      "the cache was built for another model. Cache needs to be built again.");
+
   // Verifiy the flabuffer part of the file.
   flatbuffers::Verifier verifier(mmap_handle.data() + header.buffer_list_offset,
                                  header.buffer_list_size);
@@ -516,6 +685,7 @@ bool MMapWeightCacheProvider::Load() {
                        "could not get packed weights from flatbuffer.");
 
   mmap_buffer_base_offset_ = buffer_list->base_offset();
+  loaded_model_fingerprint_ = header.model_fingerprint;
   if (const auto buffers = buffer_list->buffers(); buffers) {
     for (auto* buffer : *buffers) {
       XNNPACK_RETURN_CHECK(buffer, "invalid buffer address in buffer list.");
@@ -615,6 +785,27 @@ bool MMapWeightCacheProvider::StopBuildStep() {
   return LoadLastBuildStep();
 }
 
+bool MMapWeightCacheProvider::SetModelFingerprint(const uint64_t fingerprint) {
+  XNNPACK_ABORT_CHECK(!IsBuilding(),
+                      "Cannot set the model fingerprint during a build step.");
+  model_fingerprint_ = fingerprint;
+  builder_.SetModelFingerprint(fingerprint);
+  if (building_run_ || mmap_handles_.empty() ||
+      loaded_model_fingerprint_ == 0 ||
+      loaded_model_fingerprint_ == fingerprint) {
+    return true;
+  }
+  TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                  "XNNPack weight cache: '%s' was built for another model. "
+                  "Building it again.",
+                  file_path_.c_str());
+  const std::string path = file_path_;
+  Release();
+  model_fingerprint_ = fingerprint;
+  builder_.SetModelFingerprint(fingerprint);
+  return StartBuild(path.c_str());
+}
+
 void MMapWeightCacheProvider::MapTensorIdentifiers(
     const TfLiteTensor* tensors, const size_t size,
     const std::unordered_map<size_t, size_t>& tensor_index_to_identifier) {
@@ -685,6 +876,9 @@ void MMapWeightCacheProvider::Release() {
   cache_key_to_offset_.clear();
   mmap_handles_.clear();
   mmap_buffer_base_offset_ = 0;
+  offset_to_addr_.clear();
+  model_fingerprint_ = 0;
+  loaded_model_fingerprint_ = 0;
   builder_ = WeightCacheBuilder();
 }
 
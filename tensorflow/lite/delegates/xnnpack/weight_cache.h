@@ -54,14 +54,38 @@ inline constexpr char kInMemoryCachePath[] = ":memory";
 //
 // When reading a cache file, the cache should be rejected if `version`
 // doesn't match `kVersion`.
+//
+// `checksum` covers the header and the buffer list, but not the packed buffers,
+// so that loading a cache doesn't read all of it. `model_fingerprint`
+// identifies the model the cache was built for (see `ComputeModelFingerprint`),
+// 0 means that it is unknown.
 struct XNNPackCacheHeader {
-  enum : uint64_t { kInvalidHeader = 0, kVersion = 1 };
+  enum : uint64_t { kInvalidHeader = 0, kVersion = 2 };
   uint64_t version;
   uint8_t xnnpack_build_identifier[32];
   uint64_t buffer_list_offset;
   uint64_t buffer_list_size;
+  uint64_t model_fingerprint;
+  uint64_t checksum;
 };
 
+// Computes the checksum stored in `XNNPackCacheHeader::checksum`.
+//
+// `buffer_list_data` points to the `header.buffer_list_size` bytes of the
+// buffer list. The current value of `header.checksum` is ignored.
+uint64_t ComputeCacheChecksum(const XNNPackCacheHeader& header,
+                              const uint8_t* buffer_list_data);
+
+// Computes a fingerprint of the constant buffers of a model.
+//
+// The fingerprint combines each buffer identifier with the type and size of
+// the tensor that holds it and a few samples of its data. It is meant to detect
+// a cache file that was built for another version of a model without reading
+// all of the model weights. Never returns 0.
+uint64_t ComputeModelFingerprint(
+    const TfLiteTensor* tensors, size_t size,
+    const std::unordered_map<size_t, size_t>& tensor_index_to_identifier);
+
 struct PackIdentifier {
   enum { kNoId = SIZE_MAX };
   uint64_t pack_algorithm_id = kNoId;
@@ -171,7 +195,9 @@ class MMapHandle {
 class WeightCacheBuilder {
  public:
   WeightCacheBuilder() = default;
-  ~WeightCacheBuilder() = default;
+  // Publishes the cache file if its last build step was written, removes it
+  // otherwise.
+  ~WeightCacheBuilder();
 
   // Non-copyable.
   WeightCacheBuilder(const WeightCacheBuilder&) = delete;
@@ -215,10 +241,24 @@ class WeightCacheBuilder {
   BufferLocation Append(PackIdentifier pack_id, const void* data,
                         uint64_t size);
 
+  // Sets the model fingerprint written in the cache header.
+  void SetModelFingerprint(uint64_t fingerprint) {
+    model_fingerprint_ = fingerprint;
+  }
+
   // Writes the flatbuffer to disk.
   [[nodiscard /*Writing the weight cache can fail.*/]]
   bool StopBuildStep();
 
+  // Moves the cache file to the path given to `Start`.
+  //
+  // Data is written to a temporary file until then, and no build step can be
+  // started afterwards, so processes that have the previous file mapped keep
+  // on using it untouched. This is done on destruction if it wasn't called.
+  // No-op for in-memory caches.
+  [[nodiscard /*Renaming the weight cache can fail.*/]]
+  bool Publish();
+
   // Get the offset in the cache file of the data written during the last step.
   //
   // This includes the buffers that were appended and the whole buffer mapping.
@@ -253,6 +293,8 @@ class WeightCacheBuilder {
   uint8_t* data() const { return data_.get(); }
 
  private:
+  void PublishOrRemoveTemporaryFile();
+
   std::unique_ptr<uint8_t[]> data_ = nullptr;
   cache::schema::BufferListT schema_;
   size_t capacity_ = 0;
@@ -267,6 +309,14 @@ class WeightCacheBuilder {
   // Temporary file descriptor to write the weights to disk immediately.
   FileDescriptor fd_;
   std::string file_path_;
+  // File the data is written to until the cache is published to `file_path_`.
+  // Empty once published or for in-memory caches.
+  std::string temporary_file_path_;
+  uint64_t model_fingerprint_ = 0;
+  // True when the file holds a header and a buffer list that describe all of
+  // its data, i.e. the last build step was successfully written.
+  bool is_complete_ = false;
+  bool is_published_ = false;
 
   bool is_build_step_ = false;
 };
@@ -330,6 +380,20 @@ class MMapWeightCacheProvider {
   [[nodiscard /*Updating cache data may fail.*/]]
   bool StopBuildStep();
 
+  // Returns true if `SetModelFingerprint` was called successfully.
+  [[nodiscard]]
+  bool HasModelFingerprint() const {
+    return model_fingerprint_ != 0;
+  }
+
+  // Sets the fingerprint of the model the cache is used with.
+  //
+  // If the cache was loaded from a file built for another model, the file is
+  // discarded and a new cache build is started for the same path. This must be
+  // called before any data is looked up in the cache.
+  [[nodiscard /*Restarting a cache build may fail.*/]]
+  bool SetModelFingerprint(uint64_t fingerprint);
+
   // Creates the tensor map.
   void MapTensorIdentifiers(
       const TfLiteTensor* tensors, size_t size,
@@ -370,6 +434,8 @@ class MMapWeightCacheProvider {
   void* OffsetToAddr(size_t offset);
 
   // Releases the weight cache's memory.
+  //
+  // A cache file being built is published (see `WeightCacheBuilder::Publish`).
   void Release();
 
   // Returns true if any weights have been added to the underlying builder.
@@ -444,8 +510,8 @@ class MMapWeightCacheProvider {
   // The offset to the first buffer data in the MMap allocation.
   size_t mmap_buffer_base_offset_;
 
-  // Can hold a file descriptor when building a temporary cache to prevent it
-  // from being deleted.
+  // Holds a file descriptor to the cache being built, to prevent an in-memory
+  // cache from being deleted and to map a file that isn't published yet.
   FileDescriptor temporary_file_descriptor_;
 
   // Used to build the cache.
@@ -467,6 +533,12 @@ class MMapWeightCacheProvider {
   // Stores the loaded buffer addresses corresponding to the given offset in the
   // cache file.
   std::map<size_t, void*> offset_to_addr_;
+
+  // Fingerprint of the model the cache is used with, 0 until it is set.
+  uint64_t model_fingerprint_ = 0;
+
+  // Fingerprint stored in the header of the loaded cache file.
+  uint64_t loaded_model_fingerprint_ = 0;
 };
 
 }  // namespace xnnpack
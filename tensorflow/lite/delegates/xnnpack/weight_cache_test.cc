@@ -324,6 +324,7 @@ TEST(WeightCacheBuilderTest, ReserveAppendWriteWorks) {
   EXPECT_GE(builder.capacity(), payload_size);
 
   ASSERT_TRUE(builder.StopBuildStep());
+  ASSERT_TRUE(builder.Publish());
 
   MMapHandle handle;
   ASSERT_TRUE(handle.Map(cache_path.c_str()));
@@ -386,6 +387,7 @@ TEST(WeightCacheBuilderTest, AppendWithoutReserveWriteWorks) {
   EXPECT_EQ(loc.size, payload_size);
 
   ASSERT_TRUE(builder.StopBuildStep());
+  ASSERT_TRUE(builder.Publish());
 
   MMapHandle handle;
   ASSERT_TRUE(handle.Map(cache_path.c_str()));
@@ -497,7 +499,7 @@ TEST(WeightCacheBuilderTest, MultipleStepBuild) {
   ASSERT_TRUE(builder.StopBuildStep());
 
   MMapHandle handle;
-  ASSERT_TRUE(handle.Map(tmp_file.GetCPath()));
+  ASSERT_TRUE(handle.Map(builder.GetFileDescriptor()));
 
   ASSERT_TRUE(builder.StartBuildStep());
   {
@@ -510,6 +512,7 @@ TEST(WeightCacheBuilderTest, MultipleStepBuild) {
   }
 
   ASSERT_TRUE(builder.StopBuildStep());
+  ASSERT_TRUE(builder.Publish());
 
   ASSERT_TRUE(handle.Map(tmp_file.GetCPath()));
 
@@ -582,6 +585,61 @@ TEST(WeightCacheBuilderTest, MultipleStepBuild) {
   EXPECT_THAT(GetBufferData(buffer3), ElementsAreArray(payload3));
 }
 
+TEST(WeightCacheBuilderTest, PublishesCompleteFileOnly) {
+#if defined(_MSC_VER)
+  GTEST_SKIP() << "The cache file is written in place on Windows.";
+#endif
+  const std::string payload = "This is some data in the file.";
+  const std::string cache_path = testing::TempDir() + "/published_cache";
+  unlink(cache_path.c_str());
+
+  WeightCacheBuilder builder;
+  ASSERT_TRUE(builder.Start(cache_path.c_str()));
+  ASSERT_TRUE(builder.StartBuildStep());
+  builder.Append(PackIdentifier{1, 2, 3}, payload.c_str(), payload.size());
+  EXPECT_FALSE(builder.Publish());
+  ASSERT_TRUE(builder.StopBuildStep());
+
+  // Build steps don't write to the cache path.
+  EXPECT_NE(access(cache_path.c_str(), F_OK), 0);
+  ASSERT_TRUE(builder.StartBuildStep());
+  ASSERT_TRUE(builder.StopBuildStep());
+  EXPECT_NE(access(cache_path.c_str(), F_OK), 0);
+
+  ASSERT_TRUE(builder.Publish());
+  EXPECT_EQ(access(cache_path.c_str(), F_OK), 0);
+  // The published file is never written to again.
+  EXPECT_FALSE(builder.StartBuildStep());
+}
+
+TEST(WeightCacheBuilderTest, DestructionPublishesCompleteFile) {
+#if defined(_MSC_VER)
+  GTEST_SKIP() << "The cache file is written in place on Windows.";
+#endif
+  const std::string payload = "This is some data in the file.";
+  const std::string cache_path = testing::TempDir() + "/destroyed_cache";
+  unlink(cache_path.c_str());
+  {
+    WeightCacheBuilder builder;
+    ASSERT_TRUE(builder.Start(cache_path.c_str()));
+    ASSERT_TRUE(builder.StartBuildStep());
+    builder.Append(PackIdentifier{1, 2, 3}, payload.c_str(), payload.size());
+    ASSERT_TRUE(builder.StopBuildStep());
+    // An interrupted build step leaves the file inconsistent.
+    ASSERT_TRUE(builder.StartBuildStep());
+    builder.Append(PackIdentifier{2, 3, 4}, payload.c_str(), payload.size());
+  }
+  EXPECT_NE(access(cache_path.c_str(), F_OK), 0);
+  {
+    WeightCacheBuilder builder;
+    ASSERT_TRUE(builder.Start(cache_path.c_str()));
+    ASSERT_TRUE(builder.StartBuildStep());
+    builder.Append(PackIdentifier{1, 2, 3}, payload.c_str(), payload.size());
+    ASSERT_TRUE(builder.StopBuildStep());
+  }
+  EXPECT_EQ(access(cache_path.c_str(), F_OK), 0);
+}
+
 struct FakeContext {
   // Adds a new tensor and it's backing buffer to the context.
   //
@@ -806,9 +864,11 @@ TEST_F(BuildMMapWeightCacheProviderTest, BuildStepSequenceWorks) {
 
 struct LoadMMapWeightCacheProviderTest : BuildMMapWeightCacheProviderTest {
   enum { kWeightIndex1, kBiasIndex, kWeightIndex2 };
+  static constexpr uint64_t kModelFingerprint = 0xF1D0;
 
   void SetUp() override {
     BuildMMapWeightCacheProviderTest::SetUp();
+    ASSERT_TRUE(cache_provider.SetModelFingerprint(kModelFingerprint));
     ASSERT_TRUE(cache_provider.StartBuildStep());
 
     pack_id_1 = ctx.PackTensors(&cache_provider.GetCacheProvider(), kAlgoSeed1,
@@ -819,6 +879,12 @@ struct LoadMMapWeightCacheProviderTest : BuildMMapWeightCacheProviderTest {
     ASSERT_TRUE(cache_provider.StopBuildStep());
   }
 
+  // Publishes the cache file so that it can be loaded from its path.
+  void ReleaseCacheProvider() {
+    cache_provider.Release();
+    ASSERT_EQ(access(tmp_file.GetCPath(), F_OK), 0);
+  }
+
   xnn_weights_cache_look_up_key LookUpKey1() const {
     return ctx.LookUpKey(kAlgoSeed1, kWeightIndex1, kBiasIndex);
   }
@@ -861,6 +927,134 @@ TEST_F(LoadMMapWeightCacheProviderTest, LookUpSucceeds) {
               ElementsAreArray(reference_2.buffer));
 }
 
+TEST_F(LoadMMapWeightCacheProviderTest, ReloadSucceeds) {
+  ReleaseCacheProvider();
+  MMapWeightCacheProvider reloaded_provider;
+  ASSERT_TRUE(reloaded_provider.Load(tmp_file.GetPath()));
+  EXPECT_FALSE(reloaded_provider.CanStartBuildStep());
+}
+
+TEST_F(LoadMMapWeightCacheProviderTest, ReloadFailsBeforePublication) {
+#if defined(_MSC_VER)
+  GTEST_SKIP() << "The cache file is written in place on Windows.";
+#endif
+  MMapWeightCacheProvider reloaded_provider;
+  EXPECT_FALSE(reloaded_provider.Load(tmp_file.GetPath()));
+}
+
+TEST_F(LoadMMapWeightCacheProviderTest, CorruptedFileFailsToLoad) {
+  ReleaseCacheProvider();
+  {
+    FileDescriptor fd = FileDescriptor::Open(tmp_file.GetCPath(), O_RDWR);
+    ASSERT_TRUE(fd.IsValid());
+    XNNPackCacheHeader header;
+    ASSERT_TRUE(fd.Read(&header, sizeof(header)));
+    // Flip the last byte of the buffer list.
+    const size_t offset =
+        header.buffer_list_offset + header.buffer_list_size - 1;
+    uint8_t byte;
+    ASSERT_NE(fd.SetPos(offset), -1);
+    ASSERT_TRUE(fd.Read(&byte, 1));
+    byte ^= 0xFF;
+    ASSERT_NE(fd.SetPos(offset), -1);
+    ASSERT_TRUE(fd.Write(&byte, 1));
+  }
+  MMapWeightCacheProvider reloaded_provider;
+  EXPECT_FALSE(reloaded_provider.Load(tmp_file.GetPath()));
+}
+
+TEST_F(LoadMMapWeightCacheProviderTest, RebuildsCacheForAnotherModel) {
+  ReleaseCacheProvider();
+  MMapWeightCacheProvider reloaded_provider;
+  ASSERT_TRUE(reloaded_provider.Load(tmp_file.GetPath()));
+  ASSERT_TRUE(reloaded_provider.SetModelFingerprint(kModelFingerprint + 1));
+  EXPECT_TRUE(reloaded_provider.IsActive());
+  EXPECT_TRUE(reloaded_provider.CanStartBuildStep());
+
+  reloaded_provider.MapTensorIdentifiers(ctx.tensors.data(), ctx.tensors.size(),
+                                         ctx.tensor_buffer_identifiers);
+  const xnn_weights_cache_look_up_key look_up_key = LookUpKey1();
+  EXPECT_EQ(reloaded_provider.LookUp(&look_up_key), SIZE_MAX);
+}
+
+TEST_F(LoadMMapWeightCacheProviderTest, KeepsCacheForSameModel) {
+  ReleaseCacheProvider();
+  MMapWeightCacheProvider reloaded_provider;
+  ASSERT_TRUE(reloaded_provider.Load(tmp_file.GetPath()));
+  ASSERT_TRUE(reloaded_provider.SetModelFingerprint(kModelFingerprint));
+  EXPECT_FALSE(reloaded_provider.CanStartBuildStep());
+
+  reloaded_provider.MapTensorIdentifiers(ctx.tensors.data(), ctx.tensors.size(),
+                                         ctx.tensor_buffer_identifiers);
+  const xnn_weights_cache_look_up_key look_up_key = LookUpKey1();
+  EXPECT_EQ(reloaded_provider.LookUp(&look_up_key),
+            ctx.packed_buffers.find(pack_id_1)->second.offset);
+}
+
+TEST_F(LoadMMapWeightCacheProviderTest, RebuildDoesNotAffectLoadedCaches) {
+  ReleaseCacheProvider();
+  MMapWeightCacheProvider loaded_provider;
+  ASSERT_TRUE(loaded_provider.Load(tmp_file.GetPath()));
+  loaded_provider.MapTensorIdentifiers(ctx.tensors.data(), ctx.tensors.size(),
+                                       ctx.tensor_buffer_identifiers);
+
+  // Another process rebuilds the cache file.
+  {
+    MMapWeightCacheProvider building_provider;
+    ASSERT_TRUE(building_provider.StartBuild(tmp_file.GetCPath()));
+    building_provider.MapTensorIdentifiers(
+        ctx.tensors.data(), ctx.tensors.size(), ctx.tensor_buffer_identifiers);
+    ASSERT_TRUE(building_provider.StartBuildStep());
+    const char other_data[] = "other packed data";
+    const xnn_weights_cache_look_up_key look_up_key = LookUpKey2();
+    EXPECT_NE(building_provider.LookUpOrInsert(
+                  &look_up_key, (void*)other_data, sizeof(other_data)),
+              SIZE_MAX);
+    ASSERT_TRUE(building_provider.StopBuildStep());
+  }
+
+  const auto& reference = ctx.packed_buffers.find(pack_id_1)->second;
+  const xnn_weights_cache_look_up_key look_up_key = LookUpKey1();
+  const size_t offset = loaded_provider.LookUp(&look_up_key);
+  ASSERT_EQ(offset, reference.offset);
+  EXPECT_THAT(LightSpan<const uint8_t>(loaded_provider.OffsetToAddr(offset),
+                                       reference.buffer.size()),
+              ElementsAreArray(reference.buffer));
+}
+
+TEST(ComputeModelFingerprintTest, DependsOnBufferContents) {
+  std::vector<uint8_t> data_1(1000, 1);
+  std::vector<float> data_2(3, 2.0f);
+  TfLiteTensor tensors[2] = {};
+  tensors[0].type = kTfLiteUInt8;
+  tensors[0].bytes = data_1.size();
+  tensors[0].data.data = data_1.data();
+  tensors[1].type = kTfLiteFloat32;
+  tensors[1].bytes = data_2.size() * sizeof(float);
+  tensors[1].data.data = data_2.data();
+  const std::unordered_map<size_t, size_t> identifiers{{0, 5}, {1, 7}};
+
+  const uint64_t fingerprint =
+      ComputeModelFingerprint(tensors, 2, identifiers);
+  EXPECT_NE(fingerprint, 0);
+  EXPECT_EQ(ComputeModelFingerprint(tensors, 2, identifiers), fingerprint);
+
+  data_1.back() = 3;
+  EXPECT_NE(ComputeModelFingerprint(tensors, 2, identifiers), fingerprint);
+  data_1.back() = 1;
+
+  data_2[1] = 4.0f;
+  EXPECT_NE(ComputeModelFingerprint(tensors, 2, identifiers), fingerprint);
+  data_2[1] = 2.0f;
+
+  tensors[1].type = kTfLiteInt32;
+  EXPECT_NE(ComputeModelFingerprint(tensors, 2, identifiers), fingerprint);
+  tensors[1].type = kTfLiteFloat32;
+
+  EXPECT_NE(ComputeModelFingerprint(tensors, 2, {{0, 7}, {1, 5}}),
+            fingerprint);
+}
+
 TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   using std::size;
   TempFileDesc temp_fd(TempFileDesc::kAutoClose);
@@ -823,10 +823,22 @@ class Subgraph {
                           Delegate& delegate) {
     // Map tensors identifiers before packing anything.
     if (delegate.weight_cache_provider_.IsActive()) {
-      delegate.weight_cache_provider_.MapTensorIdentifiers(
-          context->tensors, context->tensors_size,
+      const std::unordered_map<size_t, size_t>& tensor_buffer_identifiers =
           reinterpret_cast<tflite::Subgraph*>(context->impl_)
-              ->GetTensorBufferIdentifiers());
+              ->GetTensorBufferIdentifiers();
+      // The first delegated subgraph identifies the model. A cache file that
+      // was built for another model is rebuilt before anything is packed.
+      if (!delegate.weight_cache_provider_.HasModelFingerprint() &&
+          !delegate.weight_cache_provider_.SetModelFingerprint(
+              ComputeModelFingerprint(context->tensors, context->tensors_size,
+                                      tensor_buffer_identifiers))) {
+        TF_LITE_KERNEL_LOG(context,
+                           "XNNPack delegate failed to rebuild the weight "
+                           "cache for this model.");
+        return nullptr;
+      }
+      delegate.weight_cache_provider_.MapTensorIdentifiers(
+          context->tensors, context->tensors_size, tensor_buffer_identifiers);
     }
     // Convert subgraph inputs and outputs to hash sets for faster lookup.
     const std::unordered_set<int> inputs(
@@ -0,0 +1,162 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/genai/kv_cache_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/signature_runner.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace genai {
+namespace {
+
+size_t AlignTo(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+std::shared_ptr<KVCachePool> KVCachePool::Create(size_t page_bytes,
+                                                 int num_pages) {
+  if (page_bytes == 0 || num_pages <= 0) return nullptr;
+  return std::shared_ptr<KVCachePool>(new KVCachePool(page_bytes, num_pages));
+}
+
+KVCachePool::KVCachePool(size_t page_bytes, int num_pages)
+    // Keeps every page aligned.
+    : page_bytes_(AlignTo(page_bytes, kDefaultTensorAlignment)),
+      num_pages_(num_pages),
+      buffer_(new uint8_t[page_bytes_ * num_pages + kDefaultTensorAlignment]) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(buffer_.get());
+  pages_ =
+      buffer_.get() + (AlignTo(address, kDefaultTensorAlignment) - address);
+  free_pages_.reserve(num_pages);
+  // Hands out the pages in order.
+  for (int page = num_pages - 1; page >= 0; --page) {
+    free_pages_.push_back(page);
+  }
+}
+
+int KVCachePool::num_free_pages() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return free_pages_.size();
+}
+
+int KVCachePool::AcquirePage() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_pages_.empty()) return -1;
+  const int page = free_pages_.back();
+  free_pages_.pop_back();
+  return page;
+}
+
+void KVCachePool::ReleasePage(int page) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_pages_.push_back(page);
+}
+
+std::unique_ptr<KVCacheSession> KVCacheSession::Create(
+    std::shared_ptr<KVCachePool> pool, impl::SignatureRunner* runner,
+    const std::vector<StatefulTensor>& stateful_tensors) {
+  if (pool == nullptr || runner == nullptr) return nullptr;
+  std::vector<Binding> bindings;
+  bindings.reserve(stateful_tensors.size());
+  size_t offset = 0;
+  for (const StatefulTensor& names : stateful_tensors) {
+    const TfLiteTensor* input = runner->input_tensor(names.input_name.c_str());
+    const TfLiteTensor* output =
+        runner->output_tensor(names.output_name.c_str());
+    if (input == nullptr || output == nullptr) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Stateful tensor '%s' -> '%s' is not in the signature.",
+                      names.input_name.c_str(), names.output_name.c_str());
+      return nullptr;
+    }
+    // The output shape may not be known before the tensors are allocated, in
+    // which case AllocateTensors checks that it fits when binding.
+    if (input->type != output->type ||
+        (output->bytes != 0 && output->bytes != input->bytes)) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Stateful tensors '%s' and '%s' don't match.",
+                      names.input_name.c_str(), names.output_name.c_str());
+      return nullptr;
+    }
+    bindings.push_back({names, offset, input->bytes});
+    offset = AlignTo(offset + input->bytes, kDefaultTensorAlignment);
+  }
+  if (offset > pool->page_bytes()) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Stateful tensors need %zu bytes, but pages have %zu.",
+                    offset, pool->page_bytes());
+    return nullptr;
+  }
+  const int page = pool->AcquirePage();
+  if (page < 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "KV cache pool has no free page.");
+    return nullptr;
+  }
+  std::unique_ptr<KVCacheSession> session(new KVCacheSession(
+      std::move(pool), page, runner, std::move(bindings)));
+  session->Reset();
+  return session;
+}
+
+KVCacheSession::KVCacheSession(std::shared_ptr<KVCachePool> pool, int page,
+                               impl::SignatureRunner* runner,
+                               std::vector<Binding> bindings)
+    : pool_(std::move(pool)),
+      page_(page),
+      runner_(runner),
+      bindings_(std::move(bindings)) {}
+
+KVCacheSession::~KVCacheSession() { pool_->ReleasePage(page_); }
+
+TfLiteStatus KVCacheSession::Bind() {
+  uint8_t* page_data = pool_->page_data(page_);
+  for (const Binding& binding : bindings_) {
+    const TfLiteCustomAllocation allocation = {page_data + binding.offset,
+                                               binding.bytes};
+    TF_LITE_ENSURE_STATUS(runner_->SetCustomAllocationForInputTensor(
+        binding.names.input_name.c_str(), allocation));
+    TF_LITE_ENSURE_STATUS(runner_->SetCustomAllocationForOutputTensor(
+        binding.names.output_name.c_str(), allocation));
+  }
+  // Plans the memory of the other tensors the first time. Afterwards, only
+  // checks the new allocations.
+  return runner_->AllocateTensors();
+}
+
+void KVCacheSession::Reset() {
+  uint8_t* page_data = pool_->page_data(page_);
+  for (const Binding& binding : bindings_) {
+    std::memset(page_data + binding.offset, 0, binding.bytes);
+  }
+}
+
+const void* KVCacheSession::state(int index) const {
+  return pool_->page_data(page_) + bindings_[index].offset;
+}
+
+}  // namespace genai
+}  // namespace tflite
@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_KV_CACHE_POOL_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_KV_CACHE_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/signature_runner.h"
+
+namespace tflite {
+namespace genai {
+
+/// WARNING: Experimental interface, subject to change.
+// A pair of signature input and output that hold the same state across
+// invocations, e.g. the key cache that a decoder step reads and the key cache
+// that it returns after a DYNAMIC_UPDATE_SLICE with the new token.
+struct StatefulTensor {
+  std::string input_name;
+  std::string output_name;
+};
+
+/// WARNING: Experimental interface, subject to change.
+// A pool of preallocated, fixed-size pages that hold the stateful tensors of
+// decoding sessions. A pool can be shared by any number of sessions, signature
+// runners and interpreters, from any thread.
+class KVCachePool {
+ public:
+  // Allocates `num_pages` pages of `page_bytes` bytes up front. Returns nullptr
+  // if either is 0.
+  static std::shared_ptr<KVCachePool> Create(size_t page_bytes, int num_pages);
+
+  KVCachePool(const KVCachePool&) = delete;
+  KVCachePool& operator=(const KVCachePool&) = delete;
+
+  size_t page_bytes() const { return page_bytes_; }
+  int num_pages() const { return num_pages_; }
+  int num_free_pages() const;
+
+  // Returns the index of a page that is not in use, or -1 if all are.
+  int AcquirePage();
+  void ReleasePage(int page);
+
+  // Pages are aligned to kDefaultTensorAlignment.
+  uint8_t* page_data(int page) const { return pages_ + page * page_bytes_; }
+
+ private:
+  KVCachePool(size_t page_bytes, int num_pages);
+
+  const size_t page_bytes_;
+  const int num_pages_;
+  std::unique_ptr<uint8_t[]> buffer_;
+  uint8_t* pages_;
+  mutable std::mutex mutex_;
+  std::vector<int> free_pages_;
+};
+
+/// WARNING: Experimental interface, subject to change.
+// The state of one decoding session of a signature, stored in a page of a
+// KVCachePool.
+//
+// Binding a session makes both tensors of each StatefulTensor pair point to the
+// same buffer in the page. Ops that update their input in place, such as
+// DYNAMIC_UPDATE_SLICE, then only write the new slice instead of copying the
+// whole state to the output, and the caller doesn't need to copy the output
+// back to the input before the next step. Switching sessions only swaps
+// buffers: memory is not planned again.
+//
+// Usage:
+//
+//   auto pool = KVCachePool::Create(page_bytes, /*num_pages=*/8);
+//   auto session = KVCacheSession::Create(pool, runner, {{"k_cache",
+//       "updated_k_cache"}, {"v_cache", "updated_v_cache"}});
+//   for (...) {
+//     session->Bind();
+//     // Set the other inputs.
+//     runner->Invoke();
+//   }
+class KVCacheSession {
+ public:
+  // Acquires a page of `pool` for the `stateful_tensors` of `runner` and fills
+  // it with zeros. Returns nullptr if the pool has no free page, or if the
+  // tensors are missing, mismatched or don't fit in a page.
+  //
+  // The shapes of the stateful tensors must not change afterwards.
+  static std::unique_ptr<KVCacheSession> Create(
+      std::shared_ptr<KVCachePool> pool, impl::SignatureRunner* runner,
+      const std::vector<StatefulTensor>& stateful_tensors);
+
+  // Releases the page. The runner must be bound to another session before it
+  // is invoked again.
+  ~KVCacheSession();
+
+  KVCacheSession(const KVCacheSession&) = delete;
+  KVCacheSession& operator=(const KVCacheSession&) = delete;
+
+  // Makes the next invocations of the runner read and update the state of this
+  // session. The first binding of a runner also allocates its tensors.
+  TfLiteStatus Bind();
+
+  // Clears the state, e.g. to start a new sequence.
+  void Reset();
+
+  // Returns the state of the `index`-th stateful tensor.
+  const void* state(int index) const;
+
+ private:
+  struct Binding {
+    StatefulTensor names;
+    size_t offset;
+    size_t bytes;
+  };
+
+  KVCacheSession(std::shared_ptr<KVCachePool> pool, int page,
+                 impl::SignatureRunner* runner, std::vector<Binding> bindings);
+
+  std::shared_ptr<KVCachePool> pool_;
+  const int page_;
+  impl::SignatureRunner* runner_;
+  std::vector<Binding> bindings_;
+};
+
+}  // namespace genai
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_GENAI_KV_CACHE_POOL_H_
@@ -0,0 +1,193 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/genai/kv_cache_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/core/signature_runner.h"
+#include "tensorflow/lite/interpreter_test_util.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace genai {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr int kCacheSize = 4;
+constexpr int kHeadDim = 8;
+constexpr size_t kCacheBytes = kCacheSize * kHeadDim * sizeof(float);
+
+// A decoder step that writes the new entry of the cache at the given position:
+// new_cache = DYNAMIC_UPDATE_SLICE(cache, update, start).
+class KVCacheSessionTest : public InterpreterTest {
+ protected:
+  void SetUp() override {
+    interpreter_->AddTensors(4);
+    interpreter_->SetInputs({0, 1, 2});
+    interpreter_->SetOutputs({3});
+    TfLiteQuantizationParams quant;
+    interpreter_->SetTensorParametersReadWrite(
+        0, kTfLiteFloat32, "cache", {1, kCacheSize, kHeadDim}, quant);
+    interpreter_->SetTensorParametersReadWrite(1, kTfLiteFloat32, "update",
+                                               {1, 1, kHeadDim}, quant);
+    interpreter_->SetTensorParametersReadWrite(2, kTfLiteInt32, "start", {3},
+                                               quant);
+    interpreter_->SetTensorParametersReadWrite(
+        3, kTfLiteFloat32, "new_cache", {1, kCacheSize, kHeadDim}, quant);
+    interpreter_->AddNodeWithParameters(
+        {0, 1, 2}, {3}, nullptr, 0, nullptr,
+        ops::builtin::Register_DYNAMIC_UPDATE_SLICE());
+    BuildSignature("decode", {{"cache", 0}, {"update", 1}, {"start", 2}},
+                   {{"new_cache", 3}});
+    runner_ = interpreter_->GetSignatureRunner("decode");
+    ASSERT_NE(runner_, nullptr);
+  }
+
+  // Binds `session` and fills the entry at `position` of its cache with
+  // `value`.
+  void Step(KVCacheSession* session, int position, float value) {
+    ASSERT_EQ(session->Bind(), kTfLiteOk);
+    float* update = runner_->input_tensor("update")->data.f;
+    std::fill(update, update + kHeadDim, value);
+    int32_t* start = runner_->input_tensor("start")->data.i32;
+    start[0] = 0;
+    start[1] = position;
+    start[2] = 0;
+    ASSERT_EQ(runner_->Invoke(), kTfLiteOk);
+  }
+
+  // Returns the value of each entry of the cache of `session`.
+  static std::vector<float> State(const KVCacheSession& session) {
+    const float* state = static_cast<const float*>(session.state(0));
+    std::vector<float> entries;
+    for (int i = 0; i < kCacheSize; ++i) {
+      for (int j = 1; j < kHeadDim; ++j) {
+        EXPECT_EQ(state[i * kHeadDim + j], state[i * kHeadDim]);
+      }
+      entries.push_back(state[i * kHeadDim]);
+    }
+    return entries;
+  }
+
+  const std::vector<StatefulTensor> stateful_tensors_ = {
+      {"cache", "new_cache"}};
+  impl::SignatureRunner* runner_ = nullptr;
+};
+
+TEST(KVCachePoolTest, AcquireAndRelease) {
+  auto pool = KVCachePool::Create(/*page_bytes=*/100, /*num_pages=*/2);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->page_bytes() % kDefaultTensorAlignment, 0);
+  EXPECT_GE(pool->page_bytes(), 100);
+  EXPECT_EQ(pool->num_free_pages(), 2);
+
+  const int page0 = pool->AcquirePage();
+  const int page1 = pool->AcquirePage();
+  EXPECT_EQ(page0, 0);
+  EXPECT_EQ(page1, 1);
+  EXPECT_EQ(pool->AcquirePage(), -1);
+  EXPECT_EQ(pool->num_free_pages(), 0);
+  for (int page : {page0, page1}) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(pool->page_data(page)) %
+                  kDefaultTensorAlignment,
+              0);
+  }
+
+  pool->ReleasePage(page1);
+  EXPECT_EQ(pool->num_free_pages(), 1);
+  EXPECT_EQ(pool->AcquirePage(), page1);
+}
+
+TEST(KVCachePoolTest, RejectsEmptyPool) {
+  EXPECT_EQ(KVCachePool::Create(/*page_bytes=*/0, /*num_pages=*/1), nullptr);
+  EXPECT_EQ(KVCachePool::Create(/*page_bytes=*/64, /*num_pages=*/0), nullptr);
+}
+
+TEST_F(KVCacheSessionTest, UpdatesStateInPlace) {
+  auto pool = KVCachePool::Create(kCacheBytes, /*num_pages=*/1);
+  auto session = KVCacheSession::Create(pool, runner_, stateful_tensors_);
+  ASSERT_NE(session, nullptr);
+  EXPECT_THAT(State(*session), ElementsAre(0, 0, 0, 0));
+
+  Step(session.get(), /*position=*/0, 1);
+  Step(session.get(), /*position=*/1, 2);
+
+  EXPECT_EQ(runner_->input_tensor("cache")->data.raw,
+            runner_->output_tensor("new_cache")->data.raw);
+  EXPECT_EQ(runner_->input_tensor("cache")->data.raw, session->state(0));
+  EXPECT_THAT(State(*session), ElementsAre(1, 2, 0, 0));
+}
+
+TEST_F(KVCacheSessionTest, SessionsKeepSeparateState) {
+  auto pool = KVCachePool::Create(kCacheBytes, /*num_pages=*/2);
+  auto session_a = KVCacheSession::Create(pool, runner_, stateful_tensors_);
+  auto session_b = KVCacheSession::Create(pool, runner_, stateful_tensors_);
+  ASSERT_NE(session_a, nullptr);
+  ASSERT_NE(session_b, nullptr);
+
+  Step(session_a.get(), /*position=*/0, 1);
+  Step(session_b.get(), /*position=*/0, 3);
+  Step(session_a.get(), /*position=*/1, 2);
+  Step(session_b.get(), /*position=*/3, 4);
+
+  EXPECT_THAT(State(*session_a), ElementsAre(1, 2, 0, 0));
+  EXPECT_THAT(State(*session_b), ElementsAre(3, 0, 0, 4));
+
+  session_a->Reset();
+  EXPECT_THAT(State(*session_a), ElementsAre(0, 0, 0, 0));
+  EXPECT_THAT(State(*session_b), ElementsAre(3, 0, 0, 4));
+}
+
+TEST_F(KVCacheSessionTest, SessionsShareThePool) {
+  auto pool = KVCachePool::Create(kCacheBytes, /*num_pages=*/2);
+  auto session_a = KVCacheSession::Create(pool, runner_, stateful_tensors_);
+  auto session_b = KVCacheSession::Create(pool, runner_, stateful_tensors_);
+  EXPECT_EQ(KVCacheSession::Create(pool, runner_, stateful_tensors_), nullptr);
+
+  session_a.reset();
+  EXPECT_EQ(pool->num_free_pages(), 1);
+  auto session_c = KVCacheSession::Create(pool, runner_, stateful_tensors_);
+  ASSERT_NE(session_c, nullptr);
+  EXPECT_THAT(State(*session_c), ElementsAre(0, 0, 0, 0));
+}
+
+TEST_F(KVCacheSessionTest, RejectsSmallPages) {
+  auto pool = KVCachePool::Create(kCacheBytes / 2, /*num_pages=*/1);
+  ASSERT_LT(pool->page_bytes(), kCacheBytes);
+  EXPECT_EQ(KVCacheSession::Create(pool, runner_, stateful_tensors_), nullptr);
+  EXPECT_EQ(pool->num_free_pages(), 1);
+}
+
+TEST_F(KVCacheSessionTest, RejectsInvalidTensors) {
+  auto pool = KVCachePool::Create(kCacheBytes, /*num_pages=*/1);
+  EXPECT_EQ(KVCacheSession::Create(pool, runner_, {{"cache", "missing"}}),
+            nullptr);
+  EXPECT_EQ(KVCacheSession::Create(pool, runner_, {{"update", "new_cache"}}),
+            nullptr);
+  EXPECT_EQ(pool->num_free_pages(), 1);
+}
+
+}  // namespace
+}  // namespace genai
+}  // namespace tflite
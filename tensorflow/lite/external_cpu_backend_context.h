@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -92,9 +93,28 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // Caps the number of threads of the internal backend context at
+  // `max_num_threads`, whatever the interpreter recommends. This also applies
+  // to an internal backend context that is created later. -1 means no cap.
+  void set_max_num_threads(int max_num_threads) {
+    max_num_threads_ = max_num_threads;
+    if (internal_backend_context_ != nullptr && max_num_threads_ != -1) {
+      internal_backend_context_->SetMaxNumThreads(max_num_threads_);
+    }
+  }
+
+  // Returns the number of threads the internal backend context should use
+  // given the interpreter's `recommended_num_threads`.
+  int NumThreads(int recommended_num_threads) const {
+    if (max_num_threads_ == -1) return recommended_num_threads;
+    if (recommended_num_threads == -1) return max_num_threads_;
+    return std::min(recommended_num_threads, max_num_threads_);
+  }
+
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
+  int max_num_threads_ = -1;
 
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <vector>
 
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/c/common.h"
 
@@ -260,6 +261,32 @@ class PartitionGraphIntoIndependentNodeSubsetsImpl {
 };
 // LINT.ThenChange(//tensorflow/lite/delegates/utils.h)
 
+// Returns true if the node at execution-plan index `index` has to keep its
+// order relative to the other nodes for which this returns true.
+bool MustPreserveNodeOrder(GraphInfo* info, int index) {
+  const TfLiteNode& node = info->node(index);
+  if (node.might_have_side_effect || node.delegate != nullptr) return true;
+  const int32_t builtin_code = info->registration(index).builtin_code;
+  if (builtin_code == kTfLiteBuiltinCustom ||
+      builtin_code == kTfLiteBuiltinDelegate ||
+      builtin_code == kTfLiteBuiltinStablehloWhile ||
+      builtin_code == kTfLiteBuiltinStablehloComposite) {
+    return true;
+  }
+  const TfLiteTensor* tensors = info->tensors();
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
@@ -289,4 +316,52 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
   return kTfLiteOk;
 }
 
+TfLiteStatus GroupIndependentNodesIntoStages(
+    GraphInfo* info, const ControlEdges* control_edges,
+    std::vector<std::vector<int>>* stages) {
+  const int num_nodes = info->num_execution_nodes();
+  // The stage of the node producing each tensor, or -1 for tensors that are
+  // not produced by a node of the execution plan.
+  std::vector<int> producer_stage(info->num_tensors(), -1);
+  // Earliest stage each node may be placed in.
+  std::vector<int> min_stage(num_nodes, 0);
+  std::vector<std::vector<int>> control_successors(num_nodes);
+  if (control_edges != nullptr) {
+    for (const auto& [from, to] : *control_edges) {
+      // The nodes are expected to be in dependency order already.
+      if (from < 0 || to >= num_nodes || from >= to) return kTfLiteError;
+      control_successors[from].push_back(to);
+    }
+  }
+  std::vector<int> node_stage(num_nodes, 0);
+  int last_ordered_stage = -1;
+  int num_stages = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = info->node(i);
+    int stage = min_stage[i];
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      stage = std::max(stage, producer_stage[tensor_index] + 1);
+    }
+    if (MustPreserveNodeOrder(info, i)) {
+      stage = std::max(stage, last_ordered_stage + 1);
+      last_ordered_stage = stage;
+    }
+    node_stage[i] = stage;
+    num_stages = std::max(num_stages, stage + 1);
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      producer_stage[tensor_index] = stage;
+    }
+    for (int successor : control_successors[i]) {
+      min_stage[successor] = std::max(min_stage[successor], stage + 1);
+    }
+  }
+  stages->assign(num_stages, {});
+  for (int i = 0; i < num_nodes; ++i) {
+    (*stages)[node_stage[i]].push_back(i);
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace tflite
@@ -156,6 +156,31 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
     std::vector<NodeSubset>* node_subsets, bool greedily,
     const ControlEdges* control_edges = nullptr);
 
+// Groups the nodes of the execution plan in *info into stages. Nodes in the
+// same stage do not depend on each other, so they may be executed
+// concurrently, and every node only depends on nodes in earlier stages.
+// `*stages` receives one list of execution-plan indices per stage, in
+// execution order; the indices within a stage are sorted. The function
+// assumes that the nodes of the graph represented in *info are in dependency
+// order, and each node is placed in the earliest stage its inputs allow.
+//
+// Besides data dependencies, the following nodes keep their relative order
+// (i.e. no two of them share a stage): nodes with the
+// `might_have_side_effect` attribute, nodes reading or writing variable or
+// variant tensors, custom ops and delegate kernels. `control_edges`, if not
+// null, adds dependencies between execution-plan indices.
+//
+// (Example: the graph
+//
+// 0 --> 1 --> 3
+// |           ^
+// \--> 2 -----/
+//
+// is grouped as {{0}, {1, 2}, {3}}.)
+TfLiteStatus GroupIndependentNodesIntoStages(
+    GraphInfo* info, const ControlEdges* control_edges,
+    std::vector<std::vector<int>>* stages);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_GRAPH_INFO_H_
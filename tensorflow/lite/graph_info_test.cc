@@ -693,5 +693,76 @@ TEST(PartitionTest, ComplexNonGreedily) {
                                 })));
 }
 
+std::vector<std::vector<int>> GroupIntoStages(
+    SimpleTestGraph* graph, const ControlEdges* control_edges = nullptr) {
+  std::vector<std::vector<int>> stages;
+  EXPECT_EQ(GroupIndependentNodesIntoStages(graph, control_edges, &stages),
+            kTfLiteOk);
+  return stages;
+}
+
+// Test a diamond, whose two branches can run concurrently.
+// Graph for test is like
+// (Input) -> 0 -> 1 -> 3 -> (Output)
+//             \-> 2 -/
+TEST(StageTest, Diamond) {
+  SimpleTestGraph graph(/*inputs=*/{0}, /*outputs=*/{4},
+                        /*nodes=*/
+                        {
+                            {{0}, {1}, false},
+                            {{1}, {2}, false},
+                            {{1}, {3}, false},
+                            {{2, 3}, {4}, false},
+                        });
+  EXPECT_EQ(GroupIntoStages(&graph),
+            (std::vector<std::vector<int>>{{0}, {1, 2}, {3}}));
+}
+
+// Test two independent chains whose nodes are interleaved stage by stage.
+TEST(StageTest, IndependentChains) {
+  SimpleTestGraph graph(/*inputs=*/{0}, /*outputs=*/{2, 4},
+                        /*nodes=*/
+                        {
+                            {{0}, {1}, false},
+                            {{1}, {2}, false},
+                            {{0}, {3}, false},
+                            {{3}, {4}, false},
+                        });
+  EXPECT_EQ(GroupIntoStages(&graph),
+            (std::vector<std::vector<int>>{{0, 2}, {1, 3}}));
+}
+
+// Test that nodes with side effects keep their relative order.
+TEST(StageTest, SideEffectsAreOrdered) {
+  SimpleTestGraph graph(/*inputs=*/{0}, /*outputs=*/{1, 2, 3},
+                        /*nodes=*/
+                        {
+                            {{0}, {1}, /*might_have_side_effect=*/true},
+                            {{0}, {2}, /*might_have_side_effect=*/true},
+                            {{0}, {3}, false},
+                        });
+  EXPECT_EQ(GroupIntoStages(&graph),
+            (std::vector<std::vector<int>>{{0, 2}, {1}}));
+}
+
+// Test that control edges are respected and must point forward.
+TEST(StageTest, ControlEdges) {
+  SimpleTestGraph graph(/*inputs=*/{0}, /*outputs=*/{1, 2},
+                        /*nodes=*/
+                        {
+                            {{0}, {1}, false},
+                            {{0}, {2}, false},
+                        });
+  EXPECT_EQ(GroupIntoStages(&graph), (std::vector<std::vector<int>>{{0, 1}}));
+  const ControlEdges control_edges = {{0, 1}};
+  EXPECT_EQ(GroupIntoStages(&graph, &control_edges),
+            (std::vector<std::vector<int>>{{0}, {1}}));
+  const ControlEdges backward_control_edges = {{1, 0}};
+  std::vector<std::vector<int>> stages;
+  EXPECT_EQ(GroupIndependentNodesIntoStages(&graph, &backward_control_edges,
+                                            &stages),
+            kTfLiteError);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -103,12 +103,89 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  /// Keeps up to `value` arena memory plans per subgraph, keyed by the sizes
+  /// of the tensors they place. Calling `AllocateTensors` after resizing the
+  /// inputs back to recently used shapes then reuses the cached tensor
+  /// offsets instead of replanning the arena. Only the memory plan is
+  /// cached: every node is still prepared again, since kernels may keep
+  /// shape-dependent state. Zero disables the cache.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetArenaPlanCacheSize(int value) {
+    experimental_arena_plan_cache_size_ = value > 0 ? value : 0;
+  }
+
+  /// Returns the number of arena plans cached per subgraph.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetArenaPlanCacheSize() const {
+    return experimental_arena_plan_cache_size_;
+  }
+
+  /// If `true`, cached arena plans reserve the next power of two bytes for
+  /// every tensor, so that all input shapes within a factor of two of each
+  /// other (e.g. sequence lengths 33 to 64) share one plan. This trades
+  /// arena size for fewer replans. Only has an effect together with
+  /// `SetArenaPlanCacheSize`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetBucketArenaPlanSizes(bool value = true) {
+    experimental_bucket_arena_plan_sizes_ = value;
+  }
+
+  /// Returns if arena plan sizes are rounded up to powers of two.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetBucketArenaPlanSizes() const {
+    return experimental_bucket_arena_plan_sizes_;
+  }
+
+  /// Sets the number of threads used to run independent nodes of a subgraph
+  /// concurrently. With a value greater than 1, `AllocateTensors` reorders
+  /// the execution plan into stages of nodes that do not depend on each
+  /// other and `Invoke` runs the nodes of each stage on up to `value`
+  /// threads, including the calling one. Tensors used within a stage never
+  /// share arena memory, so the arena may grow. Subgraphs with dynamic
+  /// tensors, or invoked with a profiler attached, run their nodes one at a
+  /// time in the reordered plan. Nodes with side effects, custom ops and
+  /// delegate kernels keep their relative order. Each extra thread uses its
+  /// own single-threaded CPU backend context. Values <= 1 disable concurrent
+  /// execution.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumParallelBranchThreads(int value) {
+    experimental_num_parallel_branch_threads_ = value > 1 ? value : 1;
+  }
+
+  /// Returns the number of threads used to run independent nodes.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumParallelBranchThreads() const {
+    return experimental_num_parallel_branch_threads_;
+  }
+
+  /// If `true`, constant tensors mapped from the model file are only paged in
+  /// when first read instead of being kept resident for the lifetime of the
+  /// interpreter. The first `Invoke` after `AllocateTensors` hints the OS to
+  /// read the weights of each node ahead of running it, in execution order,
+  /// and `ModifyGraphWithDelegate` drops the pages of the weights that are
+  /// only read by delegate kernels, which usually keep their own repacked
+  /// copy. Only has an effect on models loaded with `MMAPAllocation`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetLazyWeightMaterialization(bool value = true) {
+    experimental_lazy_weight_materialization_ = value;
+  }
+
+  /// Returns if constant tensors are materialized lazily.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetLazyWeightMaterialization() const {
+    return experimental_lazy_weight_materialization_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_arena_plan_cache_size_ = 0;
+  bool experimental_bucket_arena_plan_sizes_ = false;
+  int experimental_num_parallel_branch_threads_ = 1;
+  bool experimental_lazy_weight_materialization_ = false;
 };
 
 }  // namespace tflite
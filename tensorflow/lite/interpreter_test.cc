@@ -17,9 +17,12 @@ limitations under the License.
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <map>
 #include <memory>
 #include <string>
@@ -30,6 +33,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -54,6 +58,7 @@ namespace {
 
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
 
 // Make an interpreter that has no tensors and no nodes
 TEST(BasicInterpreter, ZeroInterpreter) {
@@ -1129,6 +1134,216 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+TEST(BasicInterpreter, ParallelBranches) {
+  // Two independent passthrough ops that only run once both have started, so
+  // the graph can only be invoked if they run concurrently.
+  static std::atomic<int> num_started;
+  static TfLiteExternalContext* cpu_backend_contexts[2];
+  static int cpu_backend_num_threads[2];
+  TfLiteRegistration rendezvous = GetPassthroughOpRegistration();
+  rendezvous.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const int branch = node->outputs->data[0] - 1;
+    cpu_backend_contexts[branch] =
+        context->GetExternalContext(context, kTfLiteCpuBackendContext);
+    cpu_backend_num_threads[branch] =
+        static_cast<ExternalCpuBackendContext*>(cpu_backend_contexts[branch])
+            ->NumThreads(context->recommended_num_threads);
+    ++num_started;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (num_started < 2) {
+      if (std::chrono::steady_clock::now() > deadline) return kTfLiteError;
+      std::this_thread::yield();
+    }
+    return GetPassthroughOpRegistration().invoke(context, node);
+  };
+  TfLiteRegistration passthrough = GetPassthroughOpRegistration();
+
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetNumParallelBranchThreads(2);
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.SetNumThreads(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({3, 4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+  // Node 0 -> node 2 and node 1 -> node 3 are independent branches.
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &rendezvous),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {3}, nullptr, 0, nullptr,
+                                              &passthrough),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr,
+                                              &rendezvous),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2}, {4}, nullptr, 0, nullptr,
+                                              &passthrough),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // The execution plan is reordered stage by stage.
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 2, 1, 3));
+
+  for (int i = 0; i < 3; ++i) interpreter.typed_tensor<float>(0)[i] = i + 1;
+  num_started = 0;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int output : {3, 4}) {
+    const float* data = interpreter.typed_tensor<float>(output);
+    EXPECT_THAT(std::vector<float>(data, data + 3), ElementsAre(1, 2, 3));
+  }
+  // Each thread has its own CPU backend context.
+  EXPECT_NE(cpu_backend_contexts[0], cpu_backend_contexts[1]);
+  // The worker's context is single-threaded before its first kernel runs.
+  EXPECT_THAT(cpu_backend_num_threads, UnorderedElementsAre(1, 4));
+}
+
+// Delegates ADD nodes and adds the constant second input from its own copy,
+// like a delegate that repacks the weights at init.
+class RepackingAddDelegate : public SimpleDelegateInterface {
+ public:
+  bool IsNodeSupportedByDelegate(const TfLiteRegistration* registration,
+                                 const TfLiteNode* node,
+                                 TfLiteContext* context) const override {
+    return registration->builtin_code == kTfLiteBuiltinAdd;
+  }
+
+  TfLiteStatus Initialize(TfLiteContext* context) override {
+    return kTfLiteOk;
+  }
+
+  const char* Name() const override { return "RepackingAddDelegate"; }
+
+  std::unique_ptr<SimpleDelegateKernelInterface> CreateDelegateKernelInterface()
+      override {
+    return std::make_unique<Kernel>();
+  }
+
+  SimpleDelegateInterface::Options DelegateOptions() const override {
+    return SimpleDelegateInterface::Options();
+  }
+
+ private:
+  class Kernel : public SimpleDelegateKernelInterface {
+   public:
+    TfLiteStatus Init(TfLiteContext* context,
+                      const TfLiteDelegateParams* params) override {
+      TF_LITE_ENSURE_EQ(context, params->nodes_to_replace->size, 1);
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, params->nodes_to_replace->data[0], &node, &registration));
+      const TfLiteTensor& weights = context->tensors[node->inputs->data[1]];
+      TF_LITE_ENSURE_EQ(context, weights.allocation_type, kTfLiteMmapRo);
+      weights_.assign(weights.data.f,
+                      weights.data.f + weights.bytes / sizeof(float));
+      input_ = node->inputs->data[0];
+      output_ = node->outputs->data[0];
+      return kTfLiteOk;
+    }
+
+    TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) override {
+      return kTfLiteOk;
+    }
+
+    TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) override {
+      const float* input = context->tensors[input_].data.f;
+      float* output = context->tensors[output_].data.f;
+      for (size_t i = 0; i < weights_.size(); ++i) {
+        output[i] = input[i] + weights_[i];
+      }
+      return kTfLiteOk;
+    }
+
+   private:
+    std::vector<float> weights_;
+    int input_ = -1;
+    int output_ = -1;
+  };
+};
+
+// input + weights -> output, with the weights mapped from a file.
+class LazyWeightsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!MMAPAllocation::IsSupported()) {
+      GTEST_SKIP();
+    }
+    const std::string path = ::testing::TempDir() + "/lazy_weights.bin";
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fwrite(kWeights, sizeof(kWeights), 1, file), 1);
+    ASSERT_EQ(fclose(file), 0);
+    allocation_ =
+        std::make_unique<MMAPAllocation>(path.c_str(), &error_reporter_);
+    ASSERT_TRUE(allocation_->valid());
+
+    InterpreterOptions options;
+    options.SetLazyWeightMaterialization();
+    interpreter_.ApplyOptions(&options);
+    ASSERT_EQ(interpreter_.AddTensors(3), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({2}), kTfLiteOk);
+    TfLiteQuantizationParams quantized;
+    for (int i : {0, 2}) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                          {4}, quantized),
+                kTfLiteOk);
+    }
+    ASSERT_EQ(interpreter_.SetTensorParametersReadOnly(
+                  1, kTfLiteFloat32, "weights", {4}, quantized,
+                  static_cast<const char*>(allocation_->base()),
+                  allocation_->bytes(), allocation_.get()),
+              kTfLiteOk);
+    auto* params =
+        static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    params->pot_scale_int16 = false;
+    ASSERT_EQ(interpreter_.AddNodeWithParameters({0, 1}, {2}, nullptr, 0,
+                                                 params,
+                                                 ops::builtin::Register_ADD()),
+              kTfLiteOk);
+  }
+
+  std::vector<float> Invoke() {
+    float* input = interpreter_.typed_tensor<float>(0);
+    for (int i = 0; i < 4; ++i) input[i] = i;
+    EXPECT_EQ(interpreter_.Invoke(), kTfLiteOk);
+    const float* output = interpreter_.typed_tensor<float>(2);
+    return std::vector<float>(output, output + 4);
+  }
+
+  static constexpr float kWeights[4] = {10, 20, 30, 40};
+  TestErrorReporter error_reporter_;
+  std::unique_ptr<MMAPAllocation> allocation_;
+  Interpreter interpreter_;
+};
+
+TEST_F(LazyWeightsTest, ReadsWeightsFromTheFile) {
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(1)->data.raw, allocation_->base());
+  // The first invocation prefetches the weights, the next ones don't.
+  EXPECT_THAT(Invoke(), ElementsAre(10, 21, 32, 43));
+  EXPECT_THAT(Invoke(), ElementsAre(10, 21, 32, 43));
+}
+
+TEST_F(LazyWeightsTest, ReleasesDelegatedWeights) {
+  auto delegate = TfLiteDelegateFactory::Create(
+      std::make_unique<RepackingAddDelegate>());
+  ASSERT_EQ(interpreter_.ModifyGraphWithDelegate(delegate.get()), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(Invoke(), ElementsAre(10, 21, 32, 43));
+  // The released weights are paged in again when read.
+  const float* weights = interpreter_.typed_tensor<float>(1);
+  EXPECT_THAT(std::vector<float>(weights, weights + 4),
+              ElementsAre(10, 20, 30, 40));
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -118,7 +118,8 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
     // We do the lazy initialization here for the TfLiteInternalBackendContext
     // that's wrapped inside ExternalCpuBackendContext.
     cpu_backend_context = new CpuBackendContext();
-    cpu_backend_context->SetMaxNumThreads(context->recommended_num_threads);
+    cpu_backend_context->SetMaxNumThreads(
+        external_context->NumThreads(context->recommended_num_threads));
     external_context->set_internal_backend_context(
         std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
   }
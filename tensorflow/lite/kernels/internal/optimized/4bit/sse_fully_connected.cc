@@ -26,6 +26,7 @@ limitations under the License.
 #include <cstring>
 #include <vector>
 
+#include "include/cpuinfo.h"
 #include "tensorflow/lite/kernels/internal/cppmath.h"
 #include "tensorflow/lite/kernels/internal/optimized/4bit/fully_connected_common.h"
 #include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
@@ -311,10 +312,10 @@ inline __m128i ReduceInt32x4x4(__m128i a, __m128i b, __m128i c, __m128i d) {
 }
 
 template <int RowsLeft, int RowsRight, int Cols>
-void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
-                  int lhs_layout_rows, int lhs_layout_cols, int rhs_layout_rows,
-                  int rhs_layout_cols, int dst_layout_rows,
-                  int dst_layout_cols) {
+void SseRunKernelSsse3(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                       int lhs_layout_rows, int lhs_layout_cols,
+                       int rhs_layout_rows, int rhs_layout_cols,
+                       int dst_layout_rows, int dst_layout_cols) {
   const int start_row = 0;
   const int start_col = 0;
   const int end_row = lhs_layout_rows;
@@ -390,6 +391,41 @@ void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
 }
 // NOLINTEND
 
+bool HasAvx2() {
+  static const bool has_avx2 = cpuinfo_initialize() && cpuinfo_has_x86_avx2();
+  return has_avx2;
+}
+
+bool HasAvx512Vnni() {
+  static const bool has_avx512_vnni =
+      cpuinfo_initialize() && cpuinfo_has_x86_avx512f() &&
+      cpuinfo_has_x86_avx512bw() && cpuinfo_has_x86_avx512vl() &&
+      cpuinfo_has_x86_avx512vnni();
+  return has_avx512_vnni;
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                  int lhs_layout_rows, int lhs_layout_cols, int rhs_layout_rows,
+                  int rhs_layout_cols, int dst_layout_rows,
+                  int dst_layout_cols) {
+  if (HasAvx512Vnni()) {
+    SseRunKernelAvx512Vnni<RowsLeft, RowsRight, Cols>(
+        lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+        rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+  if (HasAvx2()) {
+    SseRunKernelAvx2<RowsLeft, RowsRight, Cols>(
+        lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+        rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+  SseRunKernelSsse3<RowsLeft, RowsRight, Cols>(
+      lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+      rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+}
+
 template void SseUnpack<4, 1>(float* output_ptr, const int32_t* dst,
                               int batch_size, int num_units,
                               const float* scaling_factors,
@@ -426,6 +462,21 @@ template void SseRunKernel<4, 4, 32>(const uint8_t* lhs, const int8_t* rhs,
                                      int rhs_layout_cols, int dst_layout_rows,
                                      int dst_layout_cols);
 
+template void SseRunKernelSsse3<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelSsse3<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelSsse3<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
 }  // namespace optimized_4bit
 }  // namespace tflite
 
@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+
+#include <stdint.h>
+
+// NOLINTBEGIN
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+
+// The kernels are compiled for AVX2 regardless of the target flags and are
+// only called after checking for AVX2 at runtime.
+#if defined(__GNUC__) || defined(__clang__)
+#define FC_4BIT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FC_4BIT_TARGET_AVX2
+#endif
+
+namespace tflite {
+namespace optimized_4bit {
+namespace {
+
+// Returns [sum(a), sum(b), sum(c), sum(d)].
+FC_4BIT_TARGET_AVX2 inline __m128i ReduceInt32x8x4(__m256i a, __m256i b,
+                                                   __m256i c, __m256i d) {
+  const __m256i ab = _mm256_hadd_epi32(a, b);
+  const __m256i cd = _mm256_hadd_epi32(c, d);
+  const __m256i abcd = _mm256_hadd_epi32(ab, cd);
+  return _mm_add_epi32(_mm256_castsi256_si128(abcd),
+                       _mm256_extracti128_si256(abcd, 1));
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+FC_4BIT_TARGET_AVX2 void RunKernel(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols) {
+  static_assert(RowsLeft == 4 && Cols == 32);
+  const int end_row = lhs_layout_rows;
+  const int end_col = rhs_layout_rows;
+  const int clamped_end_row = std::min(end_row, dst_layout_cols);
+  const int clamped_end_col = std::min(end_col, dst_layout_rows);
+  int32_t* elementPtr = dst;
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const __m256i bitmask = _mm256_set1_epi8(15);
+  // Each packed lhs row holds 32 values in 16 bytes: values 0-15 in the upper
+  // nibbles and values 16-31 in the lower nibbles. Broadcasting the 16 bytes
+  // and shifting only the low 128-bit lane yields the 32 values in order, so
+  // they line up with the 32 rhs values of the same depth block.
+  const __m256i nibble_shifts = _mm256_setr_epi32(4, 4, 4, 4, 0, 0, 0, 0);
+  const __m256i ones = _mm256_set1_epi16(1);
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m256i accum[RowsRight * RowsLeft];
+      for (int m = 0; m < RowsRight * RowsLeft; ++m) {
+        accum[m] = _mm256_setzero_si256();
+      }
+      for (int k = 0; k < depth; ++k) {
+        __m256i lhs_row[RowsLeft];
+        for (int m = 0; m < RowsLeft; ++m) {
+          const __m256i packed = _mm256_broadcastsi128_si256(
+              _mm_loadu_si128((const __m128i*)lhs_val));
+          lhs_row[m] = _mm256_and_si256(
+              _mm256_srlv_epi32(packed, nibble_shifts), bitmask);
+          lhs_val += 16;
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m256i rhs_row = _mm256_loadu_si256((const __m256i*)rhs_val);
+          rhs_val += 32;
+          for (int l = 0; l < RowsLeft; ++l) {
+            // The lhs values are in [0, 15], so the pairwise sums can not
+            // saturate.
+            const __m256i sumprod_16x16 =
+                _mm256_maddubs_epi16(lhs_row[l], rhs_row);
+            accum[r * RowsLeft + l] =
+                _mm256_add_epi32(accum[r * RowsLeft + l],
+                                 _mm256_madd_epi16(sumprod_16x16, ones));
+          }
+        }
+      }
+      for (int r = 0; r < RowsRight; ++r) {
+        const __m128i sum =
+            ReduceInt32x8x4(accum[r * RowsLeft], accum[r * RowsLeft + 1],
+                            accum[r * RowsLeft + 2], accum[r * RowsLeft + 3]);
+        _mm_storeu_si128((__m128i*)elementPtr, sum);
+        elementPtr += 4;
+      }
+    }
+  }
+}
+// NOLINTEND
+
+}  // namespace
+
+// The exported kernel must not have the target attribute, which GCC would
+// treat as a different version of the function declared in the header.
+template <int RowsLeft, int RowsRight, int Cols>
+void SseRunKernelAvx2(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                      int lhs_layout_rows, int lhs_layout_cols,
+                      int rhs_layout_rows, int rhs_layout_cols,
+                      int dst_layout_rows, int dst_layout_cols) {
+  RunKernel<RowsLeft, RowsRight, Cols>(lhs, rhs, dst, lhs_layout_rows,
+                                       lhs_layout_cols, rhs_layout_rows,
+                                       rhs_layout_cols, dst_layout_rows,
+                                       dst_layout_cols);
+}
+
+template void SseRunKernelAvx2<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx2<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx2<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+}  // namespace optimized_4bit
+}  // namespace tflite
+
+#endif  // defined(FC_4BIT_SSE) && defined(__SSSE3__)
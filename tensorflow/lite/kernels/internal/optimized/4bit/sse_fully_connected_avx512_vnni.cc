@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+
+#include <stdint.h>
+
+// NOLINTBEGIN
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+
+// The kernels are compiled for AVX-512 VNNI regardless of the target flags and
+// are only called after checking for AVX-512 VNNI at runtime.
+#if defined(__GNUC__) || defined(__clang__)
+#define FC_4BIT_TARGET_AVX512_VNNI \
+  __attribute__((target("avx2,avx512f,avx512bw,avx512vl,avx512vnni")))
+#else
+#define FC_4BIT_TARGET_AVX512_VNNI
+#endif
+
+// GCC 12 implements the unmasked forms of several AVX-512 intrinsics with an
+// undefined vector as the merge source, which -Wmaybe-uninitialized reports
+// once they are inlined. The zero-masked forms with a full mask compile to the
+// same instructions, so the kernel uses those instead.
+
+namespace tflite {
+namespace optimized_4bit {
+namespace {
+
+// Returns [sum(a), sum(b), sum(c), sum(d)].
+FC_4BIT_TARGET_AVX512_VNNI inline __m128i ReduceInt32x8x4(__m256i a, __m256i b,
+                                                          __m256i c,
+                                                          __m256i d) {
+  const __m256i ab = _mm256_hadd_epi32(a, b);
+  const __m256i cd = _mm256_hadd_epi32(c, d);
+  const __m256i abcd = _mm256_hadd_epi32(ab, cd);
+  return _mm_add_epi32(_mm256_castsi256_si128(abcd),
+                       _mm256_extracti128_si256(abcd, 1));
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+FC_4BIT_TARGET_AVX512_VNNI void RunKernel(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols) {
+  static_assert(RowsLeft == 4 && Cols == 32);
+  // Each 512-bit register holds the 32 values of two lhs rows.
+  constexpr int kLhsPairs = RowsLeft / 2;
+  const int end_row = lhs_layout_rows;
+  const int end_col = rhs_layout_rows;
+  const int clamped_end_row = std::min(end_row, dst_layout_cols);
+  const int clamped_end_col = std::min(end_col, dst_layout_rows);
+  int32_t* elementPtr = dst;
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const __m512i bitmask = _mm512_set1_epi8(15);
+  // Each packed lhs row holds 32 values in 16 bytes: values 0-15 in the upper
+  // nibbles and values 16-31 in the lower nibbles. With the bytes of a row in
+  // two consecutive 128-bit lanes, shifting only the first lane yields the 32
+  // values in order, so they line up with the 32 rhs values of the same depth
+  // block.
+  const __m512i nibble_shifts = _mm512_setr_epi32(4, 4, 4, 4, 0, 0, 0, 0, 4, 4,
+                                                  4, 4, 0, 0, 0, 0);
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m512i accum[RowsRight * kLhsPairs];
+      for (int m = 0; m < RowsRight * kLhsPairs; ++m) {
+        accum[m] = _mm512_setzero_si512();
+      }
+      for (int k = 0; k < depth; ++k) {
+        __m512i lhs_rows[kLhsPairs];
+        for (int m = 0; m < kLhsPairs; ++m) {
+          // [row 2m, row 2m + 1] -> [row 2m, row 2m, row 2m + 1, row 2m + 1].
+          const __m512i packed = _mm512_maskz_broadcast_i64x4(
+              0xFF, _mm256_loadu_si256((const __m256i*)lhs_val));
+          const __m512i spread = _mm512_maskz_shuffle_i64x2(
+              0xFF, packed, packed, _MM_SHUFFLE(1, 1, 0, 0));
+          lhs_rows[m] = _mm512_and_si512(
+              _mm512_maskz_srlv_epi32(0xFFFF, spread, nibble_shifts), bitmask);
+          lhs_val += 32;
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m512i rhs_row = _mm512_maskz_broadcast_i64x4(
+              0xFF, _mm256_loadu_si256((const __m256i*)rhs_val));
+          rhs_val += 32;
+          for (int m = 0; m < kLhsPairs; ++m) {
+            accum[r * kLhsPairs + m] =
+                _mm512_dpbusd_epi32(accum[r * kLhsPairs + m], lhs_rows[m],
+                                    rhs_row);
+          }
+        }
+      }
+      for (int r = 0; r < RowsRight; ++r) {
+        const __m512i rows_01 = accum[r * kLhsPairs];
+        const __m512i rows_23 = accum[r * kLhsPairs + 1];
+        const __m128i sum = ReduceInt32x8x4(
+            _mm512_maskz_extracti64x4_epi64(0xFF, rows_01, 0),
+            _mm512_maskz_extracti64x4_epi64(0xFF, rows_01, 1),
+            _mm512_maskz_extracti64x4_epi64(0xFF, rows_23, 0),
+            _mm512_maskz_extracti64x4_epi64(0xFF, rows_23, 1));
+        _mm_storeu_si128((__m128i*)elementPtr, sum);
+        elementPtr += 4;
+      }
+    }
+  }
+}
+// NOLINTEND
+
+}  // namespace
+
+// The exported kernel must not have the target attribute, which GCC would
+// treat as a different version of the function declared in the header.
+template <int RowsLeft, int RowsRight, int Cols>
+void SseRunKernelAvx512Vnni(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                            int lhs_layout_rows, int lhs_layout_cols,
+                            int rhs_layout_rows, int rhs_layout_cols,
+                            int dst_layout_rows, int dst_layout_cols) {
+  RunKernel<RowsLeft, RowsRight, Cols>(lhs, rhs, dst, lhs_layout_rows,
+                                       lhs_layout_cols, rhs_layout_rows,
+                                       rhs_layout_cols, dst_layout_rows,
+                                       dst_layout_cols);
+}
+
+template void SseRunKernelAvx512Vnni<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx512Vnni<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx512Vnni<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+}  // namespace optimized_4bit
+}  // namespace tflite
+
+#endif  // defined(FC_4BIT_SSE) && defined(__SSSE3__)
@@ -57,6 +57,34 @@ extern void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
                          int rhs_layout_rows, int rhs_layout_cols,
                          int dst_layout_rows, int dst_layout_cols);
 
+template <int RowsLeft, int RowsRight, int Cols>
+extern void SseRunKernelSsse3(const uint8_t* lhs, const int8_t* rhs,
+                              int32_t* dst, int lhs_layout_rows,
+                              int lhs_layout_cols, int rhs_layout_rows,
+                              int rhs_layout_cols, int dst_layout_rows,
+                              int dst_layout_cols);
+
+// Same as SseRunKernelSsse3, but may only be called if HasAvx2().
+template <int RowsLeft, int RowsRight, int Cols>
+extern void SseRunKernelAvx2(const uint8_t* lhs, const int8_t* rhs,
+                             int32_t* dst, int lhs_layout_rows,
+                             int lhs_layout_cols, int rhs_layout_rows,
+                             int rhs_layout_cols, int dst_layout_rows,
+                             int dst_layout_cols);
+
+// Same as SseRunKernelSsse3, but may only be called if HasAvx512Vnni().
+template <int RowsLeft, int RowsRight, int Cols>
+extern void SseRunKernelAvx512Vnni(const uint8_t* lhs, const int8_t* rhs,
+                                   int32_t* dst, int lhs_layout_rows,
+                                   int lhs_layout_cols, int rhs_layout_rows,
+                                   int rhs_layout_cols, int dst_layout_rows,
+                                   int dst_layout_cols);
+
+// Whether the CPU and OS support the kernels above. SseRunKernel dispatches
+// to the fastest supported one.
+bool HasAvx2();
+bool HasAvx512Vnni();
+
 }  // namespace optimized_4bit
 }  // namespace tflite
 
@@ -0,0 +1,213 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the 4-bit hybrid fully connected kernels on the shapes of the
+// projections of decoder-style models.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
+
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+#endif
+
+namespace tflite {
+namespace {
+
+using ::tflite::optimized_4bit::FilterDepth;
+using ::tflite::optimized_4bit::FilterWidth;
+
+int RoundUp(int value, int multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// Quantized inputs and prepacked weights of a [batch_size, input_depth] x
+// [input_depth, output_depth] fully connected layer.
+struct FullyConnected4Bit {
+  FullyConnected4Bit(int batch_size, int input_depth, int output_depth,
+                     int rhs_width)
+      : batch_size(batch_size),
+        input_depth(input_depth),
+        output_depth(output_depth),
+        rhs_width(rhs_width),
+        lhs_layout_rows(RoundUp(output_depth, FilterWidth)),
+        lhs_layout_cols(RoundUp(input_depth, FilterDepth)),
+        rhs_layout_rows(RoundUp(batch_size, rhs_width)),
+        rhs_layout_cols(lhs_layout_cols),
+        input(batch_size * input_depth),
+        quantized_input(rhs_layout_rows * rhs_layout_cols),
+        input_offsets(rhs_layout_rows),
+        scaling_factors(rhs_layout_rows),
+        filter_scales(output_depth),
+        bias(output_depth),
+        dst(rhs_layout_rows * lhs_layout_rows),
+        output(batch_size * output_depth) {
+    std::mt19937 random_engine(2024);
+    std::uniform_int_distribution<int> int4_dist(-7, 7);
+    std::uniform_real_distribution<float> real_dist(-1.f, 1.f);
+    std::vector<int8_t> weights(output_depth * input_depth / 2);
+    for (int8_t& w : weights) {
+      w = static_cast<int8_t>((int4_dist(random_engine) << 4) |
+                              (int4_dist(random_engine) & 15));
+    }
+    for (float& v : input) v = real_dist(random_engine);
+    for (float& v : filter_scales) v = real_dist(random_engine);
+    for (float& v : bias) v = real_dist(random_engine);
+    op_data.AllocatePackedRegion(optimized_4bit::kDefaultAlignmentPadding +
+                                 lhs_layout_rows * lhs_layout_cols / 2);
+    optimized_4bit::api::Prepack(op_data.prepacked_cache, weights.data(),
+                                 lhs_layout_rows, lhs_layout_cols,
+                                 output_depth, input_depth, FilterWidth,
+                                 FilterDepth);
+    QuantizeInput();
+  }
+
+  void QuantizeInput() {
+    optimized_4bit::api::BatchQuantizeFloats4Bit(
+        input.data(), batch_size, input_depth, quantized_input.data(),
+        scaling_factors.data(), rhs_width, FilterDepth, input_offsets.data());
+  }
+
+  // Runs the whole layer, as EvalHybridDense4Bit does.
+  void Run() {
+    QuantizeInput();
+    optimized_4bit::api::AssignBiasAndComputeOffsets(
+        input_offsets.data(), scaling_factors.data(), filter_scales.data(),
+        bias.data(), output.data(), output_depth, batch_size);
+    optimized_4bit::api::RunAndUnpack(
+        rhs_width, op_data.prepacked_cache, quantized_input.data(), dst.data(),
+        output_depth, batch_size, lhs_layout_rows, lhs_layout_cols,
+        rhs_layout_rows, rhs_layout_cols, rhs_layout_rows, lhs_layout_rows,
+        output.data(), scaling_factors.data(), filter_scales.data());
+  }
+
+  int64_t WeightBytes() const {
+    return static_cast<int64_t>(lhs_layout_rows) * lhs_layout_cols / 2;
+  }
+
+  int batch_size;
+  int input_depth;
+  int output_depth;
+  int rhs_width;
+  int lhs_layout_rows;
+  int lhs_layout_cols;
+  int rhs_layout_rows;
+  int rhs_layout_cols;
+  optimized_4bit::OpData4Bit op_data;
+  std::vector<float> input;
+  std::vector<int8_t> quantized_input;
+  std::vector<int32_t> input_offsets;
+  std::vector<float> scaling_factors;
+  std::vector<float> filter_scales;
+  std::vector<float> bias;
+  std::vector<int32_t> dst;
+  std::vector<float> output;
+};
+
+int RhsWidth(int batch_size) {
+  for (int rhs_width = optimized_4bit::GetMaxSupportedRows(); rhs_width > 1;
+       rhs_width /= 2) {
+    if (batch_size >= rhs_width) return rhs_width;
+  }
+  return 1;
+}
+
+// Arguments: batch size, input depth, output depth.
+void ShapeArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"batch", "input_depth", "output_depth"});
+  for (int batch_size : {1, 4, 16}) {
+    b->Args({batch_size, 4096, 4096});
+    b->Args({batch_size, 4096, 11008});
+    b->Args({batch_size, 11008, 4096});
+  }
+}
+
+void BM_FullyConnected4Bit(benchmark::State& state) {
+  const int batch_size = state.range(0);
+  FullyConnected4Bit fc(batch_size, state.range(1), state.range(2),
+                        RhsWidth(batch_size));
+  for (auto _ : state) {
+    fc.Run();
+    benchmark::DoNotOptimize(fc.output.data());
+  }
+  state.SetBytesProcessed(state.iterations() * fc.WeightBytes());
+}
+BENCHMARK(BM_FullyConnected4Bit)->Apply(ShapeArguments);
+
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+using X86Kernel = void (*)(const uint8_t*, const int8_t*, int32_t*, int, int,
+                           int, int, int, int);
+
+// Benchmarks only the integer kernel, which RunAndUnpack dispatches to.
+template <template <int, int, int> class KernelSelector>
+void BM_RunKernel4BitX86(benchmark::State& state) {
+  if (!KernelSelector<4, 4, 32>::Supported()) {
+    state.SkipWithError("Not supported on this CPU");
+    return;
+  }
+  const int batch_size = state.range(0);
+  FullyConnected4Bit fc(batch_size, state.range(1), state.range(2),
+                        RhsWidth(batch_size));
+  X86Kernel kernel = fc.rhs_width == 4   ? KernelSelector<4, 4, 32>::Get()
+                     : fc.rhs_width == 2 ? KernelSelector<4, 2, 32>::Get()
+                                         : KernelSelector<4, 1, 32>::Get();
+  for (auto _ : state) {
+    kernel(fc.op_data.prepacked_cache, fc.quantized_input.data(),
+           fc.dst.data(), fc.lhs_layout_rows, fc.lhs_layout_cols,
+           fc.rhs_layout_rows, fc.rhs_layout_cols, fc.rhs_layout_rows,
+           fc.lhs_layout_rows);
+    benchmark::DoNotOptimize(fc.dst.data());
+  }
+  state.SetBytesProcessed(state.iterations() * fc.WeightBytes());
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+struct Ssse3Kernel {
+  static bool Supported() { return true; }
+  static X86Kernel Get() {
+    return &optimized_4bit::SseRunKernelSsse3<RowsLeft, RowsRight, Cols>;
+  }
+};
+
+template <int RowsLeft, int RowsRight, int Cols>
+struct Avx2Kernel {
+  static bool Supported() { return optimized_4bit::HasAvx2(); }
+  static X86Kernel Get() {
+    return &optimized_4bit::SseRunKernelAvx2<RowsLeft, RowsRight, Cols>;
+  }
+};
+
+template <int RowsLeft, int RowsRight, int Cols>
+struct Avx512VnniKernel {
+  static bool Supported() { return optimized_4bit::HasAvx512Vnni(); }
+  static X86Kernel Get() {
+    return &optimized_4bit::SseRunKernelAvx512Vnni<RowsLeft, RowsRight, Cols>;
+  }
+};
+
+BENCHMARK_TEMPLATE(BM_RunKernel4BitX86, Ssse3Kernel)->Apply(ShapeArguments);
+BENCHMARK_TEMPLATE(BM_RunKernel4BitX86, Avx2Kernel)->Apply(ShapeArguments);
+BENCHMARK_TEMPLATE(BM_RunKernel4BitX86, Avx512VnniKernel)
+    ->Apply(ShapeArguments);
+#endif  // defined(FC_4BIT_SSE) && defined(__SSSE3__)
+
+}  // namespace
+}  // namespace tflite
+
+BENCHMARK_MAIN();
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
@@ -22,6 +23,10 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+#endif
+
 namespace tflite {
 namespace {
 
@@ -413,6 +418,33 @@ INSTANTIATE_TEST_SUITE_P(RunUnpackTests, RunUnpackTests,
                              std::make_tuple(3, 4, 4),
                          }));
 
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+using X86Kernel = void (*)(const uint8_t*, const int8_t*, int32_t*, int, int,
+                           int, int, int, int);
+
+// Returns all the x86 kernels that the CPU supports, and not only the one that
+// RunKernel dispatches to.
+template <int RowsRight>
+std::vector<X86Kernel> SupportedX86Kernels() {
+  std::vector<X86Kernel> kernels = {
+      &optimized_4bit::SseRunKernelSsse3<optimized_4bit::FilterWidth, RowsRight,
+                                         optimized_4bit::FilterDepth>};
+  if (optimized_4bit::HasAvx2()) {
+    kernels.push_back(
+        &optimized_4bit::SseRunKernelAvx2<optimized_4bit::FilterWidth,
+                                          RowsRight,
+                                          optimized_4bit::FilterDepth>);
+  }
+  if (optimized_4bit::HasAvx512Vnni()) {
+    kernels.push_back(
+        &optimized_4bit::SseRunKernelAvx512Vnni<optimized_4bit::FilterWidth,
+                                                RowsRight,
+                                                optimized_4bit::FilterDepth>);
+  }
+  return kernels;
+}
+#endif
+
 class RunKernelTests
     : public ::testing::TestWithParam<::testing::tuple<int, int, int, int>> {};
 
@@ -502,7 +534,7 @@ TEST_P(RunKernelTests, RunKernelTests) {
 
   index = 0;
   switch (rhs_width) {
-#if defined(FC_4BIT_NEON) && defined(__aarch64__)
+#if (defined(FC_4BIT_NEON) && defined(__aarch64__)) || defined(FC_4BIT_SSE)
     case 4:
       optimized_4bit::RunKernel<optimized_4bit::FilterWidth, 4,
                                 optimized_4bit::FilterDepth>(
@@ -534,6 +566,20 @@ TEST_P(RunKernelTests, RunKernelTests) {
     int32_t val = test_accum[i];
     EXPECT_EQ(val, expected_val);
   }
+
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+  const std::vector<X86Kernel> kernels =
+      rhs_width == 4   ? SupportedX86Kernels<4>()
+      : rhs_width == 2 ? SupportedX86Kernels<2>()
+                       : SupportedX86Kernels<1>();
+  for (X86Kernel kernel : kernels) {
+    std::fill(test_accum.begin(), test_accum.end(), 0);
+    kernel(test_lhs.data(), test_rhs.data(), test_accum.data(),
+           lhs_layout_rows, lhs_layout_cols, rhs_layout_rows, rhs_layout_cols,
+           rhs_layout_rows, lhs_layout_rows);
+    EXPECT_EQ(test_accum, expected_accum);
+  }
+#endif
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -543,7 +589,7 @@ INSTANTIATE_TEST_SUITE_P(
           std::make_tuple(1, 8, 1, 64), std::make_tuple(1, 16, 1, 64),
           std::make_tuple(1, 4, 5, 64), std::make_tuple(1, 8, 9, 64),
           std::make_tuple(1, 16, 17, 64),
-#if defined(FC_4BIT_NEON) && defined(__aarch64__)
+#if (defined(FC_4BIT_NEON) && defined(__aarch64__)) || defined(FC_4BIT_SSE)
           std::make_tuple(2, 8, 2, 32), std::make_tuple(2, 16, 2, 32),
           std::make_tuple(2, 4, 4, 64), std::make_tuple(2, 8, 4, 64),
           std::make_tuple(2, 16, 4, 64), std::make_tuple(2, 4, 4, 64),
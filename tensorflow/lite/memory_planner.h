@@ -62,6 +62,15 @@ class MemoryPlanner {
   // Returns true if the non-persistent memory is available.
   virtual bool HasNonPersistentMemory() = 0;
 
+  // Declares that the execution plan runs in stages whose nodes may execute
+  // concurrently. Stage i covers the execution-plan indices
+  // [stage_begin[i], stage_begin[i + 1]) and the last stage extends to the end
+  // of the plan. Tensors used by any node of a stage must not share memory
+  // with tensors used by another node of the same stage. An empty vector means
+  // that nodes run one at a time. Takes effect on the next PlanAllocations().
+  // Planners that never share memory between tensors may ignore this.
+  virtual void SetConcurrentStages(const std::vector<int>& stage_begin) {}
+
   // Dumps the memory planning information against the specified op node
   // execution plan (i.e. `execution_plan`) for the purpose of debugging.
   virtual void DumpDebugInfo(const std::vector<int>& execution_plan) const = 0;
@@ -315,6 +315,18 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::RestorePlan(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs,
+    size_t planned_size) {
+  active_allocs_.clear();
+  for (const ArenaAllocWithUsageInterval& alloc : allocs) {
+    if (alloc.size > 0) active_allocs_.push_back(alloc);
+  }
+  std::sort(active_allocs_.begin(), active_allocs_.end());
+  high_water_mark_ = planned_size;
+  committed_ = false;
+}
+
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
   underlying_buffer_.Release();
@@ -160,6 +160,15 @@ class SimpleMemoryArena {
 
   size_t GetBufferSize() const { return underlying_buffer_.GetSize(); }
 
+  // Returns the number of bytes the current allocation plan needs.
+  size_t GetPlannedSize() const { return high_water_mark_; }
+
+  // Replaces the current allocation plan with `allocs`, which were returned by
+  // Allocate() for a plan that needed `planned_size` bytes. The arena must be
+  // committed again before allocations are resolved.
+  void RestorePlan(const std::vector<ArenaAllocWithUsageInterval>& allocs,
+                   size_t planned_size);
+
   std::intptr_t BasePointer() const {
     return reinterpret_cast<std::intptr_t>(underlying_buffer_.GetPtr());
   }
@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdarg>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -28,6 +29,7 @@ limitations under the License.
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -54,11 +56,14 @@ limitations under the License.
 #include "tensorflow/lite/optional_debug_tools.h"
 #include "tensorflow/lite/profiling/model_runtime_info.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_params.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/load_generator.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
+#include "tensorflow/lite/tools/evaluation/utils.h"
 #include "tensorflow/lite/tools/logging.h"
 #include "tensorflow/lite/tools/model_loader.h"
 #include "tensorflow/lite/tools/utils.h"
@@ -93,6 +98,10 @@ const char* kOpProfilingOutputModes[] = {kOpProfilingOutputModeStdout,
                                          kOpProfilingOutputModeCsv,
                                          kOpProfilingOutputModeProto};
 
+// Load test arrival processes.
+constexpr char kLoadTestArrivalsClosedLoop[] = "closed_loop";
+constexpr char kLoadTestArrivalsPoisson[] = "poisson";
+
 // Sets feature values in the tensorflow::Example proto from the tflite tensor.
 // Returns an error if the tensor type is not supported or the tensor dime is a
 // nullptr.
@@ -622,6 +631,19 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(15));
   default_params.AddParam("alloc_type_display_length",
                           BenchmarkParam::Create<int32_t>(18));
+  default_params.AddParam("report_xnnpack_weight_cache_startup",
+                          BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("load_test_num_instances",
+                          BenchmarkParam::Create<int32_t>(0));
+  default_params.AddParam(
+      "load_test_arrivals",
+      BenchmarkParam::Create<std::string>(kLoadTestArrivalsClosedLoop));
+  default_params.AddParam("load_test_target_qps",
+                          BenchmarkParam::Create<float>(0.0f));
+  default_params.AddParam("load_test_duration_seconds",
+                          BenchmarkParam::Create<float>(10.0f));
+  default_params.AddParam("load_test_pin_to_cores",
+                          BenchmarkParam::Create<bool>(false));
 
   tools::ProvidedDelegateList delegate_providers(&default_params);
   delegate_providers.AddAllDelegateParams();
@@ -747,7 +769,32 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "default signature will be used."),
       CreateFlag<bool>("list_signatures", &params_,
                        "Displays all signatures present in the model and then "
-                       "terminates the program.")};
+                       "terminates the program."),
+      CreateFlag<bool>(
+          "report_xnnpack_weight_cache_startup", &params_,
+          "Before benchmarking, report the time it takes to get the model "
+          "ready with the XNNPack delegate: without weight cache, when "
+          "building the cache at --xnnpack_weight_cache_file_path and when "
+          "loading it. The cache file is rebuilt."),
+      CreateFlag<int32_t>(
+          "load_test_num_instances", &params_,
+          "After benchmarking, run a load test with this many interpreter "
+          "instances, each served by its own thread, and report latency "
+          "percentiles, throughput and CPU utilization. 0 disables it."),
+      CreateFlag<std::string>(
+          "load_test_arrivals", &params_,
+          "How load test requests arrive: 'closed_loop' (each instance runs "
+          "its next request as soon as the previous one completes) or "
+          "'poisson' (open loop, at --load_test_target_qps on average)."),
+      CreateFlag<float>("load_test_target_qps", &params_,
+                        "Mean request rate of 'poisson' load test arrivals."),
+      CreateFlag<float>("load_test_duration_seconds", &params_,
+                        "Duration of the load test."),
+      CreateFlag<bool>(
+          "load_test_pin_to_cores", &params_,
+          "Pin load test instance i to core i modulo the number of cores. "
+          "Only the instance threads are pinned, not the interpreter's own "
+          "worker threads (see --num_threads).")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -815,6 +862,18 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Tensor name display length", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "tensor_type_display_length",
                       "Tensor type display length", verbose);
+  LOG_BENCHMARK_PARAM(bool, "report_xnnpack_weight_cache_startup",
+                      "Report XNNPack weight cache startup times", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "load_test_num_instances",
+                      "Load test instances", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "load_test_arrivals", "Load test arrivals",
+                      verbose);
+  LOG_BENCHMARK_PARAM(float, "load_test_target_qps", "Load test target QPS",
+                      verbose);
+  LOG_BENCHMARK_PARAM(float, "load_test_duration_seconds",
+                      "Load test duration (seconds)", verbose);
+  LOG_BENCHMARK_PARAM(bool, "load_test_pin_to_cores",
+                      "Pin load test instances to cores", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "alloc_type_display_length",
                       "Tensor allocation type display length", verbose);
 
@@ -833,6 +892,35 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
     return kTfLiteError;
   }
 
+  if (params_.Get<bool>("report_xnnpack_weight_cache_startup") &&
+      params_.Get<std::string>("xnnpack_weight_cache_file_path").empty()) {
+    TFLITE_LOG(ERROR) << "--report_xnnpack_weight_cache_startup requires "
+                         "--xnnpack_weight_cache_file_path.";
+    return kTfLiteError;
+  }
+
+  if (params_.Get<int32_t>("load_test_num_instances") > 0) {
+    const std::string arrivals = params_.Get<std::string>("load_test_arrivals");
+    if (arrivals != kLoadTestArrivalsClosedLoop &&
+        arrivals != kLoadTestArrivalsPoisson) {
+      TFLITE_LOG(ERROR) << "Load test arrivals " << arrivals
+                        << " are not supported. Supported values are: '"
+                        << kLoadTestArrivalsClosedLoop << "' and '"
+                        << kLoadTestArrivalsPoisson << "'.";
+      return kTfLiteError;
+    }
+    if (arrivals == kLoadTestArrivalsPoisson &&
+        params_.Get<float>("load_test_target_qps") <= 0) {
+      TFLITE_LOG(ERROR) << "'poisson' load test arrivals require a positive "
+                           "--load_test_target_qps.";
+      return kTfLiteError;
+    }
+    if (params_.Get<float>("load_test_duration_seconds") <= 0) {
+      TFLITE_LOG(ERROR) << "--load_test_duration_seconds must be positive.";
+      return kTfLiteError;
+    }
+  }
+
   if (params_.Get<bool>("enable_op_profiling")) {
     bool found =
         std::find(std::begin(kOpProfilingOutputModes),
@@ -1248,6 +1336,187 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   return kTfLiteOk;
 }
 
+TfLiteStatus BenchmarkTfLiteModel::Run() {
+  if (params_.Get<bool>("report_xnnpack_weight_cache_startup")) {
+    TF_LITE_ENSURE_STATUS(ValidateParams());
+    TF_LITE_ENSURE_STATUS(ReportXNNPackWeightCacheStartup());
+  }
+  TF_LITE_ENSURE_STATUS(BenchmarkModel::Run());
+  if (params_.Get<int32_t>("load_test_num_instances") > 0) {
+    TF_LITE_ENSURE_STATUS(RunLoadTestAndReport());
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::CreateLoadTestInstance(
+    LoadTestInstance& instance) {
+  auto resolver = GetOpResolver();
+  InterpreterOptions options;
+  options.SetEnsureDynamicTensorsAreReleased(
+      params_.Get<bool>("release_dynamic_tensors"));
+  options.OptimizeMemoryForLargeTensors(
+      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
+  options.SetDisableDelegateClustering(
+      params_.Get<bool>("disable_delegate_clustering"));
+  options.SetCacheConstantCastOp(
+      params_.Get<bool>("enable_builtin_cast_constant_cache"));
+  tflite::InterpreterBuilder builder(*model_, *resolver, &options);
+  TF_LITE_ENSURE_STATUS(
+      builder.SetNumThreads(params_.Get<int32_t>("num_threads")));
+  TF_LITE_ENSURE_STATUS(builder(&instance.interpreter));
+  instance.interpreter->SetAllowFp16PrecisionForFp32(
+      params_.Get<bool>("allow_fp16"));
+
+  auto status_and_runner = BenchmarkInterpreterRunner::Create(
+      instance.interpreter.get(),
+      params_.Get<std::string>("signature_to_run_for"));
+  TF_LITE_ENSURE_STATUS(status_and_runner.first);
+  instance.runner = std::move(status_and_runner.second);
+
+  const std::vector<int>& inputs = interpreter_runner_->inputs();
+  for (int i : inputs) {
+    const TfLiteTensor* t = interpreter_runner_->tensor(i);
+    if (t->type != kTfLiteString) {
+      TF_LITE_ENSURE_STATUS(instance.runner->ResizeInputTensor(
+          i, std::vector<int>(t->dims->data, t->dims->data + t->dims->size)));
+    }
+  }
+
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  for (auto& created_delegate : delegate_providers.CreateAllRankedDelegates()) {
+    instance.delegates.emplace_back(std::move(created_delegate.delegate));
+    TF_LITE_ENSURE_STATUS(instance.interpreter->ModifyGraphWithDelegate(
+        instance.delegates.back().get()));
+  }
+  TF_LITE_ENSURE_STATUS(instance.runner->AllocateTensors());
+
+  for (int i : inputs) {
+    const TfLiteTensor* src = interpreter_runner_->tensor(i);
+    TfLiteTensor* dst = instance.runner->tensor(i);
+    if (src->type == kTfLiteString) {
+      DynamicBuffer buffer;
+      for (int s = 0; s < GetStringCount(src); ++s) {
+        const StringRef str = GetString(src, s);
+        buffer.AddString(str.str, str.len);
+      }
+      buffer.WriteToTensor(dst, /*new_shape=*/nullptr);
+    } else if (src->data.raw != nullptr && dst->bytes == src->bytes) {
+      std::memcpy(dst->data.raw, src->data.raw, src->bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunLoadTestAndReport() {
+  LoadTestOptions options;
+  options.num_instances = params_.Get<int32_t>("load_test_num_instances");
+  options.arrivals =
+      params_.Get<std::string>("load_test_arrivals") == kLoadTestArrivalsPoisson
+          ? LoadTestOptions::Arrivals::kPoisson
+          : LoadTestOptions::Arrivals::kClosedLoop;
+  options.target_qps = params_.Get<float>("load_test_target_qps");
+  options.duration_seconds = params_.Get<float>("load_test_duration_seconds");
+  options.pin_instances_to_cores = params_.Get<bool>("load_test_pin_to_cores");
+  options.seed = random_engine_();
+
+  std::vector<LoadTestInstance> instances(options.num_instances);
+  for (LoadTestInstance& instance : instances) {
+    if (CreateLoadTestInstance(instance) != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to create a load test instance.";
+      return kTfLiteError;
+    }
+  }
+  // Warm up each instance outside of the measurement.
+  for (LoadTestInstance& instance : instances) {
+    TF_LITE_ENSURE_STATUS(instance.runner->Invoke());
+  }
+
+  TFLITE_LOG(INFO) << "Running load test with " << options.num_instances
+                   << " instance(s) for " << options.duration_seconds
+                   << " seconds.";
+  const LoadTestResult result =
+      tflite::benchmark::RunLoadTest(options, [&instances](int instance) {
+        return instances[instance].runner->Invoke() == kTfLiteOk;
+      });
+
+  TFLITE_LOG(INFO) << "Load test: " << result.latencies_us.size()
+                   << " requests in " << result.wall_time_seconds
+                   << " seconds, " << result.Qps() << " QPS, "
+                   << result.num_failures << " failed, " << result.num_dropped
+                   << " dropped.";
+  TFLITE_LOG(INFO) << "Load test latency (us): p50="
+                   << result.PercentileUs(50)
+                   << " p90=" << result.PercentileUs(90)
+                   << " p99=" << result.PercentileUs(99)
+                   << " p99.9=" << result.PercentileUs(99.9);
+  TFLITE_LOG(INFO) << "Load test CPU utilization: "
+                   << result.CpuUtilization() * 100 << "% of "
+                   << std::thread::hardware_concurrency() << " cores.";
+  return result.num_failures == 0 ? kTfLiteOk : kTfLiteError;
+}
+
+int64_t BenchmarkTfLiteModel::MeasureXNNPackStartupUs(
+    const std::string& weight_cache_file_path) {
+  const std::string graph = params_.Get<std::string>("graph");
+  const int64_t start_us = profiling::time::NowMicros();
+
+  std::unique_ptr<tools::ModelLoader> model_loader =
+      tools::CreateModelLoaderFromPath(graph);
+  if (!model_loader || !model_loader->Init()) {
+    TFLITE_LOG(ERROR) << "Failed to load model " << graph;
+    return -1;
+  }
+  // Only the explicitly created delegate below is applied.
+  auto resolver = std::make_unique<
+      tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates>();
+  RegisterSelectedOps(resolver.get());
+  auto delegate = evaluation::CreateXNNPACKDelegate(
+      params_.Get<int32_t>("num_threads"),
+      params_.Get<bool>("xnnpack_force_fp16"), weight_cache_file_path.c_str());
+  std::unique_ptr<Interpreter> interpreter;
+  if (tflite::InterpreterBuilder(*model_loader->GetModel(),
+                                 *resolver)(&interpreter) != kTfLiteOk ||
+      !delegate ||
+      interpreter->ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to initialize the interpreter with the "
+                         "XNNPack delegate.";
+    return -1;
+  }
+  const int64_t end_us = profiling::time::NowMicros();
+
+  // The interpreter depends on the delegate and must be destroyed first.
+  interpreter.reset();
+  return end_us - start_us;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::ReportXNNPackWeightCacheStartup() {
+  const std::string cache_path =
+      params_.Get<std::string>("xnnpack_weight_cache_file_path");
+  // Read the model once so that every measurement finds it in the page cache.
+  if (MeasureXNNPackStartupUs("") < 0) {
+    return kTfLiteError;
+  }
+  const int64_t no_cache_us = MeasureXNNPackStartupUs("");
+  if (no_cache_us < 0) {
+    return kTfLiteError;
+  }
+  // Force the next run to build the cache.
+  std::remove(cache_path.c_str());
+  const int64_t build_cache_us = MeasureXNNPackStartupUs(cache_path);
+  const int64_t load_cache_us = MeasureXNNPackStartupUs(cache_path);
+  if (build_cache_us < 0 || load_cache_us < 0) {
+    return kTfLiteError;
+  }
+  TFLITE_LOG(INFO) << "XNNPack startup without weight cache: "
+                   << no_cache_us / 1e3 << "ms.";
+  TFLITE_LOG(INFO) << "XNNPack startup building weight cache: "
+                   << build_cache_us / 1e3 << "ms.";
+  TFLITE_LOG(INFO) << "XNNPack startup loading weight cache: "
+                   << load_cache_us / 1e3 << "ms.";
+  return kTfLiteOk;
+}
+
 TfLiteStatus BenchmarkTfLiteModel::LoadModel() {
   std::string fd_or_graph_path = params_.Get<std::string>("graph");
   model_loader_ = tools::CreateModelLoaderFromPath(fd_or_graph_path);
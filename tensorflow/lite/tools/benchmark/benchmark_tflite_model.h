@@ -167,6 +167,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   uint64_t ComputeInputBytes() override;
   TfLiteStatus Init() override;
   TfLiteStatus RunImpl() override;
+  using BenchmarkModel::Run;
+  TfLiteStatus Run() override;
   static BenchmarkParams DefaultParams();
 
  protected:
@@ -203,6 +205,30 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Returns the time taken to load the model, apply the XNNPack delegate with
+  // the given weight cache file (none if empty) and allocate tensors, or -1 if
+  // any step fails.
+  int64_t MeasureXNNPackStartupUs(const std::string& weight_cache_file_path);
+
+  // Logs the startup time without XNNPack weight cache, when building the
+  // cache and when loading it.
+  TfLiteStatus ReportXNNPackWeightCacheStartup();
+
+  // An interpreter serving the requests of one load test client.
+  struct LoadTestInstance {
+    // Declared first so that the interpreter is destroyed before them.
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+    std::unique_ptr<BenchmarkInterpreterRunner> runner;
+  };
+
+  // Builds an interpreter like `Init` does, with the same input values as the
+  // benchmarked one.
+  TfLiteStatus CreateLoadTestInstance(LoadTestInstance& instance);
+
+  // Runs the --load_test_* load test and logs its results.
+  TfLiteStatus RunLoadTestAndReport();
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/load_generator.h"
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void PinCurrentThreadToCore(int core) {
+#if defined(__linux__) || defined(__ANDROID__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(core, &cpu_set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+    TFLITE_LOG(WARN) << "Failed to pin load test instance to core " << core;
+  }
+#else
+  TFLITE_LOG(WARN) << "Pinning load test instances is not supported on this "
+                      "platform.";
+#endif
+}
+
+// Returns the arrival times of a Poisson process of rate `qps` over
+// `duration`.
+std::vector<Clock::duration> PoissonArrivals(double qps, double duration_s,
+                                             uint32_t seed) {
+  std::vector<Clock::duration> arrivals;
+  std::mt19937 random_engine(seed);
+  std::exponential_distribution<double> interval_s(qps);
+  for (double t = interval_s(random_engine); t < duration_s;
+       t += interval_s(random_engine)) {
+    arrivals.push_back(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(t)));
+  }
+  return arrivals;
+}
+
+int64_t ToMicros(Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+}  // namespace
+
+double LoadTestResult::Qps() const {
+  return wall_time_seconds > 0 ? latencies_us.size() / wall_time_seconds : 0;
+}
+
+int64_t LoadTestResult::PercentileUs(double percentile) const {
+  if (latencies_us.empty()) return -1;
+  // The tolerance keeps e.g. 99.9% of 1000 from rounding up to 1000.
+  const size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * latencies_us.size() - 1e-9));
+  return latencies_us[std::clamp<size_t>(rank, 1, latencies_us.size()) - 1];
+}
+
+double LoadTestResult::CpuUtilization() const {
+  const unsigned num_cores = std::max(1u, std::thread::hardware_concurrency());
+  return wall_time_seconds > 0
+             ? cpu_time_seconds / (wall_time_seconds * num_cores)
+             : 0;
+}
+
+LoadTestResult RunLoadTest(const LoadTestOptions& options,
+                           const std::function<bool(int)>& run_request) {
+  const bool open_loop =
+      options.arrivals == LoadTestOptions::Arrivals::kPoisson;
+  const std::vector<Clock::duration> arrivals =
+      open_loop ? PoissonArrivals(options.target_qps,
+                                  options.duration_seconds, options.seed)
+                : std::vector<Clock::duration>();
+  const auto duration = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(options.duration_seconds));
+
+  // Next open-loop request to serve. Instances take requests in arrival
+  // order, which behaves like a single queue served by all instances.
+  std::atomic<size_t> next_request{0};
+  std::vector<std::vector<int64_t>> latencies_us(options.num_instances);
+  std::vector<int64_t> num_failures(options.num_instances, 0);
+  const unsigned num_cores = std::max(1u, std::thread::hardware_concurrency());
+
+  const std::clock_t start_cpu_time = std::clock();
+  const Clock::time_point start = Clock::now();
+  const Clock::time_point deadline = start + duration;
+  // Open-loop requests are not started past this point.
+  const Clock::time_point drain_deadline = deadline + duration;
+
+  auto run_instance = [&](int instance) {
+    if (options.pin_instances_to_cores) {
+      PinCurrentThreadToCore(instance % num_cores);
+    }
+    std::vector<int64_t>& instance_latencies_us = latencies_us[instance];
+    while (true) {
+      Clock::time_point request_start;
+      if (open_loop) {
+        const size_t request = next_request.fetch_add(1);
+        if (request >= arrivals.size()) break;
+        request_start = start + arrivals[request];
+        std::this_thread::sleep_until(request_start);
+        if (Clock::now() > drain_deadline) break;
+      } else {
+        request_start = Clock::now();
+        if (request_start >= deadline) break;
+      }
+      if (run_request(instance)) {
+        instance_latencies_us.push_back(
+            ToMicros(Clock::now() - request_start));
+      } else {
+        ++num_failures[instance];
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(options.num_instances);
+  for (int i = 0; i < options.num_instances; ++i) {
+    threads.emplace_back(run_instance, i);
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  LoadTestResult result;
+  result.wall_time_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  result.cpu_time_seconds =
+      static_cast<double>(std::clock() - start_cpu_time) / CLOCKS_PER_SEC;
+  for (int i = 0; i < options.num_instances; ++i) {
+    result.latencies_us.insert(result.latencies_us.end(),
+                               latencies_us[i].begin(), latencies_us[i].end());
+    result.num_failures += num_failures[i];
+  }
+  std::sort(result.latencies_us.begin(), result.latencies_us.end());
+  if (open_loop) {
+    const int64_t num_served =
+        result.latencies_us.size() + result.num_failures;
+    result.num_dropped = arrivals.size() - num_served;
+  }
+  return result;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
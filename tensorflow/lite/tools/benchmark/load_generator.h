@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_LOAD_GENERATOR_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_LOAD_GENERATOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+
+struct LoadTestOptions {
+  enum class Arrivals {
+    // Each instance sends its next request as soon as the previous one
+    // completes.
+    kClosedLoop,
+    // Requests arrive following a Poisson process of rate `target_qps`,
+    // independently of how fast they are served, and are queued until an
+    // instance is free.
+    kPoisson,
+  };
+
+  int num_instances = 1;
+  Arrivals arrivals = Arrivals::kClosedLoop;
+  // Mean arrival rate over all instances. Only used with kPoisson.
+  double target_qps = 0;
+  double duration_seconds = 10;
+  // Pins instance i to core i modulo the number of cores. Only supported on
+  // Linux and Android.
+  bool pin_instances_to_cores = false;
+  // Seed of the arrival times.
+  uint32_t seed = 0;
+};
+
+struct LoadTestResult {
+  // Latencies of the requests that succeeded, in microseconds and in
+  // increasing order. For open-loop arrivals, the latency includes the time
+  // spent waiting for a free instance.
+  std::vector<int64_t> latencies_us;
+  int64_t num_failures = 0;
+  // Open-loop requests that could not be started before the test was stopped
+  // because the instances fell too far behind the arrivals.
+  int64_t num_dropped = 0;
+  double wall_time_seconds = 0;
+  // CPU time used by the whole process during the test.
+  double cpu_time_seconds = 0;
+
+  // Returns the number of successful requests per second.
+  double Qps() const;
+
+  // Returns the nearest-rank `percentile` (in (0, 100]) of the latencies, or
+  // -1 if there are none.
+  int64_t PercentileUs(double percentile) const;
+
+  // Returns the CPU time over the wall time of all the cores of the machine.
+  double CpuUtilization() const;
+};
+
+// Runs `run_request(instance)` from `options.num_instances` threads, where
+// `instance` is the index of the calling thread, until
+// `options.duration_seconds` have elapsed. `run_request` returns false when the
+// request failed.
+//
+// With open-loop arrivals, requests that arrived before the deadline are still
+// served after it, for at most another `options.duration_seconds`.
+LoadTestResult RunLoadTest(const LoadTestOptions& options,
+                           const std::function<bool(int)>& run_request);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_LOAD_GENERATOR_H_
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/load_generator.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+TEST(LoadTestResultTest, Percentiles) {
+  LoadTestResult result;
+  EXPECT_EQ(result.PercentileUs(50), -1);
+  for (int64_t i = 1; i <= 1000; ++i) result.latencies_us.push_back(i);
+  EXPECT_EQ(result.PercentileUs(50), 500);
+  EXPECT_EQ(result.PercentileUs(90), 900);
+  EXPECT_EQ(result.PercentileUs(99), 990);
+  EXPECT_EQ(result.PercentileUs(99.9), 999);
+  EXPECT_EQ(result.PercentileUs(100), 1000);
+  EXPECT_EQ(result.PercentileUs(0), 1);
+}
+
+TEST(LoadGeneratorTest, ClosedLoopUsesAllInstances) {
+  LoadTestOptions options;
+  options.num_instances = 3;
+  options.duration_seconds = 0.1;
+  std::atomic<int> requests_per_instance[3] = {0, 0, 0};
+  const LoadTestResult result = RunLoadTest(options, [&](int instance) {
+    ++requests_per_instance[instance];
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return true;
+  });
+
+  int num_requests = 0;
+  for (const auto& count : requests_per_instance) {
+    EXPECT_GT(count, 0);
+    num_requests += count;
+  }
+  EXPECT_EQ(result.latencies_us.size(), num_requests);
+  EXPECT_EQ(result.num_failures, 0);
+  EXPECT_EQ(result.num_dropped, 0);
+  EXPECT_GE(result.PercentileUs(50), 1000);
+  EXPECT_GE(result.wall_time_seconds, 0.1);
+  EXPECT_GT(result.Qps(), 0);
+}
+
+TEST(LoadGeneratorTest, PoissonArrivalsFollowTargetRate) {
+  LoadTestOptions options;
+  options.num_instances = 2;
+  options.arrivals = LoadTestOptions::Arrivals::kPoisson;
+  options.target_qps = 400;
+  options.duration_seconds = 0.5;
+  const LoadTestResult result =
+      RunLoadTest(options, [](int instance) { return true; });
+
+  // 200 arrivals are expected, the standard deviation is ~14.
+  EXPECT_GT(result.latencies_us.size(), 120);
+  EXPECT_LT(result.latencies_us.size(), 280);
+  EXPECT_EQ(result.num_dropped, 0);
+  EXPECT_GE(result.wall_time_seconds, 0.4);
+}
+
+TEST(LoadGeneratorTest, CountsFailures) {
+  LoadTestOptions options;
+  options.duration_seconds = 0.05;
+  std::atomic<int> num_requests{0};
+  const LoadTestResult result = RunLoadTest(options, [&](int instance) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return ++num_requests % 2 == 0;
+  });
+  EXPECT_EQ(result.latencies_us.size() + result.num_failures, num_requests);
+  EXPECT_GT(result.num_failures, 0);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
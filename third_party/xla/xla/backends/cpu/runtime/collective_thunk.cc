@@ -41,6 +41,7 @@ limitations under the License.
 #include "xla/service/cpu/collectives_interface.h"
 #include "xla/service/global_device_id.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
@@ -76,6 +77,25 @@ Thunk::ResourceUses CollectiveThunk::resource_uses() const {
   return {ResourceUse::Write(op_resources_.communicator_resource)};
 }
 
+Thunk::CostEstimate CollectiveThunk::cost_estimate() const {
+  CostEstimate cost;
+  for (auto& source_buffer : source_buffers()) {
+    cost.bytes_accessed += source_buffer.size();
+  }
+  for (auto& destination_buffer : destination_buffers()) {
+    cost.bytes_accessed += destination_buffer.size();
+  }
+
+  // Reduction collectives combine every source element with the elements
+  // received from the other participants.
+  if (kind() == Kind::kAllReduce || kind() == Kind::kReduceScatter) {
+    for (const Shape& shape : op_buffers_.source_shapes) {
+      cost.flops += ShapeUtil::ElementsIn(shape);
+    }
+  }
+  return cost;
+}
+
 bool CollectiveThunk::IsDataTypeSupportedByCollectiveReduce(
     PrimitiveType datatype) {
   switch (datatype) {
@@ -83,6 +83,7 @@ class CollectiveThunk : public Thunk {
 
   BufferUses buffer_uses() const final;
   ResourceUses resource_uses() const final;
+  CostEstimate cost_estimate() const final;
 
  protected:
   // Callback for collective thunk implementations.
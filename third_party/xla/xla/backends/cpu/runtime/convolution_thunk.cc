@@ -16,6 +16,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/cpu/runtime_conv2d_acl.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
@@ -254,6 +256,19 @@ ConvolutionThunk::ConvolutionThunk(
       convolution_rank_(input_dims.size()),
       options_(options) {}
 
+ConvolutionThunk::CostEstimate ConvolutionThunk::cost_estimate() const {
+  // Each output element accumulates products over the kernel window and the
+  // input channels of its feature group, which is one filter of the kernel.
+  int64_t filter_size = ShapeUtil::ElementsIn(kernel_shape_) /
+                        std::max<int64_t>(kernel_filters_, 1);
+
+  CostEstimate cost;
+  cost.flops = 2 * ShapeUtil::ElementsIn(output_shape_) * filter_size;
+  cost.bytes_accessed =
+      input_buffer_.size() + kernel_buffer_.size() + output_buffer_.size();
+  return cost;
+}
+
 tsl::AsyncValueRef<Thunk::ExecuteEvent> ConvolutionThunk::Execute(
     const ExecuteParams& params) {
   tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
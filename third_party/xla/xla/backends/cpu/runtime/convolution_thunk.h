@@ -54,6 +54,8 @@ class ConvolutionThunk final : public Thunk {
             {output_buffer_, BufferUse::kWrite}};
   }
 
+  CostEstimate cost_estimate() const final;
+
  private:
   ConvolutionThunk(Info info, BufferAllocation::Slice input_buffer,
                    const Shape& input_shape,
@@ -29,7 +29,9 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xla/backends/cpu/runtime/packed_matmul.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/layout_util.h"
 #include "xla/primitive_util.h"
@@ -79,8 +81,28 @@ struct MatMulDims {
   bool rhs_canonical;
 };
 
+// Strides of the elements of a col-major matrix in memory.
+struct MatrixStrides {
+  int64_t row;
+  int64_t col;
+};
+
+// The range of the number of non-constant operand columns for which we use
+// the small-N kernel with a packed constant operand. For a single column Eigen
+// contraction dispatches to GEMV that doesn't pack operands, and for a large
+// number of columns Eigen GEMM amortizes the cost of packing.
+static constexpr int64_t kMinPackedMatMulCols = 2;
+static constexpr int64_t kMaxPackedMatMulCols = 4;
+
 }  // namespace
 
+// Returns strides of the `rows x cols` matrix stored in col-major layout, or
+// of the `cols x rows` matrix (if transposed) read as its transpose.
+static MatrixStrides ColMajorStrides(int64_t rows, int64_t cols,
+                                     bool transposed) {
+  return transposed ? MatrixStrides{cols, 1} : MatrixStrides{1, rows};
+}
+
 static MatMulDims GetMatMulDims(
     const Shape& lhs_shape, absl::Span<const int64_t> lhs_contracting_dims,
     const Shape& rhs_shape, absl::Span<const int64_t> rhs_contracting_dims) {
@@ -197,6 +219,88 @@ DotThunk::DotThunk(Info info, DotDimensionNumbers dot_dimensions,
     dim -= dot_dimensions_.rhs_batch_dimensions_size();
 }
 
+std::shared_ptr<const PackedMatrix> DotThunk::GetOrPackConstant(
+    const float* data, int64_t rows, int64_t cols, int64_t row_stride,
+    int64_t col_stride) {
+  absl::MutexLock lock(&packed_mu_);
+  if (packed_ == nullptr || packed_source_ != data) {
+    VLOG(3) << absl::StreamFormat("  pack constant operand: rows=%d, cols=%d",
+                                  rows, cols);
+    packed_ = std::make_shared<PackedMatrix>(
+        PackedMatrix::Pack(data, rows, cols, row_stride, col_stride));
+    packed_source_ = data;
+  }
+  return packed_;
+}
+
+tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::PackedMatMul(
+    const Eigen::ThreadPoolDevice* device, float* out, const float* lhs,
+    const float* rhs, int64_t m, int64_t n, int64_t k, bool transpose_lhs,
+    bool transpose_rhs, bool pack_lhs) {
+  MatrixStrides lhs_strides = ColMajorStrides(m, k, transpose_lhs);
+  MatrixStrides rhs_strides = ColMajorStrides(k, n, transpose_rhs);
+
+  // Small-N kernel computes `packed * other`, where `packed` is the packed
+  // constant operand. If the constant is the RHS, we compute the transposed
+  // product instead:
+  //
+  //   (A x B)^T = B^T x A^T
+  //
+  // Transposition does not move any data, and only swaps the strides.
+  std::shared_ptr<const PackedMatrix> packed;
+  const float* other;
+  int64_t other_cols;
+  MatrixStrides other_strides;
+  MatrixStrides out_strides;
+
+  if (pack_lhs) {
+    packed = GetOrPackConstant(lhs, m, k, lhs_strides.row, lhs_strides.col);
+    other = rhs;
+    other_cols = n;
+    other_strides = rhs_strides;
+    out_strides = {1, m};
+  } else {
+    packed = GetOrPackConstant(rhs, n, k, rhs_strides.col, rhs_strides.row);
+    other = lhs;
+    other_cols = m;
+    other_strides = {lhs_strides.col, lhs_strides.row};
+    out_strides = {m, 1};
+  }
+
+  // Cost of computing a single panel of the output.
+  Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/sizeof(float) * PackedMatrix::kPanelRows * k,
+      /*bytes_stored=*/sizeof(float) * PackedMatrix::kPanelRows * other_cols,
+      /*compute_cycles=*/
+      PackedMatrix::kPanelRows * k * other_cols / PackedMatrix::kPacketSize);
+
+  auto state = std::make_shared<ExecuteState>(1);
+  device->parallelForAsync(
+      packed->num_panels(), cost,
+      [=](Eigen::Index panel_begin, Eigen::Index panel_end) {
+        ::xla::cpu::PackedMatMul(*packed, other, other_cols, other_strides.row,
+                                 other_strides.col, out, out_strides.row,
+                                 out_strides.col, panel_begin, panel_end);
+      },
+      [state] { state->Notify(); });
+
+  return state->event;
+}
+
+DotThunk::CostEstimate DotThunk::cost_estimate() const {
+  // Each element of the output matrix is a dot product of a row of the LHS and
+  // a column of the RHS of length `k`.
+  int64_t k = lhs_matmul_contracting_dims_.empty()
+                  ? 1
+                  : lhs_matmul_shape_.dimensions(lhs_matmul_contracting_dims_[0]);
+
+  CostEstimate cost;
+  cost.flops = 2 * batch_size_ * ShapeUtil::ElementsIn(out_matmul_shape_) * k;
+  cost.bytes_accessed =
+      lhs_buffer_.size() + rhs_buffer_.size() + out_buffer_.size();
+  return cost;
+}
+
 tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::Execute(
     const ExecuteParams& params) {
   tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
@@ -266,14 +370,38 @@ tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::Execute(
   bool transpose_lhs = !matmul_dims.lhs_canonical;
   bool transpose_rhs = !matmul_dims.rhs_canonical;
 
+  bool lhs_constant = lhs_buffer_.allocation()->is_constant();
+  bool rhs_constant = rhs_buffer_.allocation()->is_constant();
+
   CHECK_EQ(matmul_dims.lhs_column_major, matmul_dims.rhs_column_major);
   if (!matmul_dims.lhs_column_major) {
     std::swap(matmul_dims.m, matmul_dims.n);
     std::swap(lhs, rhs);
     std::swap(transpose_lhs, transpose_rhs);
+    std::swap(lhs_constant, rhs_constant);
   }
 
   PrimitiveType element_type = lhs_matmul_shape_.element_type();
+
+  // If one of the operands is a constant (i.e. weights in inference), and the
+  // other one has just a few columns (i.e. a small batch), we pack the constant
+  // once and multiply it with the small-N kernel, instead of repacking it in
+  // Eigen contraction on every execution.
+  auto is_small = [](int64_t cols) {
+    return cols >= kMinPackedMatMulCols && cols <= kMaxPackedMatMulCols;
+  };
+
+  bool pack_lhs = lhs_constant && is_small(matmul_dims.n);
+  bool pack_rhs = rhs_constant && is_small(matmul_dims.m);
+
+  if (element_type == F32 && batch_size_ == 1 && (pack_lhs || pack_rhs)) {
+    return PackedMatMul(params.intra_op_threadpool, static_cast<float*>(out),
+                        static_cast<const float*>(lhs),
+                        static_cast<const float*>(rhs), matmul_dims.m,
+                        matmul_dims.n, matmul_dims.k, transpose_lhs,
+                        transpose_rhs, pack_lhs);
+  }
+
   int64_t byte_width = primitive_util::ByteWidth(element_type);
 
   int64_t lhs_stride = matmul_dims.m * matmul_dims.k * byte_width;
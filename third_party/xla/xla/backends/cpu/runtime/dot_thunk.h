@@ -24,11 +24,14 @@ limitations under the License.
 #include <utility>
 
 #include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "Eigen/Core"
 #include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/backends/cpu/runtime/packed_matmul.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/service/buffer_assignment.h"
@@ -53,6 +56,8 @@ class DotThunk final : public Thunk {
             BufferUse::Write(out_buffer_)};
   }
 
+  CostEstimate cost_estimate() const final;
+
  private:
   DotThunk(Info info, DotDimensionNumbers dot_dimensions,
            BufferAllocation::Slice lhs_buffer, Shape lhs_shape,
@@ -76,6 +81,23 @@ class DotThunk final : public Thunk {
                           bool transpose_lhs, bool transpose_rhs,
                           DoneCallback done);
 
+  // Col-major x Col-major MatMul implementation as a small-N kernel with one
+  // of the operands (constant) packed ahead of time. If `pack_lhs` is false,
+  // the RHS is packed.
+  tsl::AsyncValueRef<ExecuteEvent> PackedMatMul(
+      const Eigen::ThreadPoolDevice* device, float* out, const float* lhs,
+      const float* rhs, int64_t m, int64_t n, int64_t k, bool transpose_lhs,
+      bool transpose_rhs, bool pack_lhs);
+
+  // Returns a constant operand packed for the small-N matmul kernel. We pack
+  // the constant on first execution and reuse it for all later executions, as
+  // constant allocations have the same address for the executable lifetime.
+  std::shared_ptr<const PackedMatrix> GetOrPackConstant(const float* data,
+                                                        int64_t rows,
+                                                        int64_t cols,
+                                                        int64_t row_stride,
+                                                        int64_t col_stride);
+
   DotDimensionNumbers dot_dimensions_;
 
   BufferAllocation::Slice lhs_buffer_;
@@ -98,6 +120,11 @@ class DotThunk final : public Thunk {
   // Contracting dimensions of the LHS and RHS matmul shapes.
   absl::InlinedVector<int64_t, 2> lhs_matmul_contracting_dims_;
   absl::InlinedVector<int64_t, 2> rhs_matmul_contracting_dims_;
+
+  // Packed constant operand and the address it was packed from.
+  absl::Mutex packed_mu_;
+  const float* packed_source_ ABSL_GUARDED_BY(packed_mu_) = nullptr;
+  std::shared_ptr<const PackedMatrix> packed_ ABSL_GUARDED_BY(packed_mu_);
 };
 
 //===----------------------------------------------------------------------===//
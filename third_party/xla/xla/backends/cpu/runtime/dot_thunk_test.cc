@@ -0,0 +1,170 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/dot_thunk.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+// Number of rows of the constant operand that are not contracted. It is not a
+// multiple of the packed panel size, so the last panel is padded.
+static constexpr int64_t kConstantRows = 37;
+static constexpr int64_t kK = 19;
+
+// Returns `size` small integer values, so that all products and sums are exact
+// in f32 and both matmul paths produce bitwise identical results.
+static std::vector<float> Iota(int64_t size, int64_t seed) {
+  std::vector<float> data(size);
+  for (int64_t i = 0; i < data.size(); ++i) {
+    data[i] = ((i + seed) * 7) % 11 - 5;
+  }
+  return data;
+}
+
+// Returns a `rows x cols` row-major shape, or a `cols x rows` shape holding the
+// same matrix column-major (transposed) if `transposed` is true.
+static Shape MatrixShape(int64_t rows, int64_t cols, bool transposed) {
+  return transposed ? ShapeUtil::MakeShape(F32, {cols, rows})
+                    : ShapeUtil::MakeShape(F32, {rows, cols});
+}
+
+// Parameters: whether the constant operand is the LHS, whether the LHS and RHS
+// are stored transposed, and the number of non-constant operand columns.
+class DotThunkPackedTest
+    : public ::testing::TestWithParam<std::tuple<bool, bool, bool, int64_t>> {
+ protected:
+  DotThunkPackedTest()
+      : thread_pool_(tsl::Env::Default(), "dot-thunk-test", 4),
+        device_(thread_pool_.AsEigenThreadPool(), thread_pool_.NumThreads()) {}
+
+  // Executes `lhs x rhs` with DotThunk and returns the result. If `constant`
+  // is true, the constant operand is allocated as a constant, and DotThunk
+  // uses the packed small-N kernel. Otherwise it uses the Eigen contraction.
+  absl::StatusOr<std::vector<float>> Dot(std::vector<float> lhs,
+                                         std::vector<float> rhs, bool constant,
+                                         int64_t num_executions = 1) {
+    auto [lhs_constant, transpose_lhs, transpose_rhs, n] = GetParam();
+
+    int64_t m = lhs_constant ? kConstantRows : n;
+    int64_t cols = lhs_constant ? n : kConstantRows;
+
+    DotDimensionNumbers dot_dimensions;
+    dot_dimensions.add_lhs_contracting_dimensions(transpose_lhs ? 0 : 1);
+    dot_dimensions.add_rhs_contracting_dimensions(transpose_rhs ? 1 : 0);
+
+    Shape lhs_shape = MatrixShape(m, kK, transpose_lhs);
+    Shape rhs_shape = MatrixShape(kK, cols, transpose_rhs);
+    Shape out_shape = ShapeUtil::MakeShape(F32, {m, cols});
+
+    std::vector<float> out(m * cols, 0.0f);
+
+    size_t lhs_size = lhs.size() * sizeof(float);
+    size_t rhs_size = rhs.size() * sizeof(float);
+    size_t out_size = out.size() * sizeof(float);
+
+    std::vector<MaybeOwningDeviceMemory> buffers;
+    buffers.emplace_back(se::DeviceMemoryBase(lhs.data(), lhs_size));
+    buffers.emplace_back(se::DeviceMemoryBase(rhs.data(), rhs_size));
+    buffers.emplace_back(se::DeviceMemoryBase(out.data(), out_size));
+
+    BufferAllocations allocations(buffers);
+
+    BufferAllocation lhs_alloc(/*index=*/0, lhs_size, /*color=*/0);
+    BufferAllocation rhs_alloc(/*index=*/1, rhs_size, /*color=*/0);
+    BufferAllocation out_alloc(/*index=*/2, out_size, /*color=*/0);
+    lhs_alloc.set_constant(constant && lhs_constant);
+    rhs_alloc.set_constant(constant && !lhs_constant);
+
+    BufferAllocation::Slice lhs_slice(&lhs_alloc, 0, lhs_size);
+    BufferAllocation::Slice rhs_slice(&rhs_alloc, 0, rhs_size);
+    BufferAllocation::Slice out_slice(&out_alloc, 0, out_size);
+
+    TF_ASSIGN_OR_RETURN(
+        auto thunk,
+        DotThunk::Create({"dot"}, dot_dimensions, lhs_slice, lhs_shape,
+                         rhs_slice, rhs_shape, out_slice, out_shape));
+
+    Thunk::ExecuteParams params;
+    params.buffer_allocations = &allocations;
+    params.intra_op_threadpool = &device_;
+
+    for (int64_t i = 0; i < num_executions; ++i) {
+      auto execute_event = thunk->Execute(params);
+      tsl::BlockUntilReady(execute_event);
+      if (execute_event.IsError()) return execute_event.GetError();
+    }
+    return out;
+  }
+
+  tsl::thread::ThreadPool thread_pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+TEST_P(DotThunkPackedTest, MatchesEigenContraction) {
+  auto [lhs_constant, transpose_lhs, transpose_rhs, n] = GetParam();
+  int64_t m = lhs_constant ? kConstantRows : n;
+  int64_t cols = lhs_constant ? n : kConstantRows;
+
+  std::vector<float> lhs = Iota(m * kK, /*seed=*/0);
+  std::vector<float> rhs = Iota(kK * cols, /*seed=*/3);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<float> expected,
+                          Dot(lhs, rhs, /*constant=*/false));
+  // The second execution reuses the constant packed by the first one.
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<float> packed,
+      Dot(lhs, rhs, /*constant=*/true, /*num_executions=*/2));
+  EXPECT_EQ(packed, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DotThunkPacked, DotThunkPackedTest,
+    ::testing::Combine(::testing::Bool(), ::testing::Bool(), ::testing::Bool(),
+                       ::testing::Range<int64_t>(2, 5)),
+    [](const ::testing::TestParamInfo<DotThunkPackedTest::ParamType>& info) {
+      auto [lhs_constant, transpose_lhs, transpose_rhs, n] = info.param;
+      return absl::StrCat(lhs_constant ? "ConstantLhs" : "ConstantRhs",
+                          transpose_lhs ? "_TransposedLhs" : "",
+                          transpose_rhs ? "_TransposedRhs" : "", "_N", n);
+    });
+
+}  // namespace
+}  // namespace xla::cpu
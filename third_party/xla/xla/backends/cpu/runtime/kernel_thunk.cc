@@ -293,6 +293,22 @@ Thunk::BufferUses KernelThunk<num_arguments, num_results>::buffer_uses() const {
   return KernelBufferUses(arguments_buffers_, results_buffers_);
 }
 
+template <int64_t num_arguments, int64_t num_results>
+Thunk::CostEstimate
+KernelThunk<num_arguments, num_results>::cost_estimate() const {
+  // We don't know what host kernel computes, and assume that it is bound by
+  // the memory bandwidth. Host kernel launches a task per logical thread.
+  CostEstimate cost;
+  for (const BufferAllocation::Slice& buffer : arguments_buffers_) {
+    cost.bytes_accessed += buffer.size();
+  }
+  for (const BufferAllocation::Slice& buffer : results_buffers_) {
+    cost.bytes_accessed += buffer.size();
+  }
+  cost.parallelism = thread_dim_.x * thread_dim_.y * thread_dim_.z;
+  return cost;
+}
+
 }  // namespace internal
 
 tsl::AsyncValueRef<Thunk::ExecuteEvent> KernelThunk::Execute(
@@ -61,6 +61,7 @@ template <int64_t num_arguments = kDynamicKernelParameter,
 class KernelThunk : public Thunk {
  public:
   BufferUses buffer_uses() const final;
+  CostEstimate cost_estimate() const final;
 
  protected:
   tsl::AsyncValueRef<ExecuteEvent> ExecuteInternal(const ExecuteParams& params);
@@ -0,0 +1,166 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/packed_matmul.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Eigen/Core"
+
+namespace xla::cpu {
+
+using Packet = PackedMatrix::Packet;
+
+static constexpr int64_t kPacketSize = PackedMatrix::kPacketSize;
+static constexpr int64_t kPanelRows = PackedMatrix::kPanelRows;
+
+// The maximum number of `rhs` columns processed together. Accumulators for
+// all columns must fit into SIMD registers.
+static constexpr int64_t kMaxBlockCols = 4;
+
+// Packed panels are streamed from memory, and for large matrices a single
+// stream is not fast enough without software prefetching. The distance is
+// measured in `depth` steps (each step reads a column of the panel).
+static constexpr int64_t kPrefetchDistance = 32;
+
+PackedMatrix::PackedMatrix(int64_t rows, int64_t cols)
+    : rows_(rows),
+      cols_(cols),
+      num_panels_((rows + kPanelRows - 1) / kPanelRows),
+      data_(num_panels_ * kPanelRows * cols, 0.0f) {}
+
+PackedMatrix PackedMatrix::Pack(const float* data, int64_t rows, int64_t cols,
+                                int64_t row_stride, int64_t col_stride) {
+  PackedMatrix packed(rows, cols);
+
+  for (int64_t p = 0; p < packed.num_panels_; ++p) {
+    float* panel = packed.data_.data() + p * kPanelRows * cols;
+    int64_t panel_rows = std::min(kPanelRows, rows - p * kPanelRows);
+
+    for (int64_t j = 0; j < cols; ++j) {
+      const float* src = data + p * kPanelRows * row_stride + j * col_stride;
+      float* dst = panel + j * kPanelRows;
+      for (int64_t i = 0; i < panel_rows; ++i) dst[i] = src[i * row_stride];
+    }
+  }
+
+  return packed;
+}
+
+// Multiplies a single panel by `kCols` columns of the `rhs` matrix, keeping
+// `2 * kCols` accumulators in SIMD registers.
+template <int64_t kCols>
+static void PanelMatMul(const float* panel, int64_t panel_rows, int64_t depth,
+                        const float* rhs, int64_t rhs_row_stride,
+                        int64_t rhs_col_stride, float* out,
+                        int64_t out_row_stride, int64_t out_col_stride) {
+  using Eigen::internal::padd;
+  using Eigen::internal::pload;
+  using Eigen::internal::pmadd;
+  using Eigen::internal::pset1;
+  using Eigen::internal::pstoreu;
+
+  // With a few columns we don't have enough independent accumulators to hide
+  // the FMA latency, and we split the reduction over `depth` into `kSplits`
+  // interleaved partial sums.
+  static constexpr int64_t kSplits = kCols == 1 ? 4 : (kCols == 2 ? 2 : 1);
+
+  Packet acc[kSplits][kCols][2];
+  for (int64_t s = 0; s < kSplits; ++s) {
+    for (int64_t j = 0; j < kCols; ++j) {
+      acc[s][j][0] = pset1<Packet>(0.0f);
+      acc[s][j][1] = pset1<Packet>(0.0f);
+    }
+  }
+
+  auto step = [&](int64_t s, int64_t k) {
+    Eigen::internal::prefetch(panel + (k + kPrefetchDistance) * kPanelRows);
+    Packet a0 = pload<Packet>(panel + k * kPanelRows);
+    Packet a1 = pload<Packet>(panel + k * kPanelRows + kPacketSize);
+    const float* b = rhs + k * rhs_row_stride;
+    for (int64_t j = 0; j < kCols; ++j) {
+      Packet bj = pset1<Packet>(b[j * rhs_col_stride]);
+      acc[s][j][0] = pmadd(a0, bj, acc[s][j][0]);
+      acc[s][j][1] = pmadd(a1, bj, acc[s][j][1]);
+    }
+  };
+
+  int64_t k = 0;
+  for (; k + kSplits <= depth; k += kSplits) {
+    for (int64_t s = 0; s < kSplits; ++s) step(s, k + s);
+  }
+  for (; k < depth; ++k) step(0, k);
+
+  for (int64_t s = 1; s < kSplits; ++s) {
+    for (int64_t j = 0; j < kCols; ++j) {
+      acc[0][j][0] = padd(acc[0][j][0], acc[s][j][0]);
+      acc[0][j][1] = padd(acc[0][j][1], acc[s][j][1]);
+    }
+  }
+
+  for (int64_t j = 0; j < kCols; ++j) {
+    float* dst = out + j * out_col_stride;
+
+    // Fast path for storing a full panel into a contiguous column.
+    if (out_row_stride == 1 && panel_rows == kPanelRows) {
+      pstoreu(dst, acc[0][j][0]);
+      pstoreu(dst + kPacketSize, acc[0][j][1]);
+      continue;
+    }
+
+    alignas(Packet) float tmp[kPanelRows];
+    pstoreu(tmp, acc[0][j][0]);
+    pstoreu(tmp + kPacketSize, acc[0][j][1]);
+    for (int64_t i = 0; i < panel_rows; ++i) dst[i * out_row_stride] = tmp[i];
+  }
+}
+
+void PackedMatMul(const PackedMatrix& lhs, const float* rhs, int64_t n,
+                  int64_t rhs_row_stride, int64_t rhs_col_stride, float* out,
+                  int64_t out_row_stride, int64_t out_col_stride,
+                  int64_t panel_begin, int64_t panel_end) {
+  for (int64_t p = panel_begin; p < panel_end; ++p) {
+    const float* panel = lhs.panel(p);
+    int64_t panel_rows = std::min(kPanelRows, lhs.rows() - p * kPanelRows);
+    float* panel_out = out + p * kPanelRows * out_row_stride;
+
+    for (int64_t j = 0; j < n; j += kMaxBlockCols) {
+      const float* b = rhs + j * rhs_col_stride;
+      float* c = panel_out + j * out_col_stride;
+
+      switch (std::min(kMaxBlockCols, n - j)) {
+        case 1:
+          PanelMatMul<1>(panel, panel_rows, lhs.cols(), b, rhs_row_stride,
+                         rhs_col_stride, c, out_row_stride, out_col_stride);
+          break;
+        case 2:
+          PanelMatMul<2>(panel, panel_rows, lhs.cols(), b, rhs_row_stride,
+                         rhs_col_stride, c, out_row_stride, out_col_stride);
+          break;
+        case 3:
+          PanelMatMul<3>(panel, panel_rows, lhs.cols(), b, rhs_row_stride,
+                         rhs_col_stride, c, out_row_stride, out_col_stride);
+          break;
+        default:
+          PanelMatMul<4>(panel, panel_rows, lhs.cols(), b, rhs_row_stride,
+                         rhs_col_stride, c, out_row_stride, out_col_stride);
+          break;
+      }
+    }
+  }
+}
+
+}  // namespace xla::cpu
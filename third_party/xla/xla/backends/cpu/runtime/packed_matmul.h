@@ -0,0 +1,79 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_PACKED_MATMUL_H_
+#define XLA_BACKENDS_CPU_RUNTIME_PACKED_MATMUL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Eigen/Core"
+
+namespace xla::cpu {
+
+// A matrix packed into the layout of the small-N matrix multiplication kernel
+// (see `PackedMatMul` below). Packed matrix is split into panels of
+// `kPanelRows` consecutive rows, and each panel is stored column by column,
+// so that the kernel reads it with contiguous SIMD loads. The last panel is
+// padded with zeros.
+//
+// We pack constant operands (weights) of dot operations once and reuse them
+// for all executions, instead of repacking them in every Eigen contraction.
+class PackedMatrix {
+ public:
+  using Packet = Eigen::internal::packet_traits<float>::type;
+  static constexpr int64_t kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+
+  // Each panel is two SIMD registers tall: 16 rows with AVX2, 32 rows with
+  // AVX-512 (SIMD width is defined by the ISA enabled at compile time).
+  static constexpr int64_t kPanelRows = 2 * kPacketSize;
+
+  // Packs a `rows x cols` matrix, where the element `(i, j)` is located at
+  // `data[i * row_stride + j * col_stride]`.
+  static PackedMatrix Pack(const float* data, int64_t rows, int64_t cols,
+                           int64_t row_stride, int64_t col_stride);
+
+  int64_t rows() const { return rows_; }
+  int64_t cols() const { return cols_; }
+  int64_t num_panels() const { return num_panels_; }
+
+  const float* panel(int64_t index) const {
+    return data_.data() + index * kPanelRows * cols_;
+  }
+
+ private:
+  PackedMatrix(int64_t rows, int64_t cols);
+
+  int64_t rows_;
+  int64_t cols_;
+  int64_t num_panels_;
+  std::vector<float, Eigen::aligned_allocator<float>> data_;
+};
+
+// Computes `out = lhs * rhs` for panels `[panel_begin, panel_end)` of the
+// packed `lhs` matrix. Kernel is optimized for a small number of `rhs` columns
+// (i.e. matrix-vector products in batch-1 inference). Element `(k, j)` of the
+// `rhs` matrix is located at `rhs[k * rhs_row_stride + j * rhs_col_stride]`,
+// and element `(i, j)` of the `out` matrix is written to
+// `out[i * out_row_stride + j * out_col_stride]`.
+void PackedMatMul(const PackedMatrix& lhs, const float* rhs, int64_t n,
+                  int64_t rhs_row_stride, int64_t rhs_col_stride, float* out,
+                  int64_t out_row_stride, int64_t out_col_stride,
+                  int64_t panel_begin, int64_t panel_end);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_PACKED_MATMUL_H_
@@ -0,0 +1,153 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/packed_matmul.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Eigen/Core"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla::cpu {
+namespace {
+
+// Returns a `rows x cols` col-major matrix with small integer values, so that
+// all products and sums are exact in f32.
+static std::vector<float> Iota(int64_t rows, int64_t cols) {
+  std::vector<float> data(rows * cols);
+  for (int64_t i = 0; i < data.size(); ++i) data[i] = (i * 7) % 11 - 5;
+  return data;
+}
+
+TEST(PackedMatMulTest, Pack) {
+  int64_t rows = PackedMatrix::kPanelRows + 3;
+  std::vector<float> data = Iota(rows, 2);
+
+  PackedMatrix packed = PackedMatrix::Pack(
+      data.data(), rows, 2, /*row_stride=*/1, /*col_stride=*/rows);
+  EXPECT_EQ(packed.rows(), rows);
+  EXPECT_EQ(packed.cols(), 2);
+  ASSERT_EQ(packed.num_panels(), 2);
+
+  // Panels are stored column by column, and the last panel is zero padded.
+  for (int64_t j = 0; j < 2; ++j) {
+    for (int64_t i = 0; i < PackedMatrix::kPanelRows; ++i) {
+      EXPECT_EQ(packed.panel(0)[j * PackedMatrix::kPanelRows + i],
+                data[j * rows + i]);
+    }
+    for (int64_t i = 0; i < PackedMatrix::kPanelRows; ++i) {
+      float expected = i < 3 ? data[j * rows + PackedMatrix::kPanelRows + i]
+                             : 0.0f;
+      EXPECT_EQ(packed.panel(1)[j * PackedMatrix::kPanelRows + i], expected);
+    }
+  }
+}
+
+TEST(PackedMatMulTest, MatMul) {
+  for (int64_t m : {1, 5, 16, 37, 64}) {
+    for (int64_t n : {1, 2, 3, 4, 7}) {
+      for (int64_t k : {1, 3, 40}) {
+        for (bool transpose_lhs : {false, true}) {
+          std::vector<float> lhs = Iota(m, k);
+          std::vector<float> rhs = Iota(k, n);
+          std::vector<float> out(m * n, -1.0f);
+
+          // Read LHS as a transposed `k x m` matrix.
+          int64_t lhs_row_stride = transpose_lhs ? k : 1;
+          int64_t lhs_col_stride = transpose_lhs ? 1 : m;
+
+          PackedMatrix packed = PackedMatrix::Pack(
+              lhs.data(), m, k, lhs_row_stride, lhs_col_stride);
+
+          // Split panels in two ranges to check partial updates. Write output
+          // in row-major layout to check strided stores.
+          int64_t split = packed.num_panels() / 2;
+          PackedMatMul(packed, rhs.data(), n, 1, k, out.data(), n, 1, 0,
+                       split);
+          PackedMatMul(packed, rhs.data(), n, 1, k, out.data(), n, 1, split,
+                       packed.num_panels());
+
+          for (int64_t i = 0; i < m; ++i) {
+            for (int64_t j = 0; j < n; ++j) {
+              float expected = 0.0f;
+              for (int64_t p = 0; p < k; ++p) {
+                expected += lhs[i * lhs_row_stride + p * lhs_col_stride] *
+                            rhs[j * k + p];
+              }
+              ASSERT_EQ(out[i * n + j], expected)
+                  << "m=" << m << " n=" << n << " k=" << k
+                  << " transpose_lhs=" << transpose_lhs << " i=" << i
+                  << " j=" << j;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+using Matrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>;
+
+static void BM_PackedMatMul(benchmark::State& state) {
+  int64_t d = state.range(0);
+  int64_t n = state.range(1);
+
+  Matrix lhs = Matrix::Random(d, d);
+  Matrix rhs = Matrix::Random(d, n);
+  Matrix out(d, n);
+
+  PackedMatrix packed = PackedMatrix::Pack(lhs.data(), d, d, 1, d);
+
+  for (auto _ : state) {
+    PackedMatMul(packed, rhs.data(), n, 1, d, out.data(), 1, d, 0,
+                 packed.num_panels());
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+
+static void BM_EigenMatMul(benchmark::State& state) {
+  int64_t d = state.range(0);
+  int64_t n = state.range(1);
+
+  Matrix lhs = Matrix::Random(d, d);
+  Matrix rhs = Matrix::Random(d, n);
+  Matrix out(d, n);
+
+  for (auto _ : state) {
+    out.noalias() = lhs * rhs;
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+
+#define BENCHMARK_MATMUL(name) \
+  BENCHMARK(name)              \
+      ->ArgPair(256, 2)        \
+      ->ArgPair(256, 4)        \
+      ->ArgPair(1024, 2)       \
+      ->ArgPair(1024, 4)       \
+      ->ArgPair(4096, 2)       \
+      ->ArgPair(4096, 4)
+
+BENCHMARK_MATMUL(BM_PackedMatMul);
+BENCHMARK_MATMUL(BM_EigenMatMul);
+
+}  // namespace
+}  // namespace xla::cpu
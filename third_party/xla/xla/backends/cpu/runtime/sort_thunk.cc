@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -813,4 +814,24 @@ SortThunk::BufferUses SortThunk::buffer_uses() const {
   return buffer_uses;
 }
 
+SortThunk::CostEstimate SortThunk::cost_estimate() const {
+  CostEstimate cost;
+  if (inputs_.empty()) return cost;
+
+  // We sort `num_elements / sort_dim_size` independent rows of the inputs,
+  // and each row sort does O(n log n) comparisons.
+  const Shape& shape = inputs_.front().shape;
+  int64_t num_elements = ShapeUtil::ElementsIn(shape);
+  int64_t sort_dim_size = shape.dimensions(dimension_);
+  double log_sort_dim_size = std::log2(std::max<int64_t>(sort_dim_size, 2));
+
+  cost.flops =
+      num_elements * static_cast<int64_t>(std::ceil(log_sort_dim_size));
+  for (const Input& input : inputs_) {
+    // Sort is in place, we read and write every input buffer.
+    cost.bytes_accessed += 2 * input.slice.size();
+  }
+  return cost;
+}
+
 }  // namespace xla::cpu
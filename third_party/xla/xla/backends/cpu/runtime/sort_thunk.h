@@ -64,6 +64,7 @@ class SortThunk final : public Thunk {
   tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams& params) final;
 
   BufferUses buffer_uses() const final;
+  CostEstimate cost_estimate() const final;
 
  private:
   SortThunk(Info info, absl::Span<const Input> inputs, int64_t dimension,
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/base/optimization.h"
 #include "xla/executable_run_options.h"
+#include "xla/runtime/buffer_use.h"
 #include "xla/service/cpu/collectives_interface.h"
 #include "xla/service/cpu/cpu_executable_run_options.h"
 #include "xla/service/cpu/in_process_collectives.h"
@@ -90,6 +91,14 @@ Thunk::Thunk(Kind kind, Info info)
       info_(std::move(info)),
       ok_event_(OkExecuteEventSingleton()) {}
 
+Thunk::CostEstimate Thunk::cost_estimate() const {
+  CostEstimate cost;
+  for (const BufferUse& use : buffer_uses()) {
+    cost.bytes_accessed += use.slice().size();
+  }
+  return cost;
+}
+
 absl::StatusOr<Thunk::CollectiveExecuteParams>
 Thunk::CollectiveExecuteParams::Create(
     const ExecutableRunOptions* run_options) {
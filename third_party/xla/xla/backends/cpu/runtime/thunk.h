@@ -53,6 +53,8 @@ struct ThreadPoolDevice;
 
 namespace xla::cpu {
 
+class ThunkProfiler;
+
 // WARNING: This is under construction. Long term plan for XLA is to unify
 // runtimes between different backends and have a shared Thunk interface,
 // however for now we chose to have separate Thunk implementations in xla::cpu
@@ -135,6 +137,22 @@ class Thunk {
   using ResourceUses = absl::InlinedVector<ResourceUse, 4>;
   virtual ResourceUses resource_uses() const { return {}; }
 
+  // A static estimate of the work done by a thunk. Thunk executor relies on
+  // this information (via ThunkCostModel) to prioritize thunks on the critical
+  // path of the thunk sequence.
+  struct CostEstimate {
+    // Number of arithmetic operations (multiply-add counts as two).
+    int64_t flops = 0;
+    // Number of bytes read from and written to memory.
+    int64_t bytes_accessed = 0;
+    // Number of tasks that thunk splits its work into at run time.
+    int64_t parallelism = 1;
+  };
+
+  // Returns the cost estimate of the thunk. Default implementation assumes that
+  // thunk reads and writes all of its buffers once and does no compute.
+  virtual CostEstimate cost_estimate() const;
+
   //===--------------------------------------------------------------------===//
   // FunctionRegistry
   //===--------------------------------------------------------------------===//
@@ -282,6 +300,9 @@ class Thunk {
     CustomCallExecuteParams* custom_call_params = nullptr;
     ExecuteSession session = ExecuteSession(ExecuteSession::kMaxWorkers,
                                             ExecuteSession::kSplitThreshold);
+    // If not null, thunk executors record execution events of all thunks
+    // (including thunks in nested thunk sequences) in the profiler.
+    ThunkProfiler* profiler = nullptr;
   };
 
   // An execute event that becomes ready when all tasks are completed.
@@ -0,0 +1,83 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/thunk_cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/time/time.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+
+namespace xla::cpu {
+
+static bool IsCollective(Thunk::Kind kind) {
+  switch (kind) {
+    case Thunk::Kind::kAllGather:
+    case Thunk::Kind::kAllReduce:
+    case Thunk::Kind::kAllToAll:
+    case Thunk::Kind::kCollectivePermute:
+    case Thunk::Kind::kReduceScatter:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ThunkCostModel::ThunkCostModel(const Options& options) : options_(options) {}
+
+void ThunkCostModel::AddMeasurement(std::string_view op_name,
+                                    absl::Duration duration) {
+  Measurement& measurement = measurements_[op_name];
+  measurement.total += duration;
+  measurement.count++;
+}
+
+bool ThunkCostModel::HasMeasurement(std::string_view op_name) const {
+  return measurements_.contains(op_name);
+}
+
+int64_t ThunkCostModel::EstimateCostNs(const Thunk& thunk) const {
+  // Prefer measured execution time if we have one.
+  if (auto it = measurements_.find(thunk.info().op_name);
+      it != measurements_.end()) {
+    const Measurement& measurement = it->second;
+    return std::max<int64_t>(
+        1, absl::ToInt64Nanoseconds(measurement.total / measurement.count));
+  }
+
+  Thunk::CostEstimate cost = thunk.cost_estimate();
+
+  double compute_ns = cost.flops / options_.flops_per_ns;
+  double memory_ns = cost.bytes_accessed / options_.bytes_per_ns;
+
+  // Thunk tasks run concurrently on at most `max_parallelism` cores.
+  int64_t parallelism = std::clamp<int64_t>(
+      cost.parallelism, 1, std::max<int64_t>(options_.max_parallelism, 1));
+
+  double cost_ns = std::max(compute_ns, memory_ns) / parallelism +
+                   absl::ToDoubleNanoseconds(options_.launch_overhead);
+
+  if (IsCollective(thunk.kind())) {
+    cost_ns += absl::ToDoubleNanoseconds(options_.collective_latency);
+  }
+
+  return std::max<int64_t>(1, static_cast<int64_t>(std::ceil(cost_ns)));
+}
+
+}  // namespace xla::cpu
@@ -0,0 +1,93 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_THUNK_COST_MODEL_H_
+#define XLA_BACKENDS_CPU_RUNTIME_THUNK_COST_MODEL_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+
+namespace xla::cpu {
+
+namespace internal {
+// Clang does not allow defining a nested struct with member initializer, as
+// a workaround we define a struct in internal namespace and create an alias.
+struct ThunkCostModelOptions {
+  // Compute throughput of a single CPU core in floating point operations per
+  // nanosecond (GFLOP/s).
+  double flops_per_ns = 16.0;
+
+  // Memory bandwidth available to a single CPU core in bytes per nanosecond
+  // (GB/s).
+  double bytes_per_ns = 8.0;
+
+  // Maximum number of CPU cores that a single thunk can use for its tasks
+  // (typically the size of the intra-op thread pool).
+  int64_t max_parallelism = 1;
+
+  // Fixed cost of launching a thunk (dispatch, task scheduling, etc.).
+  absl::Duration launch_overhead = absl::Nanoseconds(100);
+
+  // Fixed cost of a rendezvous of collective operation participants.
+  absl::Duration collective_latency = absl::Microseconds(10);
+};
+}  // namespace internal
+
+// A cost model that estimates the execution time of thunks. Thunk executor
+// uses it to compute the length of the critical path of the thunk DAG starting
+// from each thunk, and to prioritize thunks on the critical path.
+//
+// Estimates are based on the roofline model: thunk execution time is bounded
+// by the time it takes to compute its FLOPs or to move its bytes, whichever is
+// larger, split across the tasks that thunk launches at run time. Estimates
+// can be refined with profile feedback: a measured execution time of a thunk
+// (identified by its op name) takes precedence over the static estimate.
+class ThunkCostModel {
+ public:
+  using Options = internal::ThunkCostModelOptions;
+
+  explicit ThunkCostModel(const Options& options = Options());
+
+  // Records a measured execution time of a thunk with the given op name. If
+  // the thunk was measured multiple times we use the mean execution time.
+  void AddMeasurement(std::string_view op_name, absl::Duration duration);
+
+  // Returns true if the cost model has measurements for the given op name.
+  bool HasMeasurement(std::string_view op_name) const;
+
+  // Returns the estimated execution time of a thunk in nanoseconds. Returned
+  // cost is always positive.
+  int64_t EstimateCostNs(const Thunk& thunk) const;
+
+  const Options& options() const { return options_; }
+
+ private:
+  struct Measurement {
+    absl::Duration total;
+    int64_t count = 0;
+  };
+
+  Options options_;
+  absl::flat_hash_map<std::string, Measurement> measurements_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_THUNK_COST_MODEL_H_
@@ -0,0 +1,126 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/thunk_cost_model.h"
+
+#include <memory>
+
+#include "absl/time/time.h"
+#include "xla/backends/cpu/runtime/dot_thunk.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_testlib.h"
+#include "xla/runtime/buffer_use.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+static ThunkCostModel::Options OptionsForTest() {
+  ThunkCostModel::Options options;
+  options.flops_per_ns = 16.0;
+  options.bytes_per_ns = 8.0;
+  options.launch_overhead = absl::ZeroDuration();
+  return options;
+}
+
+TEST(ThunkCostModelTest, MemoryBoundThunk) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/800, /*color=*/0);
+  BufferAllocation::Slice slice(&alloc, /*offset=*/0, /*size=*/800);
+
+  BufferUseThunk thunk(BufferUse::Write(slice));
+  EXPECT_EQ(thunk.cost_estimate().flops, 0);
+  EXPECT_EQ(thunk.cost_estimate().bytes_accessed, 800);
+
+  ThunkCostModel cost_model(OptionsForTest());
+  EXPECT_EQ(cost_model.EstimateCostNs(thunk), 100);
+}
+
+TEST(ThunkCostModelTest, ComputeBoundDotThunk) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/3 * 64 * 64 * 4, /*color=*/0);
+  BufferAllocation::Slice lhs(&alloc, /*offset=*/0, /*size=*/64 * 64 * 4);
+  BufferAllocation::Slice rhs(&alloc, /*offset=*/64 * 64 * 4,
+                              /*size=*/64 * 64 * 4);
+  BufferAllocation::Slice out(&alloc, /*offset=*/2 * 64 * 64 * 4,
+                              /*size=*/64 * 64 * 4);
+
+  Shape shape = ShapeUtil::MakeShape(F32, {64, 64});
+
+  DotDimensionNumbers dot_dimensions;
+  dot_dimensions.add_lhs_contracting_dimensions(1);
+  dot_dimensions.add_rhs_contracting_dimensions(0);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto thunk, DotThunk::Create({"dot"}, dot_dimensions, lhs, shape, rhs,
+                                   shape, out, shape));
+
+  Thunk::CostEstimate cost = thunk->cost_estimate();
+  EXPECT_EQ(cost.flops, 2 * 64 * 64 * 64);
+  EXPECT_EQ(cost.bytes_accessed, 3 * 64 * 64 * 4);
+
+  // Compute time (32768ns) dominates memory access time (6144ns).
+  ThunkCostModel cost_model(OptionsForTest());
+  EXPECT_EQ(cost_model.EstimateCostNs(*thunk), 32768);
+
+  // Dot thunk runs as a single task.
+  ThunkCostModel::Options options = OptionsForTest();
+  options.max_parallelism = 4;
+  EXPECT_EQ(ThunkCostModel(options).EstimateCostNs(*thunk), 32768);
+}
+
+TEST(ThunkCostModelTest, ParallelThunk) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/800, /*color=*/0);
+  BufferAllocation::Slice slice(&alloc, /*offset=*/0, /*size=*/800);
+
+  class ParallelThunk : public BufferUseThunk {
+   public:
+    using BufferUseThunk::BufferUseThunk;
+
+    CostEstimate cost_estimate() const final {
+      CostEstimate cost = BufferUseThunk::cost_estimate();
+      cost.parallelism = 8;
+      return cost;
+    }
+  };
+
+  ParallelThunk thunk(BufferUse::Write(slice));
+
+  // Parallelism is limited by the number of available cores.
+  ThunkCostModel::Options options = OptionsForTest();
+  options.max_parallelism = 4;
+  EXPECT_EQ(ThunkCostModel(options).EstimateCostNs(thunk), 25);
+}
+
+TEST(ThunkCostModelTest, MeasuredCost) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/800, /*color=*/0);
+  BufferAllocation::Slice slice(&alloc, /*offset=*/0, /*size=*/800);
+
+  BufferUseThunk thunk(BufferUse::Write(slice));
+
+  ThunkCostModel cost_model(OptionsForTest());
+  EXPECT_FALSE(cost_model.HasMeasurement("buffer-use"));
+
+  cost_model.AddMeasurement("buffer-use", absl::Microseconds(1));
+  cost_model.AddMeasurement("buffer-use", absl::Microseconds(3));
+
+  EXPECT_TRUE(cost_model.HasMeasurement("buffer-use"));
+  EXPECT_EQ(cost_model.EstimateCostNs(thunk), 2000);
+}
+
+}  // namespace
+}  // namespace xla::cpu
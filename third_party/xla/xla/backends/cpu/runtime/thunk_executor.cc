@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/backends/cpu/runtime/thunk_executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -34,6 +35,8 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "xla/backends/cpu/runtime/resource_use.h"
 #include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_cost_model.h"
+#include "xla/backends/cpu/runtime/thunk_profiler.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
 #include "tsl/platform/logging.h"
@@ -64,6 +67,11 @@ ThunkExecutor::ThunkExecutor(ThunkSequence thunk_sequence,
   // Erase redundant edges between nodes.
   int64_t num_erased_edges = RunTransitiveReductionAndUpdatePriorities();
 
+  // Use critical path costs as node priorities if we have a cost model.
+  if (options.cost_model) {
+    UpdatePrioritiesFromCostModel(*options.cost_model);
+  }
+
   // Check if constructed execution DAG is sequential: every node depends on the
   // completion of the previous node.
   for (NodeId i = 1; i < nodes_defs_.size() && is_sequential_; ++i) {
@@ -154,6 +162,16 @@ ThunkExecutor::ExecuteState::ExecuteState(ThunkExecutor* executor,
   }
 }
 
+// Executes `thunk` and records its execution in the profiler if profiling is
+// enabled. Thunks executed sequentially start right after they become ready.
+static ABSL_ATTRIBUTE_ALWAYS_INLINE tsl::AsyncValueRef<Thunk::ExecuteEvent>
+ExecuteThunk(Thunk& thunk, const Thunk::ExecuteParams& params) {
+  if (ABSL_PREDICT_FALSE(params.profiler)) {
+    return params.profiler->Execute(thunk, params, ThunkProfiler::NowNs());
+  }
+  return thunk.Execute(params);
+}
+
 tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent> ThunkExecutor::Execute(
     const Thunk::ExecuteParams& params) {
   // Short-circuit execution of trivial thunk sequences.
@@ -161,7 +179,7 @@ tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent> ThunkExecutor::Execute(
     return Thunk::OkExecuteEventSingleton();
   }
   if (ABSL_PREDICT_FALSE(num_thunks_ == 1)) {
-    return thunk_sequence_[0]->Execute(params);
+    return ExecuteThunk(*thunk_sequence_[0], params);
   }
 
   // When we choose sequential execution strategy (we rely on heuristics and
@@ -175,6 +193,12 @@ tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent> ThunkExecutor::Execute(
   // Create async execution state on heap and kick-off execution.
   auto state = std::make_unique<ExecuteState>(this, params.task_runner);
 
+  // When profiling is enabled, source nodes become ready when execution starts,
+  // and all other nodes when their last dependency completes.
+  if (ABSL_PREDICT_FALSE(params.profiler)) {
+    state->ready_ns.assign(num_thunks_, ThunkProfiler::NowNs());
+  }
+
   // When we kick-off execution we don't have to grab the session lock, as the
   // main thread is not counted towards the number of concurrent workers limit.
   // This also works for thunks with nested thunk executors (i.e., WhileThunk),
@@ -211,7 +235,7 @@ tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent>
 ThunkExecutor::ExecuteSequential(const Thunk::ExecuteParams& params) {
   for (auto it = thunk_sequence_.begin(); it != thunk_sequence_.end(); ++it) {
     Thunk& thunk = **it;
-    auto execute_event = thunk.Execute(params);
+    auto execute_event = ExecuteThunk(thunk, params);
 
     // Fast path for thunks executed inline and returned OkExecuteEvent.
     if (ABSL_PREDICT_TRUE(thunk.IsOkExecuteEvent(execute_event))) {
@@ -248,7 +272,7 @@ void ThunkExecutor::ResumeExecuteSequential(
     tsl::AsyncValueRef<ExecuteEvent> event) {
   for (; it != thunk_sequence_.end(); ++it) {
     Thunk& thunk = **it;
-    auto execute_event = thunk.Execute(params);
+    auto execute_event = ExecuteThunk(thunk, params);
 
     // Fast path for thunks executed inline and returned OkExecuteEvent.
     if (ABSL_PREDICT_TRUE(thunk.IsOkExecuteEvent(execute_event))) {
@@ -314,12 +338,24 @@ void ThunkExecutor::Execute(ExecuteState* state,
       SplitReadyQueue(state, params, ready_queue, split_threshold);
     }
 
+    // If we are about to execute an expensive thunk, offload all remaining
+    // ready thunks to the task runner, as otherwise they will wait for the
+    // expensive thunk to complete.
+    int64_t cost_ns = state->executor->nodes_defs_[id].cost_ns;
+    if (ABSL_PREDICT_FALSE(
+            has_runner && !ready_queue.Empty() &&
+            cost_ns > state->executor->options_.offload_cost_threshold_ns)) {
+      SplitReadyQueue(state, params, ready_queue, /*split_threshold=*/0);
+    }
+
     // Execute thunk for the given node id. If execution is aborted, we keep
     // processing the nodes DAG without executing thunks.
     Thunk& thunk = *state->executor->thunk_sequence_[id];
     tsl::AsyncValueRef<ExecuteEvent> execute_event =
         ABSL_PREDICT_FALSE(state->abort.load(std::memory_order_relaxed))
             ? Thunk::OkExecuteEventSingleton()
+        : ABSL_PREDICT_FALSE(params.profiler)
+            ? params.profiler->Execute(thunk, params, state->ready_ns[id])
             : thunk.Execute(params);
 
     if (ABSL_PREDICT_TRUE(execute_event.IsAvailable())) {
@@ -409,7 +445,12 @@ void ThunkExecutor::ProcessOutEdges(
 
     int64_t cnt = out_node.counter.fetch_sub(1, std::memory_order_release);
     DCHECK_GE(cnt, 1) << "Node counter can't drop below 0";
-    if (cnt == 1) ready_queue.Push(out_edge);
+    if (cnt == 1) {
+      if (ABSL_PREDICT_FALSE(!state->ready_ns.empty())) {
+        state->ready_ns[out_edge] = ThunkProfiler::NowNs();
+      }
+      ready_queue.Push(out_edge);
+    }
   }
 
   // Drop the pending sink nodes counter if the node is a sink.
@@ -484,6 +525,26 @@ static int64_t EraseEdge(ThunkExecutor::NodeDef& from,
   return 1;
 }
 
+void ThunkExecutor::UpdatePrioritiesFromCostModel(
+    const ThunkCostModel& cost_model) {
+  for (NodeDef& node_def : nodes_defs_) {
+    node_def.cost_ns = cost_model.EstimateCostNs(*thunk_sequence_[node_def.id]);
+  }
+
+  // Out edges always point to nodes with larger ids, so we can compute the
+  // critical path costs in a single pass in reverse order.
+  for (int64_t i = nodes_defs_.size() - 1; i >= 0; --i) {
+    NodeDef& node_def = nodes_defs_[i];
+
+    int64_t out_edges_priority = 0;
+    for (NodeId out_id : node_def.out_edges) {
+      out_edges_priority =
+          std::max(out_edges_priority, nodes_defs_[out_id].priority);
+    }
+    node_def.priority = node_def.cost_ns + out_edges_priority;
+  }
+}
+
 int64_t ThunkExecutor::RunTransitiveReductionAndUpdatePriorities() {
   int64_t num_erased_edges = 0;
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_cost_model.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
 
 namespace xla::cpu {
@@ -55,6 +56,18 @@ struct ThunkExecutorOptions {
   // Use priority ready queue to execute nodes according to their priority. By
   // default we use FIFO ready queue.
   bool use_priority_ready_queue = false;
+
+  // If not null, node priorities are computed as the estimated execution time
+  // of the longest (critical) path from the node to a sink node, instead of
+  // the number of nodes reachable from the node. Cost model is only used when
+  // the executor is created and doesn't have to outlive it.
+  const ThunkCostModel* cost_model = nullptr;
+
+  // If the estimated cost of a thunk is larger than the given threshold, the
+  // executor offloads all other ready nodes to the task runner before running
+  // the thunk in the caller thread, so that an expensive thunk does not delay
+  // the rest of the DAG. Only used together with the cost model.
+  int64_t offload_cost_threshold_ns = 100'000;
 };
 }  // namespace internal
 
@@ -83,6 +96,9 @@ class ThunkExecutor {
   struct NodeDef {
     NodeId id = kInvalidNodeId;
     int64_t priority = 0;
+    // Estimated execution time of the node thunk in nanoseconds, or 0 if the
+    // executor doesn't have a cost model.
+    int64_t cost_ns = 0;
     std::vector<NodeId> in_edges;
     std::vector<NodeId> out_edges;
   };
@@ -197,6 +213,10 @@ class ThunkExecutor {
     absl::FixedArray<NodeStorage> nodes;
     tsl::AsyncValueRef<ExecuteEvent> execute_event;
 
+    // Timestamps when nodes became ready to execute. Empty if profiling is
+    // disabled (see `Thunk::ExecuteParams::profiler`).
+    std::vector<int64_t> ready_ns;
+
     // Once the number of pending sink nodes drops to zero, the execution is
     // completed and we set `execute_event` as concrete or error.
     alignas(kAtomicAlignment) std::atomic<int64_t> pending_sink_nodes;
@@ -246,6 +266,11 @@ class ThunkExecutor {
   // See: https://en.wikipedia.org/wiki/Transitive_reduction
   int64_t RunTransitiveReductionAndUpdatePriorities();
 
+  // Estimates nodes costs with the cost model and updates nodes priorities to
+  // the cost of the critical path starting from the node. Must be called after
+  // the transitive reduction, as it relies on the reduced set of edges.
+  void UpdatePrioritiesFromCostModel(const ThunkCostModel& cost_model);
+
   ThunkSequence thunk_sequence_;
   Options options_;
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include <optional>
 #include <random>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -29,10 +30,13 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/backends/cpu/runtime/buffer_allocations.h"
 #include "xla/backends/cpu/runtime/resource_use.h"
 #include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_cost_model.h"
+#include "xla/backends/cpu/runtime/thunk_profiler.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/maybe_owning_device_memory.h"
@@ -54,6 +58,7 @@ namespace xla::cpu {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
 
 // We use a global static variable to simulate a shared resource. We check that
 // thunk executor correctly orders access to this resource by running the test
@@ -477,6 +482,187 @@ TEST(ThunkExecutorTest, Execute) {
                                 2, 2, 2, 2, 2));               // slice1
 }
 
+TEST(ThunkExecutorTest, ExecuteWithProfiler) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+
+  BufferAllocation::Slice slice0(&alloc, /*offset=*/0, /*size=*/40);
+  BufferAllocation::Slice slice1(&alloc, /*offset=*/40, /*size=*/40);
+  BufferAllocation::Slice slice2(&alloc, /*offset=*/20, /*size=*/40);
+
+  ThunkSequence sequence;
+  sequence.push_back(AddI32Thunk::Create("a", {slice0}, {slice0}));
+  sequence.push_back(AddI32Thunk::Create("b", {slice1}, {slice1}));
+  sequence.push_back(AddI32Thunk::Create("c", {slice2}, {slice2}));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      ThunkExecutor executor,
+      ThunkExecutor::Create(std::move(sequence), OptionsForTest()));
+
+  std::vector<int32_t> data(20, 1);  // shared src and dst allocation
+
+  auto buffers = AddI32Thunk::AsDeviceMemory({&data});
+  BufferAllocations allocations(buffers);
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "profiler-test", 4);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  ThunkProfiler profiler;
+
+  Thunk::ExecuteParams params = {nullptr, &allocations};
+  params.intra_op_threadpool = &device;
+  params.profiler = &profiler;
+
+  auto execute_event = executor.Execute(params);
+
+  tsl::BlockUntilReady(execute_event);
+  ASSERT_TRUE(execute_event.IsConcrete());
+
+  EXPECT_THAT(data, ElementsAre(2, 2, 2, 2, 2,                 // slice0
+                                4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  // slice2
+                                2, 2, 2, 2, 2));               // slice1
+
+  std::vector<ThunkProfiler::Event> events = profiler.events();
+  ASSERT_EQ(events.size(), 3);
+
+  std::vector<std::string> op_names;
+  for (const ThunkProfiler::Event& event : events) {
+    op_names.push_back(event.op_name);
+    EXPECT_LE(event.ready_ns, event.start_ns);
+    EXPECT_LE(event.start_ns, event.end_ns);
+    EXPECT_EQ(event.bytes_accessed, 80);
+  }
+  EXPECT_THAT(op_names, UnorderedElementsAre("a", "b", "c"));
+
+  // Thunk `c` becomes ready only after `a` and `b` completed.
+  auto find = [&](std::string_view name) {
+    return *absl::c_find_if(events, [&](const ThunkProfiler::Event& event) {
+      return event.op_name == name;
+    });
+  };
+  EXPECT_GE(find("c").ready_ns, find("a").end_ns);
+  EXPECT_GE(find("c").ready_ns, find("b").end_ns);
+}
+
+TEST(ThunkExecutorTest, CriticalPathPriorities) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+
+  BufferAllocation::Slice slice0(&alloc, /*offset=*/0, /*size=*/40);
+  BufferAllocation::Slice slice1(&alloc, /*offset=*/40, /*size=*/40);
+
+  ThunkSequence sequence;
+  sequence.push_back(AddI32Thunk::Create("a", {slice0}, {slice0}));
+  sequence.push_back(AddI32Thunk::Create("b", {slice1}, {slice1}));
+  sequence.push_back(AddI32Thunk::Create("c", {slice0}, {slice0}));
+
+  // Every thunk reads and writes 40 bytes.
+  ThunkCostModel::Options cost_model_options;
+  cost_model_options.bytes_per_ns = 1.0;
+  cost_model_options.launch_overhead = absl::ZeroDuration();
+  ThunkCostModel cost_model(cost_model_options);
+
+  ThunkExecutor::Options options = OptionsForTest();
+  options.cost_model = &cost_model;
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      ThunkExecutor executor,
+      ThunkExecutor::Create(std::move(sequence), options));
+
+  EXPECT_THAT(executor.source(), ElementsAre(0, 1));
+  EXPECT_THAT(executor.sink(), ElementsAre(1, 2));
+
+  EXPECT_EQ(executor.node_def(0).cost_ns, 80);
+  EXPECT_EQ(executor.node_def(1).cost_ns, 80);
+  EXPECT_EQ(executor.node_def(2).cost_ns, 80);
+
+  EXPECT_EQ(executor.node_def(0).priority, 160);
+  EXPECT_EQ(executor.node_def(1).priority, 80);
+  EXPECT_EQ(executor.node_def(2).priority, 80);
+}
+
+TEST(ThunkExecutorTest, CriticalPathPrioritiesFromProfile) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+
+  BufferAllocation::Slice slice0(&alloc, /*offset=*/0, /*size=*/40);
+  BufferAllocation::Slice slice1(&alloc, /*offset=*/40, /*size=*/40);
+
+  ThunkSequence sequence;
+  sequence.push_back(AddI32Thunk::Create("a", {slice0}, {slice0}));
+  sequence.push_back(AddI32Thunk::Create("b", {slice1}, {slice1}));
+  sequence.push_back(AddI32Thunk::Create("c", {slice0}, {slice0}));
+
+  ThunkCostModel::Options cost_model_options;
+  cost_model_options.bytes_per_ns = 1.0;
+  cost_model_options.launch_overhead = absl::ZeroDuration();
+  ThunkCostModel cost_model(cost_model_options);
+
+  // Measured execution time of `b` makes it the critical path.
+  cost_model.AddMeasurement("b", absl::Nanoseconds(500));
+
+  ThunkExecutor::Options options = OptionsForTest();
+  options.cost_model = &cost_model;
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      ThunkExecutor executor,
+      ThunkExecutor::Create(std::move(sequence), options));
+
+  EXPECT_EQ(executor.node_def(0).priority, 160);
+  EXPECT_EQ(executor.node_def(1).priority, 500);
+  EXPECT_EQ(executor.node_def(2).priority, 80);
+}
+
+TEST(ThunkExecutorTest, OffloadReadyThunksBeforeExpensiveThunk) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+
+  BufferAllocation::Slice slice0(&alloc, /*offset=*/0, /*size=*/40);
+  BufferAllocation::Slice slice1(&alloc, /*offset=*/40, /*size=*/40);
+
+  std::vector<std::string> trace;
+
+  ThunkSequence sequence;
+  sequence.push_back(AddI32Thunk::Create("a", {slice0}, {slice0}, &trace));
+  sequence.push_back(AddI32Thunk::Create("b", {slice1}, {slice1}, &trace));
+  sequence.push_back(AddI32Thunk::Create("c", {slice0}, {slice0}, &trace));
+
+  ThunkCostModel cost_model;
+  cost_model.AddMeasurement("a", absl::Milliseconds(1));
+
+  ThunkExecutor::Options options = OptionsForTest();
+  options.use_priority_ready_queue = true;
+  options.cost_model = &cost_model;
+  options.offload_cost_threshold_ns = 100'000;
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      ThunkExecutor executor,
+      ThunkExecutor::Create(std::move(sequence), options));
+
+  std::vector<int32_t> data(20, 1);  // shared src and dst allocation
+
+  auto buffers = AddI32Thunk::AsDeviceMemory({&data});
+  BufferAllocations allocations(buffers);
+
+  Thunk::TaskRunner task_runner = [&](Thunk::Task task) {
+    trace.push_back("<TaskRunner>");
+    task();
+  };
+
+  // Split threshold is large enough to never split the ready queue, and `b` is
+  // offloaded to the task runner only because `a` is expensive.
+  Thunk::ExecuteParams params = {nullptr, &allocations};
+  params.task_runner = &task_runner;
+  params.session =
+      Thunk::ExecuteSession(/*max_workers=*/8, /*split_threshold=*/8);
+
+  auto execute_event = executor.Execute(params);
+
+  tsl::BlockUntilReady(execute_event);
+  ASSERT_TRUE(execute_event.IsConcrete());
+
+  EXPECT_THAT(trace, ElementsAre("<TaskRunner>", "b", "a", "c"));
+  EXPECT_THAT(data, ElementsAre(4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  // slice0
+                                2, 2, 2, 2, 2, 2, 2, 2, 2, 2));  // slice1
+}
+
 //===----------------------------------------------------------------------===//
 // ThunkExecutor stress testing
 //===----------------------------------------------------------------------===//
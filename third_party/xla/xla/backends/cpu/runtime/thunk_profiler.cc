@@ -0,0 +1,206 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/thunk_profiler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/profiler/convert/trace_events_to_json.h"
+#include "xla/tsl/profiler/convert/xplane_to_trace_events.h"
+#include "xla/tsl/profiler/utils/time_utils.h"
+#include "xla/tsl/profiler/utils/xplane_builder.h"
+#include "xla/tsl/profiler/utils/xplane_schema.h"
+#include "xla/tsl/profiler/utils/xplane_utils.h"
+#include "tsl/platform/env.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla::cpu {
+
+using tensorflow::profiler::XPlane;
+using tensorflow::profiler::XSpace;
+using tsl::profiler::XLineBuilder;
+using tsl::profiler::XPlaneBuilder;
+
+int64_t ThunkProfiler::NowNs() { return tsl::profiler::GetCurrentTimeNanos(); }
+
+tsl::AsyncValueRef<Thunk::ExecuteEvent> ThunkProfiler::Execute(
+    Thunk& thunk, const Thunk::ExecuteParams& params, int64_t ready_ns) {
+  int64_t thread_id = tsl::Env::Default()->GetCurrentThreadId();
+  int64_t start_ns = NowNs();
+
+  tsl::AsyncValueRef<Thunk::ExecuteEvent> execute_event = thunk.Execute(params);
+
+  if (execute_event.IsAvailable()) {
+    Record(thunk, ready_ns, start_ns, NowNs(), thread_id);
+    return execute_event;
+  }
+
+  // Forward completion to a new event after recording thunk execution, so that
+  // the caller observes the recorded event when thunk execution is completed.
+  auto event = tsl::MakeConstructedAsyncValueRef<Thunk::ExecuteEvent>();
+  execute_event.AndThen([this, &thunk, ready_ns, start_ns, thread_id,
+                         event](absl::Status status) {
+    Record(thunk, ready_ns, start_ns, NowNs(), thread_id);
+    if (!status.ok()) {
+      event.SetError(std::move(status));
+    } else {
+      event.SetStateConcrete();
+    }
+  });
+  return event;
+}
+
+void ThunkProfiler::Record(const Thunk& thunk, int64_t ready_ns,
+                           int64_t start_ns, int64_t end_ns,
+                           int64_t thread_id) {
+  Thunk::CostEstimate cost = thunk.cost_estimate();
+
+  Event event{thunk.info().op_name, thunk.info().module_name, thunk.kind()};
+  event.ready_ns = std::min(ready_ns, start_ns);
+  event.start_ns = start_ns;
+  event.end_ns = end_ns;
+  event.thread_id = thread_id;
+  event.flops = cost.flops;
+  event.bytes_accessed = cost.bytes_accessed;
+
+  absl::MutexLock lock(&mu_);
+  events_.push_back(std::move(event));
+}
+
+std::vector<ThunkProfiler::Event> ThunkProfiler::events() const {
+  absl::MutexLock lock(&mu_);
+  return events_;
+}
+
+void ThunkProfiler::Clear() {
+  absl::MutexLock lock(&mu_);
+  events_.clear();
+}
+
+std::vector<ThunkProfiler::OpSummary> ThunkProfiler::Summarize() const {
+  std::vector<OpSummary> summaries;
+  absl::flat_hash_map<std::string, size_t> index;
+
+  for (const Event& event : events()) {
+    auto [it, inserted] = index.try_emplace(event.op_name, summaries.size());
+    if (inserted) summaries.push_back(OpSummary{event.op_name, event.kind});
+
+    OpSummary& summary = summaries[it->second];
+    summary.count++;
+    summary.total_ns += event.duration_ns();
+    summary.total_queue_delay_ns += event.queue_delay_ns();
+    summary.flops += event.flops;
+    summary.bytes_accessed += event.bytes_accessed;
+  }
+
+  absl::c_stable_sort(summaries, [](const OpSummary& a, const OpSummary& b) {
+    return a.total_ns > b.total_ns;
+  });
+  return summaries;
+}
+
+std::string ThunkProfiler::SummaryTable() const {
+  std::vector<OpSummary> summaries = Summarize();
+
+  int64_t total_ns = 0;
+  int op_name_width = 8;
+  for (const OpSummary& summary : summaries) {
+    total_ns += summary.total_ns;
+    op_name_width =
+        std::max(op_name_width, static_cast<int>(summary.op_name.size()));
+  }
+
+  std::string table = absl::StrFormat(
+      "%-*s %-12s %8s %12s %12s %12s %10s %10s %7s\n", op_name_width,
+      "hlo_op", "kind", "count", "total_us", "mean_us", "queue_us", "GFLOP/s",
+      "GB/s", "time%");
+
+  for (const OpSummary& summary : summaries) {
+    // FLOPs and bytes per nanosecond are GFLOP/s and GB/s.
+    double ns = std::max<int64_t>(summary.total_ns, 1);
+    absl::StrAppendFormat(
+        &table, "%-*s %-12s %8d %12.3f %12.3f %12.3f %10.3f %10.3f %6.2f%%\n",
+        op_name_width, summary.op_name, Thunk::KindToString(summary.kind),
+        summary.count, summary.total_ns / 1e3,
+        summary.total_ns / 1e3 / summary.count,
+        summary.total_queue_delay_ns / 1e3, summary.flops / ns,
+        summary.bytes_accessed / ns,
+        100.0 * summary.total_ns / std::max<int64_t>(total_ns, 1));
+  }
+
+  return table;
+}
+
+void ThunkProfiler::ExportToXSpace(XSpace* xspace) const {
+  std::vector<Event> events = this->events();
+  if (events.empty()) return;
+
+  XPlane* plane = tsl::profiler::FindOrAddMutablePlaneWithName(
+      xspace, tsl::profiler::kHostThreadsPlaneName);
+  XPlaneBuilder xplane(plane);
+
+  int64_t min_start_ns = events.front().start_ns;
+  for (const Event& event : events) {
+    min_start_ns = std::min(min_start_ns, event.start_ns);
+  }
+
+  const auto& hlo_op = *xplane.GetOrCreateStatMetadata("hlo_op");
+  const auto& hlo_module = *xplane.GetOrCreateStatMetadata("hlo_module");
+  const auto& thunk_kind = *xplane.GetOrCreateStatMetadata("thunk_kind");
+  const auto& flops = *xplane.GetOrCreateStatMetadata("flops");
+  const auto& bytes_accessed =
+      *xplane.GetOrCreateStatMetadata("bytes_accessed");
+  const auto& queue_delay_ns =
+      *xplane.GetOrCreateStatMetadata("queue_delay_ns");
+
+  for (const Event& event : events) {
+    XLineBuilder xline = xplane.GetOrCreateLine(event.thread_id);
+    // Lines that already have events (i.e. recorded by the profiler session
+    // for the same thread) keep their timestamp.
+    if (xline.NumEvents() == 0) xline.SetTimestampNs(min_start_ns);
+
+    auto xevent =
+        xline.AddEvent(*xplane.GetOrCreateEventMetadata(event.op_name));
+    xevent.SetTimestampNs(event.start_ns);
+    xevent.SetEndTimestampNs(event.end_ns);
+    xevent.AddStatValue(hlo_op, event.op_name);
+    xevent.AddStatValue(hlo_module, event.module_name);
+    xevent.AddStatValue(thunk_kind, Thunk::KindToString(event.kind));
+    xevent.AddStatValue(flops, event.flops);
+    xevent.AddStatValue(bytes_accessed, event.bytes_accessed);
+    xevent.AddStatValue(queue_delay_ns, event.queue_delay_ns());
+  }
+}
+
+std::string ThunkProfiler::ToChromeTrace() const {
+  XSpace xspace;
+  ExportToXSpace(&xspace);
+  return tsl::profiler::TraceContainerToJson(
+      tsl::profiler::ConvertXSpaceToTraceContainer(xspace));
+}
+
+}  // namespace xla::cpu
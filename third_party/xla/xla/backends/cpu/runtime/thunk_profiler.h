@@ -0,0 +1,116 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_THUNK_PROFILER_H_
+#define XLA_BACKENDS_CPU_RUNTIME_THUNK_PROFILER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla::cpu {
+
+// Thunk profiler records execution events of all thunks executed with
+// `Thunk::ExecuteParams::profiler` set to it, including thunks in nested thunk
+// sequences (i.e. the body of a WhileThunk). Recorded events can be exported
+// to XSpace or Chrome trace, and summarized per HLO operation.
+//
+// Profiling is opt-in, and when profiler is not set, thunk executor does not
+// pay any extra costs. Thunk profiler is thread safe.
+class ThunkProfiler {
+ public:
+  // Execution event of a single thunk.
+  struct Event {
+    std::string op_name;
+    std::string module_name;
+    Thunk::Kind kind;
+
+    // Timestamps (compatible with TraceMe timestamps) when all thunk
+    // dependencies completed, and when thunk execution started and completed.
+    int64_t ready_ns = 0;
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
+
+    // Id of the thread that started thunk execution.
+    int64_t thread_id = 0;
+
+    // Estimated work done by the thunk (see `Thunk::cost_estimate()`).
+    int64_t flops = 0;
+    int64_t bytes_accessed = 0;
+
+    // Time spent waiting in the ready queue after all dependencies completed.
+    int64_t queue_delay_ns() const { return start_ns - ready_ns; }
+    int64_t duration_ns() const { return end_ns - start_ns; }
+  };
+
+  // Aggregated execution events of all thunks with the same HLO operation.
+  struct OpSummary {
+    std::string op_name;
+    Thunk::Kind kind;
+
+    int64_t count = 0;
+    int64_t total_ns = 0;
+    int64_t total_queue_delay_ns = 0;
+    int64_t flops = 0;
+    int64_t bytes_accessed = 0;
+  };
+
+  // Returns the current time in the profiler clock domain.
+  static int64_t NowNs();
+
+  // Executes `thunk` and records its execution event once the returned execute
+  // event becomes available. `ready_ns` is the time when all thunk
+  // dependencies completed.
+  tsl::AsyncValueRef<Thunk::ExecuteEvent> Execute(
+      Thunk& thunk, const Thunk::ExecuteParams& params, int64_t ready_ns);
+
+  // Returns all recorded events in the order of their completion.
+  std::vector<Event> events() const;
+
+  // Drops all recorded events.
+  void Clear();
+
+  // Returns recorded events aggregated by HLO operation, sorted by the total
+  // execution time in descending order.
+  std::vector<OpSummary> Summarize() const;
+
+  // Returns a human readable table of per-HLO-operation costs.
+  std::string SummaryTable() const;
+
+  // Adds recorded events to the host threads plane of `xspace`, one line per
+  // worker thread, so they can be viewed together with other host events
+  // collected by the profiler session.
+  void ExportToXSpace(tensorflow::profiler::XSpace* xspace) const;
+
+  // Returns recorded events in Chrome trace format (JSON).
+  std::string ToChromeTrace() const;
+
+ private:
+  void Record(const Thunk& thunk, int64_t ready_ns, int64_t start_ns,
+              int64_t end_ns, int64_t thread_id);
+
+  mutable absl::Mutex mu_;
+  std::vector<Event> events_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_THUNK_PROFILER_H_
@@ -0,0 +1,156 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/thunk_profiler.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/runtime/buffer_use.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/profiler/utils/xplane_schema.h"
+#include "xla/tsl/profiler/utils/xplane_utils.h"
+#include "tsl/platform/test.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla::cpu {
+namespace {
+
+using ::testing::HasSubstr;
+
+// A test-only thunk that completes with the given execute event.
+class EventThunk : public Thunk {
+ public:
+  EventThunk(std::string name, BufferAllocation::Slice slice,
+             tsl::AsyncValueRef<ExecuteEvent> event)
+      : Thunk(Kind::kKernel, Info{std::move(name)}),
+        slice_(slice),
+        event_(std::move(event)) {}
+
+  tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams&) final {
+    return event_;
+  }
+
+  BufferUses buffer_uses() const final { return {BufferUse::Write(slice_)}; }
+
+ private:
+  BufferAllocation::Slice slice_;
+  tsl::AsyncValueRef<ExecuteEvent> event_;
+};
+
+TEST(ThunkProfilerTest, RecordSyncAndAsyncEvents) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+  BufferAllocation::Slice slice(&alloc, /*offset=*/0, /*size=*/80);
+
+  auto async_event = tsl::MakeConstructedAsyncValueRef<Thunk::ExecuteEvent>();
+
+  EventThunk sync_thunk("sync", slice, Thunk::OkExecuteEvent());
+  EventThunk async_thunk("async", slice, async_event);
+
+  ThunkProfiler profiler;
+  Thunk::ExecuteParams params;
+
+  int64_t ready_ns = ThunkProfiler::NowNs();
+  auto sync_done = profiler.Execute(sync_thunk, params, ready_ns);
+  auto async_done = profiler.Execute(async_thunk, params, ready_ns);
+
+  ASSERT_TRUE(sync_done.IsConcrete());
+  ASSERT_FALSE(async_done.IsAvailable());
+  ASSERT_EQ(profiler.events().size(), 1);
+
+  // Async thunk is recorded when its execute event becomes available, and
+  // the error is forwarded to the caller.
+  async_event.SetError(absl::InternalError("Injected error"));
+  ASSERT_TRUE(async_done.IsError());
+  EXPECT_EQ(async_done.GetError(), absl::InternalError("Injected error"));
+
+  std::vector<ThunkProfiler::Event> events = profiler.events();
+  ASSERT_EQ(events.size(), 2);
+
+  EXPECT_EQ(events[0].op_name, "sync");
+  EXPECT_EQ(events[1].op_name, "async");
+
+  for (const ThunkProfiler::Event& event : events) {
+    EXPECT_EQ(event.kind, Thunk::Kind::kKernel);
+    EXPECT_EQ(event.ready_ns, ready_ns);
+    EXPECT_LE(event.ready_ns, event.start_ns);
+    EXPECT_LE(event.start_ns, event.end_ns);
+    EXPECT_EQ(event.bytes_accessed, 80);
+  }
+
+  profiler.Clear();
+  EXPECT_TRUE(profiler.events().empty());
+}
+
+TEST(ThunkProfilerTest, Summarize) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+  BufferAllocation::Slice slice(&alloc, /*offset=*/0, /*size=*/80);
+
+  EventThunk a("a", slice, Thunk::OkExecuteEvent());
+  EventThunk b("b", slice, Thunk::OkExecuteEvent());
+
+  ThunkProfiler profiler;
+  Thunk::ExecuteParams params;
+
+  // Thunks executed multiple times (i.e. in a loop body) are aggregated.
+  for (int i = 0; i < 3; ++i) {
+    profiler.Execute(a, params, ThunkProfiler::NowNs());
+  }
+  profiler.Execute(b, params, ThunkProfiler::NowNs());
+
+  std::vector<ThunkProfiler::OpSummary> summaries = profiler.Summarize();
+  ASSERT_EQ(summaries.size(), 2);
+
+  for (const ThunkProfiler::OpSummary& summary : summaries) {
+    int64_t count = summary.op_name == "a" ? 3 : 1;
+    EXPECT_EQ(summary.count, count);
+    EXPECT_EQ(summary.bytes_accessed, 80 * count);
+  }
+  EXPECT_GE(summaries[0].total_ns, summaries[1].total_ns);
+
+  std::string table = profiler.SummaryTable();
+  EXPECT_THAT(table, HasSubstr("hlo_op"));
+  EXPECT_THAT(table, HasSubstr("kernel"));
+}
+
+TEST(ThunkProfilerTest, ExportToXSpace) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+  BufferAllocation::Slice slice(&alloc, /*offset=*/0, /*size=*/80);
+
+  EventThunk thunk("fusion.1", slice, Thunk::OkExecuteEvent());
+
+  ThunkProfiler profiler;
+  Thunk::ExecuteParams params;
+  profiler.Execute(thunk, params, ThunkProfiler::NowNs());
+
+  tensorflow::profiler::XSpace xspace;
+  profiler.ExportToXSpace(&xspace);
+
+  const tensorflow::profiler::XPlane* plane = tsl::profiler::FindPlaneWithName(
+      xspace, tsl::profiler::kHostThreadsPlaneName);
+  ASSERT_NE(plane, nullptr);
+  ASSERT_EQ(plane->lines_size(), 1);
+  ASSERT_EQ(plane->lines(0).events_size(), 1);
+
+  EXPECT_THAT(profiler.ToChromeTrace(), HasSubstr("fusion.1"));
+}
+
+}  // namespace
+}  // namespace xla::cpu
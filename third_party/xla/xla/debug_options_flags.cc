@@ -86,6 +86,9 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 #endif
   opts.set_xla_cpu_use_thunk_runtime(true);
   opts.set_xla_cpu_parallel_codegen_split_count(32);
+  opts.set_xla_cpu_object_cache_size_mb(0);
+  opts.set_xla_cpu_memory_limit_bytes(0);
+  opts.set_xla_cpu_autotune_level(0);
   opts.set_xla_cpu_enable_concurrency_optimized_scheduler(false);
   opts.set_xla_cpu_prefer_vector_width(256);
   opts.set_xla_cpu_max_isa("");
@@ -879,6 +882,39 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_cpu_parallel_codegen_split_count(),
       "Split LLVM module into at most this many parts before codegen to enable "
       "parallel compilation for the CPU backend."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_object_cache_size_mb",
+      int32_setter_for(&DebugOptions::set_xla_cpu_object_cache_size_mb),
+      debug_options->xla_cpu_object_cache_size_mb(),
+      "Size (in MB) of a process-wide cache of compiled kernel object files "
+      "for the CPU backend. Zero disables the cache."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_memory_limit_bytes",
+      int64_setter_for(&DebugOptions::set_xla_cpu_memory_limit_bytes),
+      debug_options->xla_cpu_memory_limit_bytes(),
+      "Peak memory budget (in bytes) for the CPU backend executables. XLA "
+      "rematerializes instructions to fit into the budget. Zero disables the "
+      "budget."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_autotune_level",
+      int32_setter_for(&DebugOptions::set_xla_cpu_autotune_level),
+      debug_options->xla_cpu_autotune_level(),
+      "Autotuning of host kernels for the CPU backend: 0 disables "
+      "autotuning, 1 applies cached results only, 2 also benchmarks kernels "
+      "missing in the cache."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_load_autotune_results_from",
+      string_setter_for(&DebugOptions::set_xla_cpu_load_autotune_results_from),
+      debug_options->xla_cpu_load_autotune_results_from(),
+      "File to load CPU autotune results from. It is a binary file unless the "
+      "name ends with .txt or .textproto."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_dump_autotune_results_to",
+      string_setter_for(&DebugOptions::set_xla_cpu_dump_autotune_results_to),
+      debug_options->xla_cpu_dump_autotune_results_to(),
+      "File to write CPU autotune results to. It is a binary file unless the "
+      "name ends with .txt or .textproto. The results are written at every "
+      "compilation that runs the autotuner."));
   flag_list->push_back(tsl::Flag(
       "xla_cpu_enable_concurrency_optimized_scheduler",
       bool_setter_for(
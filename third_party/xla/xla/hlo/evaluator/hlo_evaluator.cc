@@ -15,6 +15,7 @@ limitations under the License.
 #include "xla/hlo/evaluator/hlo_evaluator.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <complex>
@@ -1391,9 +1392,174 @@ absl::Status HloEvaluator::HandleReshape(const HloInstruction* reshape) {
   return absl::OkStatus();
 }
 
+bool HloEvaluator::IsLinearElementwise(
+    const Shape& shape, absl::Span<const Literal* const> operands) {
+  if (!LayoutUtil::IsDenseArray(shape) || !shape.is_static()) {
+    return false;
+  }
+  return absl::c_all_of(operands, [&](const Literal* operand) {
+    const Shape& operand_shape = operand->shape();
+    return LayoutUtil::IsDenseArray(operand_shape) &&
+           operand_shape.is_static() &&
+           ShapeUtil::SameDimensions(shape, operand_shape) &&
+           LayoutUtil::MinorToMajor(shape) ==
+               LayoutUtil::MinorToMajor(operand_shape);
+  });
+}
+
+void HloEvaluator::ParallelFor(int64_t num_items, int64_t item_size,
+                               absl::FunctionRef<void(int64_t, int64_t)> fn) {
+  // Ranges are large enough to amortize the cost of scheduling a task.
+  static constexpr int64_t kMinElementsPerRange = 32 * 1024;
+
+  int64_t items_per_range = std::max<int64_t>(
+      1, kMinElementsPerRange / std::max<int64_t>(1, item_size));
+  int64_t num_ranges = CeilOfRatio(num_items, items_per_range);
+
+  if (num_ranges <= 1) {
+    fn(0, num_items);
+    return;
+  }
+
+  // Don't create more ranges than we can efficiently load balance.
+  int64_t max_ranges =
+      4 * (ShapeUtil::GetForEachIndexParallelThreadCount() + 1);
+  if (num_ranges > max_ranges) {
+    num_ranges = max_ranges;
+    items_per_range = CeilOfRatio(num_items, num_ranges);
+  }
+
+  ShapeUtil::ForEachIndexParallel(
+      ShapeUtil::MakeShape(S32, {num_ranges}),
+      [&](absl::Span<const int64_t> range_index, int) {
+        int64_t begin = range_index[0] * items_per_range;
+        int64_t end = std::min(num_items, begin + items_per_range);
+        if (begin < end) fn(begin, end);
+      });
+}
+
+// Copies rows `[row_begin, row_end)` of a dense array of shape `dst_shape`
+// from `src`, where the element at the multi-dimensional index `i` is read
+// from `src[sum(i[d] * src_strides[d])]`. Rows are the minor-most dimension of
+// the `dst_shape` layout, and are numbered in the physical order.
+template <typename T>
+static void StridedCopyRows(const T* src, T* dst, const Shape& dst_shape,
+                            absl::Span<const int64_t> src_strides,
+                            int64_t row_begin, int64_t row_end) {
+  absl::Span<const int64_t> minor_to_major =
+      LayoutUtil::MinorToMajor(dst_shape);
+  absl::Span<const int64_t> dims = dst_shape.dimensions();
+
+  const int64_t rank = dims.size();
+  const int64_t minor_dim = minor_to_major[0];
+  const int64_t row_size = dims[minor_dim];
+  const int64_t minor_stride = src_strides[minor_dim];
+
+  // Index of the first row in all dimensions except the minor one.
+  DimensionVector index(rank, 0);
+  int64_t offset = 0;
+  for (int64_t i = 1, row = row_begin; i < rank; ++i) {
+    int64_t dim = minor_to_major[i];
+    index[dim] = row % dims[dim];
+    row /= dims[dim];
+    offset += index[dim] * src_strides[dim];
+  }
+
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    const T* src_row = src + offset;
+    T* dst_row = dst + row * row_size;
+
+    if (minor_stride == 1) {
+      std::copy_n(src_row, row_size, dst_row);
+    } else if (minor_stride == 0) {
+      std::fill_n(dst_row, row_size, *src_row);
+    } else {
+      for (int64_t j = 0; j < row_size; ++j) {
+        dst_row[j] = src_row[j * minor_stride];
+      }
+    }
+
+    // Move to the next row in the physical order.
+    for (int64_t i = 1; i < rank; ++i) {
+      int64_t dim = minor_to_major[i];
+      offset += src_strides[dim];
+      if (++index[dim] < dims[dim]) break;
+      offset -= index[dim] * src_strides[dim];
+      index[dim] = 0;
+    }
+  }
+}
+
+Literal HloEvaluator::StridedCopy(const Literal& src, const Shape& dst_shape,
+                                  absl::Span<const int64_t> src_strides) {
+  Literal dst(dst_shape);
+
+  if (ShapeUtil::IsZeroElementArray(dst_shape)) return dst;
+  if (dst_shape.rank() == 0) {
+    TF_CHECK_OK(dst.CopyElementFrom(src, {}, {}));
+    return dst;
+  }
+
+  const int64_t row_size =
+      dst_shape.dimensions(LayoutUtil::MinorToMajor(dst_shape)[0]);
+  const int64_t num_rows = ShapeUtil::ElementsIn(dst_shape) / row_size;
+
+  auto copy = [&](auto type_tag) {
+    using T = decltype(type_tag);
+    const T* src_data = static_cast<const T*>(src.untyped_data());
+    T* dst_data = static_cast<T*>(dst.untyped_data());
+    ParallelFor(num_rows, row_size, [&](int64_t row_begin, int64_t row_end) {
+      StridedCopyRows(src_data, dst_data, dst_shape, src_strides, row_begin,
+                      row_end);
+    });
+  };
+
+  // We copy elements as opaque values of the same size.
+  switch (ShapeUtil::ByteSizeOfPrimitiveType(dst_shape.element_type())) {
+    case 1:
+      copy(uint8_t{});
+      break;
+    case 2:
+      copy(uint16_t{});
+      break;
+    case 4:
+      copy(uint32_t{});
+      break;
+    case 8:
+      copy(uint64_t{});
+      break;
+    case 16:
+      copy(std::array<uint64_t, 2>{});
+      break;
+    default:
+      LOG(FATAL) << "Unhandled primitive type "
+                 << PrimitiveType_Name(dst_shape.element_type());
+  }
+
+  return dst;
+}
+
 absl::Status HloEvaluator::HandleTranspose(const HloInstruction* transpose) {
-  evaluated_[transpose] = GetEvaluatedLiteralFor(transpose->operand(0))
-                              .Transpose(transpose->dimensions());
+  const Literal& operand = GetEvaluatedLiteralFor(transpose->operand(0));
+  Literal result = operand.Transpose(transpose->dimensions());
+
+  // `Literal::Transpose` is a memcpy that returns a literal with a permuted
+  // layout. If the transpose has a different layout, materialize it, so that
+  // users of the transpose can iterate over it in the linear order.
+  const Shape& shape = transpose->shape();
+  if (shape.has_layout() && LayoutUtil::IsDenseArray(shape) &&
+      shape.is_static() && result.shape().is_static() &&
+      !LayoutUtil::Equal(shape.layout(), result.shape().layout())) {
+    absl::Span<const int64_t> permutation = transpose->dimensions();
+    DimensionVector src_strides(shape.rank());
+    for (int64_t i = 0; i < shape.rank(); ++i) {
+      src_strides[i] =
+          IndexUtil::GetDimensionStride(operand.shape(), permutation[i]);
+    }
+    result = StridedCopy(operand, shape, src_strides);
+  }
+
+  evaluated_[transpose] = std::move(result);
   return absl::OkStatus();
 }
 
@@ -3104,6 +3270,20 @@ absl::Status HloEvaluator::HandleBroadcast(const HloInstruction* broadcast) {
         broadcast->ToString());
   }
 
+  // Broadcast of a static dense array is a strided copy with zero strides for
+  // the broadcasted dimensions.
+  const Shape& shape = broadcast->shape();
+  if (LayoutUtil::IsDenseArray(shape) && shape.is_static() &&
+      operand.shape().is_static()) {
+    DimensionVector src_strides(shape.rank(), 0);
+    for (int64_t i = 0; i < broadcast->dimensions().size(); ++i) {
+      src_strides[broadcast->dimensions(i)] =
+          IndexUtil::GetDimensionStride(operand.shape(), i);
+    }
+    evaluated_[broadcast] = StridedCopy(operand, shape, src_strides);
+    return absl::OkStatus();
+  }
+
   TF_ASSIGN_OR_RETURN(
       evaluated_[broadcast],
       operand.Broadcast(broadcast->shape(), broadcast->dimensions()));
@@ -4299,6 +4479,28 @@ static absl::StatusOr<bool> PerformReductionStep(
   return true;
 }
 
+// Returns `init + sum(literal[begin:end])` for a floating point literal, where
+// elements are accumulated in double precision in partial sums of `chunk_size`
+// consecutive elements.
+static double SumAsDouble(const Literal& literal, double init, int64_t begin,
+                          int64_t end, int64_t chunk_size) {
+  return primitive_util::FloatingPointTypeSwitch<double>(
+      [&](auto primitive_type_constant) -> double {
+        using NativeT = NativeTypeOf<primitive_type_constant>;
+        absl::Span<const NativeT> data = literal.data<NativeT>();
+        double result = init;
+        for (int64_t i = begin; i < end; i += chunk_size) {
+          double sum = 0.0;
+          for (int64_t j = i, e = std::min(end, i + chunk_size); j < e; ++j) {
+            sum += static_cast<double>(data[j]);
+          }
+          result += sum;
+        }
+        return result;
+      },
+      literal.shape().element_type());
+}
+
 static absl::StatusOr<bool> GenerateReduceOutputElement(
     bool is_tuple, bool use_fast_path, absl::Span<const int64_t> output_index,
 
@@ -4309,7 +4511,8 @@ static absl::StatusOr<bool> GenerateReduceOutputElement(
 
     absl::Span<const int64_t> arg_dim_steps,
     absl::Span<const int64_t> arg_dim_counts,
-    absl::Span<const int64_t> result_to_arg_index) {
+    absl::Span<const int64_t> result_to_arg_index,
+    int64_t contiguous_reduce_size) {
   bool use_fast_add = use_fast_path &&
                       ShapeUtil::ElementIsFloating(init_values[0]->shape()) &&
                       IsScalarAdd(function) && !is_tuple;
@@ -4332,6 +4535,21 @@ static absl::StatusOr<bool> GenerateReduceOutputElement(
     absl::Span<const int64_t> minor_to_major = LayoutUtil::MinorToMajor(shape);
 
     static constexpr int kChunkSize = 512;
+
+    // Reduced elements are contiguous in memory, and we can sum them without
+    // computing linear indices. Partial sums are accumulated over the same
+    // chunks as below, and the result is exactly the same.
+    if (contiguous_reduce_size >= 0) {
+      int64_t begin = IndexUtil::MultidimensionalIndexToLinearIndex(
+          shape, minor_to_major, base);
+      computed_result =
+          SumAsDouble(*input_arg0, computed_result, begin,
+                      begin + contiguous_reduce_size, kChunkSize);
+      TF_RETURN_IF_ERROR(
+          results[0].SetFromDouble(output_index, computed_result));
+      return true;
+    }
+
     int64_t linear_indices[kChunkSize];
     int n_linear_indices = 0;
 
@@ -4434,6 +4652,25 @@ absl::Status HloEvaluator::HandleReduce(const HloInstruction* hlo) {
     }
   }
 
+  // If reduced dimensions are the most minor dimensions of the input layout,
+  // each output element is a reduction of a contiguous range of elements.
+  int64_t contiguous_reduce_size = -1;
+  if (num_args == 1 && LayoutUtil::IsDenseArray(arg_shape) &&
+      arg_shape.is_static()) {
+    absl::Span<const int64_t> minor_to_major =
+        LayoutUtil::MinorToMajor(arg_shape);
+    int64_t num_reduced = dimensions_to_reduce.size();
+    bool is_contiguous = absl::c_all_of(
+        minor_to_major.first(num_reduced),
+        [&](int64_t dim) { return arg_dim_steps[dim] == 1; });
+    if (is_contiguous) {
+      contiguous_reduce_size = 1;
+      for (int64_t dim : dimensions_to_reduce) {
+        contiguous_reduce_size *= arg_dimensions[dim];
+      }
+    }
+  }
+
   const int num_threads = ShapeUtil::GetForEachIndexParallelThreadCount() + 1;
   std::vector<std::unique_ptr<HloEvaluator>> embedded_evaluators;
   embedded_evaluators.reserve(num_threads);
@@ -4452,7 +4689,7 @@ absl::Status HloEvaluator::HandleReduce(const HloInstruction* hlo) {
             is_tuple, use_fast_path_reduce_, output_index, init_values,
             input_args, absl::Span<Literal>(results), function,
             embedded_evaluators[thread_id + 1].get(), arg_dim_steps,
-            arg_dim_counts, result_to_arg_index);
+            arg_dim_counts, result_to_arg_index, contiguous_reduce_size);
       }));
 
   if (is_tuple) {
@@ -36,6 +36,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xla/array2d.h"
@@ -470,6 +471,19 @@ class HloEvaluator : public ConstDfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+
+    if (IsLinearElementwise(result.shape(), {&operand_literal})) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      ParallelFor(result_data.size(), /*item_size=*/1,
+                  [&](int64_t begin, int64_t end) {
+                    for (int64_t i = begin; i < end; ++i) {
+                      result_data[i] = unary_op(operand_data[i]);
+                    }
+                  });
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -477,6 +491,28 @@ class HloEvaluator : public ConstDfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  // Returns true if all `operands` are dense arrays with static dimensions and
+  // the same layout as `shape`. Elementwise operations on such operands are
+  // evaluated with typed loops over the literal data in linear order, instead
+  // of computing a multi-dimensional index for every element.
+  static bool IsLinearElementwise(const Shape& shape,
+                                  absl::Span<const Literal* const> operands);
+
+  // Calls `fn(begin, end)` for disjoint ranges of items that cover
+  // `[0, num_items)`. Each item is `item_size` elements. If the total number of
+  // elements is large, ranges are processed in parallel on the thread pool of
+  // `ShapeUtil::ForEachIndexParallel`.
+  static void ParallelFor(int64_t num_items, int64_t item_size,
+                          absl::FunctionRef<void(int64_t, int64_t)> fn);
+
+  // Returns a dense array of shape `dst_shape` where the element at the
+  // multi-dimensional index `i` is read from the linear index
+  // `sum(i[d] * src_strides[d])` of the `src` literal. Rows of the result are
+  // copied with typed loops (a copy or a fill for unit and zero strides)
+  // instead of computing source and destination indices element by element.
+  static Literal StridedCopy(const Literal& src, const Shape& dst_shape,
+                             absl::Span<const int64_t> src_strides);
+
   // Map from a primitive type to its associated (templated) DfsHloVisitor.
   std::unique_ptr<ConstDfsHloVisitor> typed_visitors_[PrimitiveType_ARRAYSIZE];
 
@@ -620,6 +620,66 @@ TEST_F(HloEvaluatorTest, DoesBroadcastScalar) {
   EXPECT_TRUE(LiteralTestUtil::Equal(result, output_literal));
 }
 
+TEST_F(HloEvaluatorTest, DoesBroadcastWithLayout) {
+  const char* hlo_text = R"(
+HloModule BroadcastWithLayout
+
+ENTRY main {
+  c = s32[2,3]{0,1} constant({{1, 2, 3}, {4, 5, 6}})
+  ROOT broadcast = s32[2,4,3]{1,0,2} broadcast(c), dimensions={0,2}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({}));
+
+  auto expected = LiteralUtil::CreateR3<int32_t>(
+      {{{1, 2, 3}, {1, 2, 3}, {1, 2, 3}, {1, 2, 3}},
+       {{4, 5, 6}, {4, 5, 6}, {4, 5, 6}, {4, 5, 6}}});
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+  EXPECT_EQ(result.shape().layout(), LayoutUtil::MakeLayout({1, 0, 2}));
+}
+
+TEST_F(HloEvaluatorTest, DoesTransposeWithLayout) {
+  const char* hlo_text = R"(
+HloModule TransposeWithLayout
+
+ENTRY main {
+  c = s32[2,3]{1,0} constant({{1, 2, 3}, {4, 5, 6}})
+  ROOT transpose = s32[3,2]{1,0} transpose(c), dimensions={1,0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({}));
+
+  auto expected = LiteralUtil::CreateR2<int32_t>({{1, 4}, {2, 5}, {3, 6}});
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+  EXPECT_EQ(result.shape().layout(), LayoutUtil::MakeLayout({1, 0}));
+}
+
+// Elementwise operations have a fast path for operands with the same layout as
+// the result. Checks that operands with different layouts are handled too.
+TEST_F(HloEvaluatorTest, DoesElementwiseWithMixedLayouts) {
+  const char* hlo_text = R"(
+HloModule ElementwiseWithMixedLayouts
+
+ENTRY main {
+  a = s32[2,3]{1,0} constant({{1, 2, 3}, {4, 5, 6}})
+  b = s32[2,3]{0,1} constant({{10, 20, 30}, {40, 50, 60}})
+  p = pred[2,3]{0,1} constant({{true, false, true}, {false, true, false}})
+  add = s32[2,3]{0,1} add(a, b)
+  multiply = s32[2,3]{0,1} multiply(add, b)
+  negate = s32[2,3]{0,1} negate(multiply)
+  ROOT select = s32[2,3]{0,1} select(p, negate, add)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({}));
+
+  auto expected =
+      LiteralUtil::CreateR2<int32_t>({{-110, 22, -990}, {44, -2750, 66}});
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+}
+
 TEST_F(HloEvaluatorTest, DoesConcatenateSimple) {
   HloComputation::Builder b(TestName());
 
@@ -2638,6 +2698,44 @@ TEST_F(HloEvaluatorPreciseReduceTest, AddReductionPrecisionTest) {
   LiteralTestUtil::ExpectR0Equal<float>(kNumElements, result);
 }
 
+// Reduce has a fast path for reducing contiguous elements. Checks that it
+// computes the same results as the generic path for strided elements.
+TEST_F(HloEvaluatorTest, ReduceAddContiguousAndStrided) {
+  const char* hlo_text = R"(
+HloModule ReduceAddContiguousAndStrided
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  c = f32[2,3,4]{2,1,0} constant({
+    {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}},
+    {{12, 13, 14, 15}, {16, 17, 18, 19}, {20, 21, 22, 23}}})
+  t = f32[2,3,4]{0,1,2} constant({
+    {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}},
+    {{12, 13, 14, 15}, {16, 17, 18, 19}, {20, 21, 22, 23}}})
+  zero = f32[] constant(0)
+  contiguous = f32[2] reduce(c, zero), dimensions={1,2}, to_apply=add
+  strided = f32[3,4] reduce(c, zero), dimensions={0}, to_apply=add
+  transposed = f32[4] reduce(t, zero), dimensions={0,1}, to_apply=add
+  ROOT tuple = (f32[2], f32[3,4], f32[4]) tuple(contiguous, strided, transposed)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({}));
+
+  auto contiguous = LiteralUtil::CreateR1<float>({66, 210});
+  auto strided = LiteralUtil::CreateR2<float>(
+      {{12, 14, 16, 18}, {20, 22, 24, 26}, {28, 30, 32, 34}});
+  auto transposed = LiteralUtil::CreateR1<float>({60, 66, 72, 78});
+  auto expected =
+      LiteralUtil::MakeTuple({&contiguous, &strided, &transposed});
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+}
+
 // Reducing many numbers should be fast because it doesn't create
 // intermediate Literals; the microbenchmark should finish in < 1 msec.
 void BM_ReducePrecisely(::testing::benchmark::State& state) {
@@ -2677,6 +2775,43 @@ void BM_ReducePrecisely(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_ReducePrecisely);
 
+// Constant folding of large elementwise expressions with broadcasts should not
+// compute multi-dimensional indices for every element.
+void BM_ElementwiseWithBroadcast(::testing::benchmark::State& state) {
+  HloComputation::Builder b("BM_ElementwiseWithBroadcast");
+  HloModuleConfig config;
+  config.set_debug_options(GetDebugOptionsFromFlags());
+  HloModule module("BM_ElementwiseWithBroadcast", config);
+
+  constexpr int64_t kSize = 1024;
+  Shape shape = ShapeUtil::MakeShape(F32, {kSize, kSize});
+  Shape row_shape = ShapeUtil::MakeShape(F32, {kSize});
+
+  std::vector<float> row(kSize, 2.0f);
+  Array2D<float> matrix(kSize, kSize, 1.0f);
+  HloInstruction* row_instruction = b.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR1<float>(row)));
+  HloInstruction* matrix_instruction = b.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR2FromArray2D(matrix)));
+
+  HloInstruction* broadcast = b.AddInstruction(
+      HloInstruction::CreateBroadcast(shape, row_instruction, {1}));
+  HloInstruction* add = b.AddInstruction(HloInstruction::CreateBinary(
+      shape, HloOpcode::kAdd, broadcast, matrix_instruction));
+  HloInstruction* multiply = b.AddInstruction(
+      HloInstruction::CreateBinary(shape, HloOpcode::kMultiply, add, add));
+  HloInstruction* negate = b.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kNegate, multiply));
+  module.AddEntryComputation(b.Build());
+
+  for (auto s : state) {
+    HloEvaluator hlo_eval;
+    hlo_eval.Evaluate(negate).value();
+  }
+}
+
+BENCHMARK(BM_ElementwiseWithBroadcast);
+
 TEST_P(HloEvaluatorBf16Test, ReduceAdd) {
   HloComputation::Builder b(TestName());
 
@@ -201,6 +201,9 @@ const char* LiteralBase::Piece::buffer() const {
   if (auto* r = std::get_if<DenseInlinedRep>(&rep_)) {
     return r->data;
   }
+  if (auto* r = std::get_if<DenseExternalRep>(&rep_)) {
+    return r->data;
+  }
   DCHECK(std::holds_alternative<TupleRep>(rep_) ||
          std::holds_alternative<Uninitialized>(rep_));
   return nullptr;
@@ -324,6 +327,34 @@ Literal& Literal::operator=(Literal&& other) {
   return *this;
 }
 
+/* static */ absl::StatusOr<Literal> Literal::CreateFromExternalData(
+    const Shape& shape, absl::Span<const char> data,
+    std::shared_ptr<const void> storage) {
+  if (!shape.IsArray() || !LayoutUtil::IsDenseArray(shape)) {
+    return InvalidArgument("External literal data must be a dense array: %s",
+                           ShapeUtil::HumanString(shape));
+  }
+  if (!shape.is_static()) {
+    return InvalidArgument("External literal data must have a static shape: %s",
+                           ShapeUtil::HumanString(shape));
+  }
+  if (reinterpret_cast<uintptr_t>(data.data()) % kExternalDataAlignment != 0) {
+    return InvalidArgument(
+        "External literal data must be aligned to %d bytes: %p",
+        kExternalDataAlignment, data.data());
+  }
+
+  Literal literal(shape, /*allocate_arrays=*/false);
+  if (data.size() != literal.root_piece_.size_bytes_dense()) {
+    return InvalidArgument(
+        "External literal data has %d bytes, expected %d bytes for shape %s",
+        data.size(), literal.root_piece_.size_bytes_dense(),
+        ShapeUtil::HumanString(shape));
+  }
+  literal.root_piece_.set_external_buffer(data.data(), std::move(storage));
+  return std::move(literal);
+}
+
 Literal LiteralBase::CreateFromShape(const Shape& shape) {
   Literal literal(shape);
   literal.root_piece_.ForEachMutableSubpiece(
@@ -635,9 +666,21 @@ void LiteralBase::Piece::DeallocateBuffers() {
   if (auto* array_rep = GetDenseRep()) {
     tsl::port::AlignedFree(array_rep->data);
     rep_.emplace<Uninitialized>();
+  } else if (GetDenseExternalRep()) {
+    rep_.emplace<Uninitialized>();
   }
 }
 
+void LiteralBase::Piece::CopyExternalData() {
+  auto* external_rep = GetDenseExternalRep();
+  DCHECK(external_rep);
+  // Keep the external storage alive until the data is copied.
+  DenseExternalRep rep = std::move(*external_rep);
+  rep_.emplace<Uninitialized>();
+  AllocateBuffers();
+  std::memcpy(buffer(), rep.data, size_bytes_dense());
+}
+
 template <typename NativeT>
 void LiteralBase::Piece::CopyElementsWithDynamicBound(
     const LiteralBase::Piece& src) {
@@ -702,6 +745,13 @@ absl::Status LiteralBase::Piece::CopyFrom(const LiteralBase::Piece& src,
     array_value_state_ = src.array_value_state_;
   }
 
+  // All data is overwritten below, so there is no need to copy external
+  // storage into an owned buffer first.
+  if (GetDenseExternalRep() && !only_dynamic_bound && this != &src) {
+    DeallocateBuffers();
+    AllocateBuffers();
+  }
+
   if (ShapeUtil::Equal(subshape(), src.subshape())) {
     // If the layouts are equal it's faster just to memcpy.
     memcpy(buffer(), src.buffer(), src.size_bytes_dense());
@@ -2618,6 +2668,10 @@ int64_t LiteralBase::size_bytes(const ShapeIndex& shape_index) const {
   return piece(shape_index).size_bytes_dense();
 }
 
+bool LiteralBase::HasExternalStorage(const ShapeIndex& shape_index) const {
+  return piece(shape_index).has_external_buffer();
+}
+
 std::string LiteralBase::GetR1U8AsString() const {
   CHECK(shape().IsArray());
   CHECK_EQ(shape().rank(), 1);
@@ -2647,7 +2701,9 @@ void MutableBorrowingLiteral::CopyPieceSubtree(const Shape& shape,
       dest_piece->emplace_back(std::move(child_piece));
     }
   } else if (shape.IsArray()) {
-    dest_piece->set_buffer(const_cast<char*>(src_piece->buffer()));
+    // Mutable borrowing literals can write to the buffer, so literals with
+    // read-only external storage get an owned copy first.
+    dest_piece->set_buffer(const_cast<Piece*>(src_piece)->buffer());
   }
 }
 
@@ -36,6 +36,7 @@ limitations under the License.
 #include "absl/base/casts.h"
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "xla/array.h"
@@ -108,6 +109,10 @@ class LiteralBase {
   const void* untyped_data(const ShapeIndex& shape_index = {}) const;
   int64_t size_bytes(const ShapeIndex& shape_index = {}) const;
 
+  // Returns true if the array at the given shape index references external
+  // storage (see Literal::CreateFromExternalData) instead of owning its buffer.
+  bool HasExternalStorage(const ShapeIndex& shape_index = {}) const;
+
   // Computes the size in bytes of the output of the Serialize method.
   absl::StatusOr<int64_t> SerializedSize() const {
     return ShapeUtil::SerializedSize(shape());
@@ -788,6 +793,11 @@ class LiteralBase {
   // pointer to the memory allocated for the array data.
   class Piece {
    public:
+    // Literals can be used as DMA targets, which can require alignment. We
+    // force a tsl::Allocator::kAllocatorAlignment-byte minimum
+    // alignment.
+    static inline constexpr size_t kMinimumAlignment = 64;
+
     ArrayValueState get_array_value_state() const;
     void set_array_value_state(ArrayValueState state);
     // Returns the buffer holding the array data for this piece as an array
@@ -816,7 +826,12 @@ class LiteralBase {
     void DeallocateBuffers();
     // Gets/sets the buffer holding the array data.
     const char* buffer() const;
+    // External storage is read-only, so requesting a mutable buffer of a piece
+    // that references it makes a private copy of the data first.
     char* buffer() {
+      if (GetDenseExternalRep()) {
+        CopyExternalData();
+      }
       return const_cast<char*>(const_cast<const Piece*>(this)->buffer());
     }
     void set_buffer(char* buffer) {
@@ -827,11 +842,27 @@ class LiteralBase {
       DCHECK(dense_rep);
       dense_rep->data = buffer;
     }
+    // Makes this piece reference `buffer`, which is kept alive by `storage`.
+    // The piece must be uninitialized.
+    void set_external_buffer(const char* buffer,
+                             std::shared_ptr<const void> storage) {
+      DCHECK(LayoutUtil::IsDenseArray(*subshape_));
+      DCHECK(std::holds_alternative<Uninitialized>(rep_));
+      auto& external_rep = rep_.emplace<DenseExternalRep>();
+      external_rep.data = buffer;
+      external_rep.storage = std::move(storage);
+    }
+    bool has_external_buffer() const {
+      return GetDenseExternalRep() != nullptr;
+    }
     void MoveDataFrom(Piece& from) {
       DCHECK(!std::holds_alternative<DenseRep>(rep_));
+      DCHECK(!std::holds_alternative<DenseExternalRep>(rep_));
       DCHECK(!std::holds_alternative<TupleRep>(rep_));
       if (auto* dense_rep = from.GetDenseRep()) {
         rep_.emplace<DenseRep>().data = dense_rep->data;
+      } else if (auto* external_rep = from.GetDenseExternalRep()) {
+        rep_.emplace<DenseExternalRep>(std::move(*external_rep));
       } else if (auto* inlined_rep = from.GetDenseInlinedRep()) {
         std::memcpy(rep_.emplace<DenseInlinedRep>().data, inlined_rep->data,
                     from.total_bytes_dense());
@@ -1034,11 +1065,12 @@ class LiteralBase {
       // Children pieces for tuple shaped pieces.
       std::vector<Piece> children = {};
     };
-
-    // Literals can be used as DMA targets, which can require alignment. We
-    // force a tsl::Allocator::kAllocatorAlignment-byte minimum
-    // alignment.
-    static inline constexpr size_t kMinimumAlignment = 64;
+    // Dense array storage owned by someone else (e.g. a memory mapped file),
+    // which is kept alive for as long as the piece references it.
+    struct DenseExternalRep {
+      const char* data = nullptr;
+      std::shared_ptr<const void> storage;
+    };
 
     // Use just so many bytes that we don't increase the sizeof(Piece).
     static inline constexpr size_t kMaxInlinedBytes =
@@ -1059,6 +1091,16 @@ class LiteralBase {
     const DenseRep* GetDenseRep() const { return std::get_if<DenseRep>(&rep_); }
     DenseRep* GetDenseRep() { return std::get_if<DenseRep>(&rep_); }
 
+    const DenseExternalRep* GetDenseExternalRep() const {
+      return std::get_if<DenseExternalRep>(&rep_);
+    }
+    DenseExternalRep* GetDenseExternalRep() {
+      return std::get_if<DenseExternalRep>(&rep_);
+    }
+
+    // Replaces the external storage of this piece with an owned copy.
+    void CopyExternalData();
+
     const TupleRep* GetTupleRep() const { return std::get_if<TupleRep>(&rep_); }
     TupleRep* GetTupleRep() { return std::get_if<TupleRep>(&rep_); }
     // Helpers for traversing the piece via ForEachSubpiece rooted at 'index'.
@@ -1121,7 +1163,9 @@ class LiteralBase {
     void CopyElementsWithDynamicBound(const LiteralBase::Piece& src);
 
     // Storage representation of this piece.
-    std::variant<Uninitialized, DenseInlinedRep, DenseRep, TupleRep> rep_;
+    std::variant<Uninitialized, DenseInlinedRep, DenseRep, TupleRep,
+                 DenseExternalRep>
+        rep_;
 
     // The shape of piece. This points into the shape of the containing Literal
     // (Literal::shape_).
@@ -1370,6 +1414,17 @@ class Literal : public MutableLiteralBase {
           ArrayValueState leaf_array_value_state = ArrayValueState::kKnown);
   Literal& operator=(Literal&& other);
 
+  // Creates an array literal that references `data` instead of copying it. The
+  // data must be kept alive by `storage` (e.g. a memory mapped file), which is
+  // released when the literal, or a literal it was moved into, is destroyed.
+  // `data` must be aligned to kExternalDataAlignment bytes and hold exactly the
+  // array of `shape`, which must be static. Mutable accessors of the literal
+  // copy the data into an owned buffer first, so `data` is never written to.
+  static constexpr size_t kExternalDataAlignment = Piece::kMinimumAlignment;
+  static absl::StatusOr<Literal> CreateFromExternalData(
+      const Shape& shape, absl::Span<const char> data,
+      std::shared_ptr<const void> storage);
+
   // Similar to CopyFrom, but with move semantics. The subshape of this literal
   // rooted at 'dest_shape_index' must be *equal* to the shape 'src_literal'
   // (layouts and shapes must match), but need not be arrays. The memory
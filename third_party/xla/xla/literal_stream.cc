@@ -0,0 +1,818 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/literal_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "xla/layout_util.h"
+#include "xla/literal.h"
+#include "xla/primitive_util.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/tsl/util/byte_swap_array.h"
+#include "xla/util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/protobuf.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+constexpr bool kLittleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// Wire types of the protobuf encoding.
+enum WireType : uint32_t {
+  kVarint = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+  kFixed32 = 5,
+};
+
+// LiteralProto field numbers, see xla_data.proto.
+constexpr uint32_t kShapeField = 1;
+constexpr uint32_t kTupleLiteralsField = 10;
+
+// Padding is written as a field that is not a part of LiteralProto, so parsers
+// keep it as an unknown field. It uses the largest valid field number, which
+// has a five byte tag.
+constexpr uint32_t kPaddingField = (1 << 29) - 1;
+constexpr int64_t kPaddingTagSize = 5;
+
+constexpr int64_t kAlignment = Literal::kExternalDataAlignment;
+constexpr int64_t kMaxVarintBytes = 10;
+
+// The block size used for reading and writing files.
+constexpr int kFileBlockSize = 1 << 20;
+
+// How array data of a primitive type is stored in LiteralProto.
+enum class Encoding {
+  // Raw little endian bytes of the array in a `bytes` field, or in a packed
+  // repeated `float` or `double` field.
+  kRaw,
+  // A packed repeated varint field.
+  kVarint,
+};
+
+struct FieldInfo {
+  uint32_t field_number;
+  Encoding encoding;
+};
+
+absl::StatusOr<FieldInfo> GetFieldInfo(PrimitiveType type) {
+  switch (type) {
+    case PRED:
+      return FieldInfo{2, Encoding::kVarint};
+    case S32:
+      return FieldInfo{4, Encoding::kVarint};
+    case S64:
+      return FieldInfo{5, Encoding::kVarint};
+    case U32:
+      return FieldInfo{6, Encoding::kVarint};
+    case U64:
+      return FieldInfo{7, Encoding::kVarint};
+    case S2:
+      return FieldInfo{26, Encoding::kRaw};
+    case S4:
+      return FieldInfo{21, Encoding::kRaw};
+    case S8:
+      return FieldInfo{15, Encoding::kRaw};
+    case S16:
+      return FieldInfo{17, Encoding::kRaw};
+    case U2:
+      return FieldInfo{27, Encoding::kRaw};
+    case U4:
+      return FieldInfo{22, Encoding::kRaw};
+    case U8:
+      return FieldInfo{3, Encoding::kRaw};
+    case U16:
+      return FieldInfo{16, Encoding::kRaw};
+    case F16:
+      return FieldInfo{11, Encoding::kRaw};
+    case BF16:
+      return FieldInfo{13, Encoding::kRaw};
+    case F32:
+      return FieldInfo{8, Encoding::kRaw};
+    case F64:
+      return FieldInfo{9, Encoding::kRaw};
+    case C64:
+      return FieldInfo{12, Encoding::kRaw};
+    case C128:
+      return FieldInfo{18, Encoding::kRaw};
+    case F8E5M2:
+      return FieldInfo{19, Encoding::kRaw};
+    case F8E4M3:
+      return FieldInfo{28, Encoding::kRaw};
+    case F8E4M3FN:
+      return FieldInfo{20, Encoding::kRaw};
+    case F8E4M3B11FNUZ:
+      return FieldInfo{23, Encoding::kRaw};
+    case F8E5M2FNUZ:
+      return FieldInfo{24, Encoding::kRaw};
+    case F8E4M3FNUZ:
+      return FieldInfo{25, Encoding::kRaw};
+    case F8E3M4:
+      return FieldInfo{29, Encoding::kRaw};
+    default:
+      return Unimplemented("Unhandled primitive type %s",
+                           PrimitiveType_Name(type));
+  }
+}
+
+// Returns the size of the units of raw array data that are stored in the
+// little endian byte order.
+int64_t RawUnitSize(PrimitiveType type) {
+  if (primitive_util::IsComplexType(type)) {
+    return primitive_util::ByteWidth(
+        primitive_util::ComplexComponentType(type));
+  }
+  return primitive_util::ByteWidth(type);
+}
+
+uint64_t MakeTag(uint32_t field_number, WireType wire_type) {
+  return (uint64_t{field_number} << 3) | wire_type;
+}
+
+int64_t VarintSize(uint64_t value) {
+  return tsl::protobuf::io::CodedOutputStream::VarintSize64(value);
+}
+
+// Converts a value to its varint representation. Signed values are sign
+// extended to 64 bits, as protobuf does for int32 and int64 fields.
+template <typename NativeT>
+uint64_t ToVarint(NativeT value) {
+  if constexpr (std::is_signed_v<NativeT>) {
+    return static_cast<uint64_t>(static_cast<int64_t>(value));
+  } else {
+    return static_cast<uint64_t>(value);
+  }
+}
+
+absl::Status UnexpectedEnd() {
+  return InvalidArgument("Unexpected end of serialized LiteralProto");
+}
+
+absl::StatusOr<Shape> ShapeFromProto(const ShapeProto& proto) {
+  Shape shape(proto);
+  if (ShapeUtil::HasPrimitiveType(shape, OPAQUE_TYPE)) {
+    return InvalidArgument(
+        "Literal shape cannot include OPAQUE_TYPE sub-shape");
+  }
+  if (!LayoutUtil::HasLayout(shape)) {
+    return InvalidArgument("LiteralProto has no layout");
+  }
+  if (LayoutUtil::IsSparseArray(shape)) {
+    return Unimplemented("Sparse literals are not supported");
+  }
+  TF_RETURN_IF_ERROR(ShapeUtil::ValidateShapeWithOptionalLayout(shape));
+  // Literals don't support packed sub-byte elements (see Literal::SetShape).
+  if (shape.IsArray() && LayoutUtil::HasCustomElementSizeInBits(shape)) {
+    shape.mutable_layout()->set_element_size_in_bits(0);
+  }
+  return shape;
+}
+
+// Writes literals to a ZeroCopyOutputStream, or only counts the bytes that
+// would be written if the stream is null.
+class LiteralWriter {
+ public:
+  LiteralWriter(tsl::protobuf::io::ZeroCopyOutputStream* output,
+                int64_t min_aligned_payload_bytes)
+      : output_(output),
+        min_aligned_payload_bytes_(min_aligned_payload_bytes) {}
+
+  ~LiteralWriter() {
+    if (available_ > 0) {
+      output_->BackUp(available_);
+    }
+  }
+
+  // Writes the LiteralProto message of the subliteral at `index`, without a
+  // tag and a length. Padding is computed relative to the start of the
+  // message, so payloads are aligned in the output only if the message is.
+  absl::Status WriteMessage(const LiteralBase& literal,
+                            const ShapeIndex& index) {
+    const int64_t start = position_;
+    const Shape& shape = ShapeUtil::GetSubshape(literal.shape(), index);
+
+    std::string shape_proto = shape.ToProto().SerializeAsString();
+    TF_RETURN_IF_ERROR(WriteFieldHeader(start, kShapeField, shape_proto.size(),
+                                        /*align=*/false));
+    TF_RETURN_IF_ERROR(WriteRaw(shape_proto.data(), shape_proto.size()));
+
+    if (shape.IsTuple()) {
+      ShapeIndex element_index = index;
+      element_index.push_back(0);
+      for (int64_t i = 0; i < ShapeUtil::TupleElementCount(shape); ++i) {
+        element_index.back() = i;
+        TF_ASSIGN_OR_RETURN(int64_t size, MessageSize(literal, element_index));
+        TF_RETURN_IF_ERROR(WriteFieldHeader(start, kTupleLiteralsField, size,
+                                            /*align=*/true));
+        TF_RETURN_IF_ERROR(WriteMessage(literal, element_index));
+      }
+      return absl::OkStatus();
+    }
+
+    // Tokens have no data, and empty fields are omitted like in protobuf.
+    if (!shape.IsArray() || ShapeUtil::IsZeroElementArray(shape)) {
+      return absl::OkStatus();
+    }
+
+    TF_ASSIGN_OR_RETURN(FieldInfo field, GetFieldInfo(shape.element_type()));
+    if (field.encoding == Encoding::kVarint) {
+      switch (shape.element_type()) {
+        case PRED:
+          return WriteVarints(start, field, literal.data<bool>(index));
+        case S32:
+          return WriteVarints(start, field, literal.data<int32_t>(index));
+        case S64:
+          return WriteVarints(start, field, literal.data<int64_t>(index));
+        case U32:
+          return WriteVarints(start, field, literal.data<uint32_t>(index));
+        case U64:
+          return WriteVarints(start, field, literal.data<uint64_t>(index));
+        default:
+          return Internal("Unexpected varint type %s",
+                          PrimitiveType_Name(shape.element_type()));
+      }
+    }
+
+    const int64_t size = literal.size_bytes(index);
+    TF_RETURN_IF_ERROR(
+        WriteFieldHeader(start, field.field_number, size, /*align=*/true));
+    return WriteLittleEndian(
+        static_cast<const char*>(literal.untyped_data(index)), size,
+        RawUnitSize(shape.element_type()));
+  }
+
+ private:
+  // Returns the size of the LiteralProto message of the subliteral at `index`.
+  absl::StatusOr<int64_t> MessageSize(const LiteralBase& literal,
+                                      const ShapeIndex& index) {
+    LiteralWriter counter(/*output=*/nullptr, min_aligned_payload_bytes_);
+    TF_RETURN_IF_ERROR(counter.WriteMessage(literal, index));
+    return counter.position_;
+  }
+
+  // Writes the tag and the length of a length delimited field. If `align` is
+  // true and the payload is large enough, a padding field is written first so
+  // that the payload is aligned relative to the message `start`.
+  absl::Status WriteFieldHeader(int64_t start, uint32_t field_number,
+                                int64_t size, bool align) {
+    const uint64_t tag = MakeTag(field_number, kLengthDelimited);
+    if (align && min_aligned_payload_bytes_ > 0 &&
+        size >= min_aligned_payload_bytes_) {
+      int64_t header_size = VarintSize(tag) + VarintSize(size);
+      int64_t misalignment = (position_ - start + header_size) % kAlignment;
+      if (misalignment != 0) {
+        // The smallest padding field has a tag and a one byte length.
+        int64_t padding = kAlignment - misalignment;
+        if (padding < kPaddingTagSize + 1) {
+          padding += kAlignment;
+        }
+        static constexpr char kZeros[kAlignment] = {};
+        TF_RETURN_IF_ERROR(
+            WriteVarint(MakeTag(kPaddingField, kLengthDelimited)));
+        TF_RETURN_IF_ERROR(WriteVarint(padding - kPaddingTagSize - 1));
+        TF_RETURN_IF_ERROR(WriteRaw(kZeros, padding - kPaddingTagSize - 1));
+      }
+    }
+    TF_RETURN_IF_ERROR(WriteVarint(tag));
+    return WriteVarint(size);
+  }
+
+  template <typename NativeT>
+  absl::Status WriteVarints(int64_t start, const FieldInfo& field,
+                            absl::Span<const NativeT> values) {
+    int64_t size = 0;
+    for (NativeT value : values) {
+      size += VarintSize(ToVarint(value));
+    }
+    TF_RETURN_IF_ERROR(
+        WriteFieldHeader(start, field.field_number, size, /*align=*/false));
+    if (output_ == nullptr) {
+      position_ += size;
+      return absl::OkStatus();
+    }
+    for (NativeT value : values) {
+      TF_RETURN_IF_ERROR(WriteVarint(ToVarint(value)));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteVarint(uint64_t value) {
+    uint8_t bytes[kMaxVarintBytes];
+    uint8_t* end =
+        tsl::protobuf::io::CodedOutputStream::WriteVarint64ToArray(value,
+                                                                   bytes);
+    return WriteRaw(bytes, end - bytes);
+  }
+
+  // Writes `size` bytes of array data in the little endian byte order, where
+  // `unit_size` is the size of values that have a byte order.
+  absl::Status WriteLittleEndian(const char* data, int64_t size,
+                                 int64_t unit_size) {
+    if (kLittleEndian || unit_size == 1) {
+      return WriteRaw(data, size);
+    }
+    // Convert the data in chunks to avoid copying the whole array.
+    constexpr int64_t kChunkSize = 64 * 1024;
+    std::vector<char> chunk;
+    for (int64_t offset = 0; offset < size; offset += kChunkSize) {
+      int64_t chunk_size = std::min(kChunkSize, size - offset);
+      chunk.assign(data + offset, data + offset + chunk_size);
+      TF_RETURN_IF_ERROR(tsl::ByteSwapArray(chunk.data(), unit_size,
+                                            chunk_size / unit_size));
+      TF_RETURN_IF_ERROR(WriteRaw(chunk.data(), chunk_size));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteRaw(const void* data, int64_t size) {
+    position_ += size;
+    if (output_ == nullptr) {
+      return absl::OkStatus();
+    }
+    const char* src = static_cast<const char*>(data);
+    while (size > 0) {
+      if (available_ == 0) {
+        void* buffer;
+        int buffer_size;
+        if (!output_->Next(&buffer, &buffer_size)) {
+          return Internal("Failed to write a literal to the output stream");
+        }
+        buffer_ = static_cast<char*>(buffer);
+        available_ = buffer_size;
+      }
+      int64_t n = std::min(size, available_);
+      std::memcpy(buffer_, src, n);
+      buffer_ += n;
+      available_ -= n;
+      src += n;
+      size -= n;
+    }
+    return absl::OkStatus();
+  }
+
+  tsl::protobuf::io::ZeroCopyOutputStream* output_;
+  int64_t min_aligned_payload_bytes_;
+
+  // The number of bytes written (or counted) so far.
+  int64_t position_ = 0;
+
+  // The unused part of the last buffer returned by the output stream.
+  char* buffer_ = nullptr;
+  int64_t available_ = 0;
+};
+
+// Reads literals from a ZeroCopyInputStream, or from memory kept alive by a
+// storage object, in which case aligned raw array payloads are referenced by
+// the literals instead of copied.
+class LiteralReader {
+ public:
+  explicit LiteralReader(tsl::protobuf::io::ZeroCopyInputStream* input)
+      : input_(input) {}
+
+  LiteralReader(absl::Span<const char> data,
+                std::shared_ptr<const void> storage)
+      : buffer_(data.data()),
+        available_(data.size()),
+        storage_(std::move(storage)) {}
+
+  ~LiteralReader() {
+    if (input_ != nullptr && available_ > 0) {
+      input_->BackUp(available_);
+    }
+  }
+
+  // Reads a LiteralProto message which ends at the position `end`, or at the
+  // end of the input if `end` is not set.
+  absl::StatusOr<Literal> ReadMessage(std::optional<int64_t> end) {
+    std::optional<Shape> shape;
+    std::optional<FieldInfo> field;
+    std::optional<Literal> array;
+    std::vector<Literal> elements;
+
+    while (end.has_value() ? position_ < *end : Refill()) {
+      TF_ASSIGN_OR_RETURN(uint64_t tag, ReadVarint());
+      const uint64_t field_number = tag >> 3;
+      const auto wire_type = static_cast<WireType>(tag & 7);
+
+      if (field_number == kShapeField && wire_type == kLengthDelimited) {
+        if (shape.has_value()) {
+          return InvalidArgument("LiteralProto has more than one shape");
+        }
+        TF_ASSIGN_OR_RETURN(int64_t size, ReadLength());
+        std::string serialized(size, '\0');
+        TF_RETURN_IF_ERROR(ReadRaw(serialized.data(), size));
+        ShapeProto shape_proto;
+        if (!shape_proto.ParseFromString(serialized)) {
+          return InvalidArgument("Failed to parse the shape of LiteralProto");
+        }
+        TF_ASSIGN_OR_RETURN(shape, ShapeFromProto(shape_proto));
+        if (shape->IsArray()) {
+          TF_ASSIGN_OR_RETURN(field, GetFieldInfo(shape->element_type()));
+        }
+        continue;
+      }
+
+      // Data can't be interpreted without the shape, and protobuf serializers
+      // write the shape first anyway.
+      if (!shape.has_value() &&
+          LiteralProto::descriptor()->FindFieldByNumber(
+              static_cast<int>(field_number)) != nullptr) {
+        return InvalidArgument(
+            "LiteralProto field %d comes before the shape, which is not "
+            "supported",
+            field_number);
+      }
+
+      if (shape.has_value() && shape->IsTuple() &&
+          field_number == kTupleLiteralsField &&
+          wire_type == kLengthDelimited) {
+        TF_ASSIGN_OR_RETURN(int64_t size, ReadLength());
+        TF_ASSIGN_OR_RETURN(Literal element, ReadMessage(position_ + size));
+        elements.push_back(std::move(element));
+        continue;
+      }
+
+      if (field.has_value() && field_number == field->field_number &&
+          wire_type == kLengthDelimited) {
+        if (array.has_value()) {
+          return InvalidArgument("LiteralProto has more than one %s field",
+                                 PrimitiveType_Name(shape->element_type()));
+        }
+        TF_ASSIGN_OR_RETURN(int64_t size, ReadLength());
+        TF_ASSIGN_OR_RETURN(array, ReadArray(*shape, *field, size));
+        continue;
+      }
+
+      TF_RETURN_IF_ERROR(SkipField(wire_type));
+    }
+
+    if (end.has_value() && position_ != *end) {
+      return InvalidArgument("LiteralProto field overruns its tuple element");
+    }
+    if (!shape.has_value()) {
+      return InvalidArgument("LiteralProto has no shape");
+    }
+
+    if (shape->IsTuple()) {
+      if (elements.size() != ShapeUtil::TupleElementCount(*shape)) {
+        return InvalidArgument(
+            "Expected %d tuple elements in LiteralProto, has %d",
+            ShapeUtil::TupleElementCount(*shape), elements.size());
+      }
+      for (int64_t i = 0; i < elements.size(); ++i) {
+        if (!Shape::Equal().IgnoreElementSizeInLayout()(
+                elements[i].shape(), shape->tuple_shapes(i))) {
+          return InvalidArgument(
+              "Tuple element %d of LiteralProto has shape %s, expected %s", i,
+              ShapeUtil::HumanStringWithLayout(elements[i].shape()),
+              ShapeUtil::HumanStringWithLayout(shape->tuple_shapes(i)));
+        }
+      }
+      return Literal::MoveIntoTuple(absl::MakeSpan(elements));
+    }
+
+    if (!shape->IsArray()) {
+      return Literal(*shape);
+    }
+    if (array.has_value()) {
+      return *std::move(array);
+    }
+    // Empty fields are omitted from serialized messages.
+    return ReadArray(*shape, *field, /*size=*/0);
+  }
+
+ private:
+  // Reads an array payload of `size` bytes.
+  absl::StatusOr<Literal> ReadArray(const Shape& shape, const FieldInfo& field,
+                                    int64_t size) {
+    if (field.encoding == Encoding::kVarint) {
+      Literal literal(shape);
+      switch (shape.element_type()) {
+        case PRED:
+          TF_RETURN_IF_ERROR(ReadVarints(literal.data<bool>(), size));
+          break;
+        case S32:
+          TF_RETURN_IF_ERROR(ReadVarints(literal.data<int32_t>(), size));
+          break;
+        case S64:
+          TF_RETURN_IF_ERROR(ReadVarints(literal.data<int64_t>(), size));
+          break;
+        case U32:
+          TF_RETURN_IF_ERROR(ReadVarints(literal.data<uint32_t>(), size));
+          break;
+        case U64:
+          TF_RETURN_IF_ERROR(ReadVarints(literal.data<uint64_t>(), size));
+          break;
+        default:
+          return Internal("Unexpected varint type %s",
+                          PrimitiveType_Name(shape.element_type()));
+      }
+      return std::move(literal);
+    }
+
+    const int64_t expected_size = ShapeUtil::ByteSizeOf(shape);
+    if (size != expected_size) {
+      return InvalidArgument(
+          "Expected %d bytes of %s data in LiteralProto, has %d", expected_size,
+          PrimitiveType_Name(shape.element_type()), size);
+    }
+
+    // Reference aligned payloads in memory instead of copying them.
+    if (storage_ != nullptr && kLittleEndian && size > 0 && shape.is_static() &&
+        reinterpret_cast<uintptr_t>(buffer_) % kAlignment == 0) {
+      const char* data = buffer_;
+      TF_RETURN_IF_ERROR(Skip(size));
+      return Literal::CreateFromExternalData(
+          shape, absl::MakeSpan(data, size), storage_);
+    }
+
+    Literal literal(shape);
+    char* data = static_cast<char*>(literal.untyped_data());
+    TF_RETURN_IF_ERROR(ReadRaw(data, size));
+    const int64_t unit_size = RawUnitSize(shape.element_type());
+    if (!kLittleEndian && unit_size > 1) {
+      TF_RETURN_IF_ERROR(tsl::ByteSwapArray(data, unit_size, size / unit_size));
+    }
+    return std::move(literal);
+  }
+
+  template <typename NativeT>
+  absl::Status ReadVarints(absl::Span<NativeT> values, int64_t size) {
+    const int64_t end = position_ + size;
+    int64_t count = 0;
+    while (position_ < end) {
+      TF_ASSIGN_OR_RETURN(uint64_t value, ReadVarint());
+      if (count < values.size()) {
+        values[count] = static_cast<NativeT>(value);
+      }
+      ++count;
+    }
+    if (position_ != end || count != values.size()) {
+      return InvalidArgument(
+          "Expected %d elements in LiteralProto repeated field, has %d",
+          values.size(), count);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status SkipField(WireType wire_type) {
+    switch (wire_type) {
+      case kVarint:
+        return ReadVarint().status();
+      case kFixed64:
+        return Skip(8);
+      case kLengthDelimited: {
+        TF_ASSIGN_OR_RETURN(int64_t size, ReadLength());
+        return Skip(size);
+      }
+      case kFixed32:
+        return Skip(4);
+      default:
+        return InvalidArgument("Unsupported wire type %d in LiteralProto",
+                               static_cast<int>(wire_type));
+    }
+  }
+
+  // Makes sure that the current buffer is not empty. Returns false at the end
+  // of the input.
+  bool Refill() {
+    while (available_ == 0) {
+      if (input_ == nullptr) {
+        return false;
+      }
+      const void* data;
+      int size;
+      if (!input_->Next(&data, &size)) {
+        return false;
+      }
+      buffer_ = static_cast<const char*>(data);
+      available_ = size;
+    }
+    return true;
+  }
+
+  absl::StatusOr<uint64_t> ReadVarint() {
+    uint64_t result = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      if (!Refill()) {
+        return UnexpectedEnd();
+      }
+      const uint8_t byte = *buffer_;
+      ++buffer_;
+      --available_;
+      ++position_;
+      result |= uint64_t{byte & 0x7Fu} << shift;
+      if ((byte & 0x80) == 0) {
+        return result;
+      }
+    }
+    return InvalidArgument("Malformed varint in serialized LiteralProto");
+  }
+
+  absl::StatusOr<int64_t> ReadLength() {
+    TF_ASSIGN_OR_RETURN(uint64_t length, ReadVarint());
+    if (length > std::numeric_limits<int64_t>::max()) {
+      return InvalidArgument("Malformed field length in LiteralProto");
+    }
+    return static_cast<int64_t>(length);
+  }
+
+  absl::Status ReadRaw(char* dest, int64_t size) {
+    while (size > 0) {
+      if (!Refill()) {
+        return UnexpectedEnd();
+      }
+      int64_t n = std::min(size, available_);
+      std::memcpy(dest, buffer_, n);
+      buffer_ += n;
+      available_ -= n;
+      position_ += n;
+      dest += n;
+      size -= n;
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Skip(int64_t size) {
+    int64_t n = std::min(size, available_);
+    buffer_ += n;
+    available_ -= n;
+    position_ += n;
+    size -= n;
+    while (size > 0) {
+      if (input_ == nullptr) {
+        return UnexpectedEnd();
+      }
+      int count = static_cast<int>(
+          std::min<int64_t>(size, std::numeric_limits<int>::max()));
+      if (!input_->Skip(count)) {
+        return UnexpectedEnd();
+      }
+      position_ += count;
+      size -= count;
+    }
+    return absl::OkStatus();
+  }
+
+  tsl::protobuf::io::ZeroCopyInputStream* input_ = nullptr;
+
+  // The number of bytes consumed so far.
+  int64_t position_ = 0;
+
+  // The unconsumed part of the current buffer.
+  const char* buffer_ = nullptr;
+  int64_t available_ = 0;
+
+  // Keeps the memory that is read alive if not null.
+  std::shared_ptr<const void> storage_;
+};
+
+// Adapts tsl::WritableFile to CopyingOutputStreamAdaptor.
+class WritableFileStream : public tsl::protobuf::io::CopyingOutputStream {
+ public:
+  explicit WritableFileStream(tsl::WritableFile* file) : file_(file) {}
+
+  bool Write(const void* buffer, int size) override {
+    status_ = file_->Append(
+        absl::string_view(static_cast<const char*>(buffer), size));
+    return status_.ok();
+  }
+
+  const absl::Status& status() const { return status_; }
+
+ private:
+  tsl::WritableFile* file_;
+  absl::Status status_;
+};
+
+// Adapts tsl::RandomAccessFile to CopyingInputStreamAdaptor.
+class RandomAccessFileStream : public tsl::protobuf::io::CopyingInputStream {
+ public:
+  explicit RandomAccessFileStream(tsl::RandomAccessFile* file) : file_(file) {}
+
+  int Read(void* buffer, int size) override {
+    absl::string_view result;
+    absl::Status status =
+        file_->Read(offset_, size, &result, static_cast<char*>(buffer));
+    // Reads past the end of the file return the remaining data and OutOfRange.
+    if (!status.ok() && !absl::IsOutOfRange(status)) {
+      status_ = status;
+      return -1;
+    }
+    if (result.data() != buffer) {
+      std::memmove(buffer, result.data(), result.size());
+    }
+    offset_ += result.size();
+    return result.size();
+  }
+
+  const absl::Status& status() const { return status_; }
+
+ private:
+  tsl::RandomAccessFile* file_;
+  uint64_t offset_ = 0;
+  absl::Status status_;
+};
+
+}  // namespace
+
+absl::Status WriteLiteralToStream(
+    const LiteralBase& literal,
+    tsl::protobuf::io::ZeroCopyOutputStream* output,
+    int64_t min_aligned_payload_bytes) {
+  if (!literal.IsKnown()) {
+    return InvalidArgument("Can't serialize a literal with unknown values");
+  }
+  LiteralWriter writer(output, min_aligned_payload_bytes);
+  return writer.WriteMessage(literal, /*index=*/{});
+}
+
+absl::StatusOr<Literal> ReadLiteralFromStream(
+    tsl::protobuf::io::ZeroCopyInputStream* input) {
+  LiteralReader reader(input);
+  return reader.ReadMessage(/*end=*/std::nullopt);
+}
+
+absl::Status WriteLiteralToFile(tsl::Env* env, const std::string& path,
+                                const LiteralBase& literal,
+                                int64_t min_aligned_payload_bytes) {
+  std::unique_ptr<tsl::WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(path, &file));
+
+  WritableFileStream stream(file.get());
+  {
+    tsl::protobuf::io::CopyingOutputStreamAdaptor output(&stream,
+                                                         kFileBlockSize);
+    absl::Status status =
+        WriteLiteralToStream(literal, &output, min_aligned_payload_bytes);
+    if (status.ok() && !output.Flush()) {
+      status = Internal("Failed to write a literal to %s", path);
+    }
+    TF_RETURN_IF_ERROR(stream.status());
+    TF_RETURN_IF_ERROR(status);
+  }
+  return file->Close();
+}
+
+absl::StatusOr<Literal> ReadLiteralFromFile(tsl::Env* env,
+                                            const std::string& path) {
+  std::unique_ptr<tsl::RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(path, &file));
+
+  RandomAccessFileStream stream(file.get());
+  tsl::protobuf::io::CopyingInputStreamAdaptor input(&stream, kFileBlockSize);
+  absl::StatusOr<Literal> literal = ReadLiteralFromStream(&input);
+  TF_RETURN_IF_ERROR(stream.status());
+  return literal;
+}
+
+absl::StatusOr<Literal> MemoryMapLiteralFile(tsl::Env* env,
+                                             const std::string& path) {
+  std::unique_ptr<tsl::ReadOnlyMemoryRegion> region;
+  absl::Status status = env->NewReadOnlyMemoryRegionFromFile(path, &region);
+  if (absl::IsUnimplemented(status)) {
+    return ReadLiteralFromFile(env, path);
+  }
+  TF_RETURN_IF_ERROR(status);
+
+  absl::Span<const char> data(static_cast<const char*>(region->data()),
+                              region->length());
+  LiteralReader reader(data,
+                       std::shared_ptr<tsl::ReadOnlyMemoryRegion>(
+                           std::move(region)));
+  return reader.ReadMessage(/*end=*/std::nullopt);
+}
+
+}  // namespace xla
@@ -0,0 +1,86 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_LITERAL_STREAM_H_
+#define XLA_LITERAL_STREAM_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/literal.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/protobuf.h"
+
+namespace xla {
+
+// Streaming serialization of literals in the LiteralProto wire format.
+//
+// LiteralBase::ToProto and MutableLiteralBase::CreateFromProto go through a
+// LiteralProto message, which holds a copy of all the literal data, and the
+// serialized message is yet another copy. The functions below write and read
+// the same wire format directly to and from a stream, so large literals are
+// never materialized more than once, and literals in files can be memory
+// mapped without copying their data at all.
+//
+// The serialized literal can be parsed as a regular LiteralProto, and any
+// serialized LiteralProto can be read back, as long as its shape comes before
+// its data (protobuf serializers write fields in field number order, so this
+// holds for all of them). Repeated fields must be packed, as they are by
+// default in proto3.
+
+// Array payloads of at least this many bytes are aligned by default to
+// Literal::kExternalDataAlignment bytes relative to the start of the
+// serialized literal, which allows MemoryMapLiteralFile to use them in place.
+inline constexpr int64_t kDefaultMinAlignedPayloadBytes = 4096;
+
+// Writes `literal` to `output` in the LiteralProto wire format. Array payloads
+// of at least `min_aligned_payload_bytes` bytes are aligned by inserting
+// padding (an unknown field ignored by LiteralProto parsers) in front of them;
+// a non-positive value disables alignment. `literal` must be known.
+absl::Status WriteLiteralToStream(
+    const LiteralBase& literal,
+    tsl::protobuf::io::ZeroCopyOutputStream* output,
+    int64_t min_aligned_payload_bytes = kDefaultMinAlignedPayloadBytes);
+
+// Reads a literal serialized in the LiteralProto wire format from `input`,
+// which must contain nothing else. The data is copied from the stream directly
+// into the literal buffers.
+absl::StatusOr<Literal> ReadLiteralFromStream(
+    tsl::protobuf::io::ZeroCopyInputStream* input);
+
+// Writes `literal` to the file at `path` with WriteLiteralToStream.
+absl::Status WriteLiteralToFile(
+    tsl::Env* env, const std::string& path, const LiteralBase& literal,
+    int64_t min_aligned_payload_bytes = kDefaultMinAlignedPayloadBytes);
+
+// Reads a literal from the file at `path` with ReadLiteralFromStream.
+absl::StatusOr<Literal> ReadLiteralFromFile(tsl::Env* env,
+                                            const std::string& path);
+
+// Memory maps the file at `path` and reads a literal from it. Array payloads
+// which are aligned in the file (see WriteLiteralToStream) and don't need a
+// byte order conversion are not copied: the returned literal references the
+// mapped file, which stays mapped for as long as the literal, or any literal
+// that its arrays are moved into, is alive (see
+// Literal::CreateFromExternalData). Other arrays are copied. Falls back to
+// ReadLiteralFromFile if the file system doesn't support memory mapping.
+absl::StatusOr<Literal> MemoryMapLiteralFile(tsl::Env* env,
+                                             const std::string& path);
+
+}  // namespace xla
+
+#endif  // XLA_LITERAL_STREAM_H_
@@ -0,0 +1,225 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/literal_stream.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/random/random.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/primitive_util.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/test.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/protobuf.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Returns a literal of the given shape filled with random values.
+Literal MakeRandomLiteral(const Shape& shape) {
+  absl::InsecureBitGen bitgen(std::seed_seq({42}));
+  Literal literal(shape);
+  ShapeUtil::ForEachSubshape(
+      shape, [&](const Shape& subshape, const ShapeIndex& shape_index) {
+        if (!subshape.IsArray()) {
+          return;
+        }
+        primitive_util::ArrayTypeSwitch<void>(
+            [&](auto primitive_type) {
+              using NativeT = primitive_util::NativeTypeOf<primitive_type>;
+              for (auto& element : literal.data<NativeT>(shape_index)) {
+                if constexpr (std::is_same_v<NativeT, bool>) {
+                  element = absl::Uniform<int>(bitgen, 0, 2);
+                } else if constexpr (primitive_util::IsComplexType(
+                                         primitive_type)) {
+                  element = NativeT(absl::Uniform<double>(bitgen, -1.0, 1.0),
+                                    absl::Uniform<double>(bitgen, -1.0, 1.0));
+                } else if constexpr (primitive_util::IsFloatingPointType(
+                                         primitive_type)) {
+                  element = static_cast<NativeT>(
+                      absl::Uniform<double>(bitgen, -1.0, 1.0));
+                } else {
+                  element =
+                      static_cast<NativeT>(absl::Uniform<uint64_t>(bitgen));
+                }
+              }
+            },
+            subshape.element_type());
+      });
+  return literal;
+}
+
+std::string WriteToString(const LiteralBase& literal,
+                          int64_t min_aligned_payload_bytes) {
+  std::string serialized;
+  {
+    tsl::protobuf::io::StringOutputStream output(&serialized);
+    TF_CHECK_OK(
+        WriteLiteralToStream(literal, &output, min_aligned_payload_bytes));
+  }
+  return serialized;
+}
+
+absl::StatusOr<Literal> ReadFromString(const std::string& serialized) {
+  // Use small blocks to exercise reads across buffer boundaries.
+  tsl::protobuf::io::ArrayInputStream input(serialized.data(),
+                                            serialized.size(),
+                                            /*block_size=*/7);
+  return ReadLiteralFromStream(&input);
+}
+
+class LiteralStreamTest : public ::testing::TestWithParam<Shape> {
+ public:
+  static std::vector<Shape> GenerateParams() {
+    std::vector<Shape> params;
+    for (PrimitiveType element_type :
+         {PRED,          S4,         U4,         S8,     U8,     S16,
+          U16,           S32,        U32,        S64,    U64,    F16,
+          F32,           F64,        BF16,       F8E5M2, F8E4M3, F8E4M3FN,
+          F8E4M3B11FNUZ, F8E5M2FNUZ, F8E4M3FNUZ, F8E3M4, C64,    C128}) {
+      for (const DimensionVector& dimensions : {
+               DimensionVector{},
+               DimensionVector{0},
+               DimensionVector{7},
+               DimensionVector{64, 33},
+           }) {
+        params.push_back(ShapeUtil::MakeShape(element_type, dimensions));
+      }
+    }
+    params.push_back(ShapeUtil::MakeTupleShape({}));
+    params.push_back(ShapeUtil::MakeTupleShape({
+        ShapeUtil::MakeShape(S32, {5}),
+        ShapeUtil::MakeTupleShape({
+            ShapeUtil::MakeShape(F32, {1024}),
+            ShapeUtil::MakeTokenShape(),
+        }),
+        ShapeUtil::MakeShape(BF16, {3, 512}),
+    }));
+    return params;
+  }
+};
+
+TEST_P(LiteralStreamTest, RoundTrip) {
+  Literal literal = MakeRandomLiteral(GetParam());
+
+  for (int64_t min_aligned_payload_bytes : {0, 1, 4096}) {
+    std::string serialized = WriteToString(literal, min_aligned_payload_bytes);
+
+    // The result is a valid LiteralProto.
+    LiteralProto proto;
+    ASSERT_TRUE(proto.ParseFromString(serialized));
+    TF_ASSERT_OK_AND_ASSIGN(Literal from_proto,
+                            Literal::CreateFromProto(proto));
+    EXPECT_EQ(from_proto, literal);
+
+    TF_ASSERT_OK_AND_ASSIGN(Literal read, ReadFromString(serialized));
+    EXPECT_EQ(read, literal);
+  }
+}
+
+TEST_P(LiteralStreamTest, ReadLiteralProto) {
+  Literal literal = MakeRandomLiteral(GetParam());
+  std::string serialized = literal.ToProto().SerializeAsString();
+  TF_ASSERT_OK_AND_ASSIGN(Literal read, ReadFromString(serialized));
+  EXPECT_EQ(read, literal);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LiteralStreamTestInstantiation, LiteralStreamTest,
+    ::testing::ValuesIn(LiteralStreamTest::GenerateParams()));
+
+TEST(LiteralStreamFileTest, MemoryMapLiteralFile) {
+  Literal literal = MakeRandomLiteral(ShapeUtil::MakeTupleShape({
+      ShapeUtil::MakeShape(F32, {256, 64}),
+      ShapeUtil::MakeShape(S32, {16}),
+      ShapeUtil::MakeShape(C64, {1024}),
+  }));
+
+  tsl::Env* env = tsl::Env::Default();
+  std::string path =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "memory_mapped_literal.pb");
+  TF_ASSERT_OK(WriteLiteralToFile(env, path, literal));
+
+  TF_ASSERT_OK_AND_ASSIGN(Literal read, ReadLiteralFromFile(env, path));
+  EXPECT_EQ(read, literal);
+  EXPECT_FALSE(read.HasExternalStorage({0}));
+
+  TF_ASSERT_OK_AND_ASSIGN(Literal mapped, MemoryMapLiteralFile(env, path));
+  EXPECT_EQ(mapped, literal);
+
+  // Large aligned payloads are used in place, varints are always copied.
+  EXPECT_TRUE(mapped.HasExternalStorage({0}));
+  EXPECT_FALSE(mapped.HasExternalStorage({1}));
+  EXPECT_TRUE(mapped.HasExternalStorage({2}));
+
+  // The mapped data outlives the tuple it was read into.
+  Literal element = std::move(mapped.DecomposeTuple()[0]);
+  EXPECT_TRUE(element.HasExternalStorage());
+  EXPECT_EQ(element, LiteralSlice(literal, {0}));
+}
+
+TEST(LiteralStreamFileTest, MemoryMapUnalignedLiteralFile) {
+  Literal literal = MakeRandomLiteral(ShapeUtil::MakeShape(F32, {1024}));
+
+  tsl::Env* env = tsl::Env::Default();
+  std::string path =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "unaligned_literal.pb");
+  TF_ASSERT_OK(
+      WriteLiteralToFile(env, path, literal, /*min_aligned_payload_bytes=*/0));
+
+  // Without padding the payload follows the shape and is not aligned.
+  TF_ASSERT_OK_AND_ASSIGN(Literal mapped, MemoryMapLiteralFile(env, path));
+  EXPECT_FALSE(mapped.HasExternalStorage());
+  EXPECT_EQ(mapped, literal);
+}
+
+TEST(LiteralStreamReadTest, ReadInvalidLiterals) {
+  Literal literal = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  std::string serialized =
+      WriteToString(literal, /*min_aligned_payload_bytes=*/0);
+
+  EXPECT_THAT(ReadFromString(serialized.substr(0, serialized.size() - 1))
+                  .status()
+                  .message(),
+              HasSubstr("Unexpected end"));
+
+  LiteralProto proto = literal.ToProto();
+  proto.mutable_f32s()->RemoveLast();
+  EXPECT_THAT(ReadFromString(proto.SerializeAsString()).status().message(),
+              HasSubstr("Expected 16 bytes of F32 data"));
+
+  proto.clear_shape();
+  EXPECT_THAT(ReadFromString(proto.SerializeAsString()).status().message(),
+              HasSubstr("comes before the shape"));
+}
+
+}  // namespace
+}  // namespace xla
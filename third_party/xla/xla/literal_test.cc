@@ -21,6 +21,7 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <random>
 #include <string>
 #include <tuple>
@@ -2876,6 +2877,58 @@ TEST_F(LiteralUtilTest, Compare4BitType) {
   EXPECT_EQ(literal1, literal2);
 }
 
+TEST_F(LiteralUtilTest, CreateFromExternalData) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {4, 8});
+  auto storage = std::make_shared<Literal>(
+      LiteralUtil::CreateR2FromArray2D<float>(Array2D<float>(4, 8, 1.0f)));
+  absl::Span<const char> data(static_cast<const char*>(storage->untyped_data()),
+                              storage->size_bytes());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal literal, Literal::CreateFromExternalData(shape, data, storage));
+  EXPECT_TRUE(literal.HasExternalStorage());
+  EXPECT_EQ(literal.untyped_data(), storage->untyped_data());
+  EXPECT_EQ(literal, *storage);
+
+  // External storage survives moves and tuple decomposition.
+  std::vector<Literal> elements;
+  elements.push_back(std::move(literal));
+  Literal tuple = Literal::MoveIntoTuple(absl::MakeSpan(elements));
+  EXPECT_TRUE(tuple.HasExternalStorage({0}));
+  Literal element = std::move(tuple.DecomposeTuple()[0]);
+  EXPECT_TRUE(element.HasExternalStorage());
+
+  // Mutating the literal makes a private copy of the external data.
+  element.Set<float>({0, 0}, 2.0f);
+  EXPECT_FALSE(element.HasExternalStorage());
+  EXPECT_NE(element.untyped_data(), storage->untyped_data());
+  EXPECT_EQ(element.Get<float>({0, 0}), 2.0f);
+  EXPECT_EQ(element.Get<float>({3, 7}), 1.0f);
+  EXPECT_EQ(storage->Get<float>({0, 0}), 1.0f);
+}
+
+TEST_F(LiteralUtilTest, CreateFromExternalDataInvalidArguments) {
+  auto storage = std::make_shared<Literal>(
+      LiteralUtil::CreateR1<float>(std::vector<float>(32, 1.0f)));
+  const char* data = static_cast<const char*>(storage->untyped_data());
+
+  EXPECT_THAT(Literal::CreateFromExternalData(ShapeUtil::MakeShape(F32, {32}),
+                                              {data + 4, 124}, storage)
+                  .status()
+                  .message(),
+              HasSubstr("must be aligned"));
+  EXPECT_THAT(Literal::CreateFromExternalData(ShapeUtil::MakeShape(F32, {16}),
+                                              {data, 128}, storage)
+                  .status()
+                  .message(),
+              HasSubstr("expected 64 bytes"));
+  EXPECT_THAT(Literal::CreateFromExternalData(
+                  ShapeUtil::MakeShape(F32, {32}, {true}), {data, 128}, storage)
+                  .status()
+                  .message(),
+              HasSubstr("static shape"));
+}
+
 class LiteralSerializationTest : public ::testing::Test,
                                  public ::testing::WithParamInterface<Shape> {
  public:
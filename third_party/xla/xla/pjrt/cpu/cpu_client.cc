@@ -46,6 +46,9 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "unsupported/Eigen/CXX11/Tensor"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "xla/array.h"
 #include "xla/backends/cpu/runtime/buffer_allocations.h"
@@ -65,6 +68,7 @@ limitations under the License.
 #include "xla/literal_util.h"
 #include "xla/pjrt/compile_options.pb.h"
 #include "xla/pjrt/cpu/abstract_tfrt_cpu_buffer.h"
+#include "xla/pjrt/cpu/cpu_compilation_cache.h"
 #include "xla/pjrt/cpu/cpu_topology.h"
 #include "xla/pjrt/cpu/tracked_tfrt_cpu_device_buffer.h"
 #include "xla/pjrt/host_memory_spaces.h"
@@ -397,39 +401,25 @@ absl::StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
 
   return std::unique_ptr<PjRtClient>(std::make_unique<TfrtCpuClient>(
       options.process_id, std::move(devices), std::move(options.collectives),
-      num_threads, options.asynchronous));
-}
-
-// An upper bound on the number of threads to use for intra-op parallelism. It
-// is nearly impossible to utilize efficiently more than 256 threads for compute
-// intensive operations that are supposed to run inside the intra-op threadpool.
-static const size_t kMaxIntraOpThreads = 256;
-
-static tsl::ThreadOptions GetThreadOptions() {
-  tsl::ThreadOptions thread_options;
-  // On Mac OS the default stack size is 512KiB, which is too small for some
-  // BLAS and LAPACK functions (https://github.com/google/jax/issues/20428).
-  // On Linux we also observed that 2MB wasn't enough to run some OpenBLAS
-  // functions.
-  thread_options.stack_size = 8 * 1024 * 1024;
-  return thread_options;
+      num_threads, options.asynchronous, options.compilation_cache_dir,
+      options.execution_pool));
 }
 
 TfrtCpuClient::TfrtCpuClient(
     int process_index, std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
     std::shared_ptr<cpu::CollectivesInterface> collectives, size_t num_threads,
-    bool asynchronous)
+    bool asynchronous, std::optional<std::string> compilation_cache_dir,
+    std::shared_ptr<CpuExecutionPool> execution_pool)
     : process_index_(process_index),
       owned_devices_(std::move(devices)),
       computation_placer_(std::make_unique<ComputationPlacer>()),
-      eigen_intraop_pool_(new tsl::thread::ThreadPool(
-          tsl::Env::Default(), GetThreadOptions(), "XLAEigen",
-          std::min(num_threads, kMaxIntraOpThreads))),
-      eigen_intraop_device_(
-          new Eigen::ThreadPoolDevice(eigen_intraop_pool_->AsEigenThreadPool(),
-                                      eigen_intraop_pool_->NumThreads())),
+      execution_pool_(execution_pool != nullptr
+                          ? std::move(execution_pool)
+                          : std::make_shared<CpuExecutionPool>(
+                                CpuExecutionPool::Options{num_threads})),
       pjrt_client_thread_pool_(
-          new tsl::thread::ThreadPool(tsl::Env::Default(), GetThreadOptions(),
+          new tsl::thread::ThreadPool(tsl::Env::Default(),
+                                      GetCpuThreadOptions(),
                                       "XLATfrtCpuClient", num_threads)),
       async_work_runner_(std::make_unique<ThreadPoolAsyncWorkRunner>(
           pjrt_client_thread_pool_.get())),
@@ -437,6 +427,10 @@ TfrtCpuClient::TfrtCpuClient(
           tsl::MakeAvailableAsyncValueRef<CpuEvent>()),
       transpose_cache_(1024),
       collectives_(std::move(collectives)),
+      compilation_cache_(compilation_cache_dir.has_value()
+                             ? std::make_unique<CpuCompilationCache>(
+                                   *std::move(compilation_cache_dir))
+                             : nullptr),
       topology_(TfrtCpuTopologyDescription::Create(
           platform_id(), platform_name(), platform_version(), owned_devices_,
           cpu::DetectMachineAttributes())),
@@ -737,6 +731,18 @@ static absl::StatusOr<std::unique_ptr<xla::Executable>> JitCompile(
                              compile_options);
 }
 
+// Describes the machine code that the CPU compiler generates for this host,
+// as part of the keys of the compilation cache.
+static std::string GetHostTargetDescription(const DebugOptions& debug_options) {
+  std::unique_ptr<llvm::TargetMachine> target_machine =
+      cpu::SimpleOrcJIT::InferTargetMachineForJIT(
+          llvm::TargetOptions(), llvm::CodeGenOptLevel::Default,
+          debug_options.xla_cpu_max_isa());
+  return absl::StrCat(target_machine->getTargetTriple().str(), ";",
+                      target_machine->getTargetCPU().str(), ";",
+                      target_machine->getTargetFeatureString().str());
+}
+
 absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> TfrtCpuClient::Compile(
     const XlaComputation& computation, CompileOptions options) {
   tsl::profiler::TraceMe traceme("TfrtCpuClient::Compile (XlaComputation)");
@@ -821,11 +827,38 @@ absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> TfrtCpuClient::Compile(
   if (!compile_options.thread_pool) {
     compile_options.thread_pool = pjrt_client_thread_pool();
   }
+  const int num_threads = eigen_intraop_device()->getPool()->NumThreads();
+
+  // Problems with the compilation cache are not fatal, the computation is
+  // compiled instead.
+  std::string cache_key;
+  if (compilation_cache_ != nullptr) {
+    const std::string target = absl::StrCat(
+        GetHostTargetDescription(execution_options.debug_options()),
+        ";num_threads=", num_threads);
+    absl::StatusOr<std::string> key = CpuCompilationCache::GetKey(
+        computation.proto(), input_options, execution_options.debug_options(),
+        target);
+    absl::StatusOr<std::optional<std::string>> serialized =
+        key.ok() ? compilation_cache_->Lookup(*key) : key.status();
+    if (serialized.ok() && serialized->has_value()) {
+      absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> executable =
+          DeserializeExecutable(**serialized, input_options);
+      if (executable.ok()) return executable;
+      serialized = executable.status();
+    }
+    if (!serialized.ok()) {
+      LOG(WARNING) << "Failed to load the executable from the CPU "
+                      "compilation cache: "
+                   << serialized.status();
+    }
+    if (key.ok()) cache_key = *std::move(key);
+  }
+
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<Executable> cpu_executable,
       JitCompile(computation, argument_layout_pointers, build_options,
-                 execution_options, compile_options,
-                 eigen_intraop_device()->getPool()->NumThreads()));
+                 execution_options, compile_options, num_threads));
   auto cpu_executable_ptr =
       tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable.get());
 
@@ -853,6 +886,18 @@ absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> TfrtCpuClient::Compile(
   TF_RETURN_IF_ERROR(
       executable->SetUpDonation(options.parameter_is_tupled_arguments));
 
+  if (!cache_key.empty()) {
+    absl::StatusOr<std::string> serialized = executable->SerializeExecutable();
+    absl::Status status =
+        serialized.ok() ? compilation_cache_->Insert(cache_key, *serialized)
+                        : serialized.status();
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to store the executable in the CPU compilation "
+                      "cache: "
+                   << status;
+    }
+  }
+
   return std::unique_ptr<PjRtLoadedExecutable>(std::move(executable));
 }
 
@@ -1525,12 +1570,21 @@ absl::StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   auto compute_reservation = std::make_unique<Semaphore::ScopedReservation>(
       device->max_inflight_computations_semaphore().ScopedAcquire(1));
 
+  // Wait for admission to the execution pool, which might be shared with other
+  // executables and clients. Intra-op tasks of this execution (thunks, host
+  // kernel partitions and Eigen operations) are scheduled via a separate queue
+  // to interleave them with tasks of other executions.
+  std::unique_ptr<CpuExecutionPool::Admission> admission =
+      client_->execution_pool()->Admit(this, device->id());
+  std::shared_ptr<CpuExecutionPool::TaskQueue> task_queue =
+      client_->execution_pool()->CreateTaskQueue();
+
   ExecutableRunOptions run_options;
   run_options.set_run_id(run_id);
   run_options.set_device_ordinal(device->id());
   // Need to keep device_assignment alive until execution completes.
   run_options.set_device_assignment(device_assignment.get());
-  run_options.set_intra_op_thread_pool(client_->eigen_intraop_device());
+  run_options.set_intra_op_thread_pool(task_queue->eigen_device());
 
   auto cpu_run_options = std::make_shared<cpu::CpuExecutableRunOptions>();
   cpu_run_options->set_collectives(client_->collectives_.get());
@@ -1615,11 +1669,9 @@ absl::StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
           cpu::Thunk::CustomCallExecuteParams custom_call_execute_params,
           cpu::Thunk::CustomCallExecuteParams::Create(&run_options));
 
-      cpu::Thunk::TaskRunner task_runner =
-          [&run_options](cpu::Thunk::Task task) {
-            run_options.intra_op_thread_pool()->getPool()->Schedule(
-                std::move(task));
-          };
+      cpu::Thunk::TaskRunner task_runner = [&](cpu::Thunk::Task task) {
+        task_queue->Schedule(std::move(task));
+      };
 
       cpu::Thunk::ExecuteParams execute_params = {
           &cpu_executable->function_registry(),
@@ -1680,6 +1732,7 @@ absl::StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
          device_assignment = std::move(device_assignment),
          cpu_run_options = std::move(cpu_run_options),
          compute_reservation = std::move(compute_reservation),
+         admission = std::move(admission), task_queue = std::move(task_queue),
          tuplized_arg = std::move(tuplized_arg),
          donation_transactions = std::move(donation_transactions),
          execute_event = std::move(ready_on_exit).Release(),
@@ -1754,11 +1807,9 @@ absl::StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
                 custom_call_params =
                     cpu::Thunk::CustomCallExecuteParams::Create(&run_options);
 
-            cpu::Thunk::TaskRunner task_runner =
-                [&run_options](cpu::Thunk::Task task) {
-                  run_options.intra_op_thread_pool()->getPool()->Schedule(
-                      std::move(task));
-                };
+            cpu::Thunk::TaskRunner task_runner = [&](cpu::Thunk::Task task) {
+              task_queue->Schedule(std::move(task));
+            };
 
             if (collective_params.ok()) {
               cpu::Thunk::ExecuteParams execute_params = {
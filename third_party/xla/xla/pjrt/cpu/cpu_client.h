@@ -43,6 +43,8 @@ limitations under the License.
 #include "xla/layout.h"
 #include "xla/literal.h"
 #include "xla/pjrt/cpu/abstract_tfrt_cpu_buffer.h"
+#include "xla/pjrt/cpu/cpu_compilation_cache.h"
+#include "xla/pjrt/cpu/cpu_execution_pool.h"
 #include "xla/pjrt/cpu/cpu_topology.h"
 #include "xla/pjrt/cpu/tracked_tfrt_cpu_device_buffer.h"
 #include "xla/pjrt/pjrt_client.h"
@@ -258,7 +260,9 @@ class TfrtCpuClient final : public PjRtClient {
   TfrtCpuClient(int process_index,
                 std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
                 std::shared_ptr<cpu::CollectivesInterface> collectives,
-                size_t num_threads, bool asynchronous);
+                size_t num_threads, bool asynchronous,
+                std::optional<std::string> compilation_cache_dir = std::nullopt,
+                std::shared_ptr<CpuExecutionPool> execution_pool = nullptr);
   ~TfrtCpuClient() override;
 
   int process_index() const override { return process_index_; }
@@ -398,9 +402,11 @@ class TfrtCpuClient final : public PjRtClient {
   }
 
   Eigen::ThreadPoolDevice* eigen_intraop_device() const {
-    return eigen_intraop_device_.get();
+    return execution_pool_->eigen_device();
   }
 
+  CpuExecutionPool* execution_pool() const { return execution_pool_.get(); }
+
   tsl::AsyncValueRef<CpuEvent> GetLastCollectiveLaunchEvent() {
     absl::MutexLock lock(&mu_);
     return last_collective_launch_event_.CopyRef();
@@ -443,9 +449,8 @@ class TfrtCpuClient final : public PjRtClient {
   // Pointers to `owned_memory_spaces_`.
   std::vector<PjRtMemorySpace*> memory_spaces_;
 
-  // TODO(zhangqiaorjc): Use tsl::compat::EigenHostContextThreadPool.
-  std::unique_ptr<tsl::thread::ThreadPool> eigen_intraop_pool_;
-  std::unique_ptr<Eigen::ThreadPoolDevice> eigen_intraop_device_;
+  // Thread pool for running computations. Can be shared with other clients.
+  std::shared_ptr<CpuExecutionPool> execution_pool_;
 
   // Thread pool for running PjRtClient tasks.
   std::unique_ptr<tsl::thread::ThreadPool> pjrt_client_thread_pool_;
@@ -473,6 +478,9 @@ class TfrtCpuClient final : public PjRtClient {
 
   std::shared_ptr<cpu::CollectivesInterface> collectives_;
 
+  // Persistent cache of compiled executables. Null if disabled.
+  std::unique_ptr<CpuCompilationCache> compilation_cache_;
+
   xla::TfrtCpuTopologyDescription topology_;
 
   // Used to control whether asynchronous computation dispatch is available for
@@ -709,6 +717,19 @@ struct CpuClientOptions {
   // Distributed collectives implementation. Optional. If not provided, an
   // in-process collectives implementation will be used.
   std::shared_ptr<cpu::CollectivesInterface> collectives;
+
+  // Directory of a compilation cache shared by processes on hosts with the
+  // same CPU. If provided, `Compile` loads the object code of computations
+  // that were already compiled with the same options instead of compiling
+  // them again, and stores the executables it compiles.
+  std::optional<std::string> compilation_cache_dir = std::nullopt;
+
+  // Thread pool for running computations. If provided, the client runs its
+  // computations in this pool instead of creating its own intra-op thread pool.
+  // Clients in the same process should share a pool to avoid oversubscribing
+  // CPU cores, and to apply admission control and fair scheduling across all
+  // running executables (see `CpuExecutionPool`).
+  std::shared_ptr<CpuExecutionPool> execution_pool;
 };
 absl::StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
     const CpuClientOptions& options);
@@ -34,6 +34,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/notification.h"
 #include "xla/ffi/ffi.h"
@@ -42,6 +43,7 @@ limitations under the License.
 #include "xla/hlo/parser/hlo_parser.h"
 #include "xla/literal.h"
 #include "xla/literal_util.h"
+#include "xla/pjrt/cpu/cpu_execution_pool.h"
 #include "xla/pjrt/host_memory_spaces.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_executable.h"
@@ -54,6 +56,7 @@ limitations under the License.
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/file_system.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/status_matchers.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
@@ -212,6 +215,123 @@ TEST(TfrtCpuClientTest, HloSnapshot) {
       LiteralUtil::CreateR2<float>({{11.0, 22.0}, {33.0, 44.0}, {55.0, 66.0}}));
 }
 
+TEST(TfrtCpuClientTest, CompilationCache) {
+  static constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[3] parameter(0)
+      ROOT add = f32[3] add(x, x)
+    })";
+
+  const std::string dir =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "cpu_client_compilation_cache");
+  int64_t undeleted_files, undeleted_dirs;
+  tsl::Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  CpuClientOptions cpu_options;
+  cpu_options.cpu_device_count = 1;
+  cpu_options.compilation_cache_dir = dir;
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+
+  // Compiles with a new client, as a new process would.
+  auto compile_and_run = [&]() -> absl::StatusOr<std::vector<float>> {
+    TF_ASSIGN_OR_RETURN(auto client, GetTfrtCpuClient(cpu_options));
+    TF_ASSIGN_OR_RETURN(auto executable,
+                        client->Compile(xla_computation, CompileOptions()));
+    std::vector<float> data{1.0, 2.0, 3.0};
+    TF_ASSIGN_OR_RETURN(
+        auto buffer,
+        client->BufferFromHostBuffer(
+            data.data(), F32, {3}, /*byte_strides=*/std::nullopt,
+            PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+            client->addressable_devices()[0]));
+    TF_ASSIGN_OR_RETURN(auto result,
+                        executable->Execute({{buffer.get()}}, /*options=*/{}));
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<Literal> literal,
+                        result[0][0]->ToLiteralSync());
+    return std::vector<float>(literal->data<float>().begin(),
+                              literal->data<float>().end());
+  };
+  auto entries = [&]() {
+    std::vector<std::string> paths;
+    EXPECT_TRUE(tsl::Env::Default()
+                    ->GetMatchingPaths(tsl::io::JoinPath(dir, "*"), &paths)
+                    .ok());
+    return paths;
+  };
+
+  // Stores the executable.
+  EXPECT_THAT(compile_and_run(), IsOkAndHolds(ElementsAre(2.0, 4.0, 6.0)));
+  std::vector<std::string> paths = entries();
+  ASSERT_EQ(paths.size(), 1);
+
+  // Loads the executable.
+  EXPECT_THAT(compile_and_run(), IsOkAndHolds(ElementsAre(2.0, 4.0, 6.0)));
+  EXPECT_EQ(entries(), paths);
+
+  // Compiles again and replaces entries that can't be loaded.
+  TF_ASSERT_OK(
+      tsl::WriteStringToFile(tsl::Env::Default(), paths[0], "corrupted"));
+  EXPECT_THAT(compile_and_run(), IsOkAndHolds(ElementsAre(2.0, 4.0, 6.0)));
+  std::string entry;
+  TF_ASSERT_OK(tsl::ReadFileToString(tsl::Env::Default(), paths[0], &entry));
+  EXPECT_NE(entry, "corrupted");
+}
+
+TEST(TfrtCpuClientTest, SharedExecutionPool) {
+  static constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[3] parameter(0)
+      ROOT add = f32[3] add(x, x)
+    })";
+
+  CpuExecutionPool::Options pool_options;
+  pool_options.num_threads = 2;
+  pool_options.max_inflight_executions_per_executable = 1;
+  auto pool = std::make_shared<CpuExecutionPool>(pool_options);
+
+  CpuClientOptions cpu_options;
+  cpu_options.cpu_device_count = 1;
+  cpu_options.execution_pool = pool;
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+
+  auto compile_and_run = [&](PjRtClient* client)
+      -> absl::StatusOr<std::vector<float>> {
+    TF_ASSIGN_OR_RETURN(auto executable,
+                        client->Compile(xla_computation, CompileOptions()));
+    std::vector<float> data{1.0, 2.0, 3.0};
+    TF_ASSIGN_OR_RETURN(
+        auto buffer,
+        client->BufferFromHostBuffer(
+            data.data(), F32, {3}, /*byte_strides=*/std::nullopt,
+            PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+            client->addressable_devices()[0]));
+    TF_ASSIGN_OR_RETURN(auto result,
+                        executable->Execute({{buffer.get()}}, /*options=*/{}));
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<Literal> literal,
+                        result[0][0]->ToLiteralSync());
+    return std::vector<float>(literal->data<float>().begin(),
+                              literal->data<float>().end());
+  };
+
+  // Two clients run computations in the same pool.
+  TF_ASSERT_OK_AND_ASSIGN(auto client0, GetTfrtCpuClient(cpu_options));
+  TF_ASSERT_OK_AND_ASSIGN(auto client1, GetTfrtCpuClient(cpu_options));
+  EXPECT_THAT(compile_and_run(client0.get()),
+              IsOkAndHolds(ElementsAre(2.0, 4.0, 6.0)));
+  EXPECT_THAT(compile_and_run(client1.get()),
+              IsOkAndHolds(ElementsAre(2.0, 4.0, 6.0)));
+
+  // Both executions were admitted to the shared pool.
+  EXPECT_EQ(pool->stats().num_admissions, 2);
+}
+
 TEST(TfrtCpuClientTest, AsyncTransferRawData) {
   TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(CpuClientOptions()));
   xla::Shape shape = ShapeUtil::MakeShape(U32, {3, 2});
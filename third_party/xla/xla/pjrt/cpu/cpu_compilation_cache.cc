@@ -0,0 +1,119 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/cpu/cpu_compilation_cache.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "xla/pjrt/compile_options.pb.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/service/hlo.pb.h"
+#include "xla/tsl/lib/strings/proto_serialization.h"
+#include "xla/util.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/random.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+
+CpuCompilationCache::CpuCompilationCache(std::string directory)
+    : directory_(std::move(directory)) {}
+
+absl::StatusOr<std::string> CpuCompilationCache::GetKey(
+    const HloModuleProto& computation, const CompileOptions& options,
+    const DebugOptions& debug_options, absl::string_view target) {
+  TF_ASSIGN_OR_RETURN(CompileOptionsProto options_proto, options.ToProto());
+  // The module id is unique within a process only, and doesn't change the
+  // compiled code.
+  HloModuleProto canonical_computation = computation;
+  canonical_computation.clear_id();
+  std::string serialized_computation;
+  std::string serialized_options;
+  std::string serialized_debug_options;
+  if (!tsl::SerializeToStringDeterministic(canonical_computation,
+                                           &serialized_computation) ||
+      !tsl::SerializeToStringDeterministic(options_proto,
+                                           &serialized_options) ||
+      !tsl::SerializeToStringDeterministic(debug_options,
+                                           &serialized_debug_options)) {
+    return Internal("Failed to serialize the computation or compile options");
+  }
+
+  tsl::Fprint128 fingerprint = tsl::Fingerprint128(serialized_computation);
+  fingerprint = tsl::FingerprintCat128(
+      fingerprint, tsl::Fingerprint128(serialized_options));
+  fingerprint = tsl::FingerprintCat128(
+      fingerprint, tsl::Fingerprint128(serialized_debug_options));
+  fingerprint =
+      tsl::FingerprintCat128(fingerprint, tsl::Fingerprint128(target));
+  return absl::StrFormat("xla_cpu_v%d_%016x%016x", kVersion,
+                         fingerprint.high64, fingerprint.low64);
+}
+
+absl::StatusOr<std::optional<std::string>> CpuCompilationCache::Lookup(
+    absl::string_view key) const {
+  tsl::Env* env = tsl::Env::Default();
+  const std::string path = GetPath(key);
+  if (absl::Status exists = env->FileExists(path); !exists.ok()) {
+    if (absl::IsNotFound(exists)) return std::nullopt;
+    return exists;
+  }
+  std::string serialized_executable;
+  TF_RETURN_IF_ERROR(
+      tsl::ReadFileToString(env, path, &serialized_executable));
+  VLOG(1) << "Loaded " << serialized_executable.size()
+          << " bytes from the CPU compilation cache: " << path;
+  return serialized_executable;
+}
+
+absl::Status CpuCompilationCache::Insert(
+    absl::string_view key, absl::string_view serialized_executable) const {
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory_));
+
+  // Write to a temporary file and rename it, so that readers never see a
+  // partially written entry, even if several processes compile the same
+  // computation at once.
+  const std::string path = GetPath(key);
+  const std::string temp_path =
+      absl::StrCat(path, ".tmp.", absl::Hex(tsl::random::New64()));
+  TF_RETURN_IF_ERROR(
+      tsl::WriteStringToFile(env, temp_path, serialized_executable));
+  if (absl::Status status = env->RenameFile(temp_path, path); !status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Stored " << serialized_executable.size()
+          << " bytes in the CPU compilation cache: " << path;
+  return absl::OkStatus();
+}
+
+std::string CpuCompilationCache::GetPath(absl::string_view key) const {
+  return tsl::io::JoinPath(directory_, key);
+}
+
+}  // namespace xla
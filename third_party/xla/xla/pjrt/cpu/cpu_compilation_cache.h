@@ -0,0 +1,77 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_PJRT_CPU_CPU_COMPILATION_CACHE_H_
+#define XLA_PJRT_CPU_CPU_COMPILATION_CACHE_H_
+
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/service/hlo.pb.h"
+#include "xla/xla.pb.h"
+
+namespace xla {
+
+// A compilation cache that keeps serialized CPU executables in a directory,
+// so that processes compiling the same computation for the same host load the
+// object code instead of running the HLO passes and LLVM codegen again.
+//
+// Each entry is a file named after its key, holding the output of
+// `PjRtLoadedExecutable::SerializeExecutable`. Entries are written to a
+// temporary file and renamed, so processes sharing the directory never read
+// partially written entries. Entries are never evicted.
+class CpuCompilationCache {
+ public:
+  // Version of the keys and entries. Bump it when the serialized executables
+  // become incompatible, e.g. the format of `CompilationResultProto` or the
+  // runtime ABI of the compiled kernels changes.
+  static constexpr int kVersion = 1;
+
+  explicit CpuCompilationCache(std::string directory);
+
+  // Returns the key of `computation` compiled with `options` for `target`, a
+  // description of the generated machine code, e.g. the LLVM target triple,
+  // CPU name and features. `debug_options` are the debug options the compiler
+  // actually uses, i.e. the ones in `options` or, if there are none, the ones
+  // set with XLA_FLAGS. Fails if `options` can't be serialized.
+  static absl::StatusOr<std::string> GetKey(const HloModuleProto& computation,
+                                            const CompileOptions& options,
+                                            const DebugOptions& debug_options,
+                                            absl::string_view target);
+
+  // Returns the serialized executable stored under `key`, or std::nullopt if
+  // there is none.
+  absl::StatusOr<std::optional<std::string>> Lookup(
+      absl::string_view key) const;
+
+  // Stores `serialized_executable` under `key`, replacing any previous entry.
+  absl::Status Insert(absl::string_view key,
+                      absl::string_view serialized_executable) const;
+
+  const std::string& directory() const { return directory_; }
+
+ private:
+  std::string GetPath(absl::string_view key) const;
+
+  std::string directory_;
+};
+
+}  // namespace xla
+
+#endif  // XLA_PJRT_CPU_CPU_COMPILATION_CACHE_H_
@@ -0,0 +1,142 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/cpu/cpu_compilation_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/service/hlo.pb.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace {
+
+HloModuleProto MakeComputation(const std::string& name) {
+  HloModuleProto computation;
+  computation.set_name(name);
+  return computation;
+}
+
+TEST(CpuCompilationCacheTest, KeysDependOnAllInputs) {
+  const HloModuleProto computation = MakeComputation("add");
+  CompileOptions options;
+  DebugOptions debug_options;
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string key,
+      CpuCompilationCache::GetKey(computation, options, debug_options,
+                                  "x86_64;skylake"));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string same_key,
+      CpuCompilationCache::GetKey(computation, options, debug_options,
+                                  "x86_64;skylake"));
+  EXPECT_EQ(key, same_key);
+
+  HloModuleProto same_computation = computation;
+  same_computation.set_id(42);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string same_computation_key,
+      CpuCompilationCache::GetKey(same_computation, options, debug_options,
+                                  "x86_64;skylake"));
+  EXPECT_EQ(key, same_computation_key);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string other_computation,
+      CpuCompilationCache::GetKey(MakeComputation("mul"), options,
+                                  debug_options, "x86_64;skylake"));
+  EXPECT_NE(key, other_computation);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string other_target,
+      CpuCompilationCache::GetKey(computation, options, debug_options,
+                                  "x86_64;haswell"));
+  EXPECT_NE(key, other_target);
+
+  CompileOptions other_options;
+  other_options.executable_build_options.mutable_debug_options()
+      ->set_xla_cpu_enable_fast_math(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string other_options_key,
+      CpuCompilationCache::GetKey(computation, other_options, debug_options,
+                                  "x86_64;skylake"));
+  EXPECT_NE(key, other_options_key);
+}
+
+TEST(CpuCompilationCacheTest, KeysDependOnEffectiveDebugOptions) {
+  // Compile options without debug options, as when the compiler uses the ones
+  // set with XLA_FLAGS.
+  const HloModuleProto computation = MakeComputation("add");
+  CompileOptions options;
+  DebugOptions debug_options;
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string key, CpuCompilationCache::GetKey(computation, options,
+                                                   debug_options, "x86_64"));
+
+  std::vector<DebugOptions> flipped(3, debug_options);
+  flipped[0].set_xla_cpu_enable_fast_math(true);
+  flipped[1].set_xla_cpu_use_thunk_runtime(true);
+  flipped[2].set_xla_cpu_autotune_level(1);
+  for (const DebugOptions& flipped_debug_options : flipped) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::string flipped_key,
+        CpuCompilationCache::GetKey(computation, options,
+                                    flipped_debug_options, "x86_64"));
+    EXPECT_NE(key, flipped_key);
+  }
+}
+
+TEST(CpuCompilationCacheTest, LookupAndInsert) {
+  const std::string directory =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "cpu_compilation_cache_test");
+  int64_t undeleted_files, undeleted_dirs;
+  tsl::Env::Default()
+      ->DeleteRecursively(directory, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  CpuCompilationCache cache(directory);
+
+  EXPECT_THAT(cache.Lookup("key"), tsl::testing::IsOkAndHolds(std::nullopt));
+
+  TF_ASSERT_OK(cache.Insert("key", "executable"));
+  EXPECT_THAT(cache.Lookup("key"),
+              tsl::testing::IsOkAndHolds(std::optional<std::string>(
+                  "executable")));
+  EXPECT_THAT(cache.Lookup("other_key"),
+              tsl::testing::IsOkAndHolds(std::nullopt));
+
+  // Entries are replaced and visible to other instances.
+  TF_ASSERT_OK(cache.Insert("key", "new executable"));
+  EXPECT_THAT(CpuCompilationCache(directory).Lookup("key"),
+              tsl::testing::IsOkAndHolds(std::optional<std::string>(
+                  "new executable")));
+
+  // No temporary files are left behind.
+  std::vector<std::string> children;
+  TF_ASSERT_OK(tsl::Env::Default()->GetChildren(directory, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+}  // namespace
+}  // namespace xla
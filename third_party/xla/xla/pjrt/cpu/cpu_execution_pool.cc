@@ -0,0 +1,212 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/cpu/cpu_execution_pool.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/pjrt/metrics.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+
+// An upper bound on the number of threads to use for intra-op parallelism. It
+// is nearly impossible to utilize efficiently more than 256 threads for compute
+// intensive operations that are supposed to run inside the intra-op threadpool.
+static constexpr size_t kMaxIntraOpThreads = 256;
+
+tsl::ThreadOptions GetCpuThreadOptions() {
+  tsl::ThreadOptions thread_options;
+  // On Mac OS the default stack size is 512KiB, which is too small for some
+  // BLAS and LAPACK functions (https://github.com/google/jax/issues/20428).
+  // On Linux we also observed that 2MB wasn't enough to run some OpenBLAS
+  // functions.
+  thread_options.stack_size = 8 * 1024 * 1024;
+  return thread_options;
+}
+
+CpuExecutionPool::CpuExecutionPool(Options options)
+    : options_(std::move(options)),
+      thread_pool_(std::make_unique<tsl::thread::ThreadPool>(
+          tsl::Env::Default(), GetCpuThreadOptions(), "XLAEigen",
+          std::clamp<size_t>(options_.num_threads, 1, kMaxIntraOpThreads))),
+      eigen_device_(std::make_unique<Eigen::ThreadPoolDevice>(
+          thread_pool_->AsEigenThreadPool(), thread_pool_->NumThreads())) {}
+
+CpuExecutionPool::~CpuExecutionPool() {
+  // Wait for all scheduled tasks to complete before destroying the task queues.
+  eigen_device_.reset();
+  thread_pool_.reset();
+}
+
+class CpuExecutionPool::TaskQueue::EigenThreadPool
+    : public Eigen::ThreadPoolInterface {
+ public:
+  EigenThreadPool(TaskQueue* queue, Eigen::ThreadPoolInterface* pool)
+      : queue_(queue), pool_(pool) {}
+
+  void Schedule(std::function<void()> fn) final {
+    queue_->Schedule(std::move(fn));
+  }
+
+  // Tasks run on the threads of the underlying pool.
+  int NumThreads() const final { return pool_->NumThreads(); }
+  int CurrentThreadId() const final { return pool_->CurrentThreadId(); }
+
+ private:
+  TaskQueue* queue_;
+  Eigen::ThreadPoolInterface* pool_;
+};
+
+CpuExecutionPool::TaskQueue::TaskQueue(CpuExecutionPool* pool)
+    : pool_(pool),
+      eigen_thread_pool_(std::make_unique<EigenThreadPool>(
+          this, pool->thread_pool()->AsEigenThreadPool())),
+      eigen_device_(std::make_unique<Eigen::ThreadPoolDevice>(
+          eigen_thread_pool_.get(), eigen_thread_pool_->NumThreads())) {}
+
+CpuExecutionPool::TaskQueue::~TaskQueue() = default;
+
+void CpuExecutionPool::TaskQueue::Schedule(Task task) {
+  pool_->Schedule(shared_from_this(), std::move(task));
+}
+
+std::shared_ptr<CpuExecutionPool::TaskQueue>
+CpuExecutionPool::CreateTaskQueue() {
+  return std::shared_ptr<TaskQueue>(new TaskQueue(this));
+}
+
+void CpuExecutionPool::Schedule(std::shared_ptr<TaskQueue> queue, Task task) {
+  absl::Time scheduled_at = absl::Now();
+  {
+    absl::MutexLock lock(&mu_);
+    queue->tasks_.emplace_back(std::move(task), scheduled_at);
+    if (!queue->active_) {
+      queue->active_ = true;
+      active_queues_.push_back(std::move(queue));
+    }
+  }
+
+  // Every scheduled task adds exactly one pool task, which runs the next task
+  // in the round-robin order, and not necessarily the one scheduled here.
+  thread_pool_->Schedule([this] { RunNextTask(); });
+}
+
+void CpuExecutionPool::RunNextTask() {
+  Task task;
+  absl::Time scheduled_at;
+
+  {
+    absl::MutexLock lock(&mu_);
+    CHECK(!active_queues_.empty()) << "No pending tasks in the pool";
+
+    std::shared_ptr<TaskQueue> queue = std::move(active_queues_.front());
+    active_queues_.pop_front();
+
+    task = std::move(queue->tasks_.front().first);
+    scheduled_at = queue->tasks_.front().second;
+    queue->tasks_.pop_front();
+
+    // Move the queue to the back of the round-robin list if it has more tasks.
+    if (queue->tasks_.empty()) {
+      queue->active_ = false;
+    } else {
+      active_queues_.push_back(std::move(queue));
+    }
+  }
+
+  // Pool threads run tasks concurrently, so we update task statistics without
+  // taking the pool mutex, which is only held to pick the next task.
+  int64_t queue_time_ns = absl::ToInt64Nanoseconds(absl::Now() - scheduled_at);
+  num_tasks_.fetch_add(1, std::memory_order_relaxed);
+  total_task_queue_time_ns_.fetch_add(queue_time_ns, std::memory_order_relaxed);
+  int64_t max_ns = max_task_queue_time_ns_.load(std::memory_order_relaxed);
+  while (queue_time_ns > max_ns &&
+         !max_task_queue_time_ns_.compare_exchange_weak(
+             max_ns, queue_time_ns, std::memory_order_relaxed)) {
+  }
+
+  metrics::ReportCpuTaskQueueTime(queue_time_ns / 1000);
+  task();
+}
+
+std::unique_ptr<CpuExecutionPool::Admission> CpuExecutionPool::Admit(
+    const void* executable, int64_t device_id) {
+  Admission::Key key = {executable, device_id};
+  int64_t limit = options_.max_inflight_executions_per_executable;
+
+  absl::Time start = absl::Now();
+  absl::Duration wait_time;
+
+  {
+    absl::MutexLock lock(&mu_);
+
+    auto has_capacity = [&]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+      auto it = inflight_executions_.find(key);
+      return it == inflight_executions_.end() || it->second < limit;
+    };
+
+    if (limit > 0) mu_.Await(absl::Condition(&has_capacity));
+    inflight_executions_[key]++;
+
+    wait_time = absl::Now() - start;
+    stats_.num_admissions++;
+    stats_.total_admission_wait_time += wait_time;
+    stats_.max_admission_wait_time =
+        std::max(stats_.max_admission_wait_time, wait_time);
+  }
+
+  metrics::ReportCpuAdmissionWaitTime(absl::ToInt64Microseconds(wait_time));
+  return std::unique_ptr<Admission>(new Admission(this, key));
+}
+
+CpuExecutionPool::Admission::~Admission() { pool_->Release(key_); }
+
+void CpuExecutionPool::Release(const Admission::Key& key) {
+  absl::MutexLock lock(&mu_);
+  auto it = inflight_executions_.find(key);
+  CHECK(it != inflight_executions_.end()) << "Execution was not admitted";
+  if (--it->second == 0) inflight_executions_.erase(it);
+}
+
+CpuExecutionPool::Stats CpuExecutionPool::stats() const {
+  Stats stats;
+  {
+    absl::MutexLock lock(&mu_);
+    stats = stats_;
+  }
+  stats.num_tasks = num_tasks_.load(std::memory_order_relaxed);
+  stats.total_task_queue_time = absl::Nanoseconds(
+      total_task_queue_time_ns_.load(std::memory_order_relaxed));
+  stats.max_task_queue_time = absl::Nanoseconds(
+      max_task_queue_time_ns_.load(std::memory_order_relaxed));
+  return stats;
+}
+
+}  // namespace xla
@@ -0,0 +1,201 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_PJRT_CPU_CPU_EXECUTION_POOL_H_
+#define XLA_PJRT_CPU_CPU_EXECUTION_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+
+// Returns options for the threads that run XLA:CPU computations and PjRt CPU
+// client work, with a stack large enough for BLAS and LAPACK functions.
+tsl::ThreadOptions GetCpuThreadOptions();
+
+// A pool of threads for running XLA:CPU computations, that can be shared by
+// multiple PjRt CPU clients (and all executables compiled by them) in the same
+// process. Without a shared pool every client creates its own intra-op thread
+// pool sized to the number of cores, and concurrent computations oversubscribe
+// the CPU.
+//
+// The pool implements two mechanisms for predictable latency when multiple
+// computations run concurrently:
+//
+//  (1) Admission control: the number of in-flight executions of each
+//      executable on each device can be limited, so that a single model can't
+//      take over the whole pool by enqueueing many executions.
+//
+//  (2) Fair scheduling: intra-op tasks (i.e. partitions of parallel loops in
+//      host kernels, and concurrently running thunks) of each execution are
+//      queued separately, and pool threads pick up tasks from all executions
+//      in round-robin order. A large execution that splits its loops into many
+//      tasks can't starve small executions.
+//
+//      The pool does not split tasks any further: the unit of fairness is a
+//      task as scheduled by the execution, i.e. a loop partition of a
+//      `KernelThunk` host kernel as chosen by its existing partitioning, or an
+//      Eigen block. Once started, a task runs to completion, so a kernel with
+//      few long partitions can still delay other executions.
+//
+// Time spent waiting for admission and in task queues is exported as metrics
+// and accumulated in the pool statistics. Task statistics are updated for
+// every task, and are kept in atomics outside of the pool mutex.
+class CpuExecutionPool {
+ public:
+  using Task = absl::AnyInvocable<void()>;
+
+  struct Options {
+    // Number of threads in the pool.
+    size_t num_threads = 1;
+
+    // The maximum number of in-flight executions of a single executable on a
+    // single device. Zero means no limit.
+    int64_t max_inflight_executions_per_executable = 0;
+  };
+
+  struct Stats {
+    int64_t num_tasks = 0;
+    absl::Duration total_task_queue_time;
+    absl::Duration max_task_queue_time;
+
+    int64_t num_admissions = 0;
+    absl::Duration total_admission_wait_time;
+    absl::Duration max_admission_wait_time;
+  };
+
+  // A queue of intra-op tasks of a single execution.
+  class TaskQueue : public std::enable_shared_from_this<TaskQueue> {
+   public:
+    ~TaskQueue();
+
+    // Schedules `task` for execution on one of the pool threads.
+    void Schedule(Task task);
+
+    // Eigen device that schedules all its work into this queue. Host kernels
+    // (partitions of parallel loops) and Eigen operations (matmuls and
+    // convolutions) of the execution must run on this device, and not on the
+    // pool's `eigen_device()`, to be interleaved with other executions.
+    Eigen::ThreadPoolDevice* eigen_device() const {
+      return eigen_device_.get();
+    }
+
+   private:
+    friend class CpuExecutionPool;
+
+    // Eigen thread pool interface on top of the task queue.
+    class EigenThreadPool;
+
+    explicit TaskQueue(CpuExecutionPool* pool);
+
+    CpuExecutionPool* pool_;
+    std::unique_ptr<EigenThreadPool> eigen_thread_pool_;
+    std::unique_ptr<Eigen::ThreadPoolDevice> eigen_device_;
+
+    // Pending tasks with the time they were scheduled at, and a flag that
+    // tells if the queue is in the pool's round-robin list. Guarded by the pool
+    // mutex.
+    std::deque<std::pair<Task, absl::Time>> tasks_;
+    bool active_ = false;
+  };
+
+  // An RAII helper that releases an admitted execution slot on destruction.
+  class Admission {
+   public:
+    ~Admission();
+
+    Admission(Admission&&) = delete;
+    Admission& operator=(Admission&&) = delete;
+
+   private:
+    friend class CpuExecutionPool;
+
+    using Key = std::pair<const void*, int64_t>;
+
+    Admission(CpuExecutionPool* pool, Key key) : pool_(pool), key_(key) {}
+
+    CpuExecutionPool* pool_;
+    Key key_;
+  };
+
+  explicit CpuExecutionPool(Options options);
+  ~CpuExecutionPool();
+
+  // Creates a new task queue for an execution. Queue is kept alive by the
+  // pool until all scheduled tasks are completed.
+  std::shared_ptr<TaskQueue> CreateTaskQueue();
+
+  // Blocks until `executable` has fewer than the maximum number of in-flight
+  // executions on `device_id`, and returns an admission that has to be kept
+  // alive until the execution is completed.
+  std::unique_ptr<Admission> Admit(const void* executable, int64_t device_id);
+
+  Stats stats() const;
+
+  const Options& options() const { return options_; }
+
+  tsl::thread::ThreadPool* thread_pool() const { return thread_pool_.get(); }
+
+  // Eigen device for running Eigen operations (i.e. matmuls and convolutions)
+  // on the pool threads, bypassing the task queues.
+  Eigen::ThreadPoolDevice* eigen_device() const { return eigen_device_.get(); }
+
+ private:
+  // Schedules a task from `queue`.
+  void Schedule(std::shared_ptr<TaskQueue> queue, Task task);
+
+  // Runs the next task in the round-robin order.
+  void RunNextTask();
+
+  void Release(const Admission::Key& key);
+
+  Options options_;
+
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool_;
+  std::unique_ptr<Eigen::ThreadPoolDevice> eigen_device_;
+
+  mutable absl::Mutex mu_;
+
+  // Task queues with pending tasks in the round-robin order.
+  std::deque<std::shared_ptr<TaskQueue>> active_queues_ ABSL_GUARDED_BY(mu_);
+
+  // The number of in-flight executions per executable and device.
+  absl::flat_hash_map<Admission::Key, int64_t> inflight_executions_
+      ABSL_GUARDED_BY(mu_);
+
+  // Admission statistics. Task statistics are in the atomics below.
+  Stats stats_ ABSL_GUARDED_BY(mu_);
+
+  std::atomic<int64_t> num_tasks_{0};
+  std::atomic<int64_t> total_task_queue_time_ns_{0};
+  std::atomic<int64_t> max_task_queue_time_ns_{0};
+};
+
+}  // namespace xla
+
+#endif  // XLA_PJRT_CPU_CPU_EXECUTION_POOL_H_
@@ -0,0 +1,163 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/cpu/cpu_execution_pool.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(CpuExecutionPoolTest, ScheduleTasks) {
+  CpuExecutionPool pool({/*num_threads=*/4});
+
+  static constexpr int kNumTasks = 100;
+  absl::BlockingCounter counter(kNumTasks);
+
+  auto queue = pool.CreateTaskQueue();
+  for (int i = 0; i < kNumTasks; ++i) {
+    queue->Schedule([&] { counter.DecrementCount(); });
+  }
+  counter.Wait();
+
+  EXPECT_EQ(pool.stats().num_tasks, kNumTasks);
+}
+
+TEST(CpuExecutionPoolTest, RoundRobinAcrossQueues) {
+  CpuExecutionPool pool({/*num_threads=*/1});
+
+  absl::Mutex mu;
+  std::vector<std::string> order;
+  auto record = [&](std::string name) {
+    absl::MutexLock lock(&mu);
+    order.push_back(std::move(name));
+  };
+
+  // Block the only pool thread until tasks of both queues are scheduled.
+  absl::Notification unblock;
+  auto blocker = pool.CreateTaskQueue();
+  blocker->Schedule([&] { unblock.WaitForNotification(); });
+
+  absl::BlockingCounter counter(6);
+  auto a = pool.CreateTaskQueue();
+  auto b = pool.CreateTaskQueue();
+  for (int i = 0; i < 3; ++i) {
+    a->Schedule([&, i] {
+      record(absl::StrCat("a", i));
+      counter.DecrementCount();
+    });
+  }
+  for (int i = 0; i < 3; ++i) {
+    b->Schedule([&, i] {
+      record(absl::StrCat("b", i));
+      counter.DecrementCount();
+    });
+  }
+
+  unblock.Notify();
+  counter.Wait();
+
+  // Tasks of the second queue are not delayed until the first one is empty.
+  EXPECT_THAT(order, ElementsAre("a0", "b0", "a1", "b1", "a2", "b2"));
+}
+
+TEST(CpuExecutionPoolTest, EigenDeviceTasksInterleave) {
+  CpuExecutionPool pool({/*num_threads=*/1});
+
+  absl::Mutex mu;
+  std::vector<std::string> order;
+  auto record = [&](std::string name) {
+    absl::MutexLock lock(&mu);
+    order.push_back(std::move(name));
+  };
+
+  absl::Notification unblock;
+  auto blocker = pool.CreateTaskQueue();
+  blocker->Schedule([&] { unblock.WaitForNotification(); });
+
+  // Two concurrent executions schedule host kernel partitions into the Eigen
+  // device of their task queue, the same way as KernelThunk does.
+  absl::BlockingCounter counter(6);
+  auto a = pool.CreateTaskQueue();
+  auto b = pool.CreateTaskQueue();
+  EXPECT_EQ(a->eigen_device()->numThreads(), 1);
+  for (int i = 0; i < 3; ++i) {
+    a->eigen_device()->getPool()->Schedule([&, i] {
+      record(absl::StrCat("a", i));
+      counter.DecrementCount();
+    });
+  }
+  for (int i = 0; i < 3; ++i) {
+    b->eigen_device()->getPool()->Schedule([&, i] {
+      record(absl::StrCat("b", i));
+      counter.DecrementCount();
+    });
+  }
+
+  unblock.Notify();
+  counter.Wait();
+
+  EXPECT_THAT(order, ElementsAre("a0", "b0", "a1", "b1", "a2", "b2"));
+  EXPECT_EQ(pool.stats().num_tasks, 7);
+}
+
+TEST(CpuExecutionPoolTest, AdmissionControl) {
+  CpuExecutionPool pool({/*num_threads=*/1,
+                         /*max_inflight_executions_per_executable=*/1});
+
+  int executable = 0;
+  auto admission = pool.Admit(&executable, /*device_id=*/0);
+
+  // Executions on other devices are admitted immediately.
+  EXPECT_NE(pool.Admit(&executable, /*device_id=*/1), nullptr);
+
+  absl::Notification admitted;
+  std::unique_ptr<tsl::Thread> thread(tsl::Env::Default()->StartThread(
+      tsl::ThreadOptions(), "admission", [&] {
+        auto admission = pool.Admit(&executable, /*device_id=*/0);
+        admitted.Notify();
+      }));
+
+  EXPECT_FALSE(admitted.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  admission.reset();
+  admitted.WaitForNotification();
+  thread.reset();
+
+  CpuExecutionPool::Stats stats = pool.stats();
+  EXPECT_EQ(stats.num_admissions, 3);
+  EXPECT_GE(stats.max_admission_wait_time, absl::Milliseconds(50));
+}
+
+}  // namespace
+}  // namespace xla
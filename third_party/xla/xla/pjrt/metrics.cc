@@ -32,6 +32,24 @@ auto* pjrt_executable_execution_time_usecs = tsl::monitoring::Counter<0>::New(
     "The total time spent on PjRtExecutable::ExecuteHelper in "
     "microseconds.");
 
+auto* pjrt_cpu_tasks = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/cpu/tasks",
+    "The number of intra-op tasks run by the XLA:CPU execution pool.");
+
+auto* pjrt_cpu_task_queue_time_usecs = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/cpu/task_queue_time_usecs",
+    "The total time intra-op tasks spent in the XLA:CPU execution pool queue "
+    "in microseconds.");
+
+auto* pjrt_cpu_admissions = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/cpu/admissions",
+    "The number of executions admitted to the XLA:CPU execution pool.");
+
+auto* pjrt_cpu_admission_wait_time_usecs = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/cpu/admission_wait_time_usecs",
+    "The total time executions waited for admission to the XLA:CPU execution "
+    "pool in microseconds.");
+
 auto* pjrt_compiler_is_compiling_computation =
     tsl::monitoring::Gauge<bool, 0>::New(
         metrics::kPjrtCompilerCompileComputationMetricName,
@@ -56,6 +74,22 @@ void ReportExecutableEnqueueTime(const uint64_t running_time_usecs) {
   }
 }
 
+void ReportCpuTaskQueueTime(const uint64_t queue_time_usecs) {
+  static auto* pjrt_cpu_tasks_cell = pjrt_cpu_tasks->GetCell();
+  static auto* pjrt_cpu_task_queue_time_usecs_cell =
+      pjrt_cpu_task_queue_time_usecs->GetCell();
+  pjrt_cpu_tasks_cell->IncrementBy(1);
+  pjrt_cpu_task_queue_time_usecs_cell->IncrementBy(queue_time_usecs);
+}
+
+void ReportCpuAdmissionWaitTime(const uint64_t wait_time_usecs) {
+  static auto* pjrt_cpu_admissions_cell = pjrt_cpu_admissions->GetCell();
+  static auto* pjrt_cpu_admission_wait_time_usecs_cell =
+      pjrt_cpu_admission_wait_time_usecs->GetCell();
+  pjrt_cpu_admissions_cell->IncrementBy(1);
+  pjrt_cpu_admission_wait_time_usecs_cell->IncrementBy(wait_time_usecs);
+}
+
 void RecordPjrtCompilerCompileComputationStatus(bool is_compiling) {
   pjrt_compiler_is_compiling_computation->GetCell()->Set(is_compiling);
 }
@@ -32,6 +32,14 @@ inline constexpr absl::string_view kPjrtCompilerCompileModuleMetricName =
 
 void ReportExecutableEnqueueTime(uint64_t running_time_usecs);
 
+// Reports the time an intra-op task of an XLA:CPU execution spent in the
+// queue of a shared execution pool before it started running.
+void ReportCpuTaskQueueTime(uint64_t queue_time_usecs);
+
+// Reports the time an XLA:CPU execution waited for admission to a shared
+// execution pool.
+void ReportCpuAdmissionWaitTime(uint64_t wait_time_usecs);
+
 void RecordPjrtCompilerCompileComputationStatus(bool is_compiling);
 
 void RecordPjrtCompilerCompileModuleStatus(bool is_compiling);
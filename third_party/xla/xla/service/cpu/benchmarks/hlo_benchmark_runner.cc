@@ -30,6 +30,7 @@ limitations under the License.
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/service/hlo_module_config.h"
+#include "xla/xla.pb.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test_benchmark.h"
@@ -40,7 +41,8 @@ absl::Status RunHloBenchmark(benchmark::State& state,
                              std::string_view hlo_module,
                              absl::Span<const Literal* const> args,
                              StrToStrMapping replacements,
-                             bool disable_parallel_task_assigner) {
+                             bool disable_parallel_task_assigner,
+                             const DebugOptions* debug_options) {
   TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtClient> client,
                       GetTfrtCpuClient(CpuClientOptions()));
   PjRtDevice* device = client->devices().front();
@@ -54,6 +56,10 @@ absl::Status RunHloBenchmark(benchmark::State& state,
 
   // Compile HLO module to executable.
   CompileOptions compile_options;
+  if (debug_options) {
+    *compile_options.executable_build_options.mutable_debug_options() =
+        *debug_options;
+  }
   if (disable_parallel_task_assigner) {
     compile_options.executable_build_options.mutable_debug_options()
         ->add_xla_disable_hlo_passes("cpu-parallel-task-assigner");
@@ -61,6 +67,10 @@ absl::Status RunHloBenchmark(benchmark::State& state,
   TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
                       client->Compile(computation, compile_options));
 
+  TF_ASSIGN_OR_RETURN(CompiledMemoryStats memory_stats,
+                      executable->GetCompiledMemoryStats());
+  state.counters["temp_bytes"] = memory_stats.temp_size_in_bytes;
+
   // Convert literals to PjRtBuffers.
   std::vector<std::unique_ptr<PjRtBuffer>> args_buffers;
   args_buffers.reserve(args.size());
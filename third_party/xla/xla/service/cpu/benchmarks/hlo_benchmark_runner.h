@@ -22,6 +22,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "xla/literal.h"
+#include "xla/xla.pb.h"
 #include "tsl/platform/test_benchmark.h"
 
 namespace xla::cpu {
@@ -39,11 +40,18 @@ using StrToStrMapping =
 // If `disable_parallel_task_assigner` is true, the parallel task assigner will
 // not be run on the HLO module before running the benchmark. Therefore,
 // parallel backend will not be executed.
+//
+// If `debug_options` is not null, the HLO module is compiled with the given
+// debug options instead of the ones parsed from flags.
+//
+// Size of the temporary buffers of the compiled executable (its peak heap size)
+// is reported as a `temp_bytes` benchmark counter.
 absl::Status RunHloBenchmark(benchmark::State& state,
                              std::string_view hlo_module,
                              absl::Span<const Literal* const> args,
                              StrToStrMapping replacements = {},
-                             bool disable_parallel_task_assigner = false);
+                             bool disable_parallel_task_assigner = false,
+                             const DebugOptions* debug_options = nullptr);
 
 }  // namespace xla::cpu
 
@@ -0,0 +1,94 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/debug_options_flags.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/benchmarks/hlo_benchmark_runner.h"
+#include "xla/shape_util.h"
+#include "xla/xla.pb.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla::cpu {
+
+// Benchmarks step time of a module that keeps a large activation alive across
+// a chain of dots, with and without the peak memory limit. With the limit XLA
+// rematerializes the activation right before its last use, and the executable
+// needs less temporary memory (`temp_bytes` counter) at the cost of recomputing
+// the activation.
+static void BM_MemoryLimit(benchmark::State& state) {
+  int64_t d0 = state.range(0);
+  bool limit_memory = state.range(1);
+
+  std::string_view hlo = R"(
+    HloModule memory_limit_$d0
+
+    ENTRY e {
+      p0 = f32[$d0,$d0] parameter(0)
+      w = f32[$d0,$d0] parameter(1)
+      act = f32[$d0,$d0] exponential(p0)
+      dot0 = f32[$d0,$d0] dot(act, w),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      tanh0 = f32[$d0,$d0] tanh(dot0)
+      dot1 = f32[$d0,$d0] dot(tanh0, w),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      tanh1 = f32[$d0,$d0] tanh(dot1)
+      dot2 = f32[$d0,$d0] dot(tanh1, w),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      ROOT add = f32[$d0,$d0] add(dot2, act)
+    }
+  )";
+
+  std::minstd_rand0 engine;
+
+  auto shape = ShapeUtil::MakeShape(F32, {d0, d0});
+  auto p0 = *LiteralUtil::CreateRandomLiteral<F32>(shape, &engine, 0.0f, 0.1f);
+  auto w = *LiteralUtil::CreateRandomLiteral<F32>(shape, &engine, 0.0f, 0.1f);
+
+  // Without rematerialization we need five live buffers at the peak (two
+  // parameters, `act` and two dot operands/results), with rematerialization of
+  // `act` only four.
+  DebugOptions debug_options = GetDebugOptionsFromFlags();
+  if (limit_memory) {
+    int64_t buffer_size = ShapeUtil::ByteSizeOf(shape);
+    debug_options.set_xla_cpu_memory_limit_bytes(4 * buffer_size +
+                                                 buffer_size / 2);
+  }
+
+  std::vector<const Literal*> args = {&p0, &w};
+  CHECK_OK(RunHloBenchmark(state, hlo, args, {{"$d0", absl::StrCat(d0)}},
+                           /*disable_parallel_task_assigner=*/false,
+                           &debug_options));
+}
+
+BENCHMARK(BM_MemoryLimit)
+    ->MeasureProcessCPUTime()
+    ->ArgPair(256, false)
+    ->ArgPair(256, true)
+    ->ArgPair(1024, false)
+    ->ArgPair(1024, true)
+    ->ArgPair(2048, false)
+    ->ArgPair(2048, true);
+
+}  // namespace xla::cpu
@@ -0,0 +1,125 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/compiled_object_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace xla::cpu {
+
+CompiledObjectCache::CompiledObjectCache(size_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+CompiledObjectCache* CompiledObjectCache::Global() {
+  static auto* cache = new CompiledObjectCache(/*capacity_bytes=*/0);
+  return cache;
+}
+
+tsl::Fprint128 CompiledObjectCache::Fingerprint(llvm::Module& module) {
+  // Temporarily drop the source file name, as it is serialized to bitcode.
+  std::string source_file_name = module.getSourceFileName();
+  module.setSourceFileName("");
+
+  llvm::SmallString<0> bc;
+  llvm::raw_svector_ostream bcos(bc);
+  llvm::WriteBitcodeToFile(module, bcos);
+
+  module.setSourceFileName(source_file_name);
+  return tsl::Fingerprint128(absl::string_view(bc.data(), bc.size()));
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompiledObjectCache::Lookup(
+    const tsl::Fprint128& key) {
+  absl::MutexLock lock(&mu_);
+
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return llvm::MemoryBuffer::getMemBufferCopy(it->second->obj_file);
+}
+
+void CompiledObjectCache::Insert(const tsl::Fprint128& key,
+                                 llvm::StringRef obj_file) {
+  absl::MutexLock lock(&mu_);
+
+  if (obj_file.size() > capacity_bytes_ || index_.contains(key)) return;
+
+  entries_.push_front(Entry{key, obj_file.str()});
+  index_[key] = entries_.begin();
+  size_bytes_ += obj_file.size();
+
+  EvictIfNeeded();
+}
+
+void CompiledObjectCache::SetCapacity(size_t capacity_bytes) {
+  absl::MutexLock lock(&mu_);
+  capacity_bytes_ = capacity_bytes;
+  EvictIfNeeded();
+}
+
+void CompiledObjectCache::GrowCapacity(size_t capacity_bytes) {
+  absl::MutexLock lock(&mu_);
+  capacity_bytes_ = std::max(capacity_bytes_, capacity_bytes);
+}
+
+void CompiledObjectCache::EvictIfNeeded() {
+  while (size_bytes_ > capacity_bytes_) {
+    Entry& entry = entries_.back();
+    size_bytes_ -= entry.obj_file.size();
+    index_.erase(entry.key);
+    entries_.pop_back();
+  }
+}
+
+size_t CompiledObjectCache::capacity_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return capacity_bytes_;
+}
+
+size_t CompiledObjectCache::size_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return size_bytes_;
+}
+
+int64_t CompiledObjectCache::hits() const {
+  absl::MutexLock lock(&mu_);
+  return hits_;
+}
+
+int64_t CompiledObjectCache::misses() const {
+  absl::MutexLock lock(&mu_);
+  return misses_;
+}
+
+}  // namespace xla::cpu
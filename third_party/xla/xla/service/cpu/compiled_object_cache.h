@@ -0,0 +1,108 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_COMPILED_OBJECT_CACHE_H_
+#define XLA_SERVICE_CPU_COMPILED_OBJECT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace xla::cpu {
+
+// A content-addressed cache of object files compiled from LLVM modules. XLA:CPU
+// splits LLVM module into parts before codegen (see `CpuCompiler`), and if the
+// same part is compiled again (i.e. the same HLO module is recompiled, or
+// different HLO modules emit identical kernels), we can skip LLVM optimization
+// and codegen and reuse the cached object file.
+//
+// Cache keys are computed by the user (see `CompilerFunctor`), and must account
+// for everything that can change the compiled object file: LLVM module content
+// and the target machine and compilation options. When the cache size exceeds
+// its capacity, least recently used object files are evicted.
+//
+// Compiled object cache is thread safe.
+class CompiledObjectCache {
+ public:
+  explicit CompiledObjectCache(size_t capacity_bytes);
+
+  // Returns a process-wide object cache with zero capacity. Users must grow the
+  // capacity before using it (see `GrowCapacity`).
+  static CompiledObjectCache* Global();
+
+  // Returns a fingerprint of the LLVM module content. Module identifier and
+  // source file name do not contribute to the fingerprint, as they are
+  // different for each part of the split LLVM module.
+  static tsl::Fprint128 Fingerprint(llvm::Module& module);
+
+  // Returns a copy of the cached object file, or nullptr if not found.
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(const tsl::Fprint128& key);
+
+  // Adds an object file to the cache. Object files larger than the cache
+  // capacity are not cached.
+  void Insert(const tsl::Fprint128& key, llvm::StringRef obj_file);
+
+  // Updates cache capacity, and evicts object files that no longer fit.
+  void SetCapacity(size_t capacity_bytes);
+
+  // Increases cache capacity to `capacity_bytes` if it is smaller, and never
+  // evicts object files. Compilations sharing the global cache use it to
+  // request their capacity, so that a compilation asking for a smaller cache
+  // does not evict object files that other compilations rely on.
+  void GrowCapacity(size_t capacity_bytes);
+
+  size_t capacity_bytes() const;
+  size_t size_bytes() const;
+
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Entry {
+    tsl::Fprint128 key;
+    std::string obj_file;
+  };
+
+  using Entries = std::list<Entry>;
+
+  void EvictIfNeeded() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable absl::Mutex mu_;
+
+  size_t capacity_bytes_ ABSL_GUARDED_BY(mu_);
+  size_t size_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Cached object files ordered from the most to the least recently used.
+  Entries entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<tsl::Fprint128, Entries::iterator, tsl::Fprint128Hasher>
+      index_ ABSL_GUARDED_BY(mu_);
+
+  int64_t hits_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_COMPILED_OBJECT_CACHE_H_
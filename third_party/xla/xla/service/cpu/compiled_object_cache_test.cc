@@ -0,0 +1,127 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/compiled_object_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+static std::unique_ptr<llvm::Module> CreateModule(llvm::LLVMContext& context,
+                                                  const std::string& id,
+                                                  const std::string& function) {
+  auto module = std::make_unique<llvm::Module>(id, context);
+  llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context), false),
+      llvm::GlobalValue::ExternalLinkage, function, *module);
+  return module;
+}
+
+TEST(CompiledObjectCacheTest, Fingerprint) {
+  llvm::LLVMContext context;
+
+  auto part0 = CreateModule(context, "module_part_00", "kernel");
+  auto part1 = CreateModule(context, "module_part_01", "kernel");
+  auto other = CreateModule(context, "module_part_00", "other_kernel");
+
+  tsl::Fprint128 fp0 = CompiledObjectCache::Fingerprint(*part0);
+  tsl::Fprint128 fp1 = CompiledObjectCache::Fingerprint(*part1);
+  tsl::Fprint128 fp2 = CompiledObjectCache::Fingerprint(*other);
+
+  EXPECT_TRUE(fp0 == fp1);
+  EXPECT_FALSE(fp0 == fp2);
+
+  // Source file name is restored after computing the fingerprint.
+  EXPECT_EQ(part0->getSourceFileName(), "module_part_00");
+}
+
+TEST(CompiledObjectCacheTest, LookupAndInsert) {
+  CompiledObjectCache cache(/*capacity_bytes=*/1024);
+
+  tsl::Fprint128 key = tsl::Fingerprint128("kernel");
+  EXPECT_EQ(cache.Lookup(key), nullptr);
+
+  cache.Insert(key, "object file");
+  EXPECT_EQ(cache.size_bytes(), 11);
+
+  std::unique_ptr<llvm::MemoryBuffer> obj_file = cache.Lookup(key);
+  ASSERT_NE(obj_file, nullptr);
+  EXPECT_EQ(obj_file->getBuffer(), "object file");
+
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST(CompiledObjectCacheTest, EvictLeastRecentlyUsed) {
+  CompiledObjectCache cache(/*capacity_bytes=*/8);
+
+  tsl::Fprint128 a = tsl::Fingerprint128("a");
+  tsl::Fprint128 b = tsl::Fingerprint128("b");
+  tsl::Fprint128 c = tsl::Fingerprint128("c");
+
+  cache.Insert(a, "aaaa");
+  cache.Insert(b, "bbbb");
+
+  // Touch `a` to make `b` the least recently used object file.
+  ASSERT_NE(cache.Lookup(a), nullptr);
+
+  cache.Insert(c, "cccc");
+  EXPECT_EQ(cache.size_bytes(), 8);
+  EXPECT_NE(cache.Lookup(a), nullptr);
+  EXPECT_EQ(cache.Lookup(b), nullptr);
+  EXPECT_NE(cache.Lookup(c), nullptr);
+
+  // Object files larger than the capacity are not cached.
+  cache.Insert(b, "bbbbbbbbbbbb");
+  EXPECT_EQ(cache.Lookup(b), nullptr);
+
+  cache.SetCapacity(4);
+  EXPECT_EQ(cache.size_bytes(), 4);
+  EXPECT_EQ(cache.Lookup(a), nullptr);
+  EXPECT_NE(cache.Lookup(c), nullptr);
+}
+
+TEST(CompiledObjectCacheTest, GrowCapacity) {
+  CompiledObjectCache cache(/*capacity_bytes=*/8);
+
+  tsl::Fprint128 a = tsl::Fingerprint128("a");
+  tsl::Fprint128 b = tsl::Fingerprint128("b");
+
+  cache.Insert(a, "aaaa");
+  cache.Insert(b, "bbbb");
+
+  // Requesting a smaller capacity doesn't evict any object files.
+  cache.GrowCapacity(4);
+  EXPECT_EQ(cache.capacity_bytes(), 8);
+  EXPECT_NE(cache.Lookup(a), nullptr);
+  EXPECT_NE(cache.Lookup(b), nullptr);
+
+  cache.GrowCapacity(16);
+  EXPECT_EQ(cache.capacity_bytes(), 16);
+  EXPECT_EQ(cache.size_bytes(), 8);
+}
+
+}  // namespace
+}  // namespace xla::cpu
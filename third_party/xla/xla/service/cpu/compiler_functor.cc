@@ -16,9 +16,13 @@ limitations under the License.
 #include "xla/service/cpu/compiler_functor.h"
 
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/CGSCCPassManager.h"
@@ -40,9 +44,11 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/Transforms/Instrumentation/DataFlowSanitizer.h"
+#include "xla/service/cpu/compiled_object_cache.h"
 #include "xla/service/cpu/llvm_ir_runtime.h"
 #include "xla/service/llvm_ir/llvm_util.h"
 #include "xla/util.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/logging.h"
 
 namespace xla {
@@ -98,6 +104,37 @@ static std::vector<llvm::VecDesc> VectorFunctionsForTargetLibraryInfoImpl() {
   return result;
 }
 
+tsl::Fprint128 CompilerFunctor::ObjectCacheKey(
+    llvm::Module& module, const llvm::TargetMachine& target_machine) {
+  std::string fast_math_flags;
+  llvm::raw_string_ostream fast_math_flags_os(fast_math_flags);
+  fast_math_flags_.print(fast_math_flags_os);
+
+  std::string options = absl::StrCat(
+      target_machine.getTargetTriple().str(), ";",
+      target_machine.getTargetCPU().str(), ";",
+      target_machine.getTargetFeatureString().str(), ";", opt_level_, ";",
+      optimize_for_size_, ";", disable_expensive_passes_, ";",
+      disable_slp_vectorizer_, ";", fast_math_flags_os.str(), ";",
+      dfsan_enabled_, ";", absl::StrJoin(dfsan_abi_list_files_, ","));
+
+  return tsl::FingerprintCat128(CompiledObjectCache::Fingerprint(module),
+                                tsl::Fingerprint128(options));
+}
+
+void CompilerFunctor::RunPostCodegenHook(const llvm::MemoryBuffer& obj_file) {
+  absl::MutexLock lock(&mutex_);
+  if (post_codegen_hook_) {
+    llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> object_file =
+        llvm::object::ObjectFile::createObjectFile(obj_file);
+    if (object_file) {
+      post_codegen_hook_(*object_file.get());
+    } else {
+      LOG(WARNING) << "Could not convert memory buffer to object file!";
+    }
+  }
+}
+
 llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
     llvm::Module& module) {
   VLOG(2) << "IR before optimizations";
@@ -117,6 +154,18 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
     }
   }
 
+  // Skip optimization and codegen if we already compiled an identical module.
+  std::optional<tsl::Fprint128> object_cache_key;
+  if (object_cache_) {
+    object_cache_key = ObjectCacheKey(module, *target_machine);
+    if (auto obj_file = object_cache_->Lookup(*object_cache_key)) {
+      VLOG(2) << "Found compiled object file for module "
+              << module.getModuleIdentifier() << " in the object cache";
+      RunPostCodegenHook(*obj_file);
+      return std::move(obj_file);
+    }
+  }
+
   llvm::OptimizationLevel opt_level;
   if (optimize_for_size_) {
     opt_level = llvm::OptimizationLevel::Os;
@@ -211,17 +260,10 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
   std::unique_ptr<llvm::MemoryBuffer> mc_memory_buffer(
       new llvm::SmallVectorMemoryBuffer(std::move(mc_stream_buffer)));
 
-  {  // Synchronize access to user-defined hooks.
-    absl::MutexLock lock(&mutex_);
-    if (post_codegen_hook_) {
-      llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
-          llvm::object::ObjectFile::createObjectFile(*mc_memory_buffer);
-      if (obj_file) {
-        post_codegen_hook_(*obj_file.get());
-      } else {
-        LOG(WARNING) << "Could not convert memory buffer to object file!";
-      }
-    }
+  RunPostCodegenHook(*mc_memory_buffer);
+
+  if (object_cache_key.has_value()) {
+    object_cache_->Insert(*object_cache_key, mc_memory_buffer->getBuffer());
   }
 
   return std::move(mc_memory_buffer);
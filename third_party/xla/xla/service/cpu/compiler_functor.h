@@ -32,8 +32,11 @@ limitations under the License.
 #include "llvm/IR/Module.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Target/TargetMachine.h"
+#include "xla/service/cpu/compiled_object_cache.h"
 #include "xla/service/llvm_compiler.h"
+#include "tsl/platform/fingerprint.h"
 
 namespace xla::cpu {
 
@@ -59,7 +62,8 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
       absl::AnyInvocable<void(const llvm::object::ObjectFile&)>
           post_codegen_hook = nullptr,
       bool dfsan_enabled = false,
-      const std::vector<std::string>& dfsan_abi_list_files = {})
+      const std::vector<std::string>& dfsan_abi_list_files = {},
+      CompiledObjectCache* object_cache = nullptr)
       : IRCompiler(llvm::orc::IRSymbolMapper::ManglingOptions()),
         target_machine_builder_(std::move(target_machine_builder)),
         opt_level_(opt_level),
@@ -71,13 +75,24 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
         dfsan_abi_list_files_(dfsan_abi_list_files),
         pre_optimization_hook_(std::move(pre_optimization_hook)),
         post_optimization_hook_(std::move(post_optimization_hook)),
-        post_codegen_hook_(std::move(post_codegen_hook)) {}
+        post_codegen_hook_(std::move(post_codegen_hook)),
+        object_cache_(object_cache) {}
 
-  // Compile a Module to an ObjectFile.
+  // Compile a Module to an ObjectFile. If object cache is set, and it already
+  // has an object file compiled from an identical module, returns it without
+  // running optimization passes and codegen (post-optimization hook is not
+  // called in this case).
   llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> operator()(
       llvm::Module& module) override;
 
  private:
+  // Returns a key for looking up the object file compiled from `module` in the
+  // object cache.
+  tsl::Fprint128 ObjectCacheKey(llvm::Module& module,
+                                const llvm::TargetMachine& target_machine);
+
+  void RunPostCodegenHook(const llvm::MemoryBuffer& obj_file);
+
   TargetMachineBuilder target_machine_builder_;
   const unsigned opt_level_;
   const bool optimize_for_size_;
@@ -94,6 +109,8 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
 
   // Synchronizes access to user-defined compilation hooks.
   absl::Mutex mutex_;
+
+  CompiledObjectCache* object_cache_;
 };
 
 }  // namespace xla::cpu
@@ -0,0 +1,449 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/cpu_autotuner.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/cpu_function_runtime.h"
+#include "xla/executable_run_options.h"
+#include "xla/hlo/ir/hlo_clone_context.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/cpu_autotuning.pb.h"
+#include "xla/service/cpu/cpu_executable.h"
+#include "xla/service/cpu/shape_partition.h"
+#include "xla/service/hlo_module_config.h"
+#include "xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla::cpu {
+namespace {
+
+// Version of the serialized autotuning results format.
+constexpr int32_t kAutotuneResultsVersion = 1;
+
+// Autotuning results are keyed by the device and the canonical HLO text.
+using AutotuneCacheKey = std::pair<std::string, std::string>;
+using AutotuneCache = absl::flat_hash_map<AutotuneCacheKey, CpuAutotuneResult>;
+
+ABSL_CONST_INIT absl::Mutex autotune_cache_mu(absl::kConstInit);
+
+AutotuneCache& GetAutotuneCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(autotune_cache_mu) {
+  static auto* cache = new AutotuneCache();
+  return *cache;
+}
+
+std::optional<CpuAutotuneResult> FindInCache(const AutotuneCacheKey& key) {
+  absl::MutexLock lock(&autotune_cache_mu);
+  AutotuneCache& cache = GetAutotuneCache();
+  if (auto it = cache.find(key); it != cache.end()) return it->second;
+  return std::nullopt;
+}
+
+void AddToCache(AutotuneCacheKey key, CpuAutotuneResult result) {
+  absl::MutexLock lock(&autotune_cache_mu);
+  GetAutotuneCache().insert_or_assign(std::move(key), std::move(result));
+}
+
+bool IsTextProtoPath(absl::string_view path) {
+  return absl::EndsWith(path, ".txt") || absl::EndsWith(path, ".textproto");
+}
+
+// Returns candidate outer dimension partitions for a kernel with the given
+// result shape: a single task, and a few partitionings up to the maximum
+// parallelism. Partition counts are adjusted to the actual dimension sizes.
+std::vector<std::vector<int64_t>> GetPartitionCandidates(
+    const Shape& shape, int64_t max_parallelism) {
+  std::vector<std::vector<int64_t>> candidates = {{}};
+  for (int64_t target_partition_count :
+       {max_parallelism / 4, max_parallelism / 2, max_parallelism}) {
+    if (target_partition_count <= 1) continue;
+    std::vector<int64_t> partitions =
+        ShapePartitionAssigner(shape).Run(target_partition_count);
+    if (ShapePartitionAssigner::GetTotalPartitionCount(partitions) <= 1) {
+      continue;
+    }
+    if (!absl::c_linear_search(candidates, partitions)) {
+      candidates.push_back(std::move(partitions));
+    }
+  }
+  return candidates;
+}
+
+// Extracts `instr` into a new module with operands replaced by parameters, and
+// with the given backend config. Extracted modules are never dumped.
+absl::StatusOr<std::unique_ptr<HloModule>> ExtractInstruction(
+    const HloInstruction* instr, const BackendConfig& backend_config) {
+  const HloModule* module = instr->GetModule();
+
+  HloModuleConfig config = module->config();
+  DebugOptions debug_options = config.debug_options();
+  debug_options.clear_xla_dump_to();
+  config.set_debug_options(debug_options);
+
+  auto extracted = std::make_unique<HloModule>(
+      absl::StrCat(module->name(), "_autotune_", instr->name()), config);
+
+  HloComputation::Builder builder("entry");
+  std::vector<HloInstruction*> parameters;
+  for (const HloInstruction* operand : instr->operands()) {
+    int64_t parameter_number = parameters.size();
+    parameters.push_back(builder.AddInstruction(HloInstruction::CreateParameter(
+        parameter_number, operand->shape(),
+        absl::StrCat("p", parameter_number))));
+  }
+
+  HloCloneContext context(extracted.get());
+  HloInstruction* clone = builder.AddInstruction(
+      instr->CloneWithNewOperands(instr->shape(), parameters, &context));
+  TF_RETURN_IF_ERROR(clone->set_backend_config(backend_config));
+
+  extracted->AddEntryComputationWithLayouts(builder.Build());
+  return extracted;
+}
+
+absl::Status ApplyAutotuneResult(HloInstruction* instr,
+                                 const CpuAutotuneResult& result) {
+  TF_ASSIGN_OR_RETURN(BackendConfig backend_config,
+                      instr->backend_config<BackendConfig>());
+  *backend_config.mutable_outer_dimension_partitions() =
+      result.outer_dimension_partitions();
+  backend_config.set_prefer_vector_width(result.prefer_vector_width());
+
+  VLOG(2) << "Apply autotuned config to " << instr->name() << ": "
+          << backend_config.ShortDebugString();
+  return instr->set_backend_config(backend_config);
+}
+
+}  // namespace
+
+CpuAutotuner::CpuAutotuner(Options options, ProfileFn profile_fn)
+    : options_(std::move(options)), profile_fn_(std::move(profile_fn)) {}
+
+bool CpuAutotuner::IsCandidate(const HloInstruction* instr) const {
+  if (!instr->shape().IsArray()) return false;
+
+  // Copies are lowered to copy thunks and not to host kernels.
+  if (instr->opcode() == HloOpcode::kCopy ||
+      instr->opcode() == HloOpcode::kConstant) {
+    return false;
+  }
+
+  if (!instr->IsLoopFusion() && !instr->IsElementwise()) return false;
+
+  // In-place dynamic update slices can't be partitioned (see
+  // ParallelTaskAssignment).
+  if (llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instr)) {
+    return false;
+  }
+
+  return ShapeUtil::ByteSizeOf(instr->shape()) >= options_.min_result_bytes;
+}
+
+absl::StatusOr<absl::Duration> CpuAutotuner::Profile(
+    const HloInstruction* instr,
+    const std::vector<int64_t>& outer_dimension_partitions,
+    int64_t prefer_vector_width) {
+  TF_ASSIGN_OR_RETURN(BackendConfig backend_config,
+                      instr->backend_config<BackendConfig>());
+  backend_config.mutable_outer_dimension_partitions()->Assign(
+      outer_dimension_partitions.begin(), outer_dimension_partitions.end());
+  backend_config.set_prefer_vector_width(prefer_vector_width);
+
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                      ExtractInstruction(instr, backend_config));
+  return profile_fn_(std::move(module));
+}
+
+absl::StatusOr<CpuAutotuneResult> CpuAutotuner::Autotune(
+    const HloInstruction* instr) {
+  std::optional<CpuAutotuneResult> best;
+
+  auto try_config = [&](const std::vector<int64_t>& partitions,
+                        int64_t prefer_vector_width) {
+    absl::StatusOr<absl::Duration> run_time =
+        Profile(instr, partitions, prefer_vector_width);
+    if (!run_time.ok()) {
+      VLOG(1) << "Failed to profile " << instr->name() << ": "
+              << run_time.status();
+      return;
+    }
+
+    int64_t run_time_ns = absl::ToInt64Nanoseconds(*run_time);
+    VLOG(2) << "Profiled " << instr->name() << " with partitions=["
+            << absl::StrJoin(partitions, ",")
+            << "] prefer_vector_width=" << prefer_vector_width << ": "
+            << *run_time;
+
+    if (!best.has_value() || run_time_ns < best->run_time_ns()) {
+      best.emplace();
+      best->mutable_outer_dimension_partitions()->Assign(partitions.begin(),
+                                                         partitions.end());
+      best->set_prefer_vector_width(prefer_vector_width);
+      best->set_run_time_ns(run_time_ns);
+    }
+  };
+
+  // Pick the fastest partitioning with the module-wide vector width first, and
+  // then try other vector widths with it, so that the number of compiled
+  // variants grows linearly with the number of candidates.
+  for (const std::vector<int64_t>& partitions :
+       GetPartitionCandidates(instr->shape(), options_.max_parallelism)) {
+    try_config(partitions, /*prefer_vector_width=*/0);
+  }
+
+  if (!best.has_value()) {
+    return Internal("Failed to profile all autotuning candidates for %s",
+                    instr->name());
+  }
+
+  const DebugOptions& debug_options =
+      instr->GetModule()->config().debug_options();
+  int64_t default_vector_width = debug_options.xla_cpu_prefer_vector_width();
+  std::vector<int64_t> partitions(best->outer_dimension_partitions().begin(),
+                                  best->outer_dimension_partitions().end());
+  for (int64_t prefer_vector_width : options_.vector_widths) {
+    if (prefer_vector_width == default_vector_width) continue;
+    try_config(partitions, prefer_vector_width);
+  }
+
+  return *best;
+}
+
+absl::StatusOr<bool> CpuAutotuner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  if (options_.autotune_level <= 0) return false;
+
+  if (!options_.load_results_from.empty()) {
+    TF_RETURN_IF_ERROR(
+        LoadAutotuneResultsFromFile(options_.load_results_from));
+  }
+
+  std::vector<HloInstruction*> candidates;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    for (HloInstruction* instr : computation->instructions()) {
+      if (IsCandidate(instr)) candidates.push_back(instr);
+    }
+  }
+
+  // Tune instructions with the largest results first, as they are the most
+  // likely to dominate the run time.
+  absl::c_stable_sort(candidates, [](const HloInstruction* a,
+                                     const HloInstruction* b) {
+    return ShapeUtil::ByteSizeOf(a->shape()) >
+           ShapeUtil::ByteSizeOf(b->shape());
+  });
+
+  bool changed = false;
+  int64_t num_tuned = 0;
+
+  for (HloInstruction* instr : candidates) {
+    AutotuneCacheKey key = {options_.device,
+                            instr->ToString(HloPrintOptions::Fingerprint())};
+
+    std::optional<CpuAutotuneResult> result = FindInCache(key);
+    if (!result.has_value() && options_.autotune_level >= 2 &&
+        num_tuned < options_.max_tuned_instructions) {
+      ++num_tuned;
+      absl::StatusOr<CpuAutotuneResult> tuned = Autotune(instr);
+      if (!tuned.ok()) {
+        LOG(WARNING) << "Failed to autotune " << instr->name() << ": "
+                     << tuned.status();
+        continue;
+      }
+      AddToCache(key, *tuned);
+      result = *std::move(tuned);
+    }
+
+    if (!result.has_value()) continue;
+    TF_RETURN_IF_ERROR(ApplyAutotuneResult(instr, *result));
+    changed = true;
+  }
+
+  if (!options_.dump_results_to.empty()) {
+    TF_RETURN_IF_ERROR(
+        SerializeAutotuneResultsToFile(options_.dump_results_to));
+  }
+
+  return changed;
+}
+
+absl::StatusOr<absl::Duration> CpuAutotuner::ProfileExecutable(
+    CpuExecutable& executable, int64_t num_threads, int64_t num_runs) {
+  TF_RET_CHECK(executable.has_thunks())
+      << "Autotuning is supported only by the thunk runtime";
+
+  struct AlignedFree {
+    void operator()(void* ptr) const { tsl::port::AlignedFree(ptr); }
+  };
+
+  // Allocate zero-initialized storage for all buffers except constants, which
+  // are owned by the executable, and thread-local buffers.
+  const BufferAssignment& assignment = executable.buffer_assignment();
+  std::vector<MaybeOwningDeviceMemory> buffers(assignment.Allocations().size());
+  std::vector<std::unique_ptr<void, AlignedFree>> storage;
+
+  for (const BufferAllocation& allocation : assignment.Allocations()) {
+    if (allocation.is_constant() || allocation.is_thread_local()) continue;
+
+    size_t size = std::max<int64_t>(allocation.size(), 1);
+    void* data =
+        tsl::port::AlignedMalloc(size, cpu_function_runtime::MinAlign());
+    if (data == nullptr) {
+      return ResourceExhausted("Failed to allocate %d bytes for autotuning",
+                               size);
+    }
+    std::memset(data, 0, size);
+    storage.emplace_back(data);
+
+    buffers[allocation.index()] =
+        se::DeviceMemoryBase(data, allocation.size());
+  }
+
+  for (const CpuExecutable::ConstantAllocation& constant :
+       executable.constants()) {
+    buffers[constant.index] = constant.AsDeviceMemoryBase();
+  }
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "xla_cpu_autotuner",
+                                      std::max<int64_t>(num_threads, 1));
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  ExecutableRunOptions run_options;
+  run_options.set_device_ordinal(0);
+  run_options.set_intra_op_thread_pool(&device);
+
+  // Warm up caches and lazily initialized kernels before measuring.
+  TF_RETURN_IF_ERROR(executable.ExecuteThunks(
+      &run_options, buffers, /*hlo_execution_profile=*/nullptr));
+
+  absl::Duration min_run_time = absl::InfiniteDuration();
+  for (int64_t i = 0; i < num_runs; ++i) {
+    absl::Time start = absl::Now();
+    TF_RETURN_IF_ERROR(executable.ExecuteThunks(
+        &run_options, buffers, /*hlo_execution_profile=*/nullptr));
+    min_run_time = std::min(min_run_time, absl::Now() - start);
+  }
+
+  return min_run_time;
+}
+
+void CpuAutotuner::LoadAutotuneResults(const CpuAutotuneResults& results) {
+  absl::MutexLock lock(&autotune_cache_mu);
+  AutotuneCache& cache = GetAutotuneCache();
+  for (const CpuAutotuneResults::Entry& entry : results.results()) {
+    cache.insert_or_assign(AutotuneCacheKey{entry.device(), entry.hlo()},
+                           entry.result());
+  }
+}
+
+absl::Status CpuAutotuner::LoadAutotuneResultsFromFile(
+    const std::string& path) {
+  CpuAutotuneResults results;
+  TF_RETURN_IF_ERROR(
+      tsl::ReadTextOrBinaryProto(tsl::Env::Default(), path, &results));
+  if (results.version() != kAutotuneResultsVersion) {
+    return InvalidArgument(
+        "Unsupported version of CPU autotune results in %s: %d (expected %d)",
+        path, results.version(), kAutotuneResultsVersion);
+  }
+  LoadAutotuneResults(results);
+  return absl::OkStatus();
+}
+
+CpuAutotuneResults CpuAutotuner::SerializeAutotuneResults() {
+  CpuAutotuneResults results;
+  results.set_version(kAutotuneResultsVersion);
+
+  absl::MutexLock lock(&autotune_cache_mu);
+  const AutotuneCache& cache = GetAutotuneCache();
+
+  // Sort entries to make serialized results deterministic.
+  std::vector<const AutotuneCache::value_type*> entries;
+  entries.reserve(cache.size());
+  for (const auto& entry : cache) entries.push_back(&entry);
+  absl::c_sort(entries, [](const auto* a, const auto* b) {
+    return a->first < b->first;
+  });
+
+  for (const auto* entry : entries) {
+    CpuAutotuneResults::Entry* result = results.add_results();
+    result->set_device(entry->first.first);
+    result->set_hlo(entry->first.second);
+    *result->mutable_result() = entry->second;
+  }
+  return results;
+}
+
+absl::Status CpuAutotuner::SerializeAutotuneResultsToFile(
+    const std::string& path) {
+  CpuAutotuneResults results = SerializeAutotuneResults();
+  VLOG(1) << "Dump " << results.results_size()
+          << " CPU autotune results to " << path;
+  if (IsTextProtoPath(path)) {
+    return tsl::WriteTextProto(tsl::Env::Default(), path, results);
+  }
+  return tsl::WriteBinaryProto(tsl::Env::Default(), path, results);
+}
+
+void CpuAutotuner::ClearAutotuneResults() {
+  absl::MutexLock lock(&autotune_cache_mu);
+  GetAutotuneCache().clear();
+}
+
+}  // namespace xla::cpu
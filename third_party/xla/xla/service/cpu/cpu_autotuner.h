@@ -0,0 +1,131 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_CPU_AUTOTUNER_H_
+#define XLA_SERVICE_CPU_CPU_AUTOTUNER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+#include "xla/service/cpu/cpu_autotuning.pb.h"
+#include "xla/service/cpu/cpu_executable.h"
+
+namespace xla::cpu {
+
+// CpuAutotuner selects the kernel configuration (outer dimension partitions
+// and preferred vector width) for host kernels emitted for loop fusions and
+// elementwise operations, by compiling and running a few variants of each
+// kernel on the local machine.
+//
+// Autotuning results are kept in a process-wide cache keyed by the device
+// (CPU name and features) and the canonical HLO of the instruction, and can be
+// loaded from and dumped to a file, so that subsequent compilations (possibly
+// in other processes) can reuse them without benchmarking.
+//
+// The pass must run after ParallelTaskAssigner, and the selected configuration
+// is only used by the thunk runtime (IrEmitter2).
+class CpuAutotuner : public HloModulePass {
+ public:
+  // Compiles `module` (a single instruction extracted into its own module) and
+  // returns the run time of the compiled kernel.
+  using ProfileFn = std::function<absl::StatusOr<absl::Duration>(
+      std::unique_ptr<HloModule> module)>;
+
+  struct Options {
+    // 0: autotuning is disabled.
+    // 1: apply results loaded from the cache only, do not run benchmarks.
+    // 2: also benchmark instructions that are missing in the cache.
+    int64_t autotune_level = 0;
+
+    // CPU name and target features of the machine we are compiling for.
+    std::string device;
+
+    // The maximum number of parallel tasks per kernel.
+    int64_t max_parallelism = 1;
+
+    // Candidate values for the "prefer-vector-width" kernel attribute.
+    std::vector<int64_t> vector_widths = {128, 256, 512};
+
+    // The maximum number of instructions benchmarked per module. Instructions
+    // are tuned in the order of decreasing result size.
+    int64_t max_tuned_instructions = 8;
+
+    // Instructions with smaller results are not worth tuning.
+    int64_t min_result_bytes = 64 * 1024;
+
+    // If not empty, the cache is loaded from and dumped to these files.
+    std::string load_results_from;
+    std::string dump_results_to;
+  };
+
+  CpuAutotuner(Options options, ProfileFn profile_fn);
+
+  absl::string_view name() const override { return "cpu-autotuner"; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+  // Runs thunks of the `executable` on zero-initialized buffers using an intra
+  // op thread pool with `num_threads` threads, and returns the minimum run time
+  // over `num_runs` runs (after a warm-up run).
+  static absl::StatusOr<absl::Duration> ProfileExecutable(
+      CpuExecutable& executable, int64_t num_threads, int64_t num_runs = 5);
+
+  // Adds results to the process-wide cache, overriding existing entries.
+  static void LoadAutotuneResults(const CpuAutotuneResults& results);
+  static absl::Status LoadAutotuneResultsFromFile(const std::string& path);
+
+  // Serializes all results in the process-wide cache. Files with ".txt" or
+  // ".textproto" extensions are written in the text format, all others in
+  // binary.
+  static CpuAutotuneResults SerializeAutotuneResults();
+  static absl::Status SerializeAutotuneResultsToFile(const std::string& path);
+
+  static void ClearAutotuneResults();
+
+ private:
+  // Benchmarks configuration variants of `instr` and returns the fastest one.
+  absl::StatusOr<CpuAutotuneResult> Autotune(const HloInstruction* instr);
+
+  // Returns the run time of `instr` with the given kernel configuration, or
+  // an error if it failed to compile or run.
+  absl::StatusOr<absl::Duration> Profile(
+      const HloInstruction* instr,
+      const std::vector<int64_t>& outer_dimension_partitions,
+      int64_t prefer_vector_width);
+
+  // Returns true if `instr` is a host kernel that can be autotuned.
+  bool IsCandidate(const HloInstruction* instr) const;
+
+  Options options_;
+  ProfileFn profile_fn_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_CPU_AUTOTUNER_H_
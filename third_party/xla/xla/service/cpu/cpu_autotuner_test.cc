@@ -0,0 +1,244 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/cpu_autotuner.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/cpu_autotuning.pb.h"
+#include "xla/service/cpu/cpu_executable.h"
+#include "xla/service/executable.h"
+#include "xla/service/hlo_module_config.h"
+#include "xla/test.h"
+#include "xla/tests/filecheck.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr char kHloModule[] = R"(
+  HloModule m
+
+  ENTRY e {
+    p0 = f32[1024,1024] parameter(0)
+    p1 = f32[1024,1024] parameter(1)
+    ROOT add = f32[1024,1024] add(p0, p1)
+  }
+)";
+
+class CpuAutotunerTest : public HloTestBase {
+ protected:
+  CpuAutotunerTest() { CpuAutotuner::ClearAutotuneResults(); }
+
+  static CpuAutotuner::Options GetOptions(int64_t autotune_level) {
+    CpuAutotuner::Options options;
+    options.autotune_level = autotune_level;
+    options.device = "test-cpu";
+    options.max_parallelism = 8;
+    return options;
+  }
+
+  // A fake profiler that prefers kernels with more partitions and with 512-bit
+  // vectors. Default vector width is 256.
+  CpuAutotuner::ProfileFn FakeProfile() {
+    return [this](std::unique_ptr<HloModule> module)
+               -> absl::StatusOr<absl::Duration> {
+      ++num_profiled_;
+      TF_ASSIGN_OR_RETURN(BackendConfig config,
+                          module->entry_computation()
+                              ->root_instruction()
+                              ->backend_config<BackendConfig>());
+      int64_t num_partitions = 1;
+      for (int64_t partitions : config.outer_dimension_partitions()) {
+        num_partitions *= partitions;
+      }
+      absl::Duration run_time = absl::Microseconds(1000 / num_partitions);
+      if (config.prefer_vector_width() == 512) {
+        run_time -= absl::Microseconds(10);
+      }
+      return run_time;
+    };
+  }
+
+  int64_t num_profiled_ = 0;
+};
+
+TEST_F(CpuAutotunerTest, AutotuneElementwiseOp) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kHloModule));
+
+  CpuAutotuner autotuner(GetOptions(/*autotune_level=*/2), FakeProfile());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, autotuner.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  // Four partitionings with the default vector width, and then two other
+  // vector widths with the fastest partitioning.
+  EXPECT_EQ(num_profiled_, 6);
+
+  TF_ASSERT_OK_AND_ASSIGN(BackendConfig config,
+                          module->entry_computation()
+                              ->root_instruction()
+                              ->backend_config<BackendConfig>());
+  EXPECT_THAT(config.outer_dimension_partitions(), ElementsAre(8));
+  EXPECT_EQ(config.prefer_vector_width(), 512);
+
+  // Identical instructions in other modules reuse cached results.
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> other,
+                          ParseAndReturnVerifiedModule(kHloModule));
+  TF_ASSERT_OK_AND_ASSIGN(changed, autotuner.Run(other.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(num_profiled_, 6);
+}
+
+TEST_F(CpuAutotunerTest, LoadAndDumpResults) {
+  std::string path =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "cpu_autotune_results.txt");
+
+  CpuAutotuner::Options options = GetOptions(/*autotune_level=*/2);
+  options.dump_results_to = path;
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kHloModule));
+  TF_ASSERT_OK(CpuAutotuner(options, FakeProfile()).Run(module.get()).status());
+
+  CpuAutotuneResults results;
+  TF_ASSERT_OK(tsl::ReadTextProto(tsl::Env::Default(), path, &results));
+  ASSERT_EQ(results.results_size(), 1);
+  EXPECT_EQ(results.results(0).device(), "test-cpu");
+  EXPECT_EQ(results.results(0).result().prefer_vector_width(), 512);
+
+  // Results loaded from the file are applied without benchmarking.
+  CpuAutotuner::ClearAutotuneResults();
+  num_profiled_ = 0;
+
+  options = GetOptions(/*autotune_level=*/1);
+  options.load_results_from = path;
+
+  TF_ASSERT_OK_AND_ASSIGN(module, ParseAndReturnVerifiedModule(kHloModule));
+  CpuAutotuner autotuner(options, FakeProfile());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, autotuner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(num_profiled_, 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(BackendConfig config,
+                          module->entry_computation()
+                              ->root_instruction()
+                              ->backend_config<BackendConfig>());
+  EXPECT_THAT(config.outer_dimension_partitions(), ElementsAre(8));
+  EXPECT_EQ(config.prefer_vector_width(), 512);
+}
+
+TEST_F(CpuAutotunerTest, SkipSmallInstructions) {
+  constexpr char hlo[] = R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[16] parameter(0)
+      p1 = f32[16] parameter(1)
+      ROOT add = f32[16] add(p0, p1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo));
+  CpuAutotuner autotuner(GetOptions(/*autotune_level=*/2), FakeProfile());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, autotuner.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(num_profiled_, 0);
+}
+
+// Checks that the kernel of the root instruction of `executable` has the
+// given "prefer-vector-width" attribute.
+void VerifyPreferVectorWidth(const Executable& executable,
+                             int64_t prefer_vector_width) {
+  const auto& cpu_executable = static_cast<const CpuExecutable&>(executable);
+  const HloInstruction* root =
+      cpu_executable.module().entry_computation()->root_instruction();
+  std::string pattern = absl::StrReplaceAll(
+      R"(
+    CHECK: define {{.*}} @$name({{.*}}) #[[ATTRS:[0-9]+]]
+    CHECK: attributes #[[ATTRS]] = { {{.*}}"prefer-vector-width"="$width"
+  )",
+      {{"$name", root->name()},
+       {"$width", absl::StrCat(prefer_vector_width)}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool matched, RunFileCheck(cpu_executable.ir_module_string(), pattern));
+  EXPECT_TRUE(matched);
+}
+
+TEST_F(CpuAutotunerTest, AutotuneWithCpuCompiler) {
+  constexpr char hlo[] = R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[128,256] parameter(0)
+      p1 = f32[128,256] parameter(1)
+      ROOT add = f32[128,256] add(p0, p1)
+    }
+  )";
+
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_cpu_use_thunk_runtime(true);
+  debug_options.set_xla_cpu_autotune_level(2);
+  debug_options.set_xla_embed_ir_in_executable(true);
+  // Not one of the tuned vector widths, so that a kernel that keeps the
+  // module-wide width can be told apart from a tuned one.
+  debug_options.set_xla_cpu_prefer_vector_width(64);
+
+  auto compile = [&]() -> absl::StatusOr<std::unique_ptr<Executable>> {
+    HloModuleConfig config = GetModuleConfigForTest();
+    config.set_debug_options(debug_options);
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                        ParseAndReturnVerifiedModule(hlo, config));
+    return CreateExecutable(std::move(module), /*run_hlo_passes=*/true);
+  };
+
+  // The compiler profiles the candidates of the add on this machine.
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> executable, compile());
+  CpuAutotuneResults results = CpuAutotuner::SerializeAutotuneResults();
+  ASSERT_EQ(results.results_size(), 1);
+  int64_t tuned_width = results.results(0).result().prefer_vector_width();
+  VerifyPreferVectorWidth(*executable, tuned_width > 0 ? tuned_width : 64);
+
+  // A cached result overrides the module-wide vector width of the kernel.
+  int64_t cached_width = tuned_width == 512 ? 128 : 512;
+  results.mutable_results(0)->mutable_result()->set_prefer_vector_width(
+      cached_width);
+  CpuAutotuner::LoadAutotuneResults(results);
+  debug_options.set_xla_cpu_autotune_level(1);
+  TF_ASSERT_OK_AND_ASSIGN(executable, compile());
+  VerifyPreferVectorWidth(*executable, cached_width);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -42,6 +42,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -115,8 +116,10 @@ limitations under the License.
 #include "xla/service/convolution_group_converter.h"
 #include "xla/service/copy_insertion.h"
 #include "xla/service/cpu/buffer_info_util.h"
+#include "xla/service/cpu/compiled_object_cache.h"
 #include "xla/service/cpu/compiler_functor.h"
 #include "xla/service/cpu/conv_canonicalization.h"
+#include "xla/service/cpu/cpu_autotuner.h"
 #include "xla/service/cpu/cpu_executable.h"
 #include "xla/service/cpu/cpu_instruction_fusion.h"
 #include "xla/service/cpu/cpu_layout_assignment.h"
@@ -126,6 +129,7 @@ limitations under the License.
 #include "xla/service/cpu/ir_emitter.h"
 #include "xla/service/cpu/ir_emitter2.h"
 #include "xla/service/cpu/parallel_task_assignment.h"
+#include "xla/service/cpu/peak_memory_limiter.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/cpu/target_machine_features.h"
 #include "xla/service/cpu/thunk_emitter.h"
@@ -857,6 +861,35 @@ absl::Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+
+    // Autotune partitioning and vector width of host kernels emitted by the
+    // thunk runtime. Candidate kernels are compiled and benchmarked on the
+    // local machine, so this is only supported for JIT compilation.
+    const DebugOptions& options = module->config().debug_options();
+    if (options.xla_cpu_use_thunk_runtime() &&
+        options.xla_cpu_autotune_level() > 0) {
+      CpuAutotuner::Options autotuner_options;
+      autotuner_options.autotune_level = options.xla_cpu_autotune_level();
+      autotuner_options.device =
+          absl::StrCat(std::string_view(llvm::sys::getHostCPUName()), ":",
+                       target_machine_features->get_target_feature_string());
+      autotuner_options.max_parallelism = max_parallelism;
+      autotuner_options.load_results_from =
+          options.xla_cpu_load_autotune_results_from();
+      autotuner_options.dump_results_to =
+          options.xla_cpu_dump_autotune_results_to();
+
+      auto profile =
+          [this, max_parallelism](std::unique_ptr<HloModule> candidate)
+          -> absl::StatusOr<absl::Duration> {
+        TF_ASSIGN_OR_RETURN(std::unique_ptr<CpuExecutable> executable,
+                            CompileLegacyCpuExecutable(std::move(candidate)));
+        return CpuAutotuner::ProfileExecutable(*executable, max_parallelism);
+      };
+
+      pipeline.AddPass<CpuAutotuner>(std::move(autotuner_options),
+                                     std::move(profile));
+    }
   }
   // Copy insertion should be performed immediately before IR emission to
   // avoid inserting unnecessary copies (later pass adds an instruction which
@@ -1307,6 +1340,28 @@ static bool HasLargeConstants(llvm::Module& module) {
   return false;
 }
 
+// Rematerializes instructions of the scheduled HLO module to fit into the peak
+// memory budget, and returns peak memory stats for the memory report. Returns
+// std::nullopt if the budget is not set, and we don't dump the report.
+static absl::StatusOr<std::optional<PeakMemoryStats>> MaybeLimitPeakMemory(
+    HloModule* module, const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  int64_t memory_limit_bytes =
+      module->config().debug_options().xla_cpu_memory_limit_bytes();
+  if (memory_limit_bytes == 0 && !DumpingEnabledForHloModule(*module)) {
+    return std::nullopt;
+  }
+  return LimitPeakMemory(module, memory_limit_bytes, shape_size);
+}
+
+static void MaybeDumpPeakMemoryReport(
+    const std::optional<PeakMemoryStats>& stats,
+    const BufferAssignment& assignment) {
+  if (stats.has_value() && DumpingEnabledForHloModule(assignment.module())) {
+    DumpToFileInDirOrStdout(assignment.module(), "", "peak_memory_report",
+                            PeakMemoryReport(*stats, assignment));
+  }
+}
+
 inline void VlogMaxIsa(absl::string_view max_cpu_isa) {
   if (VLOG_IS_ON(1) && !max_cpu_isa.empty()) {
     if (tsl::port::IsX86CPU()) {
@@ -1350,6 +1405,18 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
       debug_options.xla_cpu_parallel_codegen_split_count();
   VlogMaxIsa(debug_options.xla_cpu_max_isa());
 
+  // Share compiled object files with other compilations via the object cache.
+  // Cached object files skip LLVM optimizations, so we don't use the cache if
+  // we have to dump or pass optimized LLVM IR to the user. The cache is process
+  // wide, so its capacity is the largest one requested by any compilation.
+  CompiledObjectCache* object_cache = nullptr;
+  if (int64_t cache_size_mb = debug_options.xla_cpu_object_cache_size_mb();
+      cache_size_mb > 0 && !DumpingEnabledForHloModule(*module) &&
+      !user_post_optimization_hook_) {
+    object_cache = CompiledObjectCache::Global();
+    object_cache->GrowCapacity(cache_size_mb * 1024 * 1024);
+  }
+
   auto jit = SimpleOrcJIT::Create(
       CompilerTargetOptions(module->config()),
       CodeGenOptLevel(module->config()),
@@ -1359,7 +1426,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
       llvm_ir::GetCpuFastMathFlags(module->config()), pre_optimization_ir_hook,
       post_optimization_ir_hook,
       CreateOrcJITPostCompilationHook(module.get(), &obj_files),
-      parallel_codegen_split_count, debug_options.xla_cpu_max_isa());
+      parallel_codegen_split_count, debug_options.xla_cpu_max_isa(),
+      object_cache);
   if (!jit) {
     return Internal("Creating JIT failed: %s", llvm::toString(jit.takeError()));
   }
@@ -1399,6 +1467,12 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
                      ComputationSchedulerToModuleScheduler(scheduler)));
   TF_RETURN_IF_ERROR(module->set_schedule(schedule));
 
+  // Rematerialization updates the module schedule.
+  TF_ASSIGN_OR_RETURN(
+      std::optional<PeakMemoryStats> peak_memory_stats,
+      MaybeLimitPeakMemory(module.get(), ShapeSizeBytesFunction()));
+  schedule = module->schedule();
+
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<BufferAssignment> assignment,
@@ -1408,6 +1482,7 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
                           /*allocate_buffers_for_constants=*/true));
   DumpHloModuleIfEnabled(*module, *assignment,
                          absl::StrCat("cpu_", kAfterOptimizationsDumpName));
+  MaybeDumpPeakMemoryReport(peak_memory_stats, *assignment);
 
   // Dump computation proto state and buffer assignment for
   // GetCompiledMemoryStats results.
@@ -1482,6 +1557,14 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
     size_t num_parts =
         std::min(num_compiled_functions, parallel_codegen_split_count);
 
+    // With object cache we split the module into a part per compiled function,
+    // so that each kernel is cached independently of the other kernels that
+    // happen to be in the same module. Parts share JIT dylibs round-robin.
+    size_t num_jit_dylibs = std::max(size_t{1}, parallel_codegen_split_count);
+    if (object_cache) {
+      num_parts = num_compiled_functions;
+    }
+
     // JIT compile the LLVM IR module to in-memory machine code. We split the
     // module into `num_jit_dylibs` parts to allow parallel compilation. In
     // practice, all of the kernel functions are independent and don't call each
@@ -1524,7 +1607,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
 
             // Clone LLVM module part into its own thread safe context.
             auto tsm = CloneAsThreadSafeModule(n, std::move(llvm_module_part));
-            cantFail((*jit)->AddModule(std::move(tsm), /*dylib_index=*/n++));
+            cantFail((*jit)->AddModule(std::move(tsm),
+                                       /*dylib_index=*/n++ % num_jit_dylibs));
           },
           /*PreserveLocals=*/true, /*RoundRobin=*/true);
 
@@ -1828,6 +1912,13 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
 
       TF_ASSIGN_OR_RETURN(HloSchedule schedule,
                           ScheduleModule(module, BufferSizeBytesFunction()));
+      TF_RETURN_IF_ERROR(module->set_schedule(schedule));
+
+      // Rematerialization updates the module schedule.
+      TF_ASSIGN_OR_RETURN(
+          std::optional<PeakMemoryStats> peak_memory_stats,
+          MaybeLimitPeakMemory(module, ShapeSizeBytesFunction()));
+      schedule = module->schedule();
 
       // Run buffer analysis on the HLO graph. This analysis figures out which
       // temporary buffers are required to run the computation.
@@ -1845,6 +1936,7 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
       }
       DumpHloModuleIfEnabled(*module, *assignment,
                              absl::StrCat("cpu_", kAfterOptimizationsDumpName));
+      MaybeDumpPeakMemoryReport(peak_memory_stats, *assignment);
 
       absl::flat_hash_map<const HloInstruction*, int64_t>
           instruction_to_profile_idx;
@@ -50,6 +50,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/literal.h"
 #include "xla/service/buffer_assignment.h"
+#include "xla/service/cpu/cpu_executable_run_options.h"
 #include "xla/service/cpu/cpu_runtime.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/custom_call_status.h"
@@ -402,6 +403,12 @@ absl::Status CpuExecutable::ExecuteThunks(
       &collective_execute_params,
       &custom_call_execute_params};
 
+  // Record thunk execution events if the caller asked for it.
+  if (const CpuExecutableRunOptions* cpu_run_options =
+          run_options->cpu_executable_run_options()) {
+    execute_params.profiler = cpu_run_options->thunk_profiler();
+  }
+
   auto executed_event = thunks_->Execute(execute_params);
   tsl::BlockUntilReady(executed_event);
 
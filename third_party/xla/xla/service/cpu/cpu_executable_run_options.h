@@ -20,6 +20,8 @@ limitations under the License.
 
 namespace xla::cpu {
 
+class ThunkProfiler;
+
 // CPU-specific executable options.
 // We keep these separate from ExecutableRunOptions to avoid adding
 // dependencies to ExecutableRunOptions.
@@ -31,10 +33,20 @@ class CpuExecutableRunOptions {
   }
   CollectivesInterface* collectives() const { return collectives_; }
 
+  CpuExecutableRunOptions& set_thunk_profiler(ThunkProfiler* thunk_profiler) {
+    thunk_profiler_ = thunk_profiler;
+    return *this;
+  }
+  ThunkProfiler* thunk_profiler() const { return thunk_profiler_; }
+
  private:
   // For cross-process collectives, use this collective implementation to
   // communicate.
   CollectivesInterface* collectives_;
+
+  // If set, executables compiled to thunks record execution events of all
+  // thunks in the profiler.
+  ThunkProfiler* thunk_profiler_ = nullptr;
 };
 
 }  // namespace xla::cpu
@@ -886,8 +886,19 @@ absl::StatusOr<IrEmitter2::KernelPrototype> IrEmitter2::EmitKernelPrototype(
                       GetKernelArgumentsParameters(instr));
   TF_ASSIGN_OR_RETURN(std::vector<KernelParameter> results,
                       GetKernelResultsParameters(instr));
-  return EmitKernelPrototype(instr->name(), std::move(arguments),
-                             std::move(results));
+  TF_ASSIGN_OR_RETURN(KernelPrototype kernel_prototype,
+                      EmitKernelPrototype(instr->name(), std::move(arguments),
+                                          std::move(results)));
+
+  // Override the module-wide preferred vector width if it was autotuned.
+  auto backend_config = instr->backend_config<BackendConfig>();
+  if (backend_config.ok() && backend_config->prefer_vector_width() > 0) {
+    kernel_prototype.function->addFnAttr(
+        "prefer-vector-width",
+        absl::StrCat(backend_config->prefer_vector_width()));
+  }
+
+  return kernel_prototype;
 }
 
 std::optional<IrEmitter2::ParallelConfig> IrEmitter2::GetParallelConfig(
@@ -0,0 +1,138 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/peak_memory_limiter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/buffer_value.h"
+#include "xla/service/heap_simulator/heap_simulator.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/service/hlo_rematerialization.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/numbers.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::cpu {
+
+using ::tsl::strings::HumanReadableNumBytes;
+
+static absl::StatusOr<int64_t> PeakMemoryBytes(
+    const HloModule& module,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  return HeapSimulator::MinimumMemoryForModule(
+      module.schedule(), [&](const BufferValue& buffer) {
+        return shape_size(buffer.shape());
+      });
+}
+
+static absl::StatusOr<double> FlopCount(
+    const HloModule& module,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  HloCostAnalysis cost_analysis(shape_size);
+  TF_RETURN_IF_ERROR(module.entry_computation()->Accept(&cost_analysis));
+  return cost_analysis.flop_count();
+}
+
+absl::StatusOr<PeakMemoryStats> LimitPeakMemory(
+    HloModule* module, int64_t memory_limit_bytes,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  PeakMemoryStats stats;
+  stats.memory_limit_bytes = memory_limit_bytes;
+
+  TF_ASSIGN_OR_RETURN(stats.peak_bytes_before,
+                      PeakMemoryBytes(*module, shape_size));
+  TF_ASSIGN_OR_RETURN(stats.flops_before, FlopCount(*module, shape_size));
+
+  stats.peak_bytes_after = stats.peak_bytes_before;
+  stats.flops_after = stats.flops_before;
+
+  VLOG(1) << "Peak memory usage of module " << module->name() << ": "
+          << HumanReadableNumBytes(stats.peak_bytes_before)
+          << " (limit: " << HumanReadableNumBytes(memory_limit_bytes) << ")";
+
+  if (memory_limit_bytes == 0 ||
+      stats.peak_bytes_before <= memory_limit_bytes) {
+    return stats;
+  }
+
+  // We only enable the recompute strategy, as XLA:CPU does not have a slower
+  // memory space to offload buffers to, and compressing buffers requires
+  // layouts that CPU emitters do not support.
+  HloCostAnalysis cost_analysis(shape_size);
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization::Options options(
+      cost_analysis,
+      HloRematerialization::RematerializationModeConfig(
+          /*recompute=*/true, /*compress=*/false, /*host_offload=*/false),
+      memory_limit_bytes, /*block_size_limit=*/1,
+      /*block_rematerialization_factor=*/1, /*min_remat_size=*/0,
+      /*compact_shape_function=*/nullptr);
+
+  HloRematerialization rematerialization(options, sizes);
+  TF_ASSIGN_OR_RETURN(stats.rematerialized, rematerialization.Run(module));
+
+  if (stats.rematerialized) {
+    TF_ASSIGN_OR_RETURN(stats.peak_bytes_after,
+                        PeakMemoryBytes(*module, shape_size));
+    TF_ASSIGN_OR_RETURN(stats.flops_after, FlopCount(*module, shape_size));
+  }
+
+  VLOG(1) << "Rematerialized module " << module->name() << ": peak memory "
+          << HumanReadableNumBytes(stats.peak_bytes_before) << " -> "
+          << HumanReadableNumBytes(stats.peak_bytes_after) << ", flops "
+          << stats.flops_before << " -> " << stats.flops_after;
+
+  if (stats.peak_bytes_after > memory_limit_bytes) {
+    LOG(WARNING) << "Can't fit module " << module->name()
+                 << " into the memory limit of "
+                 << HumanReadableNumBytes(memory_limit_bytes)
+                 << "; peak memory usage is "
+                 << HumanReadableNumBytes(stats.peak_bytes_after);
+  }
+
+  return stats;
+}
+
+std::string PeakMemoryReport(const PeakMemoryStats& stats,
+                             const BufferAssignment& assignment,
+                             size_t max_buffers_to_show) {
+  std::string report = absl::StrCat(
+      "Peak memory report for module ", assignment.module().name(), "\n",
+      "Memory limit: ",
+      stats.memory_limit_bytes ? HumanReadableNumBytes(stats.memory_limit_bytes)
+                               : "none",
+      "\n",
+      "Peak memory before rematerialization: ",
+      HumanReadableNumBytes(stats.peak_bytes_before), "\n",
+      "Peak memory after rematerialization: ",
+      HumanReadableNumBytes(stats.peak_bytes_after), "\n",
+      "Flops before rematerialization: ", stats.flops_before, "\n",
+      "Flops after rematerialization: ", stats.flops_after, "\n\n");
+
+  // Verbose buffer assignment string includes allocation stats and the
+  // largest buffers live at the point of peak memory usage.
+  absl::StrAppend(&report, assignment.ToVerboseString(max_buffers_to_show));
+  return report;
+}
+
+}  // namespace xla::cpu
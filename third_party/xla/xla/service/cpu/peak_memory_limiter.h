@@ -0,0 +1,67 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_PEAK_MEMORY_LIMITER_H_
+#define XLA_SERVICE_CPU_PEAK_MEMORY_LIMITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/hlo_cost_analysis.h"
+
+namespace xla::cpu {
+
+// Peak memory usage of a scheduled HLO module before and after running
+// `LimitPeakMemory`. Peak memory is the maximum total size of all live
+// buffers (including parameters and results) according to the heap simulator.
+struct PeakMemoryStats {
+  int64_t memory_limit_bytes = 0;
+  int64_t peak_bytes_before = 0;
+  int64_t peak_bytes_after = 0;
+
+  // The number of flops in the module before and after rematerialization.
+  // The difference is the cost of recomputing rematerialized instructions.
+  double flops_before = 0;
+  double flops_after = 0;
+
+  bool rematerialized = false;
+};
+
+// Rematerializes instructions in the scheduled HLO module to keep its peak
+// memory usage under the `memory_limit_bytes` budget. We use the heap
+// simulator to check if the module fits into the budget, and run
+// `HloRematerialization` only when it does not, because rematerialization
+// trades extra compute for memory, and on CPU compute is on the critical path.
+//
+// Memory limit is a best effort budget: if the module does not fit into it
+// even after rematerialization, we log a warning but do not return an error.
+// If `memory_limit_bytes` is zero, we only collect peak memory stats.
+absl::StatusOr<PeakMemoryStats> LimitPeakMemory(
+    HloModule* module, int64_t memory_limit_bytes,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size);
+
+// Returns a human readable report of the module peak memory usage and the
+// largest buffers live at the peak (the ones that cause it).
+std::string PeakMemoryReport(const PeakMemoryStats& stats,
+                             const BufferAssignment& assignment,
+                             size_t max_buffers_to_show = 10);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_PEAK_MEMORY_LIMITER_H_
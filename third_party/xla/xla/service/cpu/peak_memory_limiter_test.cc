@@ -0,0 +1,105 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/peak_memory_limiter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/buffer_value.h"
+#include "xla/service/hlo_ordering.h"
+#include "xla/service/logical_buffer.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/test.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::cpu {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Computation requires 16KB without rematerialization, but uses only 12KB
+// with rematerialization of the `bcast` instruction before `concat_2`.
+constexpr std::string_view kRematerializableModule = R"(
+  HloModule m, is_scheduled=true
+
+  ENTRY e {
+    param = f32[1] parameter(0)
+    reshape = f32[] reshape(param)
+    bcast = f32[1024] broadcast(reshape), dimensions={}
+    negate = f32[1024] negate(bcast)
+    concat_1 = f32[2048] concatenate(negate, negate), dimensions={0}
+    slice_1 = f32[1] slice(concat_1), slice={[0:1]}
+    concat_2 = f32[1025] concatenate(bcast, slice_1), dimensions={0}
+    ROOT slice_2 = f32[1] slice(concat_2), slice={[0:1]}
+  }
+)";
+
+static int64_t ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+}
+
+class PeakMemoryLimiterTest : public HloTestBase {};
+
+TEST_F(PeakMemoryLimiterTest, FitsIntoMemoryLimit) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kRematerializableModule));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      PeakMemoryStats stats,
+      LimitPeakMemory(module.get(), /*memory_limit_bytes=*/32 * 1024,
+                      ShapeSize));
+
+  EXPECT_FALSE(stats.rematerialized);
+  EXPECT_GE(stats.peak_bytes_before, 16 * 1024);
+  EXPECT_EQ(stats.peak_bytes_after, stats.peak_bytes_before);
+  EXPECT_EQ(stats.flops_after, stats.flops_before);
+}
+
+TEST_F(PeakMemoryLimiterTest, RematerializeToMemoryLimit) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kRematerializableModule));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      PeakMemoryStats stats,
+      LimitPeakMemory(module.get(), /*memory_limit_bytes=*/14 * 1024,
+                      ShapeSize));
+
+  EXPECT_TRUE(stats.rematerialized);
+  EXPECT_GE(stats.peak_bytes_before, 16 * 1024);
+  EXPECT_LE(stats.peak_bytes_after, 14 * 1024);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BufferAssignment> assignment,
+      BufferAssigner::Run(
+          module.get(),
+          std::make_unique<SequentialHloOrdering>(module->schedule()),
+          [](const BufferValue& buffer) { return ShapeSize(buffer.shape()); },
+          /*color_alignment=*/[](LogicalBuffer::Color) { return 1; },
+          /*allocate_buffers_for_constants=*/true));
+
+  std::string report = PeakMemoryReport(stats, *assignment);
+  EXPECT_THAT(report, HasSubstr("Peak memory report for module m"));
+  EXPECT_THAT(report, HasSubstr("Buffer 1:"));
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -47,6 +47,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/TargetParser/Triple.h"
+#include "xla/service/cpu/compiled_object_cache.h"
 #include "xla/service/cpu/compiler_functor.h"
 #include "xla/service/llvm_compiler.h"
 #include "tsl/platform/cpu_info.h"
@@ -70,7 +71,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   //
   // {pre,post}_optimization_hook is invoked on the module before/after all
   // LLVM IR-level optimizations.  post_codegen_hook is invoked after
-  // compiling to machine code.
+  // compiling to machine code. If object_cache is not null, object files
+  // compiled from identical modules are reused (see CompilerFunctor).
   SimpleOrcJIT(
       std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control,
       std::unique_ptr<llvm::orc::ExecutionSession> execution_session,
@@ -82,7 +84,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       LLVMCompiler::ModuleHook post_optimization_hook,
       absl::AnyInvocable<void(const llvm::object::ObjectFile&)>
           post_codegen_hook,
-      size_t num_jit_dylibs, absl::string_view max_cpu_isa);
+      size_t num_jit_dylibs, absl::string_view max_cpu_isa,
+      CompiledObjectCache* object_cache = nullptr);
 
   static llvm::Expected<std::unique_ptr<SimpleOrcJIT>> Create(
       const llvm::TargetOptions& target_options,
@@ -93,7 +96,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       LLVMCompiler::ModuleHook post_optimization_hook,
       absl::AnyInvocable<void(const llvm::object::ObjectFile&)>
           post_codegen_hook,
-      size_t num_jit_dylibs, absl::string_view max_cpu_isa);
+      size_t num_jit_dylibs, absl::string_view max_cpu_isa,
+      CompiledObjectCache* object_cache = nullptr);
 
   ~SimpleOrcJIT() override;
 